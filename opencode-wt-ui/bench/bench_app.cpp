@@ -0,0 +1,222 @@
+// Cost of constructing a session's App, phase by phase, in a
+// Wt::Test::WTestEnvironment: no browser, no HTTP, only the server side work
+// every new session pays for. Each phase reports wall time, heap
+// allocations and allocated bytes per construction; the full App also
+// reports the size of the HTML and CSS its first render produces.
+//
+// Needs the server's workspace like the app itself:
+//   ./bench/bench_app --docroot ../ -c ../wt_config.xml --benchmark_format=json
+// Release builds open the PostgreSQL database from the POSTGRES_* variables.
+
+#include <benchmark/benchmark.h>
+
+#include <Wt/Test/WTestEnvironment.h>
+#include <Wt/WApplication.h>
+#include <Wt/WContainerWidget.h>
+#include <Wt/WCssStyleSheet.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <vector>
+
+#include "000_Server/Server.h"
+#include "001_App/App.h"
+#include "003_Auth/AuthWidget.h"
+#include "004_Theme/DarkModeToggle.h"
+#include "004_Theme/Theme.h"
+#include "006_Stylus/Stylus.h"
+#include "007_Opencode/Opencode.h"
+#include "008_Workspace/LiveStrings.h"
+
+namespace {
+
+std::atomic<std::uint64_t> allocations{0};
+std::atomic<std::uint64_t> allocated_bytes{0};
+
+}
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace {
+
+const std::string DatabasePath = "bench_app.db";
+
+/// Allocations made between construction and report(), divided by the iterations
+class AllocationCounter {
+public:
+    AllocationCounter()
+        : allocations_(allocations.load()), bytes_(allocated_bytes.load())
+    {
+    }
+
+    void report(benchmark::State& state) const
+    {
+        double iterations = static_cast<double>(std::max<benchmark::IterationCount>(1, state.iterations()));
+        state.counters["allocs"] = static_cast<double>(allocations.load() - allocations_) / iterations;
+        state.counters["alloc_bytes"] = static_cast<double>(allocated_bytes.load() - bytes_) / iterations;
+    }
+
+private:
+    std::uint64_t allocations_;
+    std::uint64_t bytes_;
+};
+
+/// A bare application to construct the App's parts in, one per benchmark
+struct Fixture {
+    Fixture()
+        : app(environment), session(DatabasePath)
+    {
+        Workspace::LiveStrings::install(Server::instance()->messageBundles());
+    }
+
+    Wt::Test::WTestEnvironment environment;
+    Wt::WApplication app;
+    Session session;
+};
+
+void BM_Session(benchmark::State& state)
+{
+    Wt::Test::WTestEnvironment environment;
+    Wt::WApplication app(environment);
+    AllocationCounter counter;
+    for (auto _ : state) {
+        Session session(DatabasePath);
+        benchmark::DoNotOptimize(&session);
+    }
+    counter.report(state);
+}
+BENCHMARK(BM_Session)->Unit(benchmark::kMicrosecond);
+
+void BM_AuthWidget(benchmark::State& state)
+{
+    Fixture fixture;
+    AllocationCounter counter;
+    for (auto _ : state) {
+        auto auth_widget = std::make_unique<AuthWidget>(fixture.session);
+        auth_widget->processEnvironment();
+        benchmark::DoNotOptimize(auth_widget.get());
+    }
+    counter.report(state);
+}
+BENCHMARK(BM_AuthWidget)->Unit(benchmark::kMicrosecond);
+
+void BM_Theme(benchmark::State& state)
+{
+    Fixture fixture;
+    AllocationCounter counter;
+    for (auto _ : state) {
+        fixture.app.setTheme(std::make_shared<Theme>());
+    }
+    counter.report(state);
+}
+BENCHMARK(BM_Theme)->Unit(benchmark::kMicrosecond);
+
+void BM_Stylus(benchmark::State& state)
+{
+    Fixture fixture;
+    AllocationCounter counter;
+    for (auto _ : state) {
+        auto stylus = std::make_unique<Stylus::Stylus>(fixture.session);
+        benchmark::DoNotOptimize(stylus.get());
+    }
+    counter.report(state);
+}
+BENCHMARK(BM_Stylus)->Unit(benchmark::kMicrosecond);
+
+void BM_Opencode(benchmark::State& state)
+{
+    Fixture fixture;
+    AllocationCounter counter;
+    for (auto _ : state) {
+        auto opencode = std::make_unique<Opencode::Opencode>(fixture.session);
+        benchmark::DoNotOptimize(opencode.get());
+    }
+    counter.report(state);
+}
+BENCHMARK(BM_Opencode)->Unit(benchmark::kMicrosecond);
+
+/// What App::createApp builds for a visitor who is not logged in
+void BM_CreateApp(benchmark::State& state)
+{
+    Fixture fixture;
+    AllocationCounter counter;
+    for (auto _ : state) {
+        auto app_root = std::make_unique<Wt::WContainerWidget>();
+        app_root->addNew<DarkModeToggle>(fixture.session);
+        app_root->addNew<Opencode::Opencode>(fixture.session);
+        benchmark::DoNotOptimize(app_root.get());
+    }
+    counter.report(state);
+}
+BENCHMARK(BM_CreateApp)->Unit(benchmark::kMicrosecond);
+
+/// The whole App, as the "/" entry point creates it, and its first render
+void BM_App(benchmark::State& state)
+{
+    std::uint64_t app_allocations = 0;
+    std::uint64_t app_bytes = 0;
+    std::size_t html_bytes = 0;
+    std::size_t css_bytes = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto environment = std::make_unique<Wt::Test::WTestEnvironment>();
+        std::uint64_t allocations_before = allocations.load();
+        std::uint64_t bytes_before = allocated_bytes.load();
+        state.ResumeTiming();
+
+        auto app = std::make_unique<App>(*environment);
+
+        state.PauseTiming();
+        app_allocations += allocations.load() - allocations_before;
+        app_bytes += allocated_bytes.load() - bytes_before;
+        std::ostringstream html;
+        app->root()->htmlText(html);
+        html_bytes = html.str().size();
+        css_bytes = app->styleSheet().cssText(true).size();
+        app.reset();
+        environment.reset();
+        state.ResumeTiming();
+    }
+    double iterations = static_cast<double>(std::max<benchmark::IterationCount>(1, state.iterations()));
+    state.counters["allocs"] = static_cast<double>(app_allocations) / iterations;
+    state.counters["alloc_bytes"] = static_cast<double>(app_bytes) / iterations;
+    state.counters["html_bytes"] = static_cast<double>(html_bytes);
+    state.counters["css_bytes"] = static_cast<double>(css_bytes);
+}
+BENCHMARK(BM_App)->Unit(benchmark::kMillisecond);
+
+}
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+
+    // App and its widgets reach the shared services through Server::instance()
+    Server server(argc, argv);
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,127 @@
+// Line diff on generated source files: typical agent edits (a few scattered
+// changes) and worst cases (heavy rewrites) at 1k-100k lines.
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "007_Opencode/LineDiff.h"
+
+using namespace Opencode;
+
+namespace {
+
+std::vector<std::string> generateLines(std::size_t count, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<std::string> lines;
+    lines.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string line(rng() % 8 * 4, ' ');
+        line += "value_" + std::to_string(rng() % 5000) + " = compute(" + std::to_string(i) + ", state);";
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+std::string join(const std::vector<std::string>& lines)
+{
+    std::string text;
+    for (const auto& line : lines) {
+        text += line;
+        text += '\n';
+    }
+    return text;
+}
+
+/// Applies edits: each replaces, inserts or deletes a few lines somewhere
+std::vector<std::string> edit(std::vector<std::string> lines, std::size_t edits, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    for (std::size_t e = 0; e < edits && !lines.empty(); ++e) {
+        std::size_t at = rng() % lines.size();
+        switch (rng() % 3) {
+        case 0:
+            lines[at] = "    // changed " + std::to_string(e);
+            break;
+        case 1:
+            lines.insert(lines.begin() + at, 1 + rng() % 4, "    added_line(" + std::to_string(e) + ");");
+            break;
+        default:
+            lines.erase(lines.begin() + at, lines.begin() + std::min(lines.size(), at + 1 + rng() % 4));
+            break;
+        }
+    }
+    return lines;
+}
+
+void runDiff(benchmark::State& state, std::size_t lines, std::size_t edits)
+{
+    auto original = generateLines(lines, 1);
+    std::string old_text = join(original);
+    std::string new_text = join(edit(original, edits, 2));
+
+    std::size_t hunks = 0;
+    for (auto _ : state) {
+        FileDiff diff = diffLines(old_text, new_text);
+        hunks = diff.hunks.size();
+        benchmark::DoNotOptimize(diff);
+    }
+    state.counters["hunks"] = static_cast<double>(hunks);
+    state.SetBytesProcessed(state.iterations() * (old_text.size() + new_text.size()));
+}
+
+void BM_Diff_FewEdits(benchmark::State& state)
+{
+    runDiff(state, state.range(0), 10);
+}
+BENCHMARK(BM_Diff_FewEdits)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+void BM_Diff_ManyEdits(benchmark::State& state)
+{
+    runDiff(state, state.range(0), state.range(0) / 20);
+}
+BENCHMARK(BM_Diff_ManyEdits)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+void BM_Diff_Rewrite(benchmark::State& state)
+{
+    // Unrelated files: bounded by DiffOptions::max_cost
+    std::string old_text = join(generateLines(state.range(0), 1));
+    std::string new_text = join(generateLines(state.range(0), 3));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(diffLines(old_text, new_text));
+    }
+    state.SetBytesProcessed(state.iterations() * (old_text.size() + new_text.size()));
+}
+BENCHMARK(BM_Diff_Rewrite)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+void BM_SplitLines(benchmark::State& state)
+{
+    std::string text = join(generateLines(state.range(0), 1));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(splitLines(text));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_SplitLines)->Arg(100000);
+
+void BM_HashLines(benchmark::State& state)
+{
+    std::string text = join(generateLines(state.range(0), 1));
+    auto lines = splitLines(text);
+    for (auto _ : state) {
+        std::uint64_t sum = 0;
+        for (auto line : lines) {
+            sum += hashLine(line);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_HashLines)->Arg(100000);
+
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,121 @@
+// Fuzzy path completion over a generated 100k file workspace: short and
+// long queries, common and rare characters, and incremental updates.
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "008_Workspace/FuzzyIndex.h"
+
+using namespace Workspace;
+
+namespace {
+
+std::vector<FileEntry> generateTree(std::size_t files, unsigned seed)
+{
+    static const char* words[] = {
+        "src", "server", "app", "auth", "theme", "components", "stylus", "opencode", "workspace", "static",
+        "session", "transcript", "event", "stream", "client", "payload", "index", "search", "diff", "view",
+        "model", "store", "table", "user", "permission", "monaco", "editor", "tailwind", "xml", "utils"
+    };
+    static const char* extensions[] = {".cpp", ".h", ".xml", ".css", ".js", ".json", ".md", ".svg"};
+    constexpr std::size_t word_count = sizeof(words) / sizeof(words[0]);
+
+    std::mt19937 rng(seed);
+    std::vector<FileEntry> entries;
+    entries.reserve(files);
+    for (std::size_t i = 0; i < files; ++i) {
+        FileEntry entry;
+        std::size_t depth = 1 + rng() % 5;
+        for (std::size_t d = 0; d < depth; ++d) {
+            entry.path += words[rng() % word_count];
+            entry.path += d % 2 ? "_" : "/";
+        }
+        entry.path += std::string(words[rng() % word_count]) + std::to_string(i) + extensions[rng() % 8];
+        entries.push_back(std::move(entry));
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const FileEntry& a, const FileEntry& b) { return Snapshot::pathLess(a.path, b.path); });
+    return entries;
+}
+
+SnapshotPtr makeSnapshot(std::vector<FileEntry> entries, std::uint64_t version)
+{
+    return std::make_shared<const Snapshot>("/workspace", std::move(entries), version);
+}
+
+FuzzyIndex& sharedIndex()
+{
+    static FuzzyIndex index;
+    static bool filled = false;
+    if (!filled) {
+        index.update(makeSnapshot(generateTree(100000, 1), 1));
+        filled = true;
+    }
+    return index;
+}
+
+void BM_Find(benchmark::State& state, const char* query)
+{
+    FuzzyIndex& index = sharedIndex();
+    for (auto _ : state) {
+        std::vector<FuzzyMatch> matches = index.find(query, 20);
+        benchmark::DoNotOptimize(matches.data());
+    }
+}
+BENCHMARK_CAPTURE(BM_Find, one_char, "s")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Find, two_chars, "sv")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Find, word, "trans")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Find, path, "src/opencode/diff")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Find, rare, "zq")->Unit(benchmark::kMillisecond);
+
+/// One keystroke at a time, each query narrowing the previous one's candidates
+void BM_Typing(benchmark::State& state)
+{
+    FuzzyIndex& index = sharedIndex();
+    const std::string word = "transcript";
+    for (auto _ : state) {
+        FuzzyCache cache;
+        for (std::size_t length = 1; length <= word.size(); ++length) {
+            std::vector<FuzzyMatch> matches = index.find(std::string_view(word).substr(0, length), 20, &cache);
+            benchmark::DoNotOptimize(matches.data());
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * word.size()));
+}
+BENCHMARK(BM_Typing)->Unit(benchmark::kMillisecond);
+
+void BM_Build(benchmark::State& state)
+{
+    SnapshotPtr snapshot = makeSnapshot(generateTree(static_cast<std::size_t>(state.range(0)), 1), 1);
+    for (auto _ : state) {
+        FuzzyIndex index;
+        index.update(snapshot);
+        benchmark::DoNotOptimize(index.size());
+    }
+}
+BENCHMARK(BM_Build)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+void BM_IncrementalUpdate(benchmark::State& state)
+{
+    std::vector<FileEntry> entries = generateTree(100000, 1);
+    SnapshotPtr base = makeSnapshot(entries, 1);
+    entries.erase(entries.begin() + 5000, entries.begin() + 5010);
+    SnapshotPtr changed = makeSnapshot(entries, 2);
+
+    FuzzyIndex index;
+    index.update(base);
+    bool toggle = false;
+    for (auto _ : state) {
+        index.update(toggle ? base : changed);
+        toggle = !toggle;
+    }
+}
+BENCHMARK(BM_IncrementalUpdate)->Unit(benchmark::kMillisecond);
+
+}
+
+BENCHMARK_MAIN();
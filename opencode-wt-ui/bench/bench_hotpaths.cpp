@@ -0,0 +1,371 @@
+// Functions suspected to be hot on every render or refresh: the Theme's
+// class lookups and apply() over a synthetic widget tree, the permission
+// check createApp() runs, the session list refresh and reading a file into
+// the editor.
+//
+//   ./bench/bench_hotpaths --benchmark_out=hotpaths.json --benchmark_out_format=json
+//   ./bench/bench_hotpaths --baseline=hotpaths.json [--max-regression=10]
+//
+// With --baseline the real time of every benchmark is compared with the
+// same benchmark in an earlier JSON output, and the exit code is 1 when one
+// of them got slower by more than --max-regression percent.
+
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+#include <Wt/Auth/Dbo/AuthInfo.h>
+#include <Wt/Dbo/Session.h>
+#include <Wt/Dbo/backend/Sqlite3.h>
+#include <Wt/DomElement.h>
+#include <Wt/Test/WTestEnvironment.h>
+#include <Wt/WApplication.h>
+#include <Wt/WCheckBox.h>
+#include <Wt/WComboBox.h>
+#include <Wt/WContainerWidget.h>
+#include <Wt/WLineEdit.h>
+#include <Wt/WProgressBar.h>
+#include <Wt/WPushButton.h>
+#include <Wt/WTextArea.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "002_Dbo/Tables/Permission.h"
+#include "002_Dbo/Tables/User.h"
+#include "004_Theme/Theme.h"
+#include "005_Components/MonacoEditor.h"
+#include "007_Opencode/SessionListModel.h"
+#include "007_Opencode/Sessions.h"
+
+namespace {
+
+/// An application whose message bundle holds the Theme's class lists
+struct ThemeFixture {
+    ThemeFixture()
+        : app(environment)
+    {
+        // Wt's own bundle, the fallback LiveStrings uses outside a running server
+        app.messageResourceBundle().use(BENCH_SOURCE_ROOT "/static/0_stylus/xml/000_General/General_components");
+    }
+
+    Wt::Test::WTestEnvironment environment;
+    Wt::WApplication app;
+    Theme theme;
+};
+
+void BM_ClassesFromMessage(benchmark::State& state)
+{
+    ThemeFixture fixture;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Theme::classesFromMessage("btn.default"));
+    }
+}
+BENCHMARK(BM_ClassesFromMessage);
+
+void BM_AddClassesFromMessage_Element(benchmark::State& state)
+{
+    ThemeFixture fixture;
+    for (auto _ : state) {
+        Wt::DomElement element(Wt::DomElement::Mode::Create, Wt::DomElementType::BUTTON);
+        Theme::addClassesFromMessage(element, "btn.default");
+        benchmark::DoNotOptimize(&element);
+    }
+}
+BENCHMARK(BM_AddClassesFromMessage_Element);
+
+void BM_AddClassesFromMessage_Widget(benchmark::State& state)
+{
+    ThemeFixture fixture;
+    auto check_box = std::make_unique<Wt::WCheckBox>();
+    for (auto _ : state) {
+        Theme::addClassesFromMessage(check_box.get(), "checkbox.default");
+    }
+}
+BENCHMARK(BM_AddClassesFromMessage_Widget);
+
+/// Theme::apply() for every element of a tree of N form widgets, as a first render does
+void BM_ThemeApply_Tree(benchmark::State& state)
+{
+    ThemeFixture fixture;
+    auto root = std::make_unique<Wt::WContainerWidget>();
+    std::vector<std::pair<Wt::WWidget*, Wt::DomElementType>> elements;
+    for (int i = 0; i < state.range(0); ++i) {
+        switch (i % 6) {
+        case 0:
+            elements.emplace_back(root->addNew<Wt::WPushButton>("button"), Wt::DomElementType::BUTTON);
+            break;
+        case 1:
+            elements.emplace_back(root->addNew<Wt::WLineEdit>(), Wt::DomElementType::INPUT);
+            break;
+        case 2:
+            elements.emplace_back(root->addNew<Wt::WCheckBox>(), Wt::DomElementType::INPUT);
+            break;
+        case 3:
+            elements.emplace_back(root->addNew<Wt::WTextArea>(), Wt::DomElementType::TEXTAREA);
+            break;
+        case 4:
+            elements.emplace_back(root->addNew<Wt::WComboBox>(), Wt::DomElementType::SELECT);
+            break;
+        default:
+            elements.emplace_back(root->addNew<Wt::WProgressBar>(), Wt::DomElementType::DIV);
+            break;
+        }
+    }
+
+    for (auto _ : state) {
+        for (const auto& [widget, type] : elements) {
+            Wt::DomElement element(Wt::DomElement::Mode::Create, type);
+            fixture.theme.apply(widget, element, Wt::MainElement);
+            benchmark::DoNotOptimize(&element);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ThemeApply_Tree)->Arg(100)->Arg(1000);
+
+/// An in-memory database with one user holding N permissions
+struct PermissionFixture {
+    explicit PermissionFixture(int permissions)
+    {
+        session.setConnection(std::make_unique<Wt::Dbo::backend::Sqlite3>(":memory:"));
+        session.mapClass<User>("user");
+        session.mapClass<Permission>("permission");
+        session.mapClass<AuthInfo>("auth_info");
+        session.mapClass<AuthInfo::AuthIdentityType>("auth_identity");
+        session.mapClass<AuthInfo::AuthTokenType>("auth_token");
+        session.createTables();
+
+        Wt::Dbo::Transaction transaction(session);
+        user = session.add(std::make_unique<User>("bench"));
+        for (int i = 0; i < permissions; ++i) {
+            last = session.add(std::make_unique<Permission>("PERMISSION_" + std::to_string(i)));
+            user.modify()->permissions_.insert(last);
+        }
+        missing = session.add(std::make_unique<Permission>("MISSING"));
+    }
+
+    Wt::Dbo::Session session;
+    Wt::Dbo::ptr<User> user;
+    Wt::Dbo::ptr<Permission> last;
+    Wt::Dbo::ptr<Permission> missing;
+};
+
+/// The worst case: the permission checked is the last one the user holds
+void BM_HasPermission_Last(benchmark::State& state)
+{
+    PermissionFixture fixture(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        Wt::Dbo::Transaction transaction(fixture.session);
+        benchmark::DoNotOptimize(fixture.user->hasPermission(fixture.last));
+    }
+}
+BENCHMARK(BM_HasPermission_Last)->Arg(1)->Arg(10)->Arg(100)->Unit(benchmark::kMicrosecond);
+
+void BM_HasPermission_Missing(benchmark::State& state)
+{
+    PermissionFixture fixture(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        Wt::Dbo::Transaction transaction(fixture.session);
+        benchmark::DoNotOptimize(fixture.user->hasPermission(fixture.missing));
+    }
+}
+BENCHMARK(BM_HasPermission_Missing)->Arg(1)->Arg(10)->Arg(100)->Unit(benchmark::kMicrosecond);
+
+/// A /session response of N sessions, the one at `bumped` updated last
+std::string sessionList(std::size_t sessions, std::size_t bumped)
+{
+    nlohmann::json list = nlohmann::json::array();
+    for (std::size_t i = 0; i < sessions; ++i) {
+        std::size_t updated = i == bumped ? sessions * 10 : i * 10;
+        list.push_back({{"id", "ses_" + std::to_string(i)}, {"title", "Session " + std::to_string(i)},
+                        {"version", "0.5.0"}, {"projectID", "prj"}, {"directory", "/work"},
+                        {"time", {{"created", i}, {"updated", updated}}}});
+    }
+    return list.dump();
+}
+
+/// What refreshSessionList() does with a response: parse, sort, apply to an empty model
+void BM_SessionList_FirstLoad(benchmark::State& state)
+{
+    Wt::Test::WTestEnvironment environment;
+    Wt::WApplication app(environment);
+    std::string body = sessionList(state.range(0), 0);
+    for (auto _ : state) {
+        Opencode::SessionListModel model;
+        model.update(Opencode::Sessions::parseSessionList(body));
+        benchmark::DoNotOptimize(model.rowCount());
+    }
+    state.SetBytesProcessed(state.iterations() * body.size());
+}
+BENCHMARK(BM_SessionList_FirstLoad)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+/// A refresh after one session was updated, the usual case: one row moves to the top
+void BM_SessionList_Refresh(benchmark::State& state)
+{
+    Wt::Test::WTestEnvironment environment;
+    Wt::WApplication app(environment);
+    std::size_t sessions = state.range(0);
+    const std::string bodies[2] = {sessionList(sessions, 0), sessionList(sessions, sessions / 2)};
+    Opencode::SessionListModel model;
+    model.update(Opencode::Sessions::parseSessionList(bodies[1]));
+    std::size_t next = 0;
+    for (auto _ : state) {
+        model.update(Opencode::Sessions::parseSessionList(bodies[next]));
+        next ^= 1;
+        benchmark::DoNotOptimize(model.rowCount());
+    }
+    state.SetBytesProcessed(state.iterations() * bodies[0].size());
+}
+BENCHMARK(BM_SessionList_Refresh)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+/// A temporary source-like file of the given size, removed with the object
+class TempFile {
+public:
+    explicit TempFile(std::size_t bytes)
+        : path_("bench_hotpaths_" + std::to_string(bytes) + ".txt")
+    {
+        const std::string line = "    <div class=\"flex items-center gap-2\">${tr:btn.default}</div>\n";
+        std::ofstream file(path_, std::ios::binary);
+        for (std::size_t written = 0; written < bytes; written += line.size()) {
+            file.write(line.data(), static_cast<std::streamsize>(std::min(line.size(), bytes - written)));
+        }
+    }
+
+    ~TempFile() { std::remove(path_.c_str()); }
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+void BM_GetFileText(benchmark::State& state)
+{
+    std::size_t bytes = static_cast<std::size_t>(state.range(0)) << 20;
+    TempFile file(bytes);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(MonacoEditor::getFileText(file.path()));
+    }
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_GetFileText)->Arg(1)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+
+/// Prints the runs as usual and keeps their real time, in nanoseconds, by name
+class RecordingReporter : public benchmark::ConsoleReporter {
+public:
+    void ReportRuns(const std::vector<Run>& runs) override
+    {
+        ConsoleReporter::ReportRuns(runs);
+        for (const Run& run : runs) {
+            if (run.run_type == Run::RT_Iteration) {
+                real_ns[run.benchmark_name()] = run.GetAdjustedRealTime() * nanosPer(run.time_unit);
+            }
+        }
+    }
+
+    static double nanosPer(benchmark::TimeUnit unit)
+    {
+        switch (unit) {
+        case benchmark::kSecond:
+            return 1e9;
+        case benchmark::kMillisecond:
+            return 1e6;
+        case benchmark::kMicrosecond:
+            return 1e3;
+        default:
+            return 1;
+        }
+    }
+
+    std::map<std::string, double> real_ns;
+};
+
+double nanosPer(const std::string& unit)
+{
+    if (unit == "s") {
+        return 1e9;
+    }
+    if (unit == "ms") {
+        return 1e6;
+    }
+    if (unit == "us") {
+        return 1e3;
+    }
+    return 1;
+}
+
+/// Compares the real times with a --benchmark_out JSON file of an earlier run
+bool compareWithBaseline(const std::map<std::string, double>& now, const nlohmann::json& baseline,
+                         double max_regression)
+{
+    bool ok = true;
+    std::printf("\n%-50s %14s %14s %8s\n", "benchmark", "baseline ns", "now ns", "change");
+    for (const auto& entry : baseline["benchmarks"]) {
+        const std::string name = entry.value("name", std::string());
+        auto it = now.find(name);
+        if (entry.value("run_type", std::string("iteration")) != "iteration" || it == now.end()) {
+            continue;
+        }
+        double before = entry.value("real_time", 0.0) * nanosPer(entry.value("time_unit", std::string("ns")));
+        if (before <= 0) {
+            continue;
+        }
+        double change = (it->second - before) / before * 100.0;
+        bool regressed = change > max_regression;
+        std::printf("%-50s %14.0f %14.0f %+7.1f%%%s\n", name.c_str(), before, it->second, change,
+                    regressed ? "  REGRESSION" : "");
+        ok = ok && !regressed;
+    }
+    return ok;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    // Our own options are taken out before google benchmark sees the rest
+    std::string baseline_path;
+    double max_regression = 10.0;
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--baseline=", 11) == 0) {
+            baseline_path = argv[i] + 11;
+        } else if (std::strncmp(argv[i], "--max-regression=", 17) == 0) {
+            max_regression = std::atof(argv[i] + 17);
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 2;
+    }
+
+    if (baseline_path.empty()) {
+        benchmark::RunSpecifiedBenchmarks();
+        benchmark::Shutdown();
+        return 0;
+    }
+
+    std::ifstream file(baseline_path);
+    if (!file) {
+        std::fprintf(stderr, "cannot open baseline %s\n", baseline_path.c_str());
+        return 2;
+    }
+    nlohmann::json baseline = nlohmann::json::parse(file);
+
+    RecordingReporter reporter;
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+    benchmark::Shutdown();
+    return compareWithBaseline(reporter.real_ns, baseline, max_regression) ? 0 : 1;
+}
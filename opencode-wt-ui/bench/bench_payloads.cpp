@@ -0,0 +1,233 @@
+// Compares the SAX payload parsers with building a json tree and reading
+// the same fields from it, for the payload shapes opencode sends.
+
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+#include <string>
+#include <vector>
+
+#include "007_Opencode/Payloads.h"
+
+using namespace Opencode;
+
+namespace {
+
+std::string filler(std::size_t bytes)
+{
+    std::string text;
+    text.reserve(bytes);
+    while (text.size() < bytes) {
+        text += "line of tool output with \"quotes\" and\ttabs\n";
+    }
+    text.resize(bytes);
+    return text;
+}
+
+nlohmann::json toolPart(const std::string& id, std::size_t output_bytes)
+{
+    return {
+        {"id", id}, {"messageID", "msg_1"}, {"sessionID", "ses_1"}, {"type", "tool"}, {"tool", "read"},
+        {"state", {{"status", "completed"},
+                   {"input", {{"filePath", "/src/main.cpp"}}},
+                   {"output", filler(output_bytes)},
+                   {"time", {{"start", 1}, {"end", 2}}}}}
+    };
+}
+
+std::string deltaEvent()
+{
+    nlohmann::json event = {
+        {"type", "message.part.updated"},
+        {"properties", {
+            {"part", {{"id", "prt_1"}, {"messageID", "msg_1"}, {"sessionID", "ses_1"},
+                      {"type", "text"}, {"text", filler(2000)}, {"time", {{"start", 1}}}}},
+            {"delta", "next tokens"}
+        }}
+    };
+    return event.dump();
+}
+
+std::string toolEvent(std::size_t output_bytes)
+{
+    nlohmann::json event = {
+        {"type", "message.part.updated"},
+        {"properties", {{"part", toolPart("prt_2", output_bytes)}}}
+    };
+    return event.dump();
+}
+
+std::string messageList(std::size_t messages, std::size_t output_bytes)
+{
+    nlohmann::json list = nlohmann::json::array();
+    for (std::size_t i = 0; i < messages; ++i) {
+        list.push_back({
+            {"info", {{"id", "msg_" + std::to_string(i)}, {"sessionID", "ses_1"},
+                      {"role", i % 2 ? "assistant" : "user"}, {"time", {{"created", i}}}}},
+            {"parts", {
+                {{"id", "prt_a" + std::to_string(i)}, {"messageID", "msg_" + std::to_string(i)},
+                 {"type", "text"}, {"text", filler(500)}},
+                toolPart("prt_b" + std::to_string(i), output_bytes)
+            }}
+        });
+    }
+    return list.dump();
+}
+
+std::string sessionList(std::size_t sessions)
+{
+    nlohmann::json list = nlohmann::json::array();
+    for (std::size_t i = 0; i < sessions; ++i) {
+        list.push_back({{"id", "ses_" + std::to_string(i)}, {"title", "Session " + std::to_string(i)},
+                        {"version", "0.5.0"}, {"projectID", "prj"}, {"directory", "/work"},
+                        {"time", {{"created", i}, {"updated", i * 10}}}});
+    }
+    return list.dump();
+}
+
+// Tree based extraction, equivalent to what the UI did before the SAX parsers
+EventPayload domEvent(const std::string& data)
+{
+    EventPayload out;
+    auto json = nlohmann::json::parse(data);
+    out.type = json.value("type", std::string());
+    const auto& properties = json["properties"];
+    out.delta = properties.value("delta", std::string());
+    if (auto part = properties.find("part"); part != properties.end()) {
+        out.has_part = true;
+        out.part.id = part->value("id", std::string());
+        out.part.message_id = part->value("messageID", std::string());
+        out.part.session_id = part->value("sessionID", std::string());
+        out.part.type = part->value("type", std::string());
+        out.part.text = part->value("text", std::string());
+        out.part.tool = part->value("tool", std::string());
+        if (auto state = part->find("state"); state != part->end()) {
+            out.part.status = state->value("status", std::string());
+        }
+    }
+    out.session_id = out.part.session_id;
+    return out;
+}
+
+std::vector<MessageData> domMessageList(const std::string& body)
+{
+    std::vector<MessageData> out;
+    auto json = nlohmann::json::parse(body);
+    for (const auto& item : json) {
+        MessageData message;
+        message.id = item["info"].value("id", std::string());
+        message.role = item["info"].value("role", std::string());
+        for (const auto& part : item["parts"]) {
+            PartData data;
+            data.id = part.value("id", std::string());
+            data.type = part.value("type", std::string());
+            data.text = part.value("text", std::string());
+            data.tool = part.value("tool", std::string());
+            message.parts.push_back(std::move(data));
+        }
+        out.push_back(std::move(message));
+    }
+    return out;
+}
+
+std::vector<SessionInfo> domSessionList(const std::string& body)
+{
+    std::vector<SessionInfo> out;
+    auto json = nlohmann::json::parse(body);
+    for (const auto& item : json) {
+        SessionInfo info;
+        info.id = item.value("id", std::string());
+        info.title = item.value("title", std::string());
+        info.updated = item["time"].value("updated", 0.0);
+        out.push_back(std::move(info));
+    }
+    return out;
+}
+
+void BM_Event_Delta_Sax(benchmark::State& state)
+{
+    std::string data = deltaEvent();
+    for (auto _ : state) {
+        EventPayload payload;
+        benchmark::DoNotOptimize(parseEvent(data, payload));
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_Event_Delta_Sax);
+
+void BM_Event_Delta_Dom(benchmark::State& state)
+{
+    std::string data = deltaEvent();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(domEvent(data));
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_Event_Delta_Dom);
+
+void BM_Event_Tool_Sax(benchmark::State& state)
+{
+    std::string data = toolEvent(state.range(0));
+    for (auto _ : state) {
+        EventPayload payload;
+        benchmark::DoNotOptimize(parseEvent(data, payload));
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_Event_Tool_Sax)->Arg(4 << 10)->Arg(1 << 20);
+
+void BM_Event_Tool_Dom(benchmark::State& state)
+{
+    std::string data = toolEvent(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(domEvent(data));
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_Event_Tool_Dom)->Arg(4 << 10)->Arg(1 << 20);
+
+void BM_MessageList_Sax(benchmark::State& state)
+{
+    std::string body = messageList(state.range(0), 16 << 10);
+    for (auto _ : state) {
+        std::vector<MessageData> messages;
+        benchmark::DoNotOptimize(parseMessageList(body, messages));
+    }
+    state.SetBytesProcessed(state.iterations() * body.size());
+}
+BENCHMARK(BM_MessageList_Sax)->Arg(20)->Arg(200);
+
+void BM_MessageList_Dom(benchmark::State& state)
+{
+    std::string body = messageList(state.range(0), 16 << 10);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(domMessageList(body));
+    }
+    state.SetBytesProcessed(state.iterations() * body.size());
+}
+BENCHMARK(BM_MessageList_Dom)->Arg(20)->Arg(200);
+
+void BM_SessionList_Sax(benchmark::State& state)
+{
+    std::string body = sessionList(state.range(0));
+    for (auto _ : state) {
+        std::vector<SessionInfo> sessions;
+        benchmark::DoNotOptimize(parseSessionList(body, sessions));
+    }
+    state.SetBytesProcessed(state.iterations() * body.size());
+}
+BENCHMARK(BM_SessionList_Sax)->Arg(1000);
+
+void BM_SessionList_Dom(benchmark::State& state)
+{
+    std::string body = sessionList(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(domSessionList(body));
+    }
+    state.SetBytesProcessed(state.iterations() * body.size());
+}
+BENCHMARK(BM_SessionList_Dom)->Arg(1000);
+
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,721 @@
+// Simulates concurrent browser sessions against a running app instance and
+// reports request latency, throughput and the server memory per session.
+//
+// Usage: wt_loadtest <scenario.json> [--host 127.0.0.1] [--port 9020]
+//                    [--sessions N] [--iterations N] [--json report.json]
+//                    [--baseline report.json] [--max-regression 10]
+//
+// A scenario is a list of HTTP steps run by every simulated session, once
+// for the setup and then in a loop. Values found in responses are captured
+// with regular expressions into variables that later steps substitute as
+// ${name}, which is how the Wt session id, the update ack and the ids of
+// the widgets the events target are carried between requests.
+//
+// All simulated sessions come from one client address; raise admission-burst
+// and admission-max-constructing in wt_config.xml, or the server turns most
+// of them away with its busy page. The memory report reads the scenario's
+// metrics_target, set metrics-path to it for the run.
+
+#include <Wt/AsioWrapper/asio.hpp>
+#include <Wt/AsioWrapper/system_error.hpp>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <strings.h>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "007_Opencode/HttpResponseParser.h"
+
+namespace asio = Wt::AsioWrapper::asio;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Variables = std::map<std::string, std::string>;
+
+struct Capture {
+    std::string name;
+    std::regex regex;
+    int match = -1;                  ///< Which match to keep, negative counts from the last
+    bool js_string_length = false;   ///< Store the UTF-16 length of the captured JS string literal
+    bool required = false;           ///< Fail the session if nothing matches
+};
+
+struct Step {
+    std::string name;
+    std::string method = "GET";
+    std::string target = "/";
+    std::string body;
+    std::vector<std::pair<std::string, std::string>> form;
+    std::vector<std::pair<std::string, std::string>> headers;
+    int expect_status = 200;
+    std::string expect_contains;
+    std::vector<Capture> captures;
+};
+
+struct Scenario {
+    std::string name;
+    std::string host = "127.0.0.1";
+    std::string port = "9020";
+    int sessions = 10;
+    int iterations = 20;
+    std::chrono::milliseconds ramp_up{1000};
+    std::chrono::milliseconds think_min{100};
+    std::chrono::milliseconds think_max{500};
+    std::string metrics_target = "/metrics";
+    Variables variables;
+    std::vector<Capture> captures;  ///< Applied to every response, before the step's own
+    std::vector<Step> setup;
+    std::vector<Step> loop;
+};
+
+struct HttpResult {
+    int status = 0;
+    std::string body;
+    std::string error;
+};
+
+/// Latencies of one step across all sessions, in microseconds
+struct StepStats {
+    std::vector<std::uint64_t> latencies;
+    std::uint64_t errors = 0;
+};
+
+// ---------------------------------------------------------------- scenario
+
+std::vector<Capture> parseCaptures(const nlohmann::json& object)
+{
+    std::vector<Capture> captures;
+    if (!object.is_object()) {
+        return captures;
+    }
+    for (const auto& [name, spec] : object.items()) {
+        Capture capture;
+        capture.name = name;
+        if (spec.is_string()) {
+            capture.regex = std::regex(spec.get<std::string>());
+        } else {
+            capture.regex = std::regex(spec.at("regex").get<std::string>());
+            capture.match = spec.value("match", -1);
+            capture.js_string_length = spec.value("as", "") == "js_string_length";
+            capture.required = spec.value("required", false);
+        }
+        captures.push_back(std::move(capture));
+    }
+    return captures;
+}
+
+std::vector<Step> parseSteps(const nlohmann::json& array)
+{
+    std::vector<Step> steps;
+    if (!array.is_array()) {
+        return steps;
+    }
+    for (const nlohmann::json& object : array) {
+        Step step;
+        step.name = object.at("name").get<std::string>();
+        step.method = object.value("method", "GET");
+        step.target = object.value("target", "/");
+        step.body = object.value("body", "");
+        step.expect_status = object.value("expect_status", 200);
+        step.expect_contains = object.value("expect_contains", "");
+        if (object.contains("form")) {
+            for (const auto& [key, value] : object["form"].items()) {
+                step.form.emplace_back(key, value.get<std::string>());
+            }
+        }
+        if (object.contains("headers")) {
+            for (const auto& [key, value] : object["headers"].items()) {
+                step.headers.emplace_back(key, value.get<std::string>());
+            }
+        }
+        if (object.contains("capture")) {
+            step.captures = parseCaptures(object["capture"]);
+        }
+        steps.push_back(std::move(step));
+    }
+    return steps;
+}
+
+Scenario loadScenario(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    nlohmann::json json = nlohmann::json::parse(file);
+
+    Scenario scenario;
+    scenario.name = json.value("name", path);
+    scenario.host = json.value("host", scenario.host);
+    scenario.port = std::to_string(json.value("port", std::stoi(scenario.port)));
+    scenario.sessions = json.value("sessions", scenario.sessions);
+    scenario.iterations = json.value("iterations", scenario.iterations);
+    scenario.ramp_up = std::chrono::milliseconds(json.value("ramp_up_ms", scenario.ramp_up.count()));
+    if (json.contains("think_ms")) {
+        scenario.think_min = std::chrono::milliseconds(json["think_ms"].at(0).get<int>());
+        scenario.think_max = std::chrono::milliseconds(json["think_ms"].at(1).get<int>());
+    }
+    scenario.metrics_target = json.value("metrics_target", scenario.metrics_target);
+    if (json.contains("variables")) {
+        for (const auto& [key, value] : json["variables"].items()) {
+            scenario.variables[key] = value.get<std::string>();
+        }
+    }
+    scenario.captures = parseCaptures(json.value("capture", nlohmann::json::object()));
+    scenario.setup = parseSteps(json.value("setup", nlohmann::json::array()));
+    scenario.loop = parseSteps(json.value("loop", nlohmann::json::array()));
+    return scenario;
+}
+
+std::string substitute(const std::string& text, const Variables& variables)
+{
+    std::string out;
+    std::size_t position = 0;
+    while (true) {
+        std::size_t start = text.find("${", position);
+        if (start == std::string::npos) {
+            out.append(text, position, std::string::npos);
+            return out;
+        }
+        std::size_t end = text.find('}', start);
+        if (end == std::string::npos) {
+            out.append(text, position, std::string::npos);
+            return out;
+        }
+        out.append(text, position, start - position);
+        auto it = variables.find(text.substr(start + 2, end - start - 2));
+        if (it != variables.end()) {
+            out += it->second;
+        }
+        position = end + 1;
+    }
+}
+
+std::string urlEncode(const std::string& value)
+{
+    static const char* hex = "0123456789ABCDEF";
+    std::string out;
+    for (unsigned char c : value) {
+        if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            out += static_cast<char>(c);
+        } else {
+            out += '%';
+            out += hex[c >> 4];
+            out += hex[c & 0xF];
+        }
+    }
+    return out;
+}
+
+/// Length in UTF-16 units of a JS string literal body, as the editor counts offsets
+std::size_t jsStringLength(const std::string& literal)
+{
+    std::size_t length = 0;
+    for (std::size_t i = 0; i < literal.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(literal[i]);
+        if (c == '\\' && i + 1 < literal.size()) {
+            // \uXXXX is one unit, every other escape one character
+            i += literal[i + 1] == 'u' ? 5 : 1;
+            ++length;
+        } else if (c >= 0xF0) {
+            length += 2;
+        } else if ((c & 0xC0) != 0x80) {
+            ++length;
+        }
+    }
+    return length;
+}
+
+void applyCaptures(const std::vector<Capture>& captures, const std::string& body, Variables& variables,
+                   std::string& missing)
+{
+    for (const Capture& capture : captures) {
+        std::vector<std::string> matches;
+        for (auto it = std::sregex_iterator(body.begin(), body.end(), capture.regex); it != std::sregex_iterator(); ++it) {
+            matches.push_back(it->size() > 1 ? (*it)[1].str() : (*it)[0].str());
+        }
+        int index = capture.match < 0 ? static_cast<int>(matches.size()) + capture.match : capture.match;
+        if (index < 0 || index >= static_cast<int>(matches.size())) {
+            if (capture.required) {
+                missing = capture.name;
+            }
+            continue;
+        }
+        variables[capture.name] = capture.js_string_length
+            ? std::to_string(jsStringLength(matches[static_cast<std::size_t>(index)]))
+            : matches[static_cast<std::size_t>(index)];
+    }
+}
+
+// ------------------------------------------------------------------- http
+
+/**
+ * One keep-alive connection with a cookie jar, like a browser tab
+ */
+class HttpSession {
+public:
+    HttpSession(std::string host, std::string port)
+        : host_(std::move(host)), port_(std::move(port)), socket_(io_)
+    {
+    }
+
+    HttpResult request(const std::string& method, const std::string& target,
+                       const std::vector<std::pair<std::string, std::string>>& headers, const std::string& body)
+    {
+        HttpResult result;
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            // A keep-alive connection closed by the server is reopened once
+            bool reused = socket_.is_open();
+            if (!reused && !connect(result.error)) {
+                return result;
+            }
+            if (exchange(method, target, headers, body, result) || !reused) {
+                return result;
+            }
+        }
+        return result;
+    }
+
+private:
+    bool connect(std::string& error)
+    {
+        Wt::AsioWrapper::error_code ec;
+        asio::ip::tcp::resolver resolver(io_);
+        auto endpoints = resolver.resolve(host_, port_, ec);
+        if (!ec) {
+            asio::connect(socket_, endpoints, ec);
+        }
+        if (ec) {
+            error = "connect: " + ec.message();
+            socket_.close();
+            return false;
+        }
+        socket_.set_option(asio::ip::tcp::no_delay(true), ec);
+        buffer_.clear();
+        return true;
+    }
+
+    bool exchange(const std::string& method, const std::string& target,
+                  const std::vector<std::pair<std::string, std::string>>& headers, const std::string& body,
+                  HttpResult& result)
+    {
+        std::string request = method + " " + target + " HTTP/1.1\r\nHost: " + host_ + ":" + port_ +
+                              "\r\nUser-Agent: Mozilla/5.0 (X11; Linux x86_64) wt_loadtest\r\nAccept: */*\r\n";
+        if (!cookies_.empty()) {
+            request += "Cookie: ";
+            for (auto it = cookies_.begin(); it != cookies_.end(); ++it) {
+                request += (it == cookies_.begin() ? "" : "; ") + it->first + "=" + it->second;
+            }
+            request += "\r\n";
+        }
+        for (const auto& [name, value] : headers) {
+            request += name + ": " + value + "\r\n";
+        }
+        if (!body.empty() || method == "POST") {
+            request += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+        }
+        request += "\r\n" + body;
+
+        Wt::AsioWrapper::error_code ec;
+        asio::write(socket_, asio::buffer(request), ec);
+        if (ec) {
+            result.error = "write: " + ec.message();
+            socket_.close();
+            return false;
+        }
+
+        Opencode::HttpResponseParser parser;
+        parser.reset(method == "HEAD");
+        Opencode::HttpResponseParser::Result state = parser.feed(buffer_);
+        char chunk[16384];
+        while (state == Opencode::HttpResponseParser::Result::NeedMore) {
+            std::size_t read = socket_.read_some(asio::buffer(chunk), ec);
+            if (ec) {
+                state = ec == asio::error::eof ? parser.finish() : Opencode::HttpResponseParser::Result::Error;
+                break;
+            }
+            buffer_.append(chunk, read);
+            state = parser.feed(buffer_);
+        }
+        if (state != Opencode::HttpResponseParser::Result::Complete) {
+            result.error = ec ? "read: " + ec.message() : "malformed response";
+            socket_.close();
+            // Nothing received: the server dropped an idle connection, worth one retry
+            return parser.started();
+        }
+
+        for (const auto& [name, value] : parser.headers()) {
+            if (name.size() == 10 && strncasecmp(name.c_str(), "set-cookie", 10) == 0) {
+                std::string pair = value.substr(0, value.find(';'));
+                std::size_t equals = pair.find('=');
+                if (equals != std::string::npos) {
+                    cookies_[pair.substr(0, equals)] = pair.substr(equals + 1);
+                }
+            }
+        }
+        result.status = parser.status();
+        result.body = parser.takeBody();
+        result.error.clear();
+        if (!parser.keepAlive()) {
+            socket_.close();
+        }
+        return true;
+    }
+
+    std::string host_;
+    std::string port_;
+    asio::io_service io_;
+    asio::ip::tcp::socket socket_;
+    std::string buffer_;
+    std::map<std::string, std::string> cookies_;
+};
+
+// ----------------------------------------------------------------- server
+
+struct ServerSample {
+    double rss_bytes = 0;
+    double live_sessions = 0;
+    bool ok = false;
+};
+
+double metricValue(const std::string& body, const std::string& name)
+{
+    std::istringstream lines(body);
+    for (std::string line; std::getline(lines, line);) {
+        if (line.compare(0, name.size() + 1, name + " ") == 0) {
+            return std::strtod(line.c_str() + name.size() + 1, nullptr);
+        }
+    }
+    return 0;
+}
+
+ServerSample sampleServer(const Scenario& scenario)
+{
+    HttpSession http(scenario.host, scenario.port);
+    HttpResult result = http.request("GET", scenario.metrics_target, {}, "");
+    ServerSample sample;
+    if (result.status == 200) {
+        sample.rss_bytes = metricValue(result.body, "process_resident_memory_bytes");
+        sample.live_sessions = metricValue(result.body, "wt_sessions_live");
+        sample.ok = true;
+    }
+    return sample;
+}
+
+// ----------------------------------------------------------------- runner
+
+class Runner {
+public:
+    explicit Runner(const Scenario& scenario)
+        : scenario_(scenario)
+    {
+    }
+
+    void run()
+    {
+        baseline_ = sampleServer(scenario_);
+        started_ = Clock::now();
+
+        std::vector<std::thread> threads;
+        for (int index = 0; index < scenario_.sessions; ++index) {
+            threads.emplace_back([this, index]() { runSession(index); });
+        }
+
+        // Memory is sampled once every session finished its setup, before the loops end
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            set_up_changed_.wait(lock, [this]() { return set_up_ == scenario_.sessions; });
+        }
+        loaded_ = sampleServer(scenario_);
+
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        elapsed_ = Clock::now() - started_;
+    }
+
+    nlohmann::json report() const
+    {
+        nlohmann::json steps = nlohmann::json::object();
+        std::uint64_t requests = 0;
+        std::uint64_t errors = 0;
+        for (const auto& [name, stats] : stats_) {
+            std::vector<std::uint64_t> sorted = stats.latencies;
+            std::sort(sorted.begin(), sorted.end());
+            auto percentile = [&sorted](double p) {
+                if (sorted.empty()) {
+                    return 0.0;
+                }
+                std::size_t rank = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+                return static_cast<double>(sorted[rank]) / 1000.0;
+            };
+            steps[name] = {
+                {"requests", sorted.size()},
+                {"errors", stats.errors},
+                {"p50_ms", percentile(0.50)},
+                {"p95_ms", percentile(0.95)},
+                {"p99_ms", percentile(0.99)},
+                {"max_ms", sorted.empty() ? 0.0 : static_cast<double>(sorted.back()) / 1000.0}
+            };
+            requests += sorted.size();
+            errors += stats.errors;
+        }
+
+        double seconds = std::chrono::duration<double>(elapsed_).count();
+        nlohmann::json report = {
+            {"scenario", scenario_.name},
+            {"sessions", scenario_.sessions},
+            {"failed_sessions", failed_},
+            {"iterations", scenario_.iterations},
+            {"seconds", seconds},
+            {"requests", requests},
+            {"errors", errors},
+            {"throughput_rps", seconds > 0 ? static_cast<double>(requests) / seconds : 0.0},
+            {"steps", steps}
+        };
+        if (baseline_.ok && loaded_.ok) {
+            double sessions = std::max(1.0, loaded_.live_sessions - baseline_.live_sessions);
+            report["server"] = {
+                {"rss_baseline_bytes", baseline_.rss_bytes},
+                {"rss_loaded_bytes", loaded_.rss_bytes},
+                {"live_sessions", loaded_.live_sessions},
+                {"rss_per_session_bytes", (loaded_.rss_bytes - baseline_.rss_bytes) / sessions}
+            };
+        }
+        return report;
+    }
+
+private:
+    void runSession(int index)
+    {
+        std::this_thread::sleep_for(scenario_.ramp_up * index / std::max(1, scenario_.sessions));
+
+        Variables variables = scenario_.variables;
+        variables["index"] = std::to_string(index);
+        for (auto& [name, value] : variables) {
+            value = substitute(value, {{"index", std::to_string(index)}});
+        }
+
+        std::map<std::string, StepStats> local;
+        HttpSession http(scenario_.host, scenario_.port);
+        std::mt19937 rng(static_cast<unsigned>(index) * 7919u + 1u);
+        std::uniform_int_distribution<long long> think(scenario_.think_min.count(),
+                                                       std::max(scenario_.think_min, scenario_.think_max).count());
+
+        bool ok = runSteps(scenario_.setup, http, variables, local);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++set_up_;
+        }
+        set_up_changed_.notify_all();
+
+        for (int iteration = 0; ok && iteration < scenario_.iterations; ++iteration) {
+            variables["iteration"] = std::to_string(iteration);
+            std::this_thread::sleep_for(std::chrono::milliseconds(think(rng)));
+            ok = runSteps(scenario_.loop, http, variables, local);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        failed_ += ok ? 0 : 1;
+        for (auto& [name, stats] : local) {
+            StepStats& total = stats_[name];
+            total.latencies.insert(total.latencies.end(), stats.latencies.begin(), stats.latencies.end());
+            total.errors += stats.errors;
+        }
+    }
+
+    bool runSteps(const std::vector<Step>& steps, HttpSession& http, Variables& variables,
+                  std::map<std::string, StepStats>& stats)
+    {
+        for (const Step& step : steps) {
+            std::string body = substitute(step.body, variables);
+            std::vector<std::pair<std::string, std::string>> headers;
+            for (const auto& [name, value] : step.headers) {
+                headers.emplace_back(name, substitute(value, variables));
+            }
+            if (!step.form.empty()) {
+                for (const auto& [key, value] : step.form) {
+                    body += (body.empty() ? "" : "&") + urlEncode(substitute(key, variables)) + "=" +
+                            urlEncode(substitute(value, variables));
+                }
+                headers.emplace_back("Content-Type", "application/x-www-form-urlencoded");
+            }
+
+            auto start = Clock::now();
+            HttpResult result = http.request(step.method, substitute(step.target, variables), headers, body);
+            auto micros = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+
+            std::string failure = result.error;
+            if (failure.empty() && result.status != step.expect_status) {
+                failure = "status " + std::to_string(result.status);
+            }
+            if (failure.empty() && !step.expect_contains.empty() &&
+                result.body.find(substitute(step.expect_contains, variables)) == std::string::npos) {
+                failure = "missing \"" + step.expect_contains + "\"";
+            }
+            std::string missing;
+            applyCaptures(scenario_.captures, result.body, variables, missing);
+            applyCaptures(step.captures, result.body, variables, missing);
+            if (failure.empty() && !missing.empty()) {
+                failure = "nothing captured for " + missing;
+            }
+
+            StepStats& step_stats = stats[step.name];
+            step_stats.latencies.push_back(static_cast<std::uint64_t>(micros));
+            if (!failure.empty()) {
+                ++step_stats.errors;
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (reported_errors_++ < 20) {
+                    std::cerr << "session " << variables["index"] << ": " << step.name << ": " << failure << "\n";
+                }
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const Scenario& scenario_;
+    std::mutex mutex_;
+    std::condition_variable set_up_changed_;
+    int set_up_ = 0;  ///< Sessions past their setup steps, failed or not
+    int failed_ = 0;
+    int reported_errors_ = 0;
+    std::map<std::string, StepStats> stats_;
+    ServerSample baseline_;
+    ServerSample loaded_;
+    Clock::time_point started_;
+    Clock::duration elapsed_{};
+};
+
+void printReport(const nlohmann::json& report)
+{
+    std::printf("scenario %s: %d sessions (%d failed), %.1f s, %llu requests, %llu errors, %.1f req/s\n",
+                report["scenario"].get<std::string>().c_str(), report["sessions"].get<int>(),
+                report["failed_sessions"].get<int>(), report["seconds"].get<double>(),
+                report["requests"].get<unsigned long long>(), report["errors"].get<unsigned long long>(),
+                report["throughput_rps"].get<double>());
+    std::printf("%-28s %9s %7s %9s %9s %9s %9s\n", "step", "requests", "errors", "p50 ms", "p95 ms", "p99 ms", "max ms");
+    for (const auto& [name, step] : report["steps"].items()) {
+        std::printf("%-28s %9llu %7llu %9.2f %9.2f %9.2f %9.2f\n", name.c_str(),
+                    step["requests"].get<unsigned long long>(), step["errors"].get<unsigned long long>(),
+                    step["p50_ms"].get<double>(), step["p95_ms"].get<double>(), step["p99_ms"].get<double>(),
+                    step["max_ms"].get<double>());
+    }
+    if (report.contains("server")) {
+        const nlohmann::json& server = report["server"];
+        std::printf("server RSS %.1f MiB -> %.1f MiB with %.0f live sessions, %.1f KiB per session\n",
+                    server["rss_baseline_bytes"].get<double>() / (1 << 20),
+                    server["rss_loaded_bytes"].get<double>() / (1 << 20), server["live_sessions"].get<double>(),
+                    server["rss_per_session_bytes"].get<double>() / 1024);
+    } else {
+        std::printf("server RSS not available, the metrics endpoint did not answer\n");
+    }
+}
+
+/// Compares p95 latencies, throughput and memory with an earlier report
+bool compareWithBaseline(const nlohmann::json& report, const nlohmann::json& baseline, double max_regression)
+{
+    bool ok = true;
+    auto check = [&ok, max_regression](const std::string& what, double before, double now, bool higher_is_worse) {
+        if (before <= 0) {
+            return;
+        }
+        double change = (now - before) / before * 100.0;
+        bool regressed = higher_is_worse ? change > max_regression : -change > max_regression;
+        std::printf("%-40s %10.2f -> %10.2f  %+6.1f%%%s\n", what.c_str(), before, now, change,
+                    regressed ? "  REGRESSION" : "");
+        ok = ok && !regressed;
+    };
+    for (const auto& [name, step] : report["steps"].items()) {
+        if (baseline["steps"].contains(name)) {
+            check(name + " p95 ms", baseline["steps"][name].value("p95_ms", 0.0), step.value("p95_ms", 0.0), true);
+        }
+    }
+    check("throughput req/s", baseline.value("throughput_rps", 0.0), report.value("throughput_rps", 0.0), false);
+    if (report.contains("server") && baseline.contains("server")) {
+        check("RSS per session KiB", baseline["server"].value("rss_per_session_bytes", 0.0) / 1024,
+              report["server"].value("rss_per_session_bytes", 0.0) / 1024, true);
+    }
+    return ok;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <scenario.json> [--host H] [--port P] [--sessions N] [--iterations N]"
+                  << " [--json report.json] [--baseline report.json] [--max-regression percent]\n";
+        return 2;
+    }
+
+    Scenario scenario;
+    try {
+        scenario = loadScenario(argv[1]);
+    } catch (const std::exception& e) {
+        std::cerr << "scenario " << argv[1] << ": " << e.what() << "\n";
+        return 2;
+    }
+
+    std::string json_path;
+    std::string baseline_path;
+    double max_regression = 10.0;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        if (option == "--host") {
+            scenario.host = value;
+        } else if (option == "--port") {
+            scenario.port = value;
+        } else if (option == "--sessions") {
+            scenario.sessions = std::max(1, std::atoi(value.c_str()));
+        } else if (option == "--iterations") {
+            scenario.iterations = std::max(0, std::atoi(value.c_str()));
+        } else if (option == "--json") {
+            json_path = value;
+        } else if (option == "--baseline") {
+            baseline_path = value;
+        } else if (option == "--max-regression") {
+            max_regression = std::atof(value.c_str());
+        } else {
+            std::cerr << "unknown option " << option << "\n";
+            return 2;
+        }
+    }
+
+    Runner runner(scenario);
+    runner.run();
+    nlohmann::json report = runner.report();
+    printReport(report);
+
+    if (!json_path.empty()) {
+        std::ofstream(json_path) << report.dump(2) << "\n";
+    }
+    if (!baseline_path.empty()) {
+        std::ifstream file(baseline_path);
+        if (!file) {
+            std::cerr << "cannot open baseline " << baseline_path << "\n";
+            return 2;
+        }
+        if (!compareWithBaseline(report, nlohmann::json::parse(file), max_regression)) {
+            return 1;
+        }
+    }
+    return report["failed_sessions"].get<int>() == 0 ? 0 : 1;
+}
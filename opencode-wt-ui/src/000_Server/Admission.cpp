@@ -0,0 +1,91 @@
+#include "000_Server/Admission.h"
+#include "000_Server/Metrics.h"
+
+#include <algorithm>
+
+namespace {
+
+// Client addresses tracked at most
+const std::size_t MaxBuckets = 4096;
+
+}
+
+Admission::Ticket::~Ticket()
+{
+    if (admission_ != nullptr) {
+        admission_->releaseSlot();
+    }
+}
+
+Admission::Admission(Options options)
+    : options_(options)
+{
+}
+
+Admission::Ticket Admission::admit(const std::string& client_address)
+{
+    // The slot is checked first, a client turned away for capacity keeps its token
+    if (!acquireSlot()) {
+        Metrics::add(Metrics::Counter::AdmissionsOverCapacity);
+        return Ticket();
+    }
+    if (!takeToken(client_address)) {
+        releaseSlot();
+        Metrics::add(Metrics::Counter::AdmissionsRateLimited);
+        return Ticket();
+    }
+    return Ticket(this);
+}
+
+bool Admission::acquireSlot()
+{
+    if (options_.max_constructing == 0) {
+        constructing_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    std::size_t current = constructing_.load(std::memory_order_relaxed);
+    do {
+        if (current >= options_.max_constructing) {
+            return false;
+        }
+    } while (!constructing_.compare_exchange_weak(current, current + 1, std::memory_order_relaxed));
+    return true;
+}
+
+void Admission::releaseSlot()
+{
+    constructing_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool Admission::takeToken(const std::string& client_address)
+{
+    if (options_.sessions_per_second <= 0) {
+        return true;
+    }
+    const Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = buckets_.find(client_address);
+    if (it == buckets_.end()) {
+        if (buckets_.size() >= MaxBuckets) {
+            // Rejecting untracked addresses would lock out every new client once the
+            // table fills up; the least recently seen one starts over with a full bucket
+            buckets_.erase(lru_.front());
+            lru_.pop_front();
+        }
+        it = buckets_.emplace(client_address, Bucket{options_.burst, now, lru_.insert(lru_.end(), client_address)}).first;
+    } else {
+        Bucket& bucket = it->second;
+        double elapsed = std::chrono::duration<double>(now - bucket.refilled).count();
+        bucket.tokens = std::min(options_.burst, bucket.tokens + elapsed * options_.sessions_per_second);
+        bucket.refilled = now;
+        lru_.splice(lru_.end(), lru_, bucket.lru);
+    }
+
+    Bucket& bucket = it->second;
+    if (bucket.tokens < 1.0) {
+        return false;
+    }
+    bucket.tokens -= 1.0;
+    return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Admission control of new sessions
+ *
+ * A new session is admitted when its client address still has a token in
+ * its bucket and fewer than max_constructing sessions are being built at
+ * that moment. At most MaxBuckets addresses are tracked; a new address
+ * past that evicts the least recently seen one, which starts over with a
+ * full bucket when it returns. A rejected client is sent a static page
+ * that retries after a while, so a flood of new connections costs the
+ * live sessions neither threads nor memory.
+ */
+class Admission
+{
+public:
+    struct Options {
+        double sessions_per_second = 1.0;     ///< Bucket refill rate of one client address, 0 for no limit
+        double burst = 10.0;                  ///< Bucket size, new sessions a client may open at once
+        std::size_t max_constructing = 4;     ///< Sessions built at the same time, 0 for no limit
+        std::chrono::seconds retry_after{3};  ///< Delay before a rejected client retries
+    };
+
+    /**
+     * @brief Permission to build one session, holds a construction slot until destroyed
+     */
+    class Ticket
+    {
+    public:
+        Ticket() = default;
+        Ticket(Ticket&& other) noexcept : admission_(other.admission_) { other.admission_ = nullptr; }
+        Ticket& operator=(Ticket&&) = delete;
+        ~Ticket();
+
+        explicit operator bool() const { return admission_ != nullptr; }
+
+    private:
+        friend class Admission;
+        explicit Ticket(Admission* admission) : admission_(admission) {}
+
+        Admission* admission_ = nullptr;
+    };
+
+    explicit Admission(Options options);
+
+    /**
+     * @brief Admits a new session of a client address, or returns an empty ticket
+     */
+    Ticket admit(const std::string& client_address);
+
+    std::chrono::seconds retryAfter() const { return options_.retry_after; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Bucket {
+        double tokens;
+        Clock::time_point refilled;              ///< Also the last time the address was seen
+        std::list<std::string>::iterator lru;
+    };
+
+    bool acquireSlot();
+    void releaseSlot();
+    bool takeToken(const std::string& client_address);
+
+    Options options_;
+    std::atomic<std::size_t> constructing_{0};
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, Bucket> buckets_;
+    std::list<std::string> lru_;                 ///< Addresses, least recently seen first
+};
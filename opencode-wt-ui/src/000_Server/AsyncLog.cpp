@@ -0,0 +1,200 @@
+#include "000_Server/AsyncLog.h"
+#include "000_Server/Metrics.h"
+
+#include <Wt/WApplication.h>
+#include <Wt/WLogger.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+static_assert((AsyncLog::Capacity & (AsyncLog::Capacity - 1)) == 0, "Capacity must be a power of two");
+
+const char* const LevelNames[] = {"debug", "info", "warning", "error"};
+
+struct Entry {
+    AsyncLog::Level level = AsyncLog::Level::Info;
+    char session[24] = {};  ///< Wt session ids are 16 characters by default
+    std::string text;
+};
+
+/**
+ * @brief Bounded multi-producer, single-consumer ring of log lines
+ *
+ * Every slot carries a sequence number telling whether it is free for the
+ * producer at a given position or filled for the consumer, so producers
+ * only compete on one compare-and-swap of the enqueue position.
+ */
+class Sink
+{
+public:
+    static Sink& instance()
+    {
+        static Sink sink;
+        return sink;
+    }
+
+    Sink()
+        : slots_(AsyncLog::Capacity)
+    {
+        for (std::size_t i = 0; i < slots_.size(); ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        writer_ = std::thread([this] { run(); });
+    }
+
+    ~Sink()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        writer_.join();
+    }
+
+    bool push(Entry& entry)
+    {
+        std::size_t position = enqueue_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots_[position & (slots_.size() - 1)];
+            std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (difference == 0) {
+                if (enqueue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;  // Full, the writer has not caught up
+            } else {
+                position = enqueue_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->entry = std::move(entry);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        // Wakes the writer early under a burst, without taking its lock
+        if ((position & (slots_.size() / 4 - 1)) == 0) {
+            wake_.notify_one();
+        }
+        return true;
+    }
+
+    void dropped()
+    {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        Metrics::add(Metrics::Counter::LogLinesDropped);
+    }
+
+    void flush()
+    {
+        std::size_t target = enqueue_.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> lock(mutex_);
+        flushing_ = true;
+        wake_.notify_one();
+        flushed_.wait(lock, [this, target] { return written_ >= target || stopping_; });
+        flushing_ = false;
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence{0};
+        Entry entry;
+    };
+
+    bool pop(Entry& entry)
+    {
+        Slot& slot = slots_[dequeue_ & (slots_.size() - 1)];
+        std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != dequeue_ + 1) {
+            return false;  // Empty, or the producer of this slot is still writing it
+        }
+        entry = std::move(slot.entry);
+        slot.entry.text.clear();
+        slot.sequence.store(dequeue_ + slots_.size(), std::memory_order_release);
+        ++dequeue_;
+        return true;
+    }
+
+    void write(const Entry& entry)
+    {
+        auto log = Wt::log(LevelNames[static_cast<int>(entry.level)]);
+        if (entry.session[0]) {
+            log << "[" << entry.session << "] ";
+        }
+        log << entry.text;
+    }
+
+    void run()
+    {
+        Entry entry;
+        std::uint64_t reported = 0;
+        for (;;) {
+            while (pop(entry)) {
+                write(entry);
+            }
+            std::uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+            if (dropped != reported) {
+                Wt::log("warning") << "AsyncLog - " << (dropped - reported) << " log lines dropped, the queue was full";
+                reported = dropped;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            written_ = dequeue_;
+            flushed_.notify_all();
+            if (stopping_ && enqueue_.load(std::memory_order_acquire) == dequeue_) {
+                return;
+            }
+            // Producers never take the lock; lines wait at most one period
+            if (!flushing_) {
+                wake_.wait_for(lock, std::chrono::milliseconds(10));
+            }
+        }
+    }
+
+    std::vector<Slot> slots_;
+    std::atomic<std::size_t> enqueue_{0};
+    std::size_t dequeue_ = 0;  ///< Only touched by the writer thread
+    std::atomic<std::uint64_t> dropped_{0};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable flushed_;
+    std::size_t written_ = 0;
+    bool flushing_ = false;
+    bool stopping_ = false;
+    std::thread writer_;
+};
+
+}
+
+void AsyncLog::submit(Level level, std::string text)
+{
+    Entry entry;
+    entry.level = level;
+    entry.text = std::move(text);
+    if (auto* app = Wt::WApplication::instance()) {
+        const std::string& session = app->sessionId();
+        std::size_t length = std::min(session.size(), sizeof(entry.session) - 1);
+        std::memcpy(entry.session, session.data(), length);
+        entry.session[length] = '\0';
+    }
+
+    Sink& sink = Sink::instance();
+    if (!sink.push(entry)) {
+        sink.dropped();
+    }
+}
+
+void AsyncLog::flush()
+{
+    Sink::instance().flush();
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Levels below this one are compiled out: 0 debug, 1 info, 2 warning, 3 error
+#ifndef LOG_MIN_LEVEL
+#ifdef DEBUG
+#define LOG_MIN_LEVEL 0
+#else
+#define LOG_MIN_LEVEL 1
+#endif
+#endif
+
+/**
+ * @brief Log sink that keeps formatting and I/O off the request threads
+ *
+ * A line is built on the calling thread and queued in a bounded lock-free
+ * ring shared by all threads; a background thread hands the lines to Wt's
+ * logger, so <log-config> and <log-file> still apply. When the ring is full
+ * the line is dropped and counted instead of blocking the caller. Use it
+ * through APP_LOG:
+ *
+ *     APP_LOG(Debug) << "Sessions::refreshSessionList() - Requesting session list";
+ *
+ * Lines below LOG_MIN_LEVEL are removed at compile time, including the
+ * evaluation of their arguments.
+ */
+class AsyncLog
+{
+public:
+    enum class Level : int { Debug = 0, Info = 1, Warning = 2, Error = 3 };
+
+    static constexpr bool compiled(Level level) { return static_cast<int>(level) >= LOG_MIN_LEVEL; }
+
+    /// Lines that can wait for the writer thread
+    static constexpr std::size_t Capacity = 8192;
+
+    /**
+     * @brief One log line, queued when it goes out of scope
+     */
+    class Line
+    {
+    public:
+        explicit Line(Level level) : level_(level) {}
+        ~Line() { submit(level_, std::move(text_)); }
+
+        Line(const Line&) = delete;
+        Line& operator=(const Line&) = delete;
+
+        Line& operator<<(char c)
+        {
+            text_ += c;
+            return *this;
+        }
+
+        template <typename T>
+        Line& operator<<(const T& value)
+        {
+            if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+                text_.append(std::string_view(value));
+            } else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+                text_ += std::to_string(value);
+            } else {
+                std::ostringstream out;
+                out << value;
+                text_ += out.str();
+            }
+            return *this;
+        }
+
+    private:
+        Level level_;
+        std::string text_;
+    };
+
+    /**
+     * @brief Queues a line, tagged with the current Wt session if any
+     */
+    static void submit(Level level, std::string text);
+
+    /**
+     * @brief Blocks until the lines queued so far were handed to Wt's logger
+     */
+    static void flush();
+};
+
+#define APP_LOG(level) \
+    if constexpr (!AsyncLog::compiled(AsyncLog::Level::level)) {} else AsyncLog::Line(AsyncLog::Level::level)
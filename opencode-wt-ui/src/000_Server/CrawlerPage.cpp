@@ -0,0 +1,79 @@
+#include "000_Server/CrawlerPage.h"
+#include "008_Workspace/MessageBundles.h"
+
+#include <Wt/WLogger.h>
+#include <Wt/WServer.h>
+
+namespace {
+
+const char* const FallbackTitle = "Opencode Wt UI";
+const char* const FallbackBody = "<main><h1>Opencode Wt UI</h1><p><a href=\"/\">Open the application</a></p></main>";
+
+}
+
+CrawlerPage::CrawlerPage(Wt::WServer& server, Workspace::MessageBundles& bundles)
+    : server_(server),
+      bundles_(bundles),
+      page_(std::make_shared<const Page>(Page{FallbackTitle, FallbackBody}))
+{
+    // An empty session id runs the handler on the server's thread pool
+    subscription_ = bundles_.subscribe(std::string(), [this](std::shared_ptr<const Workspace::MessageBundleChange> change) {
+        if (change->bundle->path == BundlePath) {
+            scheduleRender();
+        }
+    });
+}
+
+CrawlerPage::~CrawlerPage()
+{
+    bundles_.unsubscribe(subscription_);
+}
+
+std::shared_ptr<const CrawlerPage::Page> CrawlerPage::page()
+{
+    // Bundles are loaded after the server starts and the first load is not
+    // published, so a page still rendered from the fallback checks once more
+    bool stale = false;
+    std::shared_ptr<const Page> page;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stale = version_ == 0;
+        page = page_;
+    }
+    if (stale && bundles_.bundle(BundlePath)) {
+        scheduleRender();
+    }
+    return page;
+}
+
+void CrawlerPage::scheduleRender()
+{
+    if (rendering_.exchange(true)) {
+        return;
+    }
+    server_.post(std::string(), [this]() { render(); });
+}
+
+void CrawlerPage::render()
+{
+    rendering_ = false;
+    Workspace::MessageBundlePtr bundle = bundles_.bundle(BundlePath);
+    if (!bundle) {
+        return;
+    }
+    auto page = std::make_shared<Page>(Page{FallbackTitle, FallbackBody});
+    if (auto title = bundle->messages.find("crawler.title"); title != bundle->messages.end()) {
+        page->title = title->second;
+    }
+    if (auto body = bundle->messages.find("crawler.page"); body != bundle->messages.end()) {
+        page->body = body->second;
+    } else {
+        Wt::log("warning") << "CrawlerPage - " << BundlePath << " has no crawler.page message";
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (bundle->version >= version_) {
+        page_ = std::move(page);
+        version_ = bundle->version;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Wt {
+    class WServer;
+}
+
+namespace Workspace {
+    class MessageBundles;
+}
+
+/**
+ * @brief Static page served to crawlers instead of the application
+ *
+ * Rendered from the crawler.title and crawler.page messages of
+ * crawler.xml, and rendered again on a pool thread whenever that bundle
+ * changes, so serving a crawler only copies a cached string.
+ */
+class CrawlerPage
+{
+public:
+    struct Page {
+        std::string title;
+        std::string body;  ///< XHTML, placed as is in the page body
+    };
+
+    CrawlerPage(Wt::WServer& server, Workspace::MessageBundles& bundles);
+    ~CrawlerPage();
+
+    CrawlerPage(const CrawlerPage&) = delete;
+    CrawlerPage& operator=(const CrawlerPage&) = delete;
+
+    /**
+     * @brief The last rendered page, never null
+     */
+    std::shared_ptr<const Page> page();
+
+    /// Workspace relative path of the bundle holding the page
+    static constexpr const char* BundlePath = "static/0_stylus/xml/000_General/crawler.xml";
+
+private:
+    void scheduleRender();
+    void render();
+
+    Wt::WServer& server_;
+    Workspace::MessageBundles& bundles_;
+    int subscription_ = 0;
+
+    std::mutex mutex_;
+    std::shared_ptr<const Page> page_;
+    std::uint64_t version_ = 0;  ///< Bundle version page_ was rendered from, 0 for the fallback
+    std::atomic<bool> rendering_{false};
+};
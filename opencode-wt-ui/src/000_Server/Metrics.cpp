@@ -0,0 +1,227 @@
+#include "000_Server/Metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t CounterCount = static_cast<std::size_t>(Metrics::Counter::Count);
+constexpr std::size_t PushSourceCount = static_cast<std::size_t>(Metrics::PushSource::Count);
+constexpr std::size_t BucketCount = Metrics::EventBuckets.size() + 1;  // Last one is +Inf
+
+enum class PushOutcome : std::size_t { Queued, Delivered, Dropped, Count };
+constexpr std::size_t PushOutcomeCount = static_cast<std::size_t>(PushOutcome::Count);
+
+constexpr std::size_t PushSlots = CounterCount;
+constexpr std::size_t BucketSlots = PushSlots + PushSourceCount * PushOutcomeCount;
+constexpr std::size_t EventMicrosSlot = BucketSlots + BucketCount;
+constexpr std::size_t SlotCount = EventMicrosSlot + 1;
+
+const char* const PushSourceNames[PushSourceCount] = {
+    "event_stream", "client", "file_index", "search", "tailwind", "message_bundles", "collab_documents",
+    "session_budget"
+};
+
+using Slots = std::array<std::uint64_t, SlotCount>;
+
+struct Shard {
+    std::array<std::atomic<std::uint64_t>, SlotCount> slots{};
+};
+
+/**
+ * Shards of the live threads, and the totals of the threads that exited
+ */
+class Registry
+{
+public:
+    static Registry& instance()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    void attach(Shard* shard)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shards_.push_back(shard);
+    }
+
+    void detach(Shard* shard)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::size_t i = 0; i < SlotCount; ++i) {
+            retired_[i] += shard->slots[i].load(std::memory_order_relaxed);
+        }
+        shards_.erase(std::remove(shards_.begin(), shards_.end(), shard), shards_.end());
+    }
+
+    Slots sum()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slots total = retired_;
+        for (const Shard* shard : shards_) {
+            for (std::size_t i = 0; i < SlotCount; ++i) {
+                total[i] += shard->slots[i].load(std::memory_order_relaxed);
+            }
+        }
+        return total;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<Shard*> shards_;
+    Slots retired_{};
+};
+
+struct LocalShard {
+    LocalShard() { Registry::instance().attach(&shard); }
+    ~LocalShard() { Registry::instance().detach(&shard); }
+    Shard shard;
+};
+
+void bump(std::size_t slot, std::uint64_t value)
+{
+    thread_local LocalShard local;
+    // Only this thread writes its shard, a load and a store need no locked instruction
+    std::atomic<std::uint64_t>& counter = local.shard.slots[slot];
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+std::size_t pushSlot(Metrics::PushSource source, PushOutcome outcome)
+{
+    return PushSlots + static_cast<std::size_t>(source) * PushOutcomeCount + static_cast<std::size_t>(outcome);
+}
+
+/// Difference of two counters read from different shards, which may briefly be out of step
+std::uint64_t gauge(std::uint64_t up, std::uint64_t down)
+{
+    return up > down ? up - down : 0;
+}
+
+void header(std::ostream& out, const char* name, const char* type, const char* help)
+{
+    out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n';
+}
+
+}
+
+Metrics::PushToken::PushToken(PushSource source)
+    : source(source)
+{
+    bump(pushSlot(source, PushOutcome::Queued), 1);
+}
+
+Metrics::PushToken::~PushToken()
+{
+    bump(pushSlot(source, delivered ? PushOutcome::Delivered : PushOutcome::Dropped), 1);
+}
+
+void Metrics::add(Counter counter, std::uint64_t value)
+{
+    bump(static_cast<std::size_t>(counter), value);
+}
+
+void Metrics::observeEvent(std::chrono::steady_clock::duration duration)
+{
+    auto micros = static_cast<std::uint64_t>(
+        std::max<std::int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(duration).count()));
+    std::size_t bucket = std::lower_bound(EventBuckets.begin(), EventBuckets.end(), micros) - EventBuckets.begin();
+    bump(BucketSlots + bucket, 1);
+    bump(EventMicrosSlot, micros);
+}
+
+std::uint64_t Metrics::residentBytes()
+{
+    std::ifstream statm("/proc/self/statm");
+    std::uint64_t size = 0;
+    std::uint64_t resident = 0;
+    if (!(statm >> size >> resident)) {
+        return 0;
+    }
+    return resident * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+std::string Metrics::exposition()
+{
+    const Slots total = Registry::instance().sum();
+    auto counter = [&total](Counter c) { return total[static_cast<std::size_t>(c)]; };
+
+    std::ostringstream out;
+    header(out, "wt_sessions_live", "gauge", "Wt sessions currently alive.");
+    out << "wt_sessions_live " << gauge(counter(Counter::SessionsCreated), counter(Counter::SessionsDestroyed)) << '\n';
+    header(out, "wt_sessions_created_total", "counter", "Wt sessions created.");
+    out << "wt_sessions_created_total " << counter(Counter::SessionsCreated) << '\n';
+    header(out, "wt_sessions_destroyed_total", "counter", "Wt sessions destroyed.");
+    out << "wt_sessions_destroyed_total " << counter(Counter::SessionsDestroyed) << '\n';
+
+    header(out, "wt_event_duration_seconds", "histogram", "Time a session took to handle one event.");
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < BucketCount; ++i) {
+        cumulative += total[BucketSlots + i];
+        out << "wt_event_duration_seconds_bucket{le=\"";
+        if (i < EventBuckets.size()) {
+            out << EventBuckets[i] / 1e6;
+        } else {
+            out << "+Inf";
+        }
+        out << "\"} " << cumulative << '\n';
+    }
+    out << "wt_event_duration_seconds_sum " << std::fixed << std::setprecision(6)
+        << total[EventMicrosSlot] / 1e6 << std::defaultfloat << '\n';
+    out << "wt_event_duration_seconds_count " << cumulative << '\n';
+
+    header(out, "wt_push_queue_depth", "gauge", "Callbacks posted to sessions and not run yet.");
+    for (std::size_t s = 0; s < PushSourceCount; ++s) {
+        auto source = static_cast<PushSource>(s);
+        out << "wt_push_queue_depth{source=\"" << PushSourceNames[s] << "\"} "
+            << gauge(total[pushSlot(source, PushOutcome::Queued)],
+                     total[pushSlot(source, PushOutcome::Delivered)] + total[pushSlot(source, PushOutcome::Dropped)])
+            << '\n';
+    }
+    header(out, "wt_pushes_total", "counter", "Callbacks posted to sessions, by outcome.");
+    for (std::size_t s = 0; s < PushSourceCount; ++s) {
+        auto source = static_cast<PushSource>(s);
+        out << "wt_pushes_total{source=\"" << PushSourceNames[s] << "\",outcome=\"delivered\"} "
+            << total[pushSlot(source, PushOutcome::Delivered)] << '\n';
+        out << "wt_pushes_total{source=\"" << PushSourceNames[s] << "\",outcome=\"dropped\"} "
+            << total[pushSlot(source, PushOutcome::Dropped)] << '\n';
+    }
+
+    header(out, "wt_dbo_connections_open", "gauge", "Database connections held by sessions.");
+    out << "wt_dbo_connections_open "
+        << gauge(counter(Counter::DboConnectionsOpened), counter(Counter::DboConnectionsClosed)) << '\n';
+
+    header(out, "wt_password_hashes_in_flight", "gauge", "BCrypt computations running or waiting for a CPU.");
+    out << "wt_password_hashes_in_flight "
+        << gauge(counter(Counter::PasswordHashesStarted), counter(Counter::PasswordHashesFinished)) << '\n';
+    header(out, "wt_password_hashes_total", "counter", "BCrypt computations finished.");
+    out << "wt_password_hashes_total " << counter(Counter::PasswordHashesFinished) << '\n';
+
+    header(out, "wt_sessions_trimmed_total", "counter", "Idle sessions trimmed to stay under the memory budget.");
+    out << "wt_sessions_trimmed_total " << counter(Counter::SessionsTrimmed) << '\n';
+    header(out, "wt_sessions_expired_total", "counter", "Idle sessions ended to stay under the memory budget.");
+    out << "wt_sessions_expired_total " << counter(Counter::SessionsExpired) << '\n';
+    header(out, "wt_sessions_hibernated_total", "counter", "Idle sessions that released their widget trees.");
+    out << "wt_sessions_hibernated_total " << counter(Counter::SessionsHibernated) << '\n';
+    header(out, "wt_sessions_rehydrated_total", "counter", "Widget trees rebuilt from a hibernation snapshot.");
+    out << "wt_sessions_rehydrated_total " << counter(Counter::SessionsRehydrated) << '\n';
+
+    header(out, "wt_sessions_rejected_total", "counter", "New sessions turned away by admission control.");
+    out << "wt_sessions_rejected_total{reason=\"rate_limited\"} " << counter(Counter::AdmissionsRateLimited) << '\n';
+    out << "wt_sessions_rejected_total{reason=\"over_capacity\"} " << counter(Counter::AdmissionsOverCapacity) << '\n';
+
+    header(out, "wt_log_lines_dropped_total", "counter", "Log lines dropped because the log queue was full.");
+    out << "wt_log_lines_dropped_total " << counter(Counter::LogLinesDropped) << '\n';
+
+    if (std::uint64_t rss = residentBytes()) {
+        header(out, "process_resident_memory_bytes", "gauge", "Resident memory size in bytes.");
+        out << "process_resident_memory_bytes " << rss << '\n';
+    }
+    return out.str();
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Runtime counters of the server, exported by MetricsResource
+ *
+ * Every thread counts into its own shard with plain relaxed stores, so
+ * recording costs a thread local lookup and no shared cache line. Shards
+ * are summed when the metrics are scraped; gauges such as the live session
+ * count are differences of two counters.
+ */
+class Metrics
+{
+public:
+    enum class Counter : std::size_t {
+        SessionsCreated,
+        SessionsDestroyed,
+        DboConnectionsOpened,
+        DboConnectionsClosed,
+        PasswordHashesStarted,
+        PasswordHashesFinished,
+        LogLinesDropped,
+        SessionsTrimmed,
+        SessionsExpired,
+        SessionsHibernated,
+        SessionsRehydrated,
+        AdmissionsRateLimited,
+        AdmissionsOverCapacity,
+        Count
+    };
+
+    /// Subsystems posting work into sessions
+    enum class PushSource : std::size_t {
+        EventStream,
+        Client,
+        FileIndex,
+        Search,
+        Tailwind,
+        MessageBundles,
+        CollabDocuments,
+        SessionBudget,
+        Count
+    };
+
+    static void add(Counter counter, std::uint64_t value = 1);
+
+    /**
+     * @brief Records the time a session took to handle one event
+     */
+    static void observeEvent(std::chrono::steady_clock::duration duration);
+
+    /**
+     * @brief Wraps a callback posted to a session so it is counted as queued
+     *        until it runs, or until Wt drops it with its session
+     */
+    template <typename F>
+    static std::function<void()> trackPush(PushSource source, F function)
+    {
+        auto token = std::make_shared<PushToken>(source);
+        return [token, function = std::move(function)]() mutable {
+            token->delivered = true;
+            function();
+        };
+    }
+
+    /**
+     * @brief Resident memory of the process, 0 if unknown
+     */
+    static std::uint64_t residentBytes();
+
+    /**
+     * @brief All metrics in the Prometheus text exposition format
+     */
+    static std::string exposition();
+
+    /// Upper bounds of the event duration histogram buckets, in microseconds
+    static constexpr std::array<std::uint64_t, 12> EventBuckets = {
+        1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000
+    };
+
+private:
+    struct PushToken {
+        explicit PushToken(PushSource source);
+        ~PushToken();
+        PushSource source;
+        bool delivered = false;
+    };
+};
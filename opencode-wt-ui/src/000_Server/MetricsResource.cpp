@@ -0,0 +1,16 @@
+#include "000_Server/MetricsResource.h"
+#include "000_Server/Metrics.h"
+#include <Wt/Http/Request.h>
+#include <Wt/Http/Response.h>
+
+MetricsResource::~MetricsResource()
+{
+    beingDeleted();
+}
+
+void MetricsResource::handleRequest(const Wt::Http::Request&, Wt::Http::Response& response)
+{
+    response.addHeader("Cache-Control", "no-store");
+    response.setMimeType("text/plain; version=0.0.4; charset=utf-8");
+    response.out() << Metrics::exposition();
+}
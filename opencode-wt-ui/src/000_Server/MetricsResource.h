@@ -0,0 +1,15 @@
+#pragma once
+
+#include <Wt/WResource.h>
+
+/**
+ * @brief Serves Metrics in the Prometheus text format, for scraping
+ */
+class MetricsResource : public Wt::WResource
+{
+public:
+    MetricsResource() = default;
+    ~MetricsResource() override;
+
+    void handleRequest(const Wt::Http::Request& request, Wt::Http::Response& response) override;
+};
@@ -2,10 +2,22 @@
 
 #include "000_Server/Server.h"
 #include "001_App/App.h"
+#include "001_App/BusyApp.h"
+#include "001_App/CrawlerApp.h"
+#include "000_Server/AsyncLog.h"
+#include "000_Server/Metrics.h"
+#include "000_Server/MetricsResource.h"
+#include "000_Server/SessionBudgetResource.h"
+#include "000_Server/Trace.h"
+#include "000_Server/TraceResource.h"
+#include <Wt/WIOService.h>
 #include <Wt/WSslInfo.h>
 #include <Wt/WLogger.h>
 #include <csignal>
+#include <limits>
+#include <locale>
 #include <memory>
+#include <sstream>
 
 #include <Wt/Auth/AuthService.h>
 #include <Wt/Auth/HashFunction.h>
@@ -16,6 +28,69 @@
 #include <Wt/Auth/FacebookService.h>
 #include <Wt/Auth/Mfa/TotpProcess.h>
 
+namespace {
+
+/**
+ * Counts the hashes of another hash function while they run. BCrypt is
+ * slow by design and runs on the session threads, so a burst of logins
+ * shows up here before it shows up as event latency.
+ */
+class CountedHashFunction : public Wt::Auth::HashFunction
+{
+public:
+    explicit CountedHashFunction(std::unique_ptr<Wt::Auth::HashFunction> hash)
+        : hash_(std::move(hash))
+    {
+    }
+
+    std::string name() const override { return hash_->name(); }
+
+    std::string compute(const std::string& msg, const std::string& salt) const override
+    {
+        Running running;
+        return hash_->compute(msg, salt);
+    }
+
+    bool verify(const std::string& msg, const std::string& salt, const std::string& hash) const override
+    {
+        Running running;
+        return hash_->verify(msg, salt, hash);
+    }
+
+private:
+    struct Running {
+        Running() { Metrics::add(Metrics::Counter::PasswordHashesStarted); }
+        ~Running() { Metrics::add(Metrics::Counter::PasswordHashesFinished); }
+    };
+
+    std::unique_ptr<Wt::Auth::HashFunction> hash_;
+};
+
+/**
+ * Reads a non-negative number from the configuration into value. A missing
+ * or empty property leaves value alone; so does a malformed one, which is
+ * logged with its key instead of stopping the server.
+ */
+template <typename T>
+void readNumber(const Wt::WServer& server, const std::string& key, T& value, T max = std::numeric_limits<T>::max())
+{
+    std::string text;
+    if (!server.readConfigurationProperty(key, text) || text.empty()) {
+        return;
+    }
+    std::istringstream in(text);
+    in.imbue(std::locale::classic());
+    T parsed{};
+    in >> parsed;
+    if (in.fail() || !(in >> std::ws).eof() || text[text.find_first_not_of(" \t")] == '-' || parsed > max) {
+        Wt::log("warning") << "Server - ignoring invalid " << key << " '" << text << "', keeping " << value;
+        return;
+    }
+    value = parsed;
+}
+
+}
+
 // Define static members
 Wt::Auth::AuthService Server::authService;
 Wt::Auth::PasswordService Server::passwordService(Server::authService);
@@ -28,10 +103,42 @@ Server::Server(int argc, char **argv)
 {
     setServerConfiguration(argc_, argv_, WTHTTP_CONFIGURATION);
     configureAuth();
+    configureOpencode();
+    configureWorkspace();
+    configureSessionBudget();
+    configureAdmission();
+
+    // Metrics, span tracing and the per-session accounting are only reachable
+    // when their path is configured, keep them private
+    std::string metricsPath;
+    if (readConfigurationProperty("metrics-path", metricsPath) && !metricsPath.empty()) {
+        addResource(std::make_shared<MetricsResource>(), metricsPath);
+    }
+
+    std::string tracePath;
+    if (readConfigurationProperty("trace-path", tracePath) && !tracePath.empty()) {
+        addResource(std::make_shared<TraceResource>(), tracePath);
+        std::string traceEnabled;
+        Trace::setEnabled(readConfigurationProperty("trace-enabled", traceEnabled) && traceEnabled == "true");
+    }
+
+    std::string sessionBudgetPath;
+    if (readConfigurationProperty("session-budget-path", sessionBudgetPath) && !sessionBudgetPath.empty()) {
+        addResource(std::make_shared<SessionBudgetResource>(), sessionBudgetPath);
+    }
 
     addEntryPoint(
         Wt::EntryPointType::Application,
-        [](const Wt::WEnvironment& env) {
+        [this](const Wt::WEnvironment& env) -> std::unique_ptr<Wt::WApplication> {
+            // Bots, as listed under <user-agents type="bot">, get the cached static page
+            if (env.agentIsSpiderBot()) {
+                return std::make_unique<CrawlerApp>(env, crawlerPage_->page());
+            }
+            // The ticket holds a construction slot until the App is built
+            Admission::Ticket ticket = admission_->admit(env.clientAddress());
+            if (!ticket) {
+                return std::make_unique<BusyApp>(env, admission_->retryAfter());
+            }
             return std::make_unique<App>(env);
         },
         "/");
@@ -39,16 +146,48 @@ Server::Server(int argc, char **argv)
     // run();
 }
 
+Server::~Server()
+{
+    if (opencodeEvents_) {
+        opencodeEvents_->stop();
+    }
+    if (opencodeClient_) {
+        opencodeClient_->shutdown();
+    }
+    if (workspaceSearch_) {
+        workspaceSearch_->stop();
+    }
+    if (fileIndex_) {
+        fileIndex_->stop();
+    }
+    if (sessionBudget_) {
+        sessionBudget_->stop();
+    }
+    // Queued lines are written while Wt's logger is still there
+    AsyncLog::flush();
+}
+
 int Server::run()
 {
  
    
     try {
         if (start()) {
+            opencodeEvents_->start();
+            fileIndex_->start();
+            sessionBudget_->start();
+            scheduleTranscriptMaintenance();
             int sig = WServer::waitForShutdown();
             
             Wt::log("info") << "Shutdown (signal = " << sig << ")";
+            opencodeEvents_->stop();
+            opencodeClient_->shutdown();
+            workspaceSearch_->stop();
+            fileIndex_->stop();
+            sessionBudget_->stop();
             stop();
+            transcriptStore_->flushAll();
+            collabDocuments_->persistAll();
 
             if (sig == SIGHUP)
                 restart(argc_, argv_, environ);
@@ -75,7 +214,7 @@ void Server::configureAuth()
     // authService.setMfaThrottleEnabled(true);
 
     auto verifier = std::make_unique<Wt::Auth::PasswordVerifier>();
-    verifier->addHashFunction(std::make_unique<Wt::Auth::BCryptHashFunction>(12));
+    verifier->addHashFunction(std::make_unique<CountedHashFunction>(std::make_unique<Wt::Auth::BCryptHashFunction>(12)));
     passwordService.setVerifier(std::move(verifier));
     passwordService.setPasswordThrottle(std::make_unique<Wt::Auth::AuthThrottle>());
     passwordService.setStrengthValidator(std::make_unique<Wt::Auth::PasswordStrengthValidator>());
@@ -90,3 +229,91 @@ void Server::configureAuth()
         oAuthService->generateRedirectEndpoint();
     }
 }
+
+void Server::configureOpencode()
+{
+    std::string opencodeUrl;
+    if (!readConfigurationProperty("opencode-url", opencodeUrl) || opencodeUrl.empty()) {
+        opencodeUrl = "http://127.0.0.1:4096";
+    }
+    while (!opencodeUrl.empty() && opencodeUrl.back() == '/') {
+        opencodeUrl.pop_back();
+    }
+
+    opencodeEvents_ = std::make_unique<Opencode::EventStream>(*this, opencodeUrl);
+
+    // REST calls may go over a Unix domain socket to a local opencode process
+    Opencode::Client::Options clientOptions;
+    clientOptions.base_url = opencodeUrl;
+    readConfigurationProperty("opencode-socket", clientOptions.unix_socket);
+    opencodeClient_ = std::make_unique<Opencode::Client>(*this, clientOptions);
+
+    Wt::log("info") << "Opencode server: " << opencodeUrl
+                    << (clientOptions.unix_socket.empty() ? "" : " (REST over " + clientOptions.unix_socket + ")");
+
+    std::string transcriptsDir;
+    if (!readConfigurationProperty("opencode-transcripts-dir", transcriptsDir) || transcriptsDir.empty()) {
+        transcriptsDir = "opencode-transcripts";
+    }
+    transcriptStore_ = std::make_unique<Opencode::TranscriptStore>(transcriptsDir);
+}
+
+void Server::scheduleTranscriptMaintenance()
+{
+    // Flushes transcript records that waited too long and closes idle logs;
+    // the timer dies with the IO service when the server stops
+    ioService().schedule(std::chrono::seconds(30), [this]() {
+        transcriptStore_->maintain();
+        scheduleTranscriptMaintenance();
+    });
+}
+
+void Server::configureWorkspace()
+{
+    std::string workspaceRoot;
+    if (!readConfigurationProperty("workspace-root", workspaceRoot) || workspaceRoot.empty()) {
+        workspaceRoot = docRoot();
+    }
+    fileIndex_ = std::make_unique<Workspace::FileIndex>(*this, workspaceRoot, Workspace::FileIndex::defaultIgnored());
+    workspaceSearch_ = std::make_unique<Workspace::SearchService>(*this, *fileIndex_);
+    fuzzyIndex_ = std::make_unique<Workspace::FuzzyIndex>(*fileIndex_);
+
+    std::string indexDir;
+    if (!readConfigurationProperty("workspace-index-dir", indexDir) || indexDir.empty()) {
+        indexDir = "workspace-index";
+    }
+    trigramIndex_ = std::make_unique<Workspace::TrigramIndex>(*this, *fileIndex_, indexDir + "/trigram.idx");
+    tailwind_ = std::make_unique<Workspace::TailwindBuilder>(*this, *fileIndex_, docRoot() + "/static/css", "static/css/");
+    messageBundles_ = std::make_unique<Workspace::MessageBundles>(*this, *fileIndex_);
+    collabDocuments_ = std::make_unique<Workspace::CollabDocuments>(*this, workspaceRoot);
+    revisionStore_ = std::make_unique<Workspace::RevisionStore>(indexDir + "/revisions");
+    crawlerPage_ = std::make_unique<CrawlerPage>(*this, *messageBundles_);
+}
+
+void Server::configureSessionBudget()
+{
+    SessionBudget::Options options;
+    std::uint64_t budgetMb = options.budget_bytes >> 20;
+    readNumber(*this, "session-memory-budget-mb", budgetMb, std::numeric_limits<std::uint64_t>::max() >> 20);
+    options.budget_bytes = budgetMb << 20;
+    auto idleSeconds = options.idle_after.count();
+    readNumber(*this, "session-idle-seconds", idleSeconds);
+    options.idle_after = std::chrono::seconds(idleSeconds);
+    auto hibernateSeconds = options.hibernate_after.count();
+    readNumber(*this, "session-hibernate-seconds", hibernateSeconds);
+    options.hibernate_after = std::chrono::seconds(hibernateSeconds);
+    sessionBudget_ = std::make_unique<SessionBudget>(*this, options);
+    sessionSnapshots_ = std::make_unique<SessionSnapshots>();
+}
+
+void Server::configureAdmission()
+{
+    Admission::Options options;
+    readNumber(*this, "admission-sessions-per-second", options.sessions_per_second);
+    readNumber(*this, "admission-burst", options.burst);
+    readNumber(*this, "admission-max-constructing", options.max_constructing);
+    auto retrySeconds = options.retry_after.count();
+    readNumber(*this, "admission-retry-seconds", retrySeconds);
+    options.retry_after = std::chrono::seconds(retrySeconds);
+    admission_ = std::make_unique<Admission>(options);
+}
@@ -8,12 +8,58 @@
 #include <Wt/Auth/PasswordService.h>
 #include <Wt/WServer.h>
 
+#include "000_Server/Admission.h"
+#include "000_Server/CrawlerPage.h"
+#include "000_Server/SessionBudget.h"
+#include "000_Server/SessionSnapshots.h"
+#include "007_Opencode/Client.h"
+#include "007_Opencode/EventStream.h"
+#include "007_Opencode/TranscriptStore.h"
+#include "008_Workspace/CollabDocuments.h"
+#include "008_Workspace/FileIndex.h"
+#include "008_Workspace/FuzzyIndex.h"
+#include "008_Workspace/MessageBundles.h"
+#include "008_Workspace/RevisionStore.h"
+#include "008_Workspace/Search.h"
+#include "008_Workspace/TailwindBuilder.h"
+#include "008_Workspace/TrigramIndex.h"
+
 class Server : public Wt::WServer
 {
 public:
     Server(int argc, char **argv);
+    ~Server() override;
     int run();
 
+    static Server* instance() { return static_cast<Server*>(Wt::WServer::instance()); }
+
+    // Shared upstream event stream of the configured opencode server
+    Opencode::EventStream& opencodeEvents() { return *opencodeEvents_; }
+    // Keep-alive REST client of the configured opencode server
+    Opencode::Client& opencodeClient() { return *opencodeClient_; }
+    // On-disk transcript logs of opencode sessions
+    Opencode::TranscriptStore& transcriptStore() { return *transcriptStore_; }
+    // Shared index of the files under the workspace root
+    Workspace::FileIndex& fileIndex() { return *fileIndex_; }
+    // Parallel text search over the indexed workspace files
+    Workspace::SearchService& workspaceSearch() { return *workspaceSearch_; }
+    // Fuzzy file path completion, kept in step with the file index
+    Workspace::FuzzyIndex& fuzzyIndex() { return *fuzzyIndex_; }
+    // Persistent trigram index of static/ and src/, used for find usages
+    Workspace::TrigramIndex& trigramIndex() { return *trigramIndex_; }
+    // Tailwind stylesheet regenerated from the classes used in the sources
+    Workspace::TailwindBuilder& tailwind() { return *tailwind_; }
+    // XML message bundles parsed once and pushed to live sessions on change
+    Workspace::MessageBundles& messageBundles() { return *messageBundles_; }
+    // Workspace files edited by several Stylus sessions at once
+    Workspace::CollabDocuments& collabDocuments() { return *collabDocuments_; }
+    // Content-addressed history of the files saved through Stylus
+    Workspace::RevisionStore& revisionStore() { return *revisionStore_; }
+    // Memory accounting of the live sessions, trims or ends idle ones over budget
+    SessionBudget& sessionBudget() { return *sessionBudget_; }
+    // State left by hibernated sessions, restored on their user's next reload
+    SessionSnapshots& sessionSnapshots() { return *sessionSnapshots_; }
+
     // Auth services as static members
     static Wt::Auth::AuthService authService;
     static Wt::Auth::PasswordService passwordService;
@@ -22,6 +68,26 @@ public:
 private:
     int argc_;
     char **argv_;
+    std::unique_ptr<Opencode::EventStream> opencodeEvents_;
+    std::unique_ptr<Opencode::Client> opencodeClient_;
+    std::unique_ptr<Opencode::TranscriptStore> transcriptStore_;
+    std::unique_ptr<Workspace::FileIndex> fileIndex_;
+    std::unique_ptr<Workspace::SearchService> workspaceSearch_;
+    std::unique_ptr<Workspace::FuzzyIndex> fuzzyIndex_;
+    std::unique_ptr<Workspace::TrigramIndex> trigramIndex_;
+    std::unique_ptr<Workspace::TailwindBuilder> tailwind_;
+    std::unique_ptr<Workspace::MessageBundles> messageBundles_;
+    std::unique_ptr<Workspace::CollabDocuments> collabDocuments_;
+    std::unique_ptr<Workspace::RevisionStore> revisionStore_;
+    std::unique_ptr<SessionBudget> sessionBudget_;
+    std::unique_ptr<SessionSnapshots> sessionSnapshots_;
+    std::unique_ptr<Admission> admission_;
+    std::unique_ptr<CrawlerPage> crawlerPage_;
 
     void configureAuth();
+    void configureOpencode();
+    void configureWorkspace();
+    void configureSessionBudget();
+    void configureAdmission();
+    void scheduleTranscriptMaintenance();
 };
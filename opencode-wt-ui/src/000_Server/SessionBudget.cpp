@@ -0,0 +1,260 @@
+#include "000_Server/SessionBudget.h"
+#include "000_Server/Metrics.h"
+
+#include <Wt/WApplication.h>
+#include <Wt/WLogger.h>
+#include <Wt/WIOService.h>
+#include <Wt/WServer.h>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+void SessionBudget::Entry::touch()
+{
+    last_activity_ms_.store(nowMs(), std::memory_order_relaxed);
+    trimmed_.store(false, std::memory_order_relaxed);
+    hibernated_.store(false, std::memory_order_relaxed);
+}
+
+SessionBudget::SessionBudget(Wt::WServer& server, Options options)
+    : server_(server),
+      options_(options)
+{
+    budget_bytes_ = options_.budget_bytes;
+    if (budget_bytes_ == 0) {
+        budget_bytes_ = static_cast<std::uint64_t>(cgroupLimit() * options_.cgroup_fraction);
+    }
+    if (budget_bytes_ > 0) {
+        Wt::log("info") << "SessionBudget - memory budget " << (budget_bytes_ >> 20) << " MiB";
+    } else {
+        Wt::log("info") << "SessionBudget - no memory budget, sessions are only measured";
+    }
+}
+
+SessionBudget::~SessionBudget()
+{
+    stop();
+}
+
+void SessionBudget::start()
+{
+    if (!running_.exchange(true)) {
+        schedule();
+    }
+}
+
+void SessionBudget::stop()
+{
+    running_ = false;
+}
+
+std::shared_ptr<SessionBudget::Entry> SessionBudget::add(const std::string& wt_session_id, Measure measure, Trim trim,
+                                                         Hibernate hibernate)
+{
+    auto entry = std::make_shared<Entry>();
+    entry->wt_session_id_ = wt_session_id;
+    entry->measure_ = std::move(measure);
+    entry->trim_ = std::move(trim);
+    entry->hibernate_ = std::move(hibernate);
+    entry->touch();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry->number_ = ++last_number_;
+    entries_.push_back(entry);
+    return entry;
+}
+
+void SessionBudget::remove(const std::shared_ptr<Entry>& entry)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.erase(std::remove(entries_.begin(), entries_.end(), entry), entries_.end());
+}
+
+void SessionBudget::schedule()
+{
+    server_.ioService().schedule(std::chrono::duration_cast<std::chrono::milliseconds>(options_.interval),
+                                 [this]() { sweep(); });
+}
+
+void SessionBudget::sweep()
+{
+    if (!running_) {
+        return;
+    }
+    std::vector<std::shared_ptr<Entry>> entries;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries = entries_;
+    }
+    // Decisions use the previous measurements, the new ones arrive as the sessions run them
+    enforce(entries);
+    hibernateIdle(entries);
+    measureAll(entries);
+    schedule();
+}
+
+void SessionBudget::measureAll(const std::vector<std::shared_ptr<Entry>>& entries)
+{
+    for (const auto& entry : entries) {
+        std::weak_ptr<Entry> weak = entry;
+        server_.post(entry->wt_session_id_, Metrics::trackPush(Metrics::PushSource::SessionBudget, [this, weak]() {
+            auto entry = weak.lock();
+            if (!entry) {
+                return;
+            }
+            Usage usage = entry->measure_();
+            std::lock_guard<std::mutex> lock(mutex_);
+            entry->usage_ = usage;
+        }));
+    }
+}
+
+void SessionBudget::enforce(const std::vector<std::shared_ptr<Entry>>& entries)
+{
+    if (budget_bytes_ == 0) {
+        return;
+    }
+    std::uint64_t resident = Metrics::residentBytes();
+    if (resident <= budget_bytes_) {
+        return;
+    }
+
+    struct Candidate {
+        std::shared_ptr<Entry> entry;
+        std::size_t bytes;
+    };
+    std::vector<Candidate> candidates;
+    const std::int64_t idle_before = nowMs() - std::chrono::milliseconds(options_.idle_after).count();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& entry : entries) {
+            if (entry->last_activity_ms_.load(std::memory_order_relaxed) <= idle_before) {
+                candidates.push_back({entry, entry->usage_.estimatedBytes()});
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.bytes > b.bytes;
+    });
+
+    // A trim frees part of a session, ending it frees all of it
+    const std::uint64_t excess = resident - budget_bytes_;
+    std::uint64_t freed = 0;
+    for (const Candidate& candidate : candidates) {
+        if (freed >= excess) {
+            break;
+        }
+        Entry& entry = *candidate.entry;
+        std::weak_ptr<Entry> weak = candidate.entry;
+        if (!entry.trimmed_.exchange(true)) {
+            Wt::log("info") << "SessionBudget - trimming idle session #" << entry.number_
+                            << " (~" << (candidate.bytes >> 10) << " KiB)";
+            Metrics::add(Metrics::Counter::SessionsTrimmed);
+            server_.post(entry.wt_session_id_, Metrics::trackPush(Metrics::PushSource::SessionBudget, [weak]() {
+                if (auto entry = weak.lock()) {
+                    entry->trim_();
+                }
+            }));
+            freed += candidate.bytes / 2;
+        } else {
+            Wt::log("info") << "SessionBudget - ending idle session #" << entry.number_
+                            << " (~" << (candidate.bytes >> 10) << " KiB)";
+            Metrics::add(Metrics::Counter::SessionsExpired);
+            server_.post(entry.wt_session_id_, Metrics::trackPush(Metrics::PushSource::SessionBudget, []() {
+                if (auto* app = Wt::WApplication::instance()) {
+                    app->quit(Wt::WString::fromUTF8("This session was closed to free server memory."));
+                }
+            }));
+            freed += candidate.bytes;
+        }
+    }
+}
+
+void SessionBudget::hibernateIdle(const std::vector<std::shared_ptr<Entry>>& entries)
+{
+    if (options_.hibernate_after.count() == 0) {
+        return;
+    }
+    const std::int64_t idle_before = nowMs() - std::chrono::milliseconds(options_.hibernate_after).count();
+    for (const auto& entry : entries) {
+        if (entry->last_activity_ms_.load(std::memory_order_relaxed) > idle_before
+            || entry->hibernated_.exchange(true)) {
+            continue;
+        }
+        std::weak_ptr<Entry> weak = entry;
+        server_.post(entry->wt_session_id_, Metrics::trackPush(Metrics::PushSource::SessionBudget, [weak]() {
+            if (auto entry = weak.lock()) {
+                entry->hibernate_();
+            }
+        }));
+    }
+}
+
+std::string SessionBudget::json() const
+{
+    struct Row {
+        std::uint64_t number;
+        Usage usage;
+        std::int64_t idle_ms;
+        bool trimmed;
+        bool hibernated;
+    };
+    std::vector<Row> rows;
+    const std::int64_t now = nowMs();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& entry : entries_) {
+            rows.push_back({entry->number_, entry->usage_,
+                            now - entry->last_activity_ms_.load(std::memory_order_relaxed),
+                            entry->trimmed_.load(std::memory_order_relaxed),
+                            entry->hibernated_.load(std::memory_order_relaxed)});
+        }
+    }
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+        return a.usage.estimatedBytes() > b.usage.estimatedBytes();
+    });
+
+    std::uint64_t total = 0;
+    nlohmann::json sessions = nlohmann::json::array();
+    for (const Row& row : rows) {
+        total += row.usage.estimatedBytes();
+        sessions.push_back({
+            {"session", row.number},
+            {"widgets", row.usage.widgets},
+            {"editor_bytes", row.usage.editor_bytes},
+            {"transcript_bytes", row.usage.transcript_bytes},
+            {"estimated_bytes", row.usage.estimatedBytes()},
+            {"idle_seconds", row.idle_ms / 1000},
+            {"trimmed", row.trimmed},
+            {"hibernated", row.hibernated}
+        });
+    }
+    nlohmann::json out = {
+        {"budget_bytes", budget_bytes_},
+        {"resident_bytes", Metrics::residentBytes()},
+        {"estimated_bytes", total},
+        {"sessions", std::move(sessions)}
+    };
+    return out.dump(2);
+}
+
+std::uint64_t SessionBudget::cgroupLimit()
+{
+    // cgroup v2, then v1; "max" or a huge value means no limit
+    for (const char* path : {"/sys/fs/cgroup/memory.max", "/sys/fs/cgroup/memory/memory.limit_in_bytes"}) {
+        std::ifstream file(path);
+        std::uint64_t limit = 0;
+        if (file >> limit) {
+            return limit < (std::uint64_t(1) << 60) ? limit : 0;
+        }
+    }
+    return 0;
+}
+
+std::int64_t SessionBudget::nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
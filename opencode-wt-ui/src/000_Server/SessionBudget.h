@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Wt {
+    class WServer;
+}
+
+/**
+ * @brief Memory accounting of the live sessions, and a process wide budget
+ *
+ * Every App registers itself with a measure and a trim callback. Each
+ * sweep the measure callbacks are posted to their sessions, and when the
+ * resident size of the process is over the budget, the largest sessions
+ * that have been idle for a while are trimmed first, then ended if they
+ * are still the largest on a later sweep. Independently of the budget,
+ * sessions idle for longer than hibernate_after are asked to hibernate:
+ * release their widget trees until the user comes back.
+ *
+ * The budget is configured in MiB, or else taken as a fraction of the
+ * cgroup memory limit; without either, sessions are only measured.
+ */
+class SessionBudget
+{
+public:
+    /**
+     * @brief What a session holds, as measured in the session
+     */
+    struct Usage {
+        std::size_t widgets = 0;           ///< Widgets in the session's trees
+        std::size_t editor_bytes = 0;      ///< Text kept by the Monaco editors
+        std::size_t transcript_bytes = 0;  ///< Message text kept by the opencode transcripts
+
+        /// Rough size, widgets are counted at WidgetBytes each
+        std::size_t estimatedBytes() const { return widgets * WidgetBytes + editor_bytes + transcript_bytes; }
+    };
+
+    struct Options {
+        std::uint64_t budget_bytes = 0;                 ///< 0 takes cgroup_fraction of the cgroup limit
+        double cgroup_fraction = 0.8;
+        std::chrono::seconds idle_after{120};           ///< Sessions idle this long may be trimmed or ended
+        std::chrono::seconds hibernate_after{300};      ///< Sessions idle this long hibernate, 0 never
+        std::chrono::seconds interval{30};              ///< Time between two sweeps
+    };
+
+    using Measure = std::function<Usage()>;
+    using Trim = std::function<void()>;
+    using Hibernate = std::function<void()>;
+
+    /**
+     * @brief A registered session, shared with its App
+     */
+    class Entry {
+    public:
+        /**
+         * @brief Marks the session as active, called for every user event it handles
+         */
+        void touch();
+
+    private:
+        friend class SessionBudget;
+
+        std::string wt_session_id_;
+        std::uint64_t number_ = 0;  ///< Opaque id shown by json(), the Wt session id is a credential
+        Measure measure_;
+        Trim trim_;
+        Hibernate hibernate_;
+        std::atomic<std::int64_t> last_activity_ms_{0};
+        std::atomic<bool> trimmed_{false};
+        std::atomic<bool> hibernated_{false};
+        Usage usage_;  ///< Last measurement, guarded by SessionBudget::mutex_
+    };
+
+    SessionBudget(Wt::WServer& server, Options options);
+    ~SessionBudget();
+
+    SessionBudget(const SessionBudget&) = delete;
+    SessionBudget& operator=(const SessionBudget&) = delete;
+
+    void start();
+    void stop();
+
+    /**
+     * @brief Registers the calling session
+     * @param measure Called in the session to measure it
+     * @param trim Called in the session to release what it can do without
+     * @param hibernate Called in the session to release its widget trees
+     */
+    std::shared_ptr<Entry> add(const std::string& wt_session_id, Measure measure, Trim trim, Hibernate hibernate);
+    void remove(const std::shared_ptr<Entry>& entry);
+
+    /**
+     * @brief Budget in bytes, 0 when there is none
+     */
+    std::uint64_t budgetBytes() const { return budget_bytes_; }
+
+    /**
+     * @brief Last measurements of every session, largest first, as JSON
+     *
+     * Sessions are numbered in the order they registered; their Wt session
+     * ids are left out since they act as session tokens.
+     */
+    std::string json() const;
+
+    /// Assumed size of one widget and its server side state
+    static constexpr std::size_t WidgetBytes = 1024;
+
+private:
+    void schedule();
+    void sweep();
+    void measureAll(const std::vector<std::shared_ptr<Entry>>& entries);
+    void enforce(const std::vector<std::shared_ptr<Entry>>& entries);
+    void hibernateIdle(const std::vector<std::shared_ptr<Entry>>& entries);
+    static std::uint64_t cgroupLimit();
+    static std::int64_t nowMs();
+
+    Wt::WServer& server_;
+    Options options_;
+    std::uint64_t budget_bytes_ = 0;
+
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<Entry>> entries_;
+    std::uint64_t last_number_ = 0;
+    std::atomic<bool> running_{false};
+};
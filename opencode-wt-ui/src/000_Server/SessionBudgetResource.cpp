@@ -0,0 +1,16 @@
+#include "000_Server/SessionBudgetResource.h"
+#include "000_Server/Server.h"
+#include <Wt/Http/Request.h>
+#include <Wt/Http/Response.h>
+
+SessionBudgetResource::~SessionBudgetResource()
+{
+    beingDeleted();
+}
+
+void SessionBudgetResource::handleRequest(const Wt::Http::Request&, Wt::Http::Response& response)
+{
+    response.addHeader("Cache-Control", "no-store");
+    response.setMimeType("application/json");
+    response.out() << Server::instance()->sessionBudget().json();
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <Wt/WResource.h>
+
+/**
+ * @brief Serves the per-session memory accounting of SessionBudget as JSON
+ *
+ * Only mounted when session-budget-path is configured. Sessions are listed
+ * by an opaque number, never by their Wt session id.
+ */
+class SessionBudgetResource : public Wt::WResource
+{
+public:
+    SessionBudgetResource() = default;
+    ~SessionBudgetResource() override;
+
+    void handleRequest(const Wt::Http::Request& request, Wt::Http::Response& response) override;
+};
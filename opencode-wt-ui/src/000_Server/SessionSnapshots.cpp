@@ -0,0 +1,51 @@
+#include "000_Server/SessionSnapshots.h"
+
+#include <algorithm>
+
+SessionSnapshots::SessionSnapshots(std::size_t capacity, std::chrono::seconds ttl)
+    : capacity_(std::max<std::size_t>(1, capacity)),
+      ttl_(ttl)
+{
+}
+
+void SessionSnapshots::put(const std::string& key, std::string snapshot)
+{
+    const Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshots_.erase(key);
+    evict(now);
+    snapshots_.emplace(key, Stored{std::move(snapshot), now});
+}
+
+std::optional<std::string> SessionSnapshots::take(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = snapshots_.find(key);
+    if (it == snapshots_.end()) {
+        return std::nullopt;
+    }
+    std::optional<std::string> snapshot;
+    if (Clock::now() - it->second.stored < ttl_) {
+        snapshot = std::move(it->second.snapshot);
+    }
+    snapshots_.erase(it);
+    return snapshot;
+}
+
+void SessionSnapshots::evict(Clock::time_point now)
+{
+    for (auto it = snapshots_.begin(); it != snapshots_.end();) {
+        if (now - it->second.stored >= ttl_) {
+            it = snapshots_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    // Puts are rare, one per hibernation, so a scan for the oldest is enough
+    while (snapshots_.size() >= capacity_) {
+        auto oldest = std::min_element(snapshots_.begin(), snapshots_.end(), [](const auto& a, const auto& b) {
+            return a.second.stored < b.second.stored;
+        });
+        snapshots_.erase(oldest);
+    }
+}
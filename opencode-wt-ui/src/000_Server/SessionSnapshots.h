@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Serialized state of hibernated sessions, kept for their next reload
+ *
+ * With reload-is-new-session a reload starts a new session; the state a
+ * hibernated session left under its user's key is taken by the first new
+ * session of that user. Snapshots are opaque strings here, and are
+ * dropped after a while or when the store is full, oldest first.
+ */
+class SessionSnapshots
+{
+public:
+    explicit SessionSnapshots(std::size_t capacity = 1024, std::chrono::seconds ttl = std::chrono::hours(24));
+
+    /**
+     * @brief Stores the snapshot of a key, replacing the previous one
+     */
+    void put(const std::string& key, std::string snapshot);
+
+    /**
+     * @brief Removes and returns the snapshot of a key, if there is a live one
+     */
+    std::optional<std::string> take(const std::string& key);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stored {
+        std::string snapshot;
+        Clock::time_point stored;
+    };
+
+    void evict(Clock::time_point now);
+
+    std::size_t capacity_;
+    std::chrono::seconds ttl_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, Stored> snapshots_;
+};
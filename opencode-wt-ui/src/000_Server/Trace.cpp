@@ -0,0 +1,232 @@
+#include "000_Server/Trace.h"
+
+#include <Wt/WApplication.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unistd.h>
+#include <vector>
+
+std::atomic<bool> Trace::enabled_{false};
+
+namespace {
+
+struct Event {
+    const char* name;
+    const char* category;
+    std::int64_t start_us;
+    std::int64_t duration_us;
+    char session[24];  ///< Wt session ids are 16 characters by default
+    char detail[64];
+};
+
+/**
+ * @brief Spans of one thread, the oldest overwritten first
+ *
+ * Only the owning thread writes; the mutex is there for the rare reader
+ * exporting a trace and is otherwise never contended.
+ */
+struct Ring {
+    explicit Ring(int tid)
+        : tid(tid), events(Trace::RingCapacity)
+    {
+    }
+
+    std::mutex mutex;
+    int tid;
+    std::vector<Event> events;
+    std::size_t next = 0;
+    std::size_t count = 0;
+};
+
+class Registry
+{
+public:
+    static Registry& instance()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    Ring* attach()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rings_.push_back(std::make_unique<Ring>(++lastTid_));
+        return rings_.back().get();
+    }
+
+    void detach(Ring* ring)
+    {
+        // The spans of an exited thread are dropped with it
+        std::lock_guard<std::mutex> lock(mutex_);
+        rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                    [ring](const std::unique_ptr<Ring>& r) { return r.get() == ring; }),
+                     rings_.end());
+    }
+
+    template <typename F>
+    void forEach(F function)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& ring : rings_) {
+            std::lock_guard<std::mutex> ringLock(ring->mutex);
+            function(*ring);
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Ring>> rings_;
+    int lastTid_ = 0;
+};
+
+struct LocalRing {
+    LocalRing() : ring(Registry::instance().attach()) {}
+    ~LocalRing() { Registry::instance().detach(ring); }
+    Ring* ring;
+};
+
+std::int64_t micros(Trace::Clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+}
+
+void copyTruncated(char* target, std::size_t size, const char* source, std::size_t length)
+{
+    length = std::min(length, size - 1);
+    std::memcpy(target, source, length);
+    target[length] = '\0';
+}
+
+void push(const char* name, const char* category, const char* session, std::size_t sessionLength,
+          Trace::Clock::time_point start, Trace::Clock::time_point end, const char* detail, std::size_t detailLength)
+{
+    thread_local LocalRing local;
+    Ring& ring = *local.ring;
+    std::lock_guard<std::mutex> lock(ring.mutex);
+    Event& event = ring.events[ring.next];
+    event.name = name;
+    event.category = category;
+    event.start_us = micros(start);
+    event.duration_us = std::max<std::int64_t>(0, micros(end) - event.start_us);
+    copyTruncated(event.session, sizeof(event.session), session, sessionLength);
+    copyTruncated(event.detail, sizeof(event.detail), detail, detailLength);
+    ring.next = (ring.next + 1) % ring.events.size();
+    ring.count = std::min(ring.count + 1, ring.events.size());
+}
+
+void writeString(std::ostream& out, const char* text)
+{
+    out << '"';
+    for (const char* c = text; *c; ++c) {
+        switch (*c) {
+        case '"':
+            out << "\\\"";
+            break;
+        case '\\':
+            out << "\\\\";
+            break;
+        default:
+            if (static_cast<unsigned char>(*c) < 0x20) {
+                out << ' ';
+            } else {
+                out << *c;
+            }
+        }
+    }
+    out << '"';
+}
+
+}
+
+void Trace::setEnabled(bool enabled)
+{
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void Trace::record(const char* name, const char* category, const std::string& session,
+                   Clock::time_point start, Clock::time_point end, const std::string& detail)
+{
+    if (!enabled()) {
+        return;
+    }
+    push(name, category, session.data(), session.size(), start, end, detail.data(), detail.size());
+}
+
+void Trace::record(const char* name, const char* category,
+                   Clock::time_point start, Clock::time_point end, const char* detail)
+{
+    if (!enabled()) {
+        return;
+    }
+    const char* session = "";
+    std::size_t sessionLength = 0;
+    if (auto* app = Wt::WApplication::instance()) {
+        session = app->sessionId().data();
+        sessionLength = app->sessionId().size();
+    }
+    push(name, category, session, sessionLength, start, end,
+         detail ? detail : "", detail ? std::strlen(detail) : 0);
+}
+
+std::string Trace::chromeJson(const std::string& session)
+{
+    struct Exported {
+        int tid;
+        Event event;
+    };
+    std::vector<Exported> exported;
+    std::vector<int> tids;
+    Registry::instance().forEach([&](const Ring& ring) {
+        tids.push_back(ring.tid);
+        std::size_t first = (ring.next + ring.events.size() - ring.count) % ring.events.size();
+        for (std::size_t i = 0; i < ring.count; ++i) {
+            const Event& event = ring.events[(first + i) % ring.events.size()];
+            if (session.empty() || session == event.session) {
+                exported.push_back({ring.tid, event});
+            }
+        }
+    });
+    std::sort(exported.begin(), exported.end(), [](const Exported& a, const Exported& b) {
+        return a.event.start_us < b.event.start_us;
+    });
+
+    std::ostringstream out;
+    const int pid = static_cast<int>(getpid());
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (int tid : tids) {
+        out << (first ? "" : ",") << "\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid
+            << ",\"tid\":" << tid << ",\"args\":{\"name\":\"thread " << tid << "\"}}";
+        first = false;
+    }
+    for (const Exported& e : exported) {
+        out << (first ? "" : ",") << "\n{\"ph\":\"X\",\"name\":";
+        writeString(out, e.event.name);
+        out << ",\"cat\":";
+        writeString(out, e.event.category);
+        out << ",\"ts\":" << e.event.start_us << ",\"dur\":" << e.event.duration_us
+            << ",\"pid\":" << pid << ",\"tid\":" << e.tid << ",\"args\":{\"session\":";
+        writeString(out, e.event.session);
+        if (e.event.detail[0]) {
+            out << ",\"detail\":";
+            writeString(out, e.event.detail);
+        }
+        out << "}}";
+        first = false;
+    }
+    out << "\n]}\n";
+    return out.str();
+}
+
+void Trace::clear()
+{
+    Registry::instance().forEach([](Ring& ring) {
+        ring.next = 0;
+        ring.count = 0;
+    });
+}
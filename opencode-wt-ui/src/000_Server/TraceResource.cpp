@@ -0,0 +1,33 @@
+#include "000_Server/TraceResource.h"
+#include "000_Server/Trace.h"
+#include <Wt/Http/Request.h>
+#include <Wt/Http/Response.h>
+
+TraceResource::~TraceResource()
+{
+    beingDeleted();
+}
+
+void TraceResource::handleRequest(const Wt::Http::Request& request, Wt::Http::Response& response)
+{
+    response.addHeader("Cache-Control", "no-store");
+
+    const std::string* record = request.getParameter("record");
+    const std::string* clear = request.getParameter("clear");
+    if (record || clear) {
+        if (clear && *clear == "1") {
+            Trace::clear();
+        }
+        if (record) {
+            Trace::setEnabled(*record == "1");
+        }
+        response.setMimeType("text/plain; charset=utf-8");
+        response.out() << "recording " << (Trace::enabled() ? "on" : "off") << "\n";
+        return;
+    }
+
+    const std::string* session = request.getParameter("session");
+    response.setMimeType("application/json");
+    response.addHeader("Content-Disposition", "attachment; filename=\"trace.json\"");
+    response.out() << Trace::chromeJson(session ? *session : std::string());
+}
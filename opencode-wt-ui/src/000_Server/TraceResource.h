@@ -0,0 +1,20 @@
+#pragma once
+
+#include <Wt/WResource.h>
+
+/**
+ * @brief Serves the spans recorded by Trace as a Chrome trace JSON file
+ *
+ * Query parameters:
+ *  - session=<id>: only the spans of that Wt session
+ *  - record=1 or record=0: turns recording on or off
+ *  - clear=1: drops the recorded spans
+ */
+class TraceResource : public Wt::WResource
+{
+public:
+    TraceResource() = default;
+    ~TraceResource() override;
+
+    void handleRequest(const Wt::Http::Request& request, Wt::Http::Response& response) override;
+};
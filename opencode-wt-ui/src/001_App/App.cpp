@@ -1,7 +1,14 @@
 #include "App.h"
+#include "000_Server/Server.h"
+#include "000_Server/Metrics.h"
+#include "000_Server/Trace.h"
+#include "001_App/AppSnapshot.h"
+#include "008_Workspace/LiveStrings.h"
 // #include "006-Navigation/Navigation.h"
 
 #include "004_Theme/DarkModeToggle.h"
+#include "005_Components/MonacoEditor.h"
+#include "007_Opencode/Transcript.h"
 // #include "004_Theme/ThemeSwitcher.h"
 
 // #include "005_Components/ComponentsDisplay.h"
@@ -12,21 +19,54 @@
 #include <Wt/WPushButton.h>
 #include <Wt/WMenu.h>
 #include <Wt/WLabel.h>
+#include <Wt/WText.h>
 #include <Wt/WTheme.h>
 #include <Wt/WContainerWidget.h>
 #include <Wt/WDialog.h>
+#include <chrono>
 #include <memory>
+#include <unordered_set>
 #include <Wt/WRandom.h>
 
 // #include "101-Stylus/000-Utils/StylusState.h"
 
+namespace {
+
+// Transcript limits of a trimmed session, the older messages reload on demand
+const std::size_t TrimmedTranscriptMessages = 20;
+const std::size_t TrimmedTranscriptBytes = 256 * 1024;
+
+// Browser input counts as activity at most this often, mouse moves included
+const int ActivityThrottleMs = 60 * 1000;
+
+template <typename F>
+void forEachWidget(Wt::WWidget* widget, std::unordered_set<const Wt::WWidget*>& seen, F& visit)
+{
+    if (widget == nullptr || !seen.insert(widget).second) {
+        return;
+    }
+    visit(widget);
+    for (Wt::WWidget* child : widget->children()) {
+        forEachWidget(child, seen, visit);
+    }
+}
+
+}
+
 App::App(const Wt::WEnvironment& env)
     : Wt::WApplication(env),
-      session_(appRoot() + "../dbo.db")
+      session_(appRoot() + "../dbo.db"),
+      activity_(this, "activity")
 {
+    Trace::Span span("App::App", "app");
 #ifdef DEBUG
     Wt::log("debug") << "App::App() - application starting";
 #endif
+    Metrics::add(Metrics::Counter::SessionsCreated);
+    budgetEntry_ = Server::instance()->sessionBudget().add(sessionId(),
+        [this]() { return measureUsage(); },
+        [this]() { trimMemory(); },
+        [this]() { hibernate(); });
     // Title
     setTitle("Wt CPP app title");
     setHtmlClass("dark");
@@ -36,6 +76,8 @@ App::App(const Wt::WEnvironment& env)
     // #elif RELEASE
     // useStyleSheet(docRoot() + "/static/css/tailwind.minify.css");
     // #endif
+    // Opencode events are pushed into the session from the shared event stream
+    enableUpdates(true);
     setBodyClass("min-h-screen min-w-screen bg-gray-50 text-gray-900 font-sans antialiased dark:bg-gray-900 dark:text-gray-100 transition-colors");
     // require("https://cdn.jsdelivr.net/npm/@tailwindcss/browser@4");
     // require("https://unpkg.com/vue@3/dist/vue.global.prod.js");
@@ -50,7 +92,12 @@ App::App(const Wt::WEnvironment& env)
         // bundle.use(docRoot() + "/static/0_stylus/xml/001_Auth/ovrwt-auth-strings");
         // bundle.use(docRoot() + "/static/0_stylus/xml/001_Auth/ovrwt-registration-view");
     }
+    // Message bundles resolve from the shared, hot-reloaded copies
+    Workspace::LiveStrings::install(Server::instance()->messageBundles());
     setTheme(std::make_shared<Theme>());
+    tailwindSubscription_ = Server::instance()->tailwind().subscribe(sessionId(), [this](std::string url) {
+        swapStyleSheet(url);
+    });
 
     authDialog_ = wApp->root()->addNew<Wt::WDialog>("");
     authDialog_->keyWentDown().connect([=](Wt::WKeyEvent e) {
@@ -74,7 +121,30 @@ App::App(const Wt::WEnvironment& env)
     // authWidget_->addStyleClass("w-full max-w-md bg-white text-gray-900 border border-gray-200 rounded-xl shadow-lg p-6 space-y-4 dark:bg-gray-800 dark:text-gray-100 dark:border-gray-700 transition-colors");
     appRoot_ = root()->addNew<Wt::WContainerWidget>();
     stylus_ = root()->addChild(std::make_unique<Stylus::Stylus>(session_));
-    opencode_ = root()->addChild(std::make_unique<Opencode::Opencode>(session_));
+
+    // Reading or scrolling sends no event; without this such a session would look idle
+    activity_.connect(this, &App::rehydrate);
+    doJavaScript(R"(
+        (function() {
+            var last = Date.now();
+            function active(e) {
+                if (document.visibilityState !== 'visible') {
+                    return;
+                }
+                // Coming back to the tab is reported at once, a hibernated page should not wait for a click
+                var returned = e.type === 'visibilitychange' || e.type === 'focus';
+                if (!returned && Date.now() - last < )" + std::to_string(ActivityThrottleMs) + R"() {
+                    return;
+                }
+                last = Date.now();
+                )" + activity_.createCall({}) + R"(;
+            }
+            ['pointermove', 'pointerdown', 'keydown', 'wheel', 'visibilitychange'].forEach(function(name) {
+                document.addEventListener(name, active, { capture: true, passive: true });
+            });
+            window.addEventListener('focus', active);
+        })();
+    )");
     
     session_.login().changed().connect(this, &App::authEvent);
     authWidget_->processEnvironment();
@@ -102,6 +172,79 @@ App::App(const Wt::WEnvironment& env)
     });
 }
 
+App::~App()
+{
+    if (tailwindSubscription_ != 0) {
+        Server::instance()->tailwind().unsubscribe(tailwindSubscription_);
+    }
+    Server::instance()->sessionBudget().remove(budgetEntry_);
+    Metrics::add(Metrics::Counter::SessionsDestroyed);
+}
+
+void App::notify(const Wt::WEvent& event)
+{
+    Trace::Span span("App::notify", "event");
+    // Server pushes into the session are not activity, only what the user does
+    if (budgetEntry_ && event.eventType() == Wt::EventType::User) {
+        budgetEntry_->touch();
+    }
+    auto start = std::chrono::steady_clock::now();
+    Wt::WApplication::notify(event);
+    Metrics::observeEvent(std::chrono::steady_clock::now() - start);
+}
+
+void App::swapStyleSheet(const std::string& url)
+{
+    // The new sheet is linked before the old one goes, so nothing renders unstyled
+    useStyleSheet(Wt::WLink(url));
+    if (!tailwindSheet_.empty()) {
+        removeStyleSheet(Wt::WLink(tailwindSheet_));
+    }
+    tailwindSheet_ = url;
+#ifdef DEBUG
+    Wt::log("debug") << "App::swapStyleSheet() - " << url;
+#endif
+    triggerUpdate();
+}
+
+SessionBudget::Usage App::measureUsage() const
+{
+    SessionBudget::Usage usage;
+    std::unordered_set<const Wt::WWidget*> seen;
+    auto visit = [&usage](Wt::WWidget* widget) {
+        ++usage.widgets;
+        if (auto* editor = dynamic_cast<MonacoEditor*>(widget)) {
+            usage.editor_bytes += editor->bufferBytes();
+        } else if (auto* transcript = dynamic_cast<Opencode::Transcript*>(widget)) {
+            usage.transcript_bytes += transcript->retainedBytes();
+        }
+    };
+    // Dialogs are not in the root's tree
+    for (Wt::WWidget* top : std::initializer_list<Wt::WWidget*>{root(), authDialog_, stylus_, opencode_}) {
+        forEachWidget(top, seen, visit);
+    }
+    return usage;
+}
+
+void App::trimMemory()
+{
+    std::unordered_set<const Wt::WWidget*> seen;
+    std::size_t trimmed = 0;
+    auto visit = [&trimmed](Wt::WWidget* widget) {
+        if (auto* transcript = dynamic_cast<Opencode::Transcript*>(widget)) {
+            transcript->setLimits(TrimmedTranscriptMessages, TrimmedTranscriptBytes);
+            ++trimmed;
+        }
+    };
+    for (Wt::WWidget* top : std::initializer_list<Wt::WWidget*>{root(), authDialog_, stylus_, opencode_}) {
+        forEachWidget(top, seen, visit);
+    }
+#ifdef DEBUG
+    Wt::log("debug") << "App::trimMemory() - trimmed " << trimmed << " transcripts";
+#endif
+    triggerUpdate();
+}
+
 void App::authEvent() {
     if (session_.login().loggedIn()) {
         const Wt::Auth::User& u = session_.login().user();
@@ -119,16 +262,35 @@ void App::authEvent() {
         //     authDialog_->show();
         // }
     }
+    if (hibernated_) {
+        rehydrate();
+        return;
+    }
     createApp();
+
+    // A reload starts a new session; it picks up where a hibernated one of the same user was
+    std::string key = snapshotKey();
+    if (key.empty()) {
+        return;
+    }
+    if (auto stored = Server::instance()->sessionSnapshots().take(key)) {
+        AppSnapshot snapshot;
+        if (AppSnapshot::fromJson(*stored, snapshot)) {
+            applySnapshot(snapshot);
+            Metrics::add(Metrics::Counter::SessionsRehydrated);
+        }
+    }
 }
 
 void App::createApp()
 {
+    Trace::Span span("App::createApp", "app");
     if (appRoot_ != nullptr && !appRoot_->children().empty()) {
         appRoot_->clear();
     }
 
     if (session_.login().loggedIn()) {
+        Trace::Span transactionSpan("Dbo::Transaction", "dbo", "App::createApp");
         Wt::Dbo::Transaction transaction(session_);
 
         // Query for STYLUS permission, taking first result if multiple exist
@@ -153,3 +315,83 @@ void App::createApp()
 
 
 }
+
+void App::hibernate()
+{
+    if (hibernated_) {
+        return;
+    }
+    Trace::Span span("App::hibernate", "app");
+
+    AppSnapshot snapshot;
+    if (stylus_ != nullptr) {
+        snapshot.stylus = stylus_->state();
+    }
+    if (opencode_ != nullptr) {
+        snapshot.opencode = opencode_->state();
+    }
+    std::string key = snapshotKey();
+    if (!key.empty()) {
+        Server::instance()->sessionSnapshots().put(key, snapshot.toJson());
+    }
+    snapshot_ = std::move(snapshot);
+
+    // The auth dialog stays, it holds the login
+    appRoot_->clear();
+    // Shown until the next activity rebuilds the page, createApp() clears it
+    appRoot_->addNew<Wt::WText>("Restoring your workspace...")
+        ->setStyleClass("min-h-screen flex items-center justify-center text-gray-500 dark:text-gray-400");
+    opencode_ = nullptr;
+    if (stylus_ != nullptr) {
+        root()->removeChild(stylus_);
+        stylus_ = nullptr;
+    }
+    hibernated_ = true;
+    Metrics::add(Metrics::Counter::SessionsHibernated);
+#ifdef DEBUG
+    Wt::log("debug") << "App::hibernate() - widgets released";
+#endif
+    triggerUpdate();
+}
+
+void App::rehydrate()
+{
+    if (!hibernated_) {
+        return;
+    }
+    Trace::Span span("App::rehydrate", "app");
+    hibernated_ = false;
+    stylus_ = root()->addChild(std::make_unique<Stylus::Stylus>(session_));
+    createApp();
+    if (snapshot_) {
+        applySnapshot(*snapshot_);
+        snapshot_.reset();
+    }
+    // Restored here, so a later reload starts fresh
+    std::string key = snapshotKey();
+    if (!key.empty()) {
+        Server::instance()->sessionSnapshots().take(key);
+    }
+    Metrics::add(Metrics::Counter::SessionsRehydrated);
+#ifdef DEBUG
+    Wt::log("debug") << "App::rehydrate() - widgets rebuilt";
+#endif
+}
+
+void App::applySnapshot(const AppSnapshot& snapshot)
+{
+    if (stylus_ != nullptr) {
+        stylus_->restoreState(snapshot.stylus);
+    }
+    if (opencode_ != nullptr) {
+        opencode_->restoreState(snapshot.opencode);
+    }
+}
+
+std::string App::snapshotKey()
+{
+    if (!session_.login().loggedIn()) {
+        return std::string();
+    }
+    return session_.login().user().id();
+}
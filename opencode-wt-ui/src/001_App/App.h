@@ -1,7 +1,12 @@
 #pragma once
 
 #include <Wt/WApplication.h>
+#include <Wt/WJavaScript.h>
 
+#include <optional>
+
+#include "000_Server/SessionBudget.h"
+#include "001_App/AppSnapshot.h"
 #include "002_Dbo/Session.h"
 
 #include "006_Stylus/Stylus.h"
@@ -18,6 +23,10 @@ class App : public Wt::WApplication
 {
 public:
     App(const Wt::WEnvironment& env);
+    ~App() override;
+
+protected:
+    void notify(const Wt::WEvent& event) override;
 
     // Wt::Signal<bool> dark_mode_changed_;
     // Wt::Signal<ThemeConfig> theme_changed_;
@@ -32,4 +41,22 @@ private:
     void createApp();
     AuthWidget* authWidget_ = nullptr;
     Wt::WContainerWidget* appRoot_ = nullptr;
+    // Regenerated Tailwind sheet linked by the last hot swap
+    std::string tailwindSheet_;
+    int tailwindSubscription_ = 0;
+    void swapStyleSheet(const std::string& url);
+    // Widgets and buffers this session holds, for the server's memory budget
+    SessionBudget::Usage measureUsage() const;
+    // Releases what can be rebuilt, when the session is idle and memory is short
+    void trimMemory();
+    std::shared_ptr<SessionBudget::Entry> budgetEntry_;
+    // Idle sessions keep a snapshot instead of their dialogs and appRoot_ content
+    void hibernate();
+    void rehydrate();
+    void applySnapshot(const AppSnapshot& snapshot);
+    std::string snapshotKey();
+    bool hibernated_ = false;
+    std::optional<AppSnapshot> snapshot_;
+    // Input the widgets do not report, throttled in the browser; wakes a hibernated session
+    Wt::JSignal<> activity_;
 };
\ No newline at end of file
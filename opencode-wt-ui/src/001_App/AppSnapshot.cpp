@@ -0,0 +1,68 @@
+#include "001_App/AppSnapshot.h"
+
+#include <nlohmann/json.hpp>
+
+namespace {
+
+// Bumped whenever a field changes meaning, older snapshots are then ignored
+const int Version = 1;
+
+nlohmann::json editorToJson(const MonacoEditor::State& editor)
+{
+    nlohmann::json json = {{"path", editor.path}, {"shared", editor.shared}};
+    if (!editor.unsaved_edits.empty()) {
+        json["unsaved"] = editor.unsaved_edits;
+    }
+    return json;
+}
+
+MonacoEditor::State editorFromJson(const nlohmann::json& json)
+{
+    MonacoEditor::State editor;
+    editor.path = json.value("path", "");
+    editor.shared = json.value("shared", false);
+    editor.unsaved_edits = json.value("unsaved", "");
+    return editor;
+}
+
+}
+
+std::string AppSnapshot::toJson() const
+{
+    nlohmann::json json = {
+        {"v", Version},
+        {"stylus", {
+            {"visible", stylus.visible},
+            {"tab", stylus.tab},
+            {"xml", editorToJson(stylus.xml_editor)},
+            {"css", editorToJson(stylus.css_editor)}
+        }},
+        {"opencode", {
+            {"visible", opencode.visible},
+            {"session", opencode.opencode_session_id}
+        }}
+    };
+    return json.dump();
+}
+
+bool AppSnapshot::fromJson(const std::string& text, AppSnapshot& snapshot)
+{
+    auto json = nlohmann::json::parse(text, nullptr, false);
+    if (!json.is_object() || json.value("v", 0) != Version) {
+        return false;
+    }
+    try {
+        const auto& stylus = json.at("stylus");
+        snapshot.stylus.visible = stylus.value("visible", false);
+        snapshot.stylus.tab = stylus.value("tab", 0);
+        snapshot.stylus.xml_editor = editorFromJson(stylus.at("xml"));
+        snapshot.stylus.css_editor = editorFromJson(stylus.at("css"));
+
+        const auto& opencode = json.at("opencode");
+        snapshot.opencode.visible = opencode.value("visible", false);
+        snapshot.opencode.opencode_session_id = opencode.value("session", "");
+    } catch (const nlohmann::json::exception&) {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+
+#include "006_Stylus/Stylus.h"
+#include "007_Opencode/Opencode.h"
+
+/**
+ * @brief The state a hibernating session needs to rebuild its widgets
+ *
+ * It is what the user would notice losing: which dialog is open, the
+ * selected opencode session, the files open in the editors with their
+ * unsaved edits. Everything else is rebuilt from scratch.
+ */
+struct AppSnapshot
+{
+    Stylus::Stylus::State stylus;
+    Opencode::Opencode::State opencode;
+
+    std::string toJson() const;
+
+    /**
+     * @brief Parses a snapshot written by toJson()
+     * @return False for malformed input or one of another version
+     */
+    static bool fromJson(const std::string& text, AppSnapshot& snapshot);
+};
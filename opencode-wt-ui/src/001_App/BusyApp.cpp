@@ -0,0 +1,25 @@
+#include "001_App/BusyApp.h"
+#include "000_Server/Server.h"
+
+#include <Wt/WRandom.h>
+#include <Wt/WText.h>
+
+#include <string>
+
+BusyApp::BusyApp(const Wt::WEnvironment& env, std::chrono::seconds retry_after)
+    : Wt::WApplication(env)
+{
+    // Retries are spread over a second delay, so rejected clients do not come back at once
+    const long long seconds = retry_after.count() + Wt::WRandom::get() % (retry_after.count() + 1);
+    setTitle("Busy");
+    addMetaHeader(Wt::MetaHeaderType::HttpHeader, "refresh", std::to_string(seconds));
+    setBodyClass("min-h-screen flex items-center justify-center font-sans");
+    root()->addNew<Wt::WText>("The server is busy, retrying in a few seconds...");
+
+    // Ended after the longest refresh delay the jitter can pick, not before the page reloads
+    Server::instance()->schedule(retry_after * 2 + std::chrono::seconds(1), sessionId(), []() {
+        if (auto* app = Wt::WApplication::instance()) {
+            app->quit();
+        }
+    });
+}
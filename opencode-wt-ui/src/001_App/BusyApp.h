@@ -0,0 +1,18 @@
+#pragma once
+
+#include <Wt/WApplication.h>
+
+#include <chrono>
+
+/**
+ * @brief What a client turned away by admission control gets instead of an App
+ *
+ * A static page that reloads itself after the retry delay, with no
+ * database, auth or dialogs behind it. The session ends on its own once
+ * the page has been served.
+ */
+class BusyApp : public Wt::WApplication
+{
+public:
+    BusyApp(const Wt::WEnvironment& env, std::chrono::seconds retry_after);
+};
@@ -0,0 +1,10 @@
+#include "001_App/CrawlerApp.h"
+
+#include <Wt/WText.h>
+
+CrawlerApp::CrawlerApp(const Wt::WEnvironment& env, std::shared_ptr<const CrawlerPage::Page> page)
+    : Wt::WApplication(env)
+{
+    setTitle(Wt::WString::fromUTF8(page->title));
+    root()->addNew<Wt::WText>(Wt::WString::fromUTF8(page->body), Wt::TextFormat::UnsafeXHTML);
+}
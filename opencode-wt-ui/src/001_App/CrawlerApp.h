@@ -0,0 +1,18 @@
+#pragma once
+
+#include <Wt/WApplication.h>
+
+#include "000_Server/CrawlerPage.h"
+
+/**
+ * @brief What a crawler gets instead of an App
+ *
+ * The cached crawler page in a single text widget: no database, no auth,
+ * no theme and no dialogs. Wt ends the session of a bot after its first
+ * response.
+ */
+class CrawlerApp : public Wt::WApplication
+{
+public:
+    CrawlerApp(const Wt::WEnvironment& env, std::shared_ptr<const CrawlerPage::Page> page);
+};
@@ -1,6 +1,9 @@
 #include "002_Dbo/Session.h"
 #include "002_Dbo/Tables/Permission.h"
+#include "002_Dbo/Tables/OpencodeSession.h"
 #include "000_Server/Server.h"
+#include "000_Server/Metrics.h"
+#include "000_Server/Trace.h"
 
 #include <Wt/Dbo/SqlConnection.h>
 #include <Wt/Dbo/backend/Sqlite3.h>
@@ -16,6 +19,7 @@
 
 Session::Session(const std::string &sqliteDb)
 {
+  Trace::Span span("Session::Session", "dbo");
   std::unique_ptr<Wt::Dbo::SqlConnection> connection;
 
   #ifdef DEBUG
@@ -70,6 +74,7 @@ Session::Session(const std::string &sqliteDb)
 
   mapClass<User>("user");
   mapClass<Permission>("permission");
+  mapClass<OpencodeSession>("opencode_session");
   mapClass<AuthInfo>("auth_info");
   mapClass<AuthInfo::AuthIdentityType>("auth_identity");
   mapClass<AuthInfo::AuthTokenType>("auth_token");
@@ -88,6 +93,13 @@ Session::Session(const std::string &sqliteDb)
   users_ = std::make_unique<UserDatabase>(*this);
   createInitialData();
 
+  // Each session holds its own connection, there is no shared pool
+  Metrics::add(Metrics::Counter::DboConnectionsOpened);
+}
+
+Session::~Session()
+{
+  Metrics::add(Metrics::Counter::DboConnectionsClosed);
 }
 
 
@@ -98,6 +110,7 @@ Wt::Auth::AbstractUserDatabase& Session::users()
 
 dbo::ptr<User> Session::user() const
 {
+  Trace::Span span("Session::user", "dbo");
   if (login_.loggedIn()) {
     dbo::ptr<AuthInfo> authInfo = users_->find(login_.user());
     return authInfo->user();
@@ -107,6 +120,7 @@ dbo::ptr<User> Session::user() const
 
 dbo::ptr<User> Session::user(const Wt::Auth::User& authUser)
 {
+  Trace::Span span("Session::user", "dbo");
   dbo::ptr<AuthInfo> authInfo = users_->find(authUser);
 
   dbo::ptr<User> user = authInfo->user();
@@ -142,6 +156,7 @@ std::vector<const Wt::Auth::OAuthService *> Session::oAuth()
 Wt::Dbo::ptr<User> addUser(Wt::Dbo::Session& session, UserDatabase& users, const std::string& loginName,
              const std::string& email, const std::string& password)
 {
+  Trace::Span span("Dbo::Transaction", "dbo", "addUser");
   Wt::Dbo::Transaction t(session);
   auto user = session.addNew<User>(loginName);
   auto authUser = users.registerNew();
@@ -159,6 +174,7 @@ Wt::Dbo::ptr<User> addUser(Wt::Dbo::Session& session, UserDatabase& users, const
 
 void Session::createInitialData()
 {
+  Trace::Span span("Session::createInitialData", "dbo");
   // Create STYLUS permission if it doesn't exist
   {
     Wt::Dbo::Transaction t(*this);
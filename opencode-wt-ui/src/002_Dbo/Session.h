@@ -23,6 +23,7 @@ public:
   // void configureAuth();
 
   explicit Session(const std::string& sqliteDb);
+  ~Session() override;
 
   dbo::ptr<User> user() const;
   dbo::ptr<User> user(const Wt::Auth::User& authUser);
@@ -0,0 +1,9 @@
+#include "002_Dbo/Tables/OpencodeSession.h"
+#include <Wt/Dbo/Impl.h>
+
+DBO_INSTANTIATE_TEMPLATES(OpencodeSession)
+
+OpencodeSession::OpencodeSession(const std::string& opencodeId)
+  : opencodeId_(opencodeId)
+{
+}
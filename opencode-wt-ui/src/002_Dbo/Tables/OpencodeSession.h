@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+
+#include <Wt/Dbo/Types.h>
+#include <Wt/Dbo/WtSqlTraits.h>
+#include <Wt/WDateTime.h>
+#include <Wt/WGlobal.h>
+
+// Metadata of an opencode session whose transcript is kept on disk. The
+// messages themselves live in the session's TranscriptStore log, the row
+// only points at it.
+class OpencodeSession {
+public:
+  OpencodeSession() = default;
+  explicit OpencodeSession(const std::string& opencodeId);
+
+  std::string opencodeId_;
+  std::string logFile_;
+  long long logSize_ = 0;
+  int messageCount_ = 0;
+  Wt::WDateTime updated_;
+
+  template<class Action>
+  void persist(Action& a)
+  {
+    Wt::Dbo::field(a, opencodeId_, "opencode_id");
+    Wt::Dbo::field(a, logFile_, "log_file");
+    Wt::Dbo::field(a, logSize_, "log_size");
+    Wt::Dbo::field(a, messageCount_, "message_count");
+    Wt::Dbo::field(a, updated_, "updated");
+  }
+private:
+};
+
+
+DBO_EXTERN_TEMPLATES(OpencodeSession)
@@ -4,6 +4,7 @@
 #include "003_Auth/UserDetailsModel.h"
 #include "002_Dbo/Tables/User.h"
 #include "002_Dbo/Tables/Permission.h"
+#include "008_Workspace/LiveStrings.h"
 
 #include <Wt/Auth/PasswordService.h>
 #include <Wt/WApplication.h>
@@ -16,10 +17,10 @@ AuthWidget::AuthWidget(Session& session)
     session_(session)
 { 
   // setInternalBasePath("/user");
-  wApp->messageResourceBundle().use(wApp->docRoot() + "/static/0_stylus/xml/001_Auth/ovrwt-auth");
-  wApp->messageResourceBundle().use(wApp->docRoot() + "/static/0_stylus/xml/001_Auth/ovrwt-auth-login");
-  wApp->messageResourceBundle().use(wApp->docRoot() + "/static/0_stylus/xml/001_Auth/ovrwt-auth-strings");
-  wApp->messageResourceBundle().use(wApp->docRoot() + "/static/0_stylus/xml/001_Auth/ovrwt-registration-view");
+  Workspace::LiveStrings::use(wApp->docRoot() + "/static/0_stylus/xml/001_Auth/ovrwt-auth");
+  Workspace::LiveStrings::use(wApp->docRoot() + "/static/0_stylus/xml/001_Auth/ovrwt-auth-login");
+  Workspace::LiveStrings::use(wApp->docRoot() + "/static/0_stylus/xml/001_Auth/ovrwt-auth-strings");
+  Workspace::LiveStrings::use(wApp->docRoot() + "/static/0_stylus/xml/001_Auth/ovrwt-registration-view");
 
   model()->addPasswordAuth(&Session::passwordAuth());
   model()->addOAuth(Session::oAuth());
@@ -1,4 +1,5 @@
 #include "004_Theme/DarkModeToggle.h"
+#include "000_Server/Trace.h"
 
 #include <Wt/Dbo/Transaction.h>
 #include <Wt/WApplication.h>
@@ -16,6 +17,7 @@ DarkModeToggle::DarkModeToggle(Session& session)
 
     changed().connect(this, [this]() {
         if (session_.login().loggedIn()) {
+            Trace::Span span("Dbo::Transaction", "dbo", "DarkModeToggle");
             Wt::Dbo::Transaction transaction(session_);
             auto user = session_.user(session_.login().user());
             if (user) {
@@ -1,4 +1,7 @@
 #include "Theme.h"
+#include "000_Server/Server.h"
+#include "008_Workspace/LiveStrings.h"
+#include "000_Server/Trace.h"
 
 #include <initializer_list>
 #include <sstream>
@@ -30,55 +33,13 @@ void addClasses(Wt::DomElement& element, std::initializer_list<const char*> clas
     }
 }
 
-std::string classesFromMessage(const char* messageId)
-{
-    if (!messageId) {
-        return {};
-    }
-
-    const std::string classes = Wt::WString::tr(messageId).toUTF8();
-    if (classes.size() >= 4 && classes[0] == '?' && classes[1] == '?') {
-        return {};
-    }
-
-    return classes;
-}
-
-void addClassesFromMessage(Wt::DomElement& element, const char* messageId)
-{
-    const std::string classes = classesFromMessage(messageId);
-    if (classes.empty()) {
-        return;
-    }
-
-    std::istringstream stream(classes);
-    std::string cls;
-    while (stream >> cls) {
-        element.addPropertyWord(Wt::Property::Class, cls);
-    }
-}
-
-void addClassesFromMessage(Wt::WWidget* widget, const char* messageId)
-{
-    if (!widget) {
-        return;
-    }
-
-    const std::string classes = classesFromMessage(messageId);
-    if (classes.empty()) {
-        return;
-    }
-
-    widget->addStyleClass(classes);
-}
-
 }
 
 Theme::Theme(const std::string& name)
     : WTheme()
     , name_(name.empty() ? "tailwind" : name)
 {
-    wApp->messageResourceBundle().use(wApp->docRoot() + "/static/0_stylus/xml/000_General/General_components");
+    Workspace::LiveStrings::use(wApp->docRoot() + "/static/0_stylus/xml/000_General/General_components");
 }
 
 Theme::~Theme() = default;
@@ -97,6 +58,13 @@ std::vector<Wt::WLinkedCssStyleSheet> Theme::styleSheets() const
         return sheets;
     }
 
+    // Sheet regenerated from the current sources, when there is one
+    const std::string generated = Server::instance()->tailwind().styleSheetUrl();
+    if (!generated.empty()) {
+        sheets.emplace_back(Wt::WLinkedCssStyleSheet(Wt::WLink(generated)));
+        return sheets;
+    }
+
 #ifdef DEBUG
     const std::string cssPath = "static/css/tailwind.css?v=" + Wt::WRandom::generateId();
 #else
@@ -109,6 +77,7 @@ std::vector<Wt::WLinkedCssStyleSheet> Theme::styleSheets() const
 
 void Theme::apply(Wt::WWidget* widget, Wt::WWidget* child, int widgetRole) const
 {
+    Trace::Span span("Theme::apply", "theme");
     if (!widget->isThemeStyleEnabled()) {
         return;
     }
@@ -160,6 +129,7 @@ void Theme::apply(Wt::WWidget* widget, Wt::WWidget* child, int widgetRole) const
 
 void Theme::apply(Wt::WWidget* widget, Wt::DomElement& element, int elementRole) const
 {
+    Trace::Span span("Theme::apply", "theme");
     if (!widget->isThemeStyleEnabled()) {
         return;
     }
@@ -387,3 +357,45 @@ bool Theme::canBorderBoxElement(const Wt::DomElement& element) const
     (void)element;
     return true;
 }
+
+std::string Theme::classesFromMessage(const char* messageId)
+{
+    if (!messageId) {
+        return {};
+    }
+
+    const std::string classes = Wt::WString::tr(messageId).toUTF8();
+    if (classes.size() >= 4 && classes[0] == '?' && classes[1] == '?') {
+        return {};
+    }
+
+    return classes;
+}
+
+void Theme::addClassesFromMessage(Wt::DomElement& element, const char* messageId)
+{
+    const std::string classes = classesFromMessage(messageId);
+    if (classes.empty()) {
+        return;
+    }
+
+    std::istringstream stream(classes);
+    std::string cls;
+    while (stream >> cls) {
+        element.addPropertyWord(Wt::Property::Class, cls);
+    }
+}
+
+void Theme::addClassesFromMessage(Wt::WWidget* widget, const char* messageId)
+{
+    if (!widget) {
+        return;
+    }
+
+    const std::string classes = classesFromMessage(messageId);
+    if (classes.empty()) {
+        return;
+    }
+
+    widget->addStyleClass(classes);
+}
@@ -32,6 +32,13 @@ public:
                               Wt::WFlags<Wt::ValidationStyleFlag> styles) const override;
     bool canBorderBoxElement(const Wt::DomElement& element) const override;
 
+    /**
+     * @brief Classes held by a message id, empty when the message is missing
+     */
+    static std::string classesFromMessage(const char* messageId);
+    static void addClassesFromMessage(Wt::DomElement& element, const char* messageId);
+    static void addClassesFromMessage(Wt::WWidget* widget, const char* messageId);
+
 private:
     std::string name_;
 };
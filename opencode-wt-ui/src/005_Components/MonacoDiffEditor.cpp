@@ -0,0 +1,69 @@
+#include "005_Components/MonacoDiffEditor.h"
+#include <Wt/WApplication.h>
+#include <Wt/WRandom.h>
+#include <Wt/WWebWidget.h>
+
+MonacoDiffEditor::MonacoDiffEditor(std::string language)
+    : language_(language)
+{
+    setMinimumSize(Wt::WLength(1, Wt::LengthUnit::Pixel), Wt::WLength(1, Wt::LengthUnit::Pixel));
+    wApp->require(wApp->docRoot() + "/static/stylus/monaco-edditor.js", "monaco-editor");
+
+    doJavaScript(R"(require.config({ paths: { 'vs': 'https://unpkg.com/monaco-editor@0.34.1/min/vs' } });)");
+    editor_js_var_name_ = "diff" + Wt::WRandom::generateId() + "_editor";
+
+    bool isDarkMode = wApp->htmlClass().find("dark") != std::string::npos;
+
+    doJavaScript(
+        R"(
+        require(['vs/editor/editor.main'], function () {
+            window.)" + editor_js_var_name_ + R"( = monaco.editor.createDiffEditor(document.getElementById(')" + id() + R"('), {
+                theme: )" + (isDarkMode ? "'vs-dark'" : "'vs-light'") + R"(,
+                readOnly: true,
+                originalEditable: false,
+                renderSideBySide: true,
+                automaticLayout: true,
+                minimap: { enabled: false },
+                scrollBeyondLastLine: false,
+                scrollbar: { vertical: 'auto', horizontal: 'auto', alwaysConsumeMouseWheel: false }
+            });
+        });
+    )");
+}
+
+void MonacoDiffEditor::setTexts(const std::string& original, const std::string& modified,
+                                int original_first_line, int modified_first_line)
+{
+    // Runs once the editor exists; line numbers are offset to the excerpt position
+    doJavaScript(
+        R"(
+        require(['vs/editor/editor.main'], function () {
+            var editor = window.)" + editor_js_var_name_ + R"(;
+            if (!editor) {
+                return;
+            }
+            var old = editor.getModel();
+            editor.setModel({
+                original: monaco.editor.createModel()" + Wt::WWebWidget::jsStringLiteral(original) + R"(, ')" + language_ + R"('),
+                modified: monaco.editor.createModel()" + Wt::WWebWidget::jsStringLiteral(modified) + R"(, ')" + language_ + R"(')
+            });
+            if (old) {
+                old.original.dispose();
+                old.modified.dispose();
+            }
+            editor.getOriginalEditor().updateOptions({ lineNumbers: function(n) { return n + )" + std::to_string(original_first_line - 1) + R"(; } });
+            editor.getModifiedEditor().updateOptions({ lineNumbers: function(n) { return n + )" + std::to_string(modified_first_line - 1) + R"(; } });
+        });
+    )");
+}
+
+void MonacoDiffEditor::setSideBySide(bool side_by_side)
+{
+    doJavaScript(
+        R"(
+        require(['vs/editor/editor.main'], function () {
+            if (window.)" + editor_js_var_name_ + R"()
+                window.)" + editor_js_var_name_ + R"(.updateOptions({ renderSideBySide: )" + (side_by_side ? "true" : "false") + R"( });
+        });
+    )");
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <Wt/WContainerWidget.h>
+
+/**
+ * @brief A read-only Monaco diff editor widget
+ *
+ * Shows an original and a modified text side by side. The texts may be
+ * excerpts of larger files: line numbers are shifted so they match the
+ * position of the excerpt in the full file.
+ */
+class MonacoDiffEditor : public Wt::WContainerWidget {
+public:
+    /**
+     * @brief Constructor - creates a diff editor for the specified language
+     * @param language Programming language for syntax highlighting (e.g., "cpp", "css")
+     */
+    MonacoDiffEditor(std::string language);
+
+    /**
+     * @brief Sets the texts to compare
+     * @param original Original text
+     * @param modified Modified text
+     * @param original_first_line Line number of the first original line in its file
+     * @param modified_first_line Line number of the first modified line in its file
+     */
+    void setTexts(const std::string& original, const std::string& modified,
+                  int original_first_line = 1, int modified_first_line = 1);
+
+    /**
+     * @brief Switches between side by side and inline rendering
+     */
+    void setSideBySide(bool side_by_side);
+
+private:
+    std::string editor_js_var_name_;  ///< JavaScript variable name for this editor instance
+    std::string language_;
+};
@@ -1,12 +1,177 @@
 #include "005_Components/MonacoEditor.h"
+#include "008_Workspace/CollabDocuments.h"
 #include <Wt/WApplication.h>
 #include <Wt/WRandom.h>
 #include <Wt/WLogger.h>
 #include <fstream>
 #include <iostream>
 
+namespace {
+
+// Browser side of shared editing, declared once per page. Local edits are
+// collected into one operation per animation frame; only one operation is
+// in flight at a time, and edits pushed by the server are transformed past
+// the unacknowledged ones before being applied (the ot.js client protocol).
+const char* SharedClientJs = R"(
+if (!window.WtShared) window.WtShared = (function() {
+    function kind(c) { return typeof c === 'string' ? 'i' : (c > 0 ? 'r' : 'd'); }
+    function size(c) { return typeof c === 'string' ? c.length : Math.abs(c); }
+    function drop(c, n) { return typeof c === 'string' ? c.substr(n) : (c > 0 ? c - n : c + n); }
+    function retain(op, n) {
+        if (!n) return;
+        var last = op[op.length - 1];
+        if (typeof last === 'number' && last > 0) op[op.length - 1] += n; else op.push(n);
+    }
+    function insert(op, s) {
+        if (!s) return;
+        var last = op[op.length - 1];
+        if (typeof last === 'string') op[op.length - 1] += s;
+        else if (typeof last === 'number' && last < 0) {
+            if (typeof op[op.length - 2] === 'string') op[op.length - 2] += s; else op.splice(op.length - 1, 0, s);
+        } else op.push(s);
+    }
+    function remove(op, n) {
+        if (!n) return;
+        var last = op[op.length - 1];
+        if (typeof last === 'number' && last < 0) op[op.length - 1] -= n; else op.push(-n);
+    }
+    function transform(a, b) {
+        var ap = [], bp = [], i = 0, j = 0, x = a[0], y = b[0];
+        while (x !== undefined || y !== undefined) {
+            if (x !== undefined && kind(x) === 'i') { insert(ap, x); retain(bp, x.length); x = a[++i]; continue; }
+            if (y !== undefined && kind(y) === 'i') { retain(ap, y.length); insert(bp, y); y = b[++j]; continue; }
+            if (x === undefined || y === undefined) throw new Error('transform: length mismatch');
+            var n = Math.min(size(x), size(y));
+            if (kind(x) === 'r' && kind(y) === 'r') { retain(ap, n); retain(bp, n); }
+            else if (kind(x) === 'd' && kind(y) === 'r') remove(ap, n);
+            else if (kind(x) === 'r' && kind(y) === 'd') remove(bp, n);
+            x = size(x) === n ? a[++i] : drop(x, n);
+            y = size(y) === n ? b[++j] : drop(y, n);
+        }
+        return [ap, bp];
+    }
+    function compose(a, b) {
+        var r = [], i = 0, j = 0, x = a[0], y = b[0];
+        while (x !== undefined || y !== undefined) {
+            if (x !== undefined && kind(x) === 'd') { remove(r, -x); x = a[++i]; continue; }
+            if (y !== undefined && kind(y) === 'i') { insert(r, y); y = b[++j]; continue; }
+            if (x === undefined || y === undefined) throw new Error('compose: length mismatch');
+            var n = Math.min(size(x), size(y));
+            if (kind(x) === 'r' && kind(y) === 'r') retain(r, n);
+            else if (kind(x) === 'i' && kind(y) === 'r') insert(r, x.substr(0, n));
+            else if (kind(x) === 'r' && kind(y) === 'd') remove(r, n);
+            x = size(x) === n ? a[++i] : drop(x, n);
+            y = size(y) === n ? b[++j] : drop(y, n);
+        }
+        return r;
+    }
+    function fromChanges(changes, length) {
+        var sorted = changes.slice().sort(function(p, q) { return p.rangeOffset - q.rangeOffset; });
+        var op = [], pos = 0;
+        sorted.forEach(function(c) {
+            retain(op, c.rangeOffset - pos);
+            remove(op, c.rangeLength);
+            insert(op, c.text);
+            pos = c.rangeOffset + c.rangeLength;
+        });
+        retain(op, length - pos);
+        return op;
+    }
+    function apply(s, op) {
+        var model = s.editor.getModel(), edits = [], index = 0;
+        op.forEach(function(c) {
+            var start = model.getPositionAt(index);
+            if (kind(c) === 'r') { index += c; return; }
+            if (kind(c) === 'i') {
+                edits.push({ offset: index, range: new monaco.Range(start.lineNumber, start.column, start.lineNumber, start.column), text: c, forceMoveMarkers: true });
+                return;
+            }
+            var end = model.getPositionAt(index - c);
+            var last = edits[edits.length - 1];
+            if (last && last.offset === index) {
+                last.range = new monaco.Range(start.lineNumber, start.column, end.lineNumber, end.column);
+            } else {
+                edits.push({ offset: index, range: new monaco.Range(start.lineNumber, start.column, end.lineNumber, end.column), text: '' });
+            }
+            index -= c;
+        });
+        s.applying = true;
+        model.applyEdits(edits.map(function(e) { return { range: e.range, text: e.text, forceMoveMarkers: e.forceMoveMarkers }; }));
+        s.applying = false;
+        s.length = model.getValueLength();
+    }
+    function reset(s, revision, text) {
+        s.revision = revision;
+        s.outstanding = null;
+        s.buffer = null;
+        s.applying = true;
+        s.editor.getModel().setValue(text);
+        s.applying = false;
+        s.length = s.editor.getModel().getValueLength();
+    }
+    function send(s) {
+        s.frame = 0;
+        if (s.outstanding || !s.buffer) return;
+        s.outstanding = s.buffer;
+        s.buffer = null;
+        Wt.emit(s.id, 'sharedOps', JSON.stringify({ r: s.revision, o: s.outstanding }));
+    }
+    function schedule(s) {
+        if (!s.frame) s.frame = requestAnimationFrame(function() { send(s); });
+    }
+    var states = {};
+    return {
+        attach: function(name, id, revision, text) {
+            var editor = window[name];
+            if (!editor) { setTimeout(function() { WtShared.attach(name, id, revision, text); }, 50); return; }
+            var s = states[name];
+            if (!s) {
+                s = states[name] = { editor: editor, id: id, frame: 0 };
+                editor.onDidChangeModelContent(function(event) {
+                    if (!s.attached || s.applying) return;
+                    var op = fromChanges(event.changes, s.length);
+                    s.length = editor.getModel().getValueLength();
+                    s.buffer = s.buffer ? compose(s.buffer, op) : op;
+                    schedule(s);
+                });
+            }
+            s.attached = false;
+            reset(s, revision, text);
+            s.attached = true;
+            // The model may normalize line endings; make the server copy match it
+            var value = editor.getModel().getValue();
+            if (value !== text) {
+                s.buffer = [];
+                remove(s.buffer, text.length);
+                insert(s.buffer, value);
+                schedule(s);
+            }
+        },
+        detach: function(name) {
+            if (states[name]) states[name].attached = false;
+        },
+        receive: function(name, events) {
+            var s = states[name];
+            if (!s || !s.attached) return;
+            events.forEach(function(e) {
+                if (e.s !== undefined) { reset(s, e.s, e.t); return; }
+                if (e.a !== undefined) { s.revision = e.a; s.outstanding = null; schedule(s); return; }
+                var op = e.o, t;
+                if (s.outstanding) { t = transform(s.outstanding, op); s.outstanding = t[0]; op = t[1]; }
+                if (s.buffer) { t = transform(s.buffer, op); s.buffer = t[0]; op = t[1]; }
+                apply(s, op);
+                s.revision = e.r;
+            });
+        }
+    };
+})();
+)";
+
+}
+
 MonacoEditor::MonacoEditor(std::string language)
     : js_signal_text_changed_(this, "editorTextChanged"),
+      js_signal_shared_ops_(this, "sharedOps"),
       current_text_(""),
       unsaved_text_("")
 {
@@ -18,6 +183,7 @@ MonacoEditor::MonacoEditor(std::string language)
     // setStyleClass("h-fill");
 
     js_signal_text_changed_.connect(this, &MonacoEditor::editorTextChanged);
+    js_signal_shared_ops_.connect(this, &MonacoEditor::sharedOpsReceived);
     doJavaScript(R"(require.config({ paths: { 'vs': 'https://unpkg.com/monaco-editor@0.34.1/min/vs' } });)");
     editor_js_var_name_ = language + Wt::WRandom::generateId() + "_editor";
     
@@ -50,6 +216,9 @@ MonacoEditor::MonacoEditor(std::string language)
             });
 
             window.)" + editor_js_var_name_ + R"(.onDidChangeModelContent(function (event) {
+                if (window.WtShared && window.)" + editor_js_var_name_ + R"(_shared) {
+                    return;
+                }
                 if (window.)" + editor_js_var_name_ + R"(_current_text !== window.)" + editor_js_var_name_ + R"(.getValue()) {
                     window.)" + editor_js_var_name_ + R"(_current_text = window.)" + editor_js_var_name_ + R"(.getValue();
                     Wt.emit(')" + id() + R"(', 'editorTextChanged', window.)" + editor_js_var_name_ + R"(.getValue());
@@ -84,7 +253,9 @@ MonacoEditor::MonacoEditor(std::string language)
         {
             if (e.key() == Wt::Key::S)
             {
-                if(unsavedChanges()){
+                if (documents_) {
+                    saveFile();
+                } else if(unsavedChanges()){
                     save_file_signal_.emit(unsaved_text_);
                 }
             }
@@ -92,6 +263,11 @@ MonacoEditor::MonacoEditor(std::string language)
     });
 }
 
+MonacoEditor::~MonacoEditor()
+{
+    closeShared();
+}
+
 void MonacoEditor::layoutSizeChanged(int width, int height)
 {
     resetLayout();
@@ -128,6 +304,11 @@ bool MonacoEditor::unsavedChanges()
 
 void MonacoEditor::setEditorText(std::string resource_path)
 {
+    if (documents_) {
+        closeShared();
+        doJavaScript("if (window.WtShared) WtShared.detach('" + editor_js_var_name_ + "');"
+                     "window." + editor_js_var_name_ + "_shared = false;");
+    }
     resetLayout();
     auto resource_path_url = resource_path + "?v=" + Wt::WRandom::generateId();
     doJavaScript(
@@ -164,6 +345,79 @@ void MonacoEditor::setEditorText(std::string resource_path)
     resetLayout();
 }
 
+MonacoEditor::State MonacoEditor::state() const
+{
+    State state;
+    if (documents_) {
+        state.path = shared_path_;
+        state.shared = true;
+        return state;
+    }
+    state.path = selected_file_path_;
+    if (current_text_ == unsaved_text_) {
+        return state;
+    }
+
+    // Only the changed middle is kept, as one replace between the common ends
+    std::u16string saved = Workspace::TextOperation::fromUtf8(current_text_);
+    std::u16string unsaved = Workspace::TextOperation::fromUtf8(unsaved_text_);
+    std::size_t prefix = 0;
+    while (prefix < saved.size() && prefix < unsaved.size() && saved[prefix] == unsaved[prefix]) {
+        ++prefix;
+    }
+    std::size_t suffix = 0;
+    while (suffix < saved.size() - prefix && suffix < unsaved.size() - prefix
+           && saved[saved.size() - 1 - suffix] == unsaved[unsaved.size() - 1 - suffix]) {
+        ++suffix;
+    }
+    Workspace::TextOperation edits;
+    edits.retain(prefix)
+        .remove(saved.size() - prefix - suffix)
+        .insert(std::u16string_view(unsaved).substr(prefix, unsaved.size() - prefix - suffix))
+        .retain(suffix);
+    state.unsaved_edits = edits.toJson().dump();
+    return state;
+}
+
+void MonacoEditor::restoreState(const State& state)
+{
+    if (state.shared || state.path.empty()) {
+        return;
+    }
+    selected_file_path_ = state.path;
+    current_text_ = getFileText(state.path);
+    unsaved_text_ = current_text_;
+
+    if (!state.unsaved_edits.empty()) {
+        Workspace::TextOperation edits;
+        std::u16string text = Workspace::TextOperation::fromUtf8(current_text_);
+        auto json = nlohmann::json::parse(state.unsaved_edits, nullptr, false);
+        if (Workspace::TextOperation::fromJson(json, edits) && edits.apply(text)) {
+            unsaved_text_ = Workspace::TextOperation::toUtf8(text);
+        } else {
+            Wt::log("warning") << "MonacoEditor::restoreState() - " << state.path
+                               << " changed on disk, its unsaved edits were dropped";
+        }
+    }
+
+    // The editor loads asynchronously; setting _current_text first keeps the text from being echoed back
+    doJavaScript(R"(
+        (function() {
+            var interval = setInterval(function() {
+                if (window.)" + editor_js_var_name_ + R"() {
+                    clearInterval(interval);
+                    window.)" + editor_js_var_name_ + R"(_current_text = )" + Wt::WWebWidget::jsStringLiteral(unsaved_text_) + R"(;
+                    window.)" + editor_js_var_name_ + R"(.setValue(window.)" + editor_js_var_name_ + R"(_current_text);
+                }
+            }, 50);
+        })();
+    )");
+    if (unsaved_text_ != current_text_) {
+        available_save_.emit();
+    }
+    resetLayout();
+}
+
 void MonacoEditor::resetLayout()
 {
     doJavaScript("setTimeout(function() { window." + editor_js_var_name_ + ".layout() }, 200);");
@@ -186,21 +440,87 @@ void MonacoEditor::setDarkTheme(bool dark)
 
 std::string MonacoEditor::getFileText(std::string file_path)
 {
-    std::ifstream file(file_path);
+    std::ifstream file(file_path, std::ios::binary | std::ios::ate);
     if (!file.is_open())
     {
         Wt::log("error") << "Failed to read file: " << file_path;
         return "!Failed to read file!";
     }
 
-    std::string file_content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    file.close();
-    Wt::WString file_content_wt = Wt::WString::fromUTF8(file_content);
+    // One allocation and one read instead of growing the string a character at a time
+    std::string file_content;
+    std::streamoff size = file.tellg();
+    if (size > 0) {
+        file_content.resize(static_cast<std::size_t>(size));
+        file.seekg(0);
+        file.read(&file_content[0], size);
+        file_content.resize(static_cast<std::size_t>(file.gcount()));
+    }
     return file_content;
 }
 
+void MonacoEditor::openShared(Workspace::CollabDocuments& documents, const std::string& path)
+{
+    closeShared();
+    auto joined = documents.join(path, wApp->sessionId(), [this](std::string events) {
+        doJavaScript("WtShared.receive('" + editor_js_var_name_ + "', " + events + ");");
+        wApp->triggerUpdate();
+    });
+    if (joined.subscription_id == 0) {
+        Wt::log("error") << "MonacoEditor::openShared() - cannot open " << path;
+        return;
+    }
+    documents_ = &documents;
+    shared_path_ = path;
+    shared_subscription_ = joined.subscription_id;
+    current_text_ = joined.text;
+    unsaved_text_ = current_text_;
+
+    // A template literal, as in the initializer, would break on backticks in the file
+    std::string text = Wt::WWebWidget::jsStringLiteral(joined.text);
+    doJavaScript(SharedClientJs);
+    doJavaScript("window." + editor_js_var_name_ + "_shared = true;"
+                 "WtShared.attach('" + editor_js_var_name_ + "', '" + id() + "', "
+                 + std::to_string(joined.revision) + ", " + text + ");");
+    resetLayout();
+}
+
+void MonacoEditor::closeShared()
+{
+    if (!documents_) {
+        return;
+    }
+    documents_->leave(shared_subscription_);
+    documents_ = nullptr;
+    shared_subscription_ = 0;
+    shared_path_.clear();
+}
+
+void MonacoEditor::sharedOpsReceived(std::string message)
+{
+    if (!documents_) {
+        return;
+    }
+    auto json = nlohmann::json::parse(message, nullptr, false);
+    Workspace::TextOperation operation;
+    if (!json.is_object() || !json.contains("r") || !json["r"].is_number_unsigned()
+        || !json.contains("o") || !Workspace::TextOperation::fromJson(json["o"], operation)) {
+        Wt::log("error") << "MonacoEditor::sharedOpsReceived() - malformed edit for " << shared_path_;
+        return;
+    }
+    documents_->submit(shared_subscription_, json["r"].get<std::uint64_t>(), operation);
+}
+
 void MonacoEditor::saveFile()
 {
+    if (documents_) {
+        // Shared documents are written by the document service; the signal
+        // follows the save with the saved text
+        documents_->persist(shared_path_);
+        Wt::log("info") << "File path: " << shared_path_ << " saved successfully.";
+        save_file_signal_.emit(documents_->text(shared_path_));
+        return;
+    }
     // Save the unsaved text to the file system
     if (unsaved_text_.empty())
     {
@@ -5,6 +5,10 @@
 #include <Wt/WStringStream.h>
 #include <Wt/WSignal.h>
 
+namespace Workspace {
+    class CollabDocuments;
+}
+
 /**
  * @brief A Monaco code editor widget integrated with Wt
  * 
@@ -14,11 +18,21 @@
  */
 class MonacoEditor : public Wt::WContainerWidget {
 public:
+    /**
+     * @brief The open file and its unsaved edits, enough to reopen the editor as it was
+     */
+    struct State {
+        std::string path;           ///< File path, or workspace relative path of a shared document
+        bool shared = false;        ///< Shared documents keep their unsaved edits in the document service
+        std::string unsaved_edits;  ///< TextOperation JSON from the saved to the unsaved text, empty if none
+    };
+
     /**
      * @brief Constructor - creates a Monaco editor for the specified language
      * @param language Programming language for syntax highlighting (e.g., "javascript", "css", "html")
      */
     MonacoEditor(std::string language);
+    ~MonacoEditor() override;
     
     /**
      * @brief Sets the read-only state of the editor
@@ -37,6 +51,24 @@ public:
      * @return String containing the unsaved text
      */
     std::string getUnsavedText() { return unsaved_text_; }
+
+    /**
+     * @brief Bytes of text held server side for this editor
+     */
+    std::size_t bufferBytes() const { return current_text_.size() + unsaved_text_.size(); }
+
+    /**
+     * @brief Captures the open file and, for a file, its unsaved edits
+     */
+    State state() const;
+
+    /**
+     * @brief Reopens a file captured by state() and reapplies its unsaved edits
+     *
+     * Shared documents are reopened with openShared() instead. The edits are
+     * dropped with a warning when the file changed on disk in between.
+     */
+    void restoreState(const State& state);
     
     /**
      * @brief Marks the current text as saved (synchronizes current and unsaved text)
@@ -49,6 +81,16 @@ public:
      */
     void setEditorText(std::string resource_path);
     
+    /**
+     * @brief Edits a workspace file together with every other session that has it open
+     *
+     * Edits are exchanged as operations through the shared document service
+     * instead of whole texts, and are written to the file by the service.
+     * @param documents Shared document service
+     * @param path Workspace relative path of the file
+     */
+    void openShared(Workspace::CollabDocuments& documents, const std::string& path);
+    
     /**
      * @brief Saves the current editor content to the selected file
      */
@@ -84,6 +126,8 @@ public:
 
     /**
      * @brief Signal emitted when save operation is requested
+     *
+     * For a shared document it is emitted after the save, with the saved text.
      * @return Signal that provides the text content to save
      */
     Wt::Signal<std::string>& saveFileSignal() { return save_file_signal_; }
@@ -114,12 +158,27 @@ private:
      */
     void editorTextChanged(std::string text);
 
+    /**
+     * @brief Callback for a batch of edits of a shared document
+     * @param message JSON object with the base revision and the operation
+     */
+    void sharedOpsReceived(std::string message);
+
+    /**
+     * @brief Stops editing the shared document, if any
+     */
+    void closeShared();
+
     std::string selected_file_path_;       ///< Path to currently selected file
     std::string current_text_;             ///< Current saved text content
     std::string unsaved_text_;             ///< Unsaved text content
     std::string editor_js_var_name_;       ///< JavaScript variable name for this editor instance
+    Workspace::CollabDocuments* documents_ = nullptr;  ///< Set while editing a shared document
+    std::string shared_path_;              ///< Workspace relative path of the shared document
+    int shared_subscription_ = 0;          ///< Subscription to the shared document
     
     Wt::JSignal<std::string> js_signal_text_changed_;  ///< JavaScript signal for text changes
+    Wt::JSignal<std::string> js_signal_shared_ops_;    ///< JavaScript signal for shared document edits
     Wt::Signal<> available_save_;                       ///< Signal for save availability
     Wt::Signal<std::string> save_file_signal_;          ///< Signal for save file operation
     Wt::Signal<Wt::WString> width_changed_;             ///< Signal for width changes
@@ -0,0 +1,92 @@
+#include "006_Stylus/FilesList.h"
+#include "000_Server/Server.h"
+#include <Wt/WApplication.h>
+#include <Wt/WLogger.h>
+
+namespace Stylus {
+
+namespace {
+
+const std::string FileButtonStyles = "w-full text-left truncate px-2 py-0.5 rounded-md cursor-pointer hover:bg-surface";
+const std::string SelectedFileStyles = "bg-primary/20";
+
+}
+
+FilesList::FilesList(const std::string& directory, std::vector<std::string> extensions)
+    : directory_(directory),
+      extensions_(std::move(extensions))
+{
+    setupContent();
+
+    Workspace::FileIndex& index = Server::instance()->fileIndex();
+    showSnapshot(index.snapshot());
+    index_subscription_ = index.subscribe(
+        wApp->sessionId(),
+        [this](Workspace::SnapshotPtr snapshot) {
+            showSnapshot(snapshot);
+            wApp->triggerUpdate();
+        });
+}
+
+FilesList::~FilesList()
+{
+    if (index_subscription_ != 0) {
+        Server::instance()->fileIndex().unsubscribe(index_subscription_);
+    }
+}
+
+void FilesList::setupContent()
+{
+    setStyleClass("flex flex-col h-full w-[260px] overflow-y-auto border-r border-solid");
+
+    title_ = addNew<Wt::WText>(directory_);
+    title_->setStyleClass("text-xs font-semibold px-2 py-1 truncate border-b border-solid");
+
+    files_wrapper_ = addNew<Wt::WContainerWidget>();
+    files_wrapper_->setStyleClass("flex flex-col p-1 text-sm");
+}
+
+void FilesList::showSnapshot(const Workspace::SnapshotPtr& snapshot)
+{
+    std::vector<const Workspace::FileEntry*> files = snapshot->files(directory_, extensions_);
+
+    std::vector<std::pair<std::string, std::int64_t>> listed;
+    listed.reserve(files.size());
+    for (const Workspace::FileEntry* file : files) {
+        listed.emplace_back(file->path, file->modified);
+    }
+    if (listed == shown_) {
+        return;
+    }
+    shown_ = std::move(listed);
+
+#ifdef DEBUG
+    Wt::log("debug") << "FilesList::showSnapshot() - " << directory_ << ": " << shown_.size()
+                     << " files (snapshot " << snapshot->version() << ")";
+#endif
+
+    files_wrapper_->clear();
+    file_buttons_.clear();
+    std::size_t prefix = directory_.empty() ? 0 : directory_.size() + 1;
+    for (const auto& [path, modified] : shown_) {
+        auto button = files_wrapper_->addNew<Wt::WPushButton>(path.substr(prefix));
+        button->setStyleClass(FileButtonStyles);
+        if (path == selected_file_) {
+            button->addStyleClass(SelectedFileStyles);
+        }
+        std::string file = path;
+        button->clicked().connect([this, file]() { selectFile(file); });
+        file_buttons_.emplace_back(path, button);
+    }
+}
+
+void FilesList::selectFile(const std::string& path)
+{
+    selected_file_ = path;
+    for (const auto& [file, button] : file_buttons_) {
+        button->toggleStyleClass(SelectedFileStyles, file == path);
+    }
+    fileSelected_.emit(path);
+}
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Wt/WContainerWidget.h>
+#include <Wt/WPushButton.h>
+#include <Wt/WSignal.h>
+#include <Wt/WText.h>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "008_Workspace/FileIndex.h"
+
+namespace Stylus {
+
+/**
+ * @brief Files of one workspace directory, read from the shared file index
+ *
+ * The list is built from index snapshots only, so opening a pane never
+ * touches the file system. It is refreshed when the index publishes a
+ * snapshot whose matching files differ from the ones shown.
+ */
+class FilesList : public Wt::WContainerWidget
+{
+public:
+    /**
+     * @param directory Workspace relative directory to list
+     * @param extensions Lower case extensions to show, empty for all files
+     */
+    FilesList(const std::string& directory, std::vector<std::string> extensions);
+    ~FilesList() override;
+
+    /**
+     * @brief Emitted with the workspace relative path of a clicked file
+     */
+    Wt::Signal<std::string>& fileSelected() { return fileSelected_; }
+
+    const std::string& selectedFile() const { return selected_file_; }
+
+    /**
+     * @brief Selects a file as a click on it does, emitting fileSelected()
+     */
+    void selectFile(const std::string& path);
+
+private:
+    void setupContent();
+    void showSnapshot(const Workspace::SnapshotPtr& snapshot);
+
+    std::string directory_;
+    std::vector<std::string> extensions_;
+
+    Wt::WText* title_;
+    Wt::WContainerWidget* files_wrapper_;
+    std::vector<std::pair<std::string, Wt::WPushButton*>> file_buttons_;
+    std::vector<std::pair<std::string, std::int64_t>> shown_;  ///< Path and mtime of the listed files
+    std::string selected_file_;
+
+    int index_subscription_ = 0;
+
+    Wt::Signal<std::string> fileSelected_;
+};
+
+}
@@ -0,0 +1,136 @@
+#include "006_Stylus/HistoryPanel.h"
+#include "000_Server/Server.h"
+#include "007_Opencode/DiffView.h"
+#include <Wt/Auth/Identity.h>
+#include <Wt/WDateTime.h>
+#include <Wt/WLogger.h>
+#include <chrono>
+#include <cstdio>
+
+namespace Stylus {
+
+namespace {
+
+std::string formatSize(std::uint64_t size)
+{
+    char buffer[32];
+    if (size < 1024) {
+        std::snprintf(buffer, sizeof(buffer), "%llu B", static_cast<unsigned long long>(size));
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.1f KB", size / 1024.0);
+    }
+    return buffer;
+}
+
+}
+
+HistoryPanel::HistoryPanel(Session& session)
+    : session_(session)
+{
+    setupContent();
+}
+
+void HistoryPanel::setupContent()
+{
+    setStyleClass("flex flex-col h-full w-[420px] overflow-hidden border-r border-solid");
+
+    title_ = addNew<Wt::WText>("History");
+    title_->setStyleClass("text-sm font-semibold px-2 py-1 truncate");
+
+    revisions_wrapper_ = addNew<Wt::WContainerWidget>();
+    revisions_wrapper_->setStyleClass("flex flex-col max-h-[35%] overflow-y-auto px-1 text-xs");
+
+    restore_button_ = addNew<Wt::WPushButton>("Restore selected");
+    restore_button_->setStyleClass("m-2 px-2 py-1 text-xs rounded-md border border-solid cursor-pointer disabled:opacity-50");
+    restore_button_->disable();
+    restore_button_->clicked().connect(this, &HistoryPanel::restoreSelected);
+
+    diff_view_ = addNew<Opencode::DiffView>();
+    diff_view_->addStyleClass("flex-1 overflow-y-auto");
+    diff_view_->hide();
+}
+
+void HistoryPanel::showFile(const std::string& path)
+{
+    path_ = path;
+    selected_ = 0;
+    restore_button_->disable();
+    diff_view_->hide();
+    title_->setText(Wt::WString::fromUTF8("History of " + path));
+    listRevisions();
+}
+
+void HistoryPanel::recordSave(const std::string& text)
+{
+    if (path_.empty()) {
+        return;
+    }
+    if (Server::instance()->revisionStore().record(path_, text, author()) == 0) {
+        Wt::log("error") << "HistoryPanel::recordSave() - cannot store a revision of " << path_;
+        return;
+    }
+    listRevisions();
+}
+
+void HistoryPanel::listRevisions()
+{
+    revisions_wrapper_->clear();
+    std::vector<Workspace::FileRevision> revisions = Server::instance()->revisionStore().revisions(path_);
+    for (auto it = revisions.rbegin(); it != revisions.rend(); ++it) {
+        Wt::WDateTime time(std::chrono::system_clock::time_point(std::chrono::milliseconds(it->time)));
+        std::string label = "#" + std::to_string(it->number) + "  " + time.toString("yyyy-MM-dd HH:mm:ss").toUTF8()
+            + "  " + formatSize(it->size) + "  " + it->author;
+        auto button = revisions_wrapper_->addNew<Wt::WPushButton>(Wt::WString::fromUTF8(label), Wt::TextFormat::Plain);
+        button->setStyleClass("w-full text-left truncate font-mono px-2 rounded-md cursor-pointer hover:bg-surface");
+        if (it->number == selected_) {
+            button->addStyleClass("font-semibold");
+        }
+        std::uint64_t number = it->number;
+        button->clicked().connect([this, number]() { selectRevision(number); });
+    }
+    if (revisions.empty()) {
+        revisions_wrapper_->addNew<Wt::WText>("No saved revisions yet, Ctrl+S in the editor stores one")->setStyleClass("px-2");
+    }
+}
+
+void HistoryPanel::selectRevision(std::uint64_t number)
+{
+    std::string old_text;
+    if (!Server::instance()->revisionStore().read(path_, number, old_text)) {
+        Wt::log("error") << "HistoryPanel::selectRevision() - cannot read " << path_ << " #" << number;
+        return;
+    }
+    selected_ = number;
+    restore_button_->enable();
+    diff_view_->setDiff(path_, std::move(old_text), Server::instance()->collabDocuments().text(path_));
+    diff_view_->show();
+    listRevisions();
+}
+
+void HistoryPanel::restoreSelected()
+{
+    std::string text;
+    if (selected_ == 0 || !Server::instance()->revisionStore().read(path_, selected_, text)) {
+        return;
+    }
+    if (!Server::instance()->collabDocuments().replace(path_, text)) {
+        Wt::log("error") << "HistoryPanel::restoreSelected() - cannot restore " << path_ << " #" << selected_;
+        return;
+    }
+#ifdef DEBUG
+    Wt::log("debug") << "HistoryPanel::restoreSelected() - restored " << path_ << " #" << selected_;
+#endif
+    // The restore is a revision of its own, so it can be undone
+    recordSave(text);
+    selectRevision(selected_);
+}
+
+std::string HistoryPanel::author()
+{
+    if (!session_.login().loggedIn()) {
+        return "";
+    }
+    return session_.login().user().identity(Wt::Auth::Identity::LoginName).toUTF8();
+}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Wt/WContainerWidget.h>
+#include <Wt/WPushButton.h>
+#include <Wt/WText.h>
+#include <cstdint>
+#include <string>
+#include "002_Dbo/Session.h"
+
+namespace Opencode {
+    class DiffView;
+}
+
+namespace Stylus {
+
+/**
+ * @brief Saved versions of a file, kept in the shared revision store
+ *
+ * Lists the revisions of the selected file, shows the diff between a
+ * revision and the current text, and restores a revision into the file and
+ * every editor that has it open.
+ */
+class HistoryPanel : public Wt::WContainerWidget
+{
+public:
+    explicit HistoryPanel(Session& session);
+
+    /**
+     * @brief Lists the revisions of a workspace relative file
+     */
+    void showFile(const std::string& path);
+
+    /**
+     * @brief Stores a saved text of the shown file as its newest revision
+     */
+    void recordSave(const std::string& text);
+
+private:
+    void setupContent();
+    void listRevisions();
+    void selectRevision(std::uint64_t number);
+    void restoreSelected();
+    std::string author();
+
+    Session& session_;
+    std::string path_;
+    std::uint64_t selected_ = 0;
+
+    Wt::WText* title_;
+    Wt::WContainerWidget* revisions_wrapper_;
+    Wt::WPushButton* restore_button_;
+    Opencode::DiffView* diff_view_;
+};
+
+}
@@ -0,0 +1,119 @@
+#include "006_Stylus/SearchPanel.h"
+#include "000_Server/Server.h"
+#include <Wt/WApplication.h>
+#include <Wt/WLogger.h>
+#include <Wt/WPushButton.h>
+
+namespace Stylus {
+
+SearchPanel::SearchPanel()
+{
+    setupContent();
+}
+
+SearchPanel::~SearchPanel()
+{
+    cancelSearch();
+}
+
+void SearchPanel::setupContent()
+{
+    setStyleClass("flex flex-col h-full w-[420px] overflow-hidden border-r border-solid");
+
+    auto controls = addNew<Wt::WContainerWidget>();
+    controls->setStyleClass("flex items-center gap-2 p-2 border-b border-solid");
+
+    query_edit_ = controls->addNew<Wt::WLineEdit>();
+    query_edit_->setPlaceholderText("Search workspace");
+    query_edit_->setStyleClass("flex-1 px-2 py-1 rounded-md border border-solid text-sm");
+    query_edit_->textInput().connect([this]() { startSearch(); });
+
+    case_sensitive_ = controls->addNew<Wt::WCheckBox>("Aa");
+    case_sensitive_->setToolTip("Match case");
+    case_sensitive_->changed().connect([this]() { startSearch(); });
+
+    status_ = addNew<Wt::WText>();
+    status_->setStyleClass("text-xs px-2 py-1");
+
+    results_wrapper_ = addNew<Wt::WContainerWidget>();
+    results_wrapper_->setStyleClass("flex flex-col flex-1 overflow-y-auto p-1 text-sm");
+}
+
+void SearchPanel::cancelSearch()
+{
+    if (search_id_ != 0) {
+        Server::instance()->workspaceSearch().cancel(search_id_);
+        search_id_ = 0;
+    }
+}
+
+void SearchPanel::startSearch()
+{
+    cancelSearch();
+    results_wrapper_->clear();
+    file_groups_.clear();
+    match_count_ = 0;
+
+    std::string pattern = query_edit_->text().toUTF8();
+    if (pattern.size() < MinQueryLength) {
+        status_->setText("");
+        return;
+    }
+
+    Workspace::SearchQuery query;
+    query.pattern = pattern;
+    query.case_sensitive = case_sensitive_->isChecked();
+
+    status_->setText("Searching...");
+    search_id_ = Server::instance()->workspaceSearch().search(
+        wApp->sessionId(),
+        std::move(query),
+        [this](Workspace::SearchBatch batch) {
+            resultsReceived(std::move(batch));
+        });
+}
+
+Wt::WContainerWidget* SearchPanel::fileGroup(const std::string& path)
+{
+    auto it = file_groups_.find(path);
+    if (it != file_groups_.end()) {
+        return it->second;
+    }
+    auto group = results_wrapper_->addNew<Wt::WContainerWidget>();
+    group->setStyleClass("flex flex-col mb-1");
+    auto title = group->addNew<Wt::WText>(Wt::WString::fromUTF8(path), Wt::TextFormat::Plain);
+    title->setStyleClass("text-xs font-semibold px-1 truncate");
+    file_groups_[path] = group;
+    return group;
+}
+
+void SearchPanel::resultsReceived(Workspace::SearchBatch batch)
+{
+    for (Workspace::SearchMatch& match : batch.matches) {
+        if (++match_count_ > MaxShownMatches) {
+            continue;
+        }
+        auto row = fileGroup(match.path)->addNew<Wt::WPushButton>(
+            Wt::WString::fromUTF8(std::to_string(match.line) + ": " + match.text), Wt::TextFormat::Plain);
+        row->setStyleClass("w-full text-left truncate font-mono text-xs px-2 rounded-md cursor-pointer hover:bg-surface");
+        std::string path = match.path;
+        int line = static_cast<int>(match.line);
+        row->clicked().connect([this, path, line]() { matchSelected_.emit(path, line); });
+    }
+
+    std::string status = std::to_string(match_count_) + (batch.truncated ? "+" : "") + " matches in "
+                       + std::to_string(file_groups_.size()) + " files";
+    if (!batch.done) {
+        status += " (" + std::to_string(batch.files_scanned) + "/" + std::to_string(batch.files_total) + " scanned)";
+    } else {
+        search_id_ = 0;
+    }
+    status_->setText(status);
+
+#ifdef DEBUG
+    Wt::log("debug") << "SearchPanel::resultsReceived() - " << batch.matches.size() << " matches, done " << batch.done;
+#endif
+    wApp->triggerUpdate();
+}
+
+}
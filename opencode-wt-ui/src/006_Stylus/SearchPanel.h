@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Wt/WCheckBox.h>
+#include <Wt/WContainerWidget.h>
+#include <Wt/WLineEdit.h>
+#include <Wt/WSignal.h>
+#include <Wt/WText.h>
+#include <map>
+#include <string>
+#include "008_Workspace/Search.h"
+
+namespace Stylus {
+
+/**
+ * @brief Workspace-wide text search with results streamed as they are found
+ *
+ * Every edit of the query cancels the running search and starts a new one,
+ * so typing stays responsive on large workspaces.
+ */
+class SearchPanel : public Wt::WContainerWidget
+{
+public:
+    SearchPanel();
+    ~SearchPanel() override;
+
+    /**
+     * @brief Emitted with the workspace relative path and 1-based line of a clicked match
+     */
+    Wt::Signal<std::string, int>& matchSelected() { return matchSelected_; }
+
+    /// Matches rendered per search; the rest are only counted
+    static constexpr std::size_t MaxShownMatches = 500;
+    /// Shortest query that is searched
+    static constexpr std::size_t MinQueryLength = 2;
+
+private:
+    void setupContent();
+    void startSearch();
+    void cancelSearch();
+    void resultsReceived(Workspace::SearchBatch batch);
+    Wt::WContainerWidget* fileGroup(const std::string& path);
+
+    Wt::WLineEdit* query_edit_;
+    Wt::WCheckBox* case_sensitive_;
+    Wt::WText* status_;
+    Wt::WContainerWidget* results_wrapper_;
+    std::map<std::string, Wt::WContainerWidget*> file_groups_;
+
+    int search_id_ = 0;
+    std::size_t match_count_ = 0;
+
+    Wt::Signal<std::string, int> matchSelected_;
+};
+
+}
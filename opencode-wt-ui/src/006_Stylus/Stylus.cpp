@@ -1,4 +1,6 @@
 #include "006_Stylus/Stylus.h"
+#include "000_Server/Server.h"
+#include "008_Workspace/LiveStrings.h"
 #include <Wt/WLength.h>
 #include <Wt/WApplication.h>
 #include <Wt/WTemplate.h>
@@ -31,7 +33,7 @@ void Stylus::initializeDialog()
                    Wt::WLength(100, Wt::LengthUnit::ViewportHeight));
     setLayoutSizeAware(true);
 
-    wApp->messageResourceBundle().use(wApp->docRoot() + "/static/0_stylus/xml/002_Stylus/stylus_svg");
+    Workspace::LiveStrings::use(wApp->docRoot() + "/static/0_stylus/xml/002_Stylus/stylus_svg");
 }
 
 void Stylus::setupKeyboardShortcuts()
@@ -52,7 +54,8 @@ void Stylus::setupKeyboardShortcuts()
         });
     )");
 
-    wApp->globalKeyWentDown().connect([=](Wt::WKeyEvent e) { keyWentDown(e); });
+    // Bound to this, so the connection goes with the dialog when a session hibernates
+    wApp->globalKeyWentDown().connect(this, &Stylus::keyWentDown);
 }
 
 void Stylus::setupContent()
@@ -71,6 +74,7 @@ void Stylus::setupContent()
     std::unique_ptr<Wt::WContainerWidget> tailwind_files_wrapper = std::make_unique<Wt::WContainerWidget>();
     std::unique_ptr<Wt::WContainerWidget> images_files_wrapper = std::make_unique<Wt::WContainerWidget>();
     std::unique_ptr<Wt::WContainerWidget> settings_wrapper = std::make_unique<Wt::WContainerWidget>();
+    std::unique_ptr<Wt::WContainerWidget> search_wrapper = std::make_unique<Wt::WContainerWidget>();
 
     xml_files_wrapper_ = xml_files_wrapper.get();
     css_files_wrapper_ = css_files_wrapper.get();
@@ -78,6 +82,42 @@ void Stylus::setupContent()
     tailwind_files_wrapper_ = tailwind_files_wrapper.get();
     images_files_wrapper_ = images_files_wrapper.get();
     settings_wrapper_ = settings_wrapper.get();
+    search_wrapper_ = search_wrapper.get();
+
+    // File lists come from the shared workspace index, not from the disk
+    xml_files_ = xml_files_wrapper_->addNew<FilesList>("static/0_stylus/xml", std::vector<std::string>{"xml"});
+    css_files_ = css_files_wrapper_->addNew<FilesList>("static/css", std::vector<std::string>{"css"});
+    js_files_ = js_files_wrapper_->addNew<FilesList>("static", std::vector<std::string>{"js"});
+    tailwind_files_ = tailwind_files_wrapper_->addNew<FilesList>("static/0_stylus/tailwind", std::vector<std::string>{"css", "js", "json"});
+    images_files_ = images_files_wrapper_->addNew<FilesList>("static", std::vector<std::string>{"png", "jpg", "jpeg", "gif", "svg", "webp"});
+    search_panel_ = search_wrapper_->addNew<SearchPanel>();
+
+    // Find usages of the selected bundle's message ids and of css classes
+    xml_files_wrapper_->setStyleClass("flex h-full");
+    css_files_wrapper_->setStyleClass("flex h-full");
+    xml_usages_ = xml_files_wrapper_->addNew<UsagesPanel>();
+    css_usages_ = css_files_wrapper_->addNew<UsagesPanel>();
+    xml_files_->fileSelected().connect(xml_usages_, &UsagesPanel::showMessageIds);
+
+    // Bundles and stylesheets are edited together with the other Stylus sessions
+    xml_editor_ = xml_files_wrapper_->insertNew<MonacoEditor>(1, "xml");
+    css_editor_ = css_files_wrapper_->insertNew<MonacoEditor>(1, "css");
+    xml_editor_->addStyleClass("flex-1 h-full min-w-0");
+    css_editor_->addStyleClass("flex-1 h-full min-w-0");
+    xml_files_->fileSelected().connect([this](const std::string& path) {
+        xml_editor_->openShared(Server::instance()->collabDocuments(), path);
+    });
+    css_files_->fileSelected().connect([this](const std::string& path) {
+        css_editor_->openShared(Server::instance()->collabDocuments(), path);
+    });
+
+    // Every save is kept as a revision that can be compared and restored
+    xml_history_ = xml_files_wrapper_->addNew<HistoryPanel>(session_);
+    css_history_ = css_files_wrapper_->addNew<HistoryPanel>(session_);
+    xml_files_->fileSelected().connect(xml_history_, &HistoryPanel::showFile);
+    css_files_->fileSelected().connect(css_history_, &HistoryPanel::showFile);
+    xml_editor_->saveFileSignal().connect(xml_history_, &HistoryPanel::recordSave);
+    css_editor_->saveFileSignal().connect(css_history_, &HistoryPanel::recordSave);
 
     xml_menu_item_ = menu_->addItem("", std::move(xml_files_wrapper));
     css_menu_item_ = menu_->addItem("", std::move(css_files_wrapper));
@@ -85,6 +125,7 @@ void Stylus::setupContent()
     tailwind_menu_item_ = menu_->addItem("", std::move(tailwind_files_wrapper));
     images_menu_item_ = menu_->addItem("", std::move(images_files_wrapper));
     settings_menu_item_ = menu_->addItem("", std::move(settings_wrapper));
+    search_menu_item_ = menu_->addItem("", std::move(search_wrapper));
 
     auto xml_icon = xml_menu_item_->anchor()->insertNew<Wt::WTemplate>(0, Wt::WString::tr("stylus-svg-xml-logo"));
     auto css_icon = css_menu_item_->anchor()->insertNew<Wt::WTemplate>(0, Wt::WString::tr("stylus-svg-css-logo"));
@@ -92,6 +133,7 @@ void Stylus::setupContent()
     auto tailwind_icon = tailwind_menu_item_->anchor()->insertNew<Wt::WTemplate>(0, Wt::WString::tr("stylus-svg-tailwind-logo"));
     auto images_icon = images_menu_item_->anchor()->insertNew<Wt::WTemplate>(0, Wt::WString::tr("stylus-svg-images-logo"));
     auto settings_icon = settings_menu_item_->anchor()->insertNew<Wt::WTemplate>(0, Wt::WString::tr("stylus-svg-settings-logo"));
+    auto search_icon = search_menu_item_->anchor()->insertNew<Wt::WTemplate>(0, Wt::WString::tr("stylus-svg-search"));
 
     std::string nav_btns_styles = "w-[35px] m-[3px] !p-1 cursor-pointer rounded-md flex items-center justify-center";
 
@@ -101,6 +143,37 @@ void Stylus::setupContent()
     tailwind_menu_item_->anchor()->setStyleClass(nav_btns_styles);
     images_menu_item_->anchor()->setStyleClass(nav_btns_styles);
     settings_menu_item_->anchor()->setStyleClass(nav_btns_styles);
+    search_menu_item_->anchor()->setStyleClass(nav_btns_styles);
+}
+
+Stylus::State Stylus::state() const
+{
+    State state;
+    state.visible = !isHidden();
+    state.tab = menu_->currentIndex();
+    state.xml_editor = xml_editor_->state();
+    state.css_editor = css_editor_->state();
+    return state;
+}
+
+void Stylus::restoreState(const State& state)
+{
+    if (state.tab >= 0 && state.tab < menu_->count()) {
+        menu_->select(state.tab);
+    }
+    // Selecting the file also fills its history and usages panels
+    auto restoreEditor = [](FilesList* files, MonacoEditor* editor, const MonacoEditor::State& editor_state) {
+        if (editor_state.shared) {
+            files->selectFile(editor_state.path);
+        } else {
+            editor->restoreState(editor_state);
+        }
+    };
+    restoreEditor(xml_files_, xml_editor_, state.xml_editor);
+    restoreEditor(css_files_, css_editor_, state.css_editor);
+    if (state.visible) {
+        show();
+    }
 }
 
 void Stylus::keyWentDown(Wt::WKeyEvent e)
@@ -124,6 +197,8 @@ void Stylus::keyWentDown(Wt::WKeyEvent e)
             menu_->select(4);
         } else if (e.key() == Wt::Key::Key_6) {
             menu_->select(5);
+        } else if (e.key() == Wt::Key::Key_7) {
+            menu_->select(6);
         }
         
         if (e.modifiers().test(Wt::KeyboardModifier::Shift)) {
@@ -6,14 +6,32 @@
 #include <Wt/WContainerWidget.h>
 #include <Wt/WStackedWidget.h>
 #include "002_Dbo/Session.h"
+#include "005_Components/MonacoEditor.h"
+#include "006_Stylus/FilesList.h"
+#include "006_Stylus/HistoryPanel.h"
+#include "006_Stylus/SearchPanel.h"
+#include "006_Stylus/UsagesPanel.h"
 
 namespace Stylus {
 
 class Stylus : public Wt::WDialog
 {
 public:
+    /**
+     * @brief What a hibernating session keeps of the dialog
+     */
+    struct State {
+        bool visible = false;
+        int tab = 0;
+        MonacoEditor::State xml_editor;
+        MonacoEditor::State css_editor;
+    };
+
     Stylus(Session& session);
 
+    State state() const;
+    void restoreState(const State& state);
+
 private:
     void initializeDialog();
     void setupContent();
@@ -32,6 +50,20 @@ private:
     Wt::WContainerWidget* tailwind_files_wrapper_;
     Wt::WContainerWidget* images_files_wrapper_;
     Wt::WContainerWidget* settings_wrapper_;
+    Wt::WContainerWidget* search_wrapper_;
+
+    FilesList* xml_files_;
+    FilesList* css_files_;
+    FilesList* js_files_;
+    FilesList* tailwind_files_;
+    FilesList* images_files_;
+    SearchPanel* search_panel_;
+    UsagesPanel* xml_usages_;
+    UsagesPanel* css_usages_;
+    MonacoEditor* xml_editor_;
+    MonacoEditor* css_editor_;
+    HistoryPanel* xml_history_;
+    HistoryPanel* css_history_;
 
     Wt::WMenuItem* xml_menu_item_;
     Wt::WMenuItem* css_menu_item_;
@@ -39,6 +71,7 @@ private:
     Wt::WMenuItem* tailwind_menu_item_;
     Wt::WMenuItem* images_menu_item_;
     Wt::WMenuItem* settings_menu_item_;
+    Wt::WMenuItem* search_menu_item_;
 };
 
 }
\ No newline at end of file
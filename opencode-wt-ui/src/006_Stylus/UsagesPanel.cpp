@@ -0,0 +1,101 @@
+#include "006_Stylus/UsagesPanel.h"
+#include "000_Server/Server.h"
+#include <Wt/WLogger.h>
+#include <Wt/WPushButton.h>
+#include <fstream>
+#include <regex>
+#include <set>
+#include <sstream>
+
+namespace Stylus {
+
+UsagesPanel::UsagesPanel()
+{
+    setupContent();
+}
+
+void UsagesPanel::setupContent()
+{
+    setStyleClass("flex flex-col h-full w-[360px] overflow-hidden border-r border-solid");
+
+    term_edit_ = addNew<Wt::WLineEdit>();
+    term_edit_->setPlaceholderText("Find usages");
+    term_edit_->setStyleClass("m-2 px-2 py-1 rounded-md border border-solid text-sm");
+    term_edit_->enterPressed().connect([this]() { findUsages(term_edit_->text().toUTF8()); });
+
+    ids_wrapper_ = addNew<Wt::WContainerWidget>();
+    ids_wrapper_->setStyleClass("flex flex-col max-h-[40%] overflow-y-auto px-1 text-xs");
+
+    status_ = addNew<Wt::WText>();
+    status_->setStyleClass("text-xs px-2 py-1 border-t border-solid");
+
+    results_wrapper_ = addNew<Wt::WContainerWidget>();
+    results_wrapper_->setStyleClass("flex flex-col flex-1 overflow-y-auto p-1 text-sm");
+}
+
+void UsagesPanel::showMessageIds(const std::string& path)
+{
+    ids_wrapper_->clear();
+
+    const std::string root = Server::instance()->fileIndex().snapshot()->root();
+    std::ifstream file(root + "/" + path);
+    if (!file.is_open()) {
+        Wt::log("error") << "UsagesPanel::showMessageIds() - cannot open " << path;
+        return;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string content = buffer.str();
+
+    static const std::regex message_id("<message\\s+id=\"([^\"]+)\"");
+    std::set<std::string> ids;
+    for (auto it = std::sregex_iterator(content.begin(), content.end(), message_id); it != std::sregex_iterator(); ++it) {
+        ids.insert((*it)[1].str());
+    }
+    for (const std::string& id : ids) {
+        auto button = ids_wrapper_->addNew<Wt::WPushButton>(Wt::WString::fromUTF8(id), Wt::TextFormat::Plain);
+        button->setStyleClass("w-full text-left truncate font-mono px-2 rounded-md cursor-pointer hover:bg-surface");
+        button->clicked().connect([this, id]() {
+            term_edit_->setText(Wt::WString::fromUTF8(id));
+            findUsages(id);
+        });
+    }
+}
+
+void UsagesPanel::findUsages(const std::string& term)
+{
+    results_wrapper_->clear();
+    if (term.size() < 3) {
+        status_->setText("Type at least 3 characters");
+        return;
+    }
+
+    std::vector<Workspace::UsageHit> hits = Server::instance()->trigramIndex().find(term, true);
+
+    std::string current_path;
+    Wt::WContainerWidget* group = nullptr;
+    std::size_t files = 0;
+    for (const Workspace::UsageHit& hit : hits) {
+        if (!group || hit.path != current_path) {
+            current_path = hit.path;
+            group = results_wrapper_->addNew<Wt::WContainerWidget>();
+            group->setStyleClass("flex flex-col mb-1");
+            auto title = group->addNew<Wt::WText>(Wt::WString::fromUTF8(hit.path), Wt::TextFormat::Plain);
+            title->setStyleClass("text-xs font-semibold px-1 truncate");
+            ++files;
+        }
+        auto row = group->addNew<Wt::WPushButton>(
+            Wt::WString::fromUTF8(std::to_string(hit.line) + ": " + hit.text), Wt::TextFormat::Plain);
+        row->setStyleClass("w-full text-left truncate font-mono text-xs px-2 rounded-md cursor-pointer hover:bg-surface");
+        std::string path = hit.path;
+        int line = static_cast<int>(hit.line);
+        row->clicked().connect([this, path, line]() { usageSelected_.emit(path, line); });
+    }
+    status_->setText(std::to_string(hits.size()) + " usages in " + std::to_string(files) + " files");
+
+#ifdef DEBUG
+    Wt::log("debug") << "UsagesPanel::findUsages() - " << term << ": " << hits.size() << " hits";
+#endif
+}
+
+}
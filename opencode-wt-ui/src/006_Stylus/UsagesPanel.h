@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Wt/WContainerWidget.h>
+#include <Wt/WLineEdit.h>
+#include <Wt/WSignal.h>
+#include <Wt/WText.h>
+#include <string>
+
+namespace Stylus {
+
+/**
+ * @brief Find usages of a message id or class name, answered by the trigram index
+ *
+ * Besides the free text query, the panel can list the message ids of an
+ * XML bundle so that each one is a click away from its usages.
+ */
+class UsagesPanel : public Wt::WContainerWidget
+{
+public:
+    UsagesPanel();
+
+    /**
+     * @brief Lists the <message id="..."> ids of a workspace relative XML file
+     */
+    void showMessageIds(const std::string& path);
+
+    /**
+     * @brief Shows the whole word usages of term
+     */
+    void findUsages(const std::string& term);
+
+    /**
+     * @brief Emitted with the workspace relative path and 1-based line of a clicked usage
+     */
+    Wt::Signal<std::string, int>& usageSelected() { return usageSelected_; }
+
+private:
+    void setupContent();
+
+    Wt::WLineEdit* term_edit_;
+    Wt::WContainerWidget* ids_wrapper_;
+    Wt::WText* status_;
+    Wt::WContainerWidget* results_wrapper_;
+
+    Wt::Signal<std::string, int> usageSelected_;
+};
+
+}
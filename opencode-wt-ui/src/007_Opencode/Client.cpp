@@ -0,0 +1,568 @@
+#include "007_Opencode/Client.h"
+#include "000_Server/AsyncLog.h"
+#include "000_Server/Metrics.h"
+#include "000_Server/Trace.h"
+
+#include <Wt/WServer.h>
+
+#include <algorithm>
+#include <array>
+
+namespace asio = Wt::AsioWrapper::asio;
+
+namespace Opencode {
+
+namespace {
+
+// A reused connection that fails this soon after a request was written most
+// likely raced opencode closing it while idle, and the request was not seen
+const std::chrono::milliseconds StaleReuseWindow(500);
+
+}
+
+struct Client::Request {
+    std::string method;
+    std::string path;
+    std::string body;
+    std::string wt_session_id;
+    Callback callback;
+    std::unique_ptr<asio::steady_timer> timer;
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::time_point sent_at;
+    bool idempotent = true;
+    bool sent = false;              ///< Fully written on the current connection
+    bool retried = false;
+    bool finished = false;
+};
+
+struct Client::Connection {
+    explicit Connection(asio::io_service& io)
+        : io(io)
+    {
+    }
+
+    asio::io_service& io;
+    std::unique_ptr<asio::ip::tcp::socket> tcp;
+    std::unique_ptr<asio::local::stream_protocol::socket> local;
+
+    bool connected = false;
+    bool closed = false;
+    bool writing = false;
+    bool exclusive = false;         ///< A non-idempotent request is in flight, do not pipeline behind it
+    std::size_t written = 0;        ///< Requests at the front of in_flight that were fully written
+    std::size_t served = 0;         ///< Responses received on this connection
+    std::deque<RequestPtr> in_flight;
+
+    std::string read_buffer;
+    std::array<char, 16 * 1024> chunk;
+    HttpResponseParser parser;
+
+    template <typename Buffers, typename Handler>
+    void asyncWrite(const Buffers& buffers, Handler&& handler)
+    {
+        if (local) {
+            asio::async_write(*local, buffers, std::forward<Handler>(handler));
+        } else {
+            asio::async_write(*tcp, buffers, std::forward<Handler>(handler));
+        }
+    }
+
+    template <typename Handler>
+    void asyncReadSome(Handler&& handler)
+    {
+        if (local) {
+            local->async_read_some(asio::buffer(chunk), std::forward<Handler>(handler));
+        } else {
+            tcp->async_read_some(asio::buffer(chunk), std::forward<Handler>(handler));
+        }
+    }
+
+    void close()
+    {
+        Wt::AsioWrapper::error_code ignored;
+        if (local) {
+            local->close(ignored);
+        }
+        if (tcp) {
+            tcp->close(ignored);
+        }
+    }
+};
+
+Client::Client(Wt::WServer& server, Options options)
+    : server_(server),
+      io_(server.ioService()),
+      options_(std::move(options))
+{
+    // base_url is "http://host[:port]", anything after the authority is ignored
+    std::string authority = options_.base_url;
+    if (authority.compare(0, 7, "http://") == 0) {
+        authority = authority.substr(7);
+    } else if (authority.compare(0, 8, "https://") == 0) {
+        APP_LOG(Error) << "Opencode::Client - https is not supported, connecting in plain http to " << options_.base_url;
+        authority = authority.substr(8);
+    }
+    authority = authority.substr(0, authority.find('/'));
+
+    std::size_t colon = authority.rfind(':');
+    if (colon != std::string::npos && authority.find(']', colon) == std::string::npos) {
+        host_ = authority.substr(0, colon);
+        port_ = authority.substr(colon + 1);
+    } else {
+        host_ = authority;
+        port_ = "80";
+    }
+
+    options_.max_connections = std::max<std::size_t>(1, options_.max_connections);
+    options_.pipeline_depth = std::max<std::size_t>(1, options_.pipeline_depth);
+}
+
+Client::~Client()
+{
+    shutdown();
+}
+
+void Client::get(const std::string& path, const std::string& wt_session_id, Callback callback,
+                 std::chrono::milliseconds timeout)
+{
+    request("GET", path, std::string(), wt_session_id, std::move(callback), timeout);
+}
+
+void Client::post(const std::string& path, const std::string& body, const std::string& wt_session_id,
+                  Callback callback, std::chrono::milliseconds timeout)
+{
+    request("POST", path, body, wt_session_id, std::move(callback), timeout);
+}
+
+void Client::del(const std::string& path, const std::string& wt_session_id, Callback callback,
+                 std::chrono::milliseconds timeout)
+{
+    request("DELETE", path, std::string(), wt_session_id, std::move(callback), timeout);
+}
+
+void Client::request(const std::string& method,
+                     const std::string& path,
+                     const std::string& body,
+                     const std::string& wt_session_id,
+                     Callback callback,
+                     std::chrono::milliseconds timeout)
+{
+    auto request = std::make_shared<Request>();
+    request->method = method;
+    request->path = path;
+    request->body = body;
+    request->wt_session_id = wt_session_id;
+    request->callback = std::move(callback);
+    request->started = std::chrono::steady_clock::now();
+    request->idempotent = method == "GET" || method == "HEAD" || method == "PUT" ||
+                          method == "DELETE" || method == "OPTIONS";
+
+    request->timer = std::make_unique<asio::steady_timer>(io_);
+    request->timer->expires_after(timeout > std::chrono::milliseconds::zero() ? timeout : options_.timeout);
+    request->timer->async_wait([this, request](Wt::AsioWrapper::error_code ec) {
+        if (!ec) {
+            onTimeout(request);
+        }
+    });
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shutdown_) {
+        fail(request, "client is shut down");
+        return;
+    }
+    pending_.push_back(request);
+    dispatchPending();
+}
+
+void Client::shutdown()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shutdown_) {
+        return;
+    }
+    shutdown_ = true;
+
+    auto connections = connections_;
+    for (const auto& connection : connections) {
+        closeConnection(connection, "client is shut down");
+    }
+    while (!pending_.empty()) {
+        auto request = pending_.front();
+        pending_.pop_front();
+        fail(request, "client is shut down");
+    }
+}
+
+void Client::dispatchPending()
+{
+    // Called with mutex_ held
+    while (!pending_.empty()) {
+        if (!assign(pending_.front())) {
+            return;
+        }
+        pending_.pop_front();
+    }
+}
+
+bool Client::assign(const RequestPtr& request)
+{
+    // Pick the least loaded connection that can take one more request.
+    // Non-idempotent requests are never pipelined behind, or ahead of, others.
+    ConnectionPtr best;
+    for (const auto& connection : connections_) {
+        if (connection->closed || connection->exclusive) {
+            continue;
+        }
+        if (connection->in_flight.size() >= options_.pipeline_depth) {
+            continue;
+        }
+        if (!request->idempotent && !connection->in_flight.empty()) {
+            continue;
+        }
+        if (!best || connection->in_flight.size() < best->in_flight.size()) {
+            best = connection;
+        }
+    }
+
+    // Prefer opening a new connection over queueing behind a busy one
+    if ((!best || !best->in_flight.empty()) && connections_.size() < options_.max_connections) {
+        best = openConnection();
+    }
+
+    if (!best) {
+        return false;
+    }
+
+    best->in_flight.push_back(request);
+    if (!request->idempotent) {
+        best->exclusive = true;
+    }
+    if (best->connected) {
+        startWrite(best);
+    }
+    return true;
+}
+
+Client::ConnectionPtr Client::openConnection()
+{
+    // Called with mutex_ held
+    auto connection = std::make_shared<Connection>(io_);
+    connections_.push_back(connection);
+
+    if (!options_.unix_socket.empty()) {
+        connection->local = std::make_unique<asio::local::stream_protocol::socket>(io_);
+        connection->local->async_connect(
+            asio::local::stream_protocol::endpoint(options_.unix_socket),
+            [this, connection](Wt::AsioWrapper::error_code ec) { onConnected(connection, ec); });
+        return connection;
+    }
+
+    connection->tcp = std::make_unique<asio::ip::tcp::socket>(io_);
+    if (!endpoints_.empty()) {
+        asio::async_connect(*connection->tcp, endpoints_,
+            [this, connection](Wt::AsioWrapper::error_code ec, const asio::ip::tcp::endpoint&) {
+                onConnected(connection, ec);
+            });
+        return connection;
+    }
+
+    // Resolve once, the endpoints are reused for every further connection
+    auto resolver = std::make_shared<asio::ip::tcp::resolver>(io_);
+    resolver->async_resolve(host_, port_,
+        [this, connection, resolver](Wt::AsioWrapper::error_code ec,
+                                     asio::ip::tcp::resolver::results_type results) {
+            if (ec) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                connectFailed(connection, "could not resolve " + host_ + ": " + ec.message());
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                endpoints_.assign(results.begin(), results.end());
+            }
+            asio::async_connect(*connection->tcp, results,
+                [this, connection](Wt::AsioWrapper::error_code ec, const asio::ip::tcp::endpoint&) {
+                    onConnected(connection, ec);
+                });
+        });
+    return connection;
+}
+
+void Client::onConnected(const ConnectionPtr& connection, Wt::AsioWrapper::error_code ec)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (connection->closed) {
+        return;
+    }
+    if (ec) {
+        // Endpoints may be stale (opencode restarted on another address)
+        endpoints_.clear();
+        connectFailed(connection, "could not connect to opencode: " + ec.message());
+        return;
+    }
+
+    if (connection->tcp) {
+        connection->tcp->set_option(asio::ip::tcp::no_delay(true), ec);
+    }
+    connection->connected = true;
+    startWrite(connection);
+    startRead(connection);
+}
+
+void Client::startWrite(const ConnectionPtr& connection)
+{
+    // Called with mutex_ held
+    if (connection->closed || connection->writing ||
+        connection->written >= connection->in_flight.size()) {
+        return;
+    }
+
+    auto request = connection->in_flight[connection->written];
+    auto data = std::make_shared<std::string>(serialize(*request));
+    connection->writing = true;
+    connection->asyncWrite(asio::buffer(*data),
+        [this, connection, request, data](Wt::AsioWrapper::error_code ec, std::size_t) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            connection->writing = false;
+            if (connection->closed) {
+                return;
+            }
+            if (ec) {
+                closeConnection(connection, "write failed: " + ec.message());
+                dispatchPending();
+                return;
+            }
+            request->sent = true;
+            request->sent_at = std::chrono::steady_clock::now();
+            ++connection->written;
+            startWrite(connection);
+        });
+}
+
+void Client::startRead(const ConnectionPtr& connection)
+{
+    // Called with mutex_ held
+    connection->asyncReadSome(
+        [this, connection](Wt::AsioWrapper::error_code ec, std::size_t bytes) {
+            onRead(connection, ec, bytes);
+        });
+}
+
+void Client::onRead(const ConnectionPtr& connection, Wt::AsioWrapper::error_code ec, std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (connection->closed) {
+        return;
+    }
+
+    if (ec) {
+        if (ec == asio::error::eof && !connection->in_flight.empty() &&
+            connection->parser.finish() == HttpResponseParser::Result::Complete) {
+            auto request = connection->in_flight.front();
+            connection->in_flight.pop_front();
+            Response response;
+            response.status = connection->parser.status();
+            response.headers = connection->parser.headers();
+            response.body = connection->parser.takeBody();
+            complete(request, std::move(response));
+        }
+        closeConnection(connection, ec == asio::error::eof ? "connection closed by opencode"
+                                                           : "read failed: " + ec.message());
+        dispatchPending();
+        return;
+    }
+
+    connection->read_buffer.append(connection->chunk.data(), bytes);
+
+    // Several pipelined responses may arrive in one read
+    while (!connection->in_flight.empty()) {
+        auto result = connection->parser.feed(connection->read_buffer);
+        if (result == HttpResponseParser::Result::NeedMore) {
+            break;
+        }
+        if (result == HttpResponseParser::Result::Error) {
+            closeConnection(connection, "malformed response from opencode");
+            dispatchPending();
+            return;
+        }
+
+        auto request = connection->in_flight.front();
+        connection->in_flight.pop_front();
+        if (connection->written > 0) {
+            --connection->written;
+        }
+        ++connection->served;
+        connection->exclusive = std::any_of(connection->in_flight.begin(), connection->in_flight.end(),
+                                            [](const RequestPtr& r) { return !r->idempotent; });
+
+        bool keep_alive = connection->parser.keepAlive();
+        Response response;
+        response.status = connection->parser.status();
+        response.headers = connection->parser.headers();
+        response.body = connection->parser.takeBody();
+        connection->parser.reset(!connection->in_flight.empty() &&
+                                 connection->in_flight.front()->method == "HEAD");
+        complete(request, std::move(response));
+
+        if (!keep_alive) {
+            closeConnection(connection, "connection closed by opencode");
+            dispatchPending();
+            return;
+        }
+    }
+
+    dispatchPending();
+    startRead(connection);
+}
+
+void Client::closeConnection(const ConnectionPtr& connection, const std::string& reason)
+{
+    // Called with mutex_ held
+    if (connection->closed) {
+        return;
+    }
+    connection->closed = true;
+    connection->close();
+    connections_.erase(std::remove(connections_.begin(), connections_.end(), connection), connections_.end());
+
+    // Idempotent requests are retried once. A non-idempotent one only when
+    // opencode cannot have acted on it: it was not fully written, or a reused
+    // connection failed right after it was, before any response byte, which
+    // is the race with opencode closing an idle keep-alive connection. A
+    // prompt that fails later may have run and is not sent a second time.
+    bool response_started = connection->parser.started();
+    auto now = std::chrono::steady_clock::now();
+    std::deque<RequestPtr> orphans;
+    orphans.swap(connection->in_flight);
+    for (std::size_t i = 0; i < orphans.size(); ++i) {
+        const auto& request = orphans[i];
+        if (request->finished) {
+            continue;
+        }
+        bool stale_reuse = connection->served > 0 && !(i == 0 && response_started) &&
+                           now - request->sent_at < StaleReuseWindow;
+        bool replayable = request->idempotent || !request->sent || stale_reuse;
+        if (!shutdown_ && !request->retried && replayable) {
+            request->retried = true;
+            request->sent = false;
+            pending_.push_front(request);
+        } else {
+            fail(request, reason);
+        }
+    }
+}
+
+void Client::connectFailed(const ConnectionPtr& connection, const std::string& reason)
+{
+    // Called with mutex_ held. The connection never came up: nothing was
+    // sent on it, so its requests go back to the queue. Unless another
+    // connection is up, opencode is most likely down and the queue is
+    // failed instead of reconnecting in a loop.
+    if (connection->closed) {
+        return;
+    }
+    connection->closed = true;
+    connection->close();
+    connections_.erase(std::remove(connections_.begin(), connections_.end(), connection), connections_.end());
+
+    pending_.insert(pending_.begin(), connection->in_flight.begin(), connection->in_flight.end());
+    connection->in_flight.clear();
+    bool reachable = std::any_of(connections_.begin(), connections_.end(),
+                                 [](const ConnectionPtr& c) { return c->connected; });
+    if (reachable && !shutdown_) {
+        dispatchPending();
+        return;
+    }
+    while (!pending_.empty()) {
+        auto request = pending_.front();
+        pending_.pop_front();
+        fail(request, reason);
+    }
+}
+
+void Client::onTimeout(const RequestPtr& request)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (request->finished) {
+        return;
+    }
+
+    auto pending = std::find(pending_.begin(), pending_.end(), request);
+    if (pending != pending_.end()) {
+        pending_.erase(pending);
+        fail(request, "timeout");
+        return;
+    }
+
+    // The request is in flight: responses are ordered on a connection, so
+    // the only way to skip it is to drop the connection.
+    for (const auto& connection : connections_) {
+        auto it = std::find(connection->in_flight.begin(), connection->in_flight.end(), request);
+        if (it != connection->in_flight.end()) {
+            fail(request, "timeout");
+            closeConnection(connection, "timeout");
+            break;
+        }
+    }
+    dispatchPending();
+}
+
+void Client::complete(const RequestPtr& request, Response response)
+{
+    // Called with mutex_ held. Callbacks never run under the lock: they are
+    // posted to the owning session, or to the IO service otherwise.
+    if (request->finished) {
+        return;
+    }
+    request->finished = true;
+    request->timer->cancel();
+    if (Trace::enabled()) {
+        Trace::record("Client::request", "opencode", request->wt_session_id, request->started,
+                      Trace::Clock::now(), request->method + " " + request->path);
+    }
+
+    auto callback = std::move(request->callback);
+    if (!callback) {
+        return;
+    }
+    auto deliver = [callback, response = std::move(response)]() mutable {
+        Trace::Span span("Client::callback", "opencode");
+        callback(std::move(response));
+    };
+    if (request->wt_session_id.empty()) {
+        asio::post(io_, std::move(deliver));
+    } else {
+        server_.post(request->wt_session_id, Metrics::trackPush(Metrics::PushSource::Client, std::move(deliver)));
+    }
+}
+
+void Client::fail(const RequestPtr& request, const std::string& error)
+{
+    APP_LOG(Debug) << "Opencode::Client - " << request->method << " " << request->path << " failed: " << error;
+
+    Response response;
+    response.error = error;
+    complete(request, std::move(response));
+}
+
+std::string Client::serialize(const Request& request) const
+{
+    std::string out;
+    out.reserve(256 + request.body.size());
+    out += request.method;
+    out += ' ';
+    out += request.path;
+    out += " HTTP/1.1\r\nHost: ";
+    out += options_.unix_socket.empty() ? host_ + ":" + port_ : std::string("localhost");
+    out += "\r\nUser-Agent: opencode-wt-ui\r\nAccept: application/json\r\nConnection: keep-alive\r\n";
+    if (!request.body.empty() || request.method == "POST" || request.method == "PUT" || request.method == "PATCH") {
+        out += "Content-Type: application/json\r\nContent-Length: ";
+        out += std::to_string(request.body.size());
+        out += "\r\n";
+    }
+    out += "\r\n";
+    out += request.body;
+    return out;
+}
+
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Wt/AsioWrapper/asio.hpp>
+#include <Wt/AsioWrapper/steady_timer.hpp>
+#include <Wt/AsioWrapper/system_error.hpp>
+
+#include "007_Opencode/HttpResponseParser.h"
+
+namespace Wt {
+    class WServer;
+}
+
+namespace Opencode {
+
+/**
+ * @brief Response of a request to the opencode REST API
+ */
+struct Response {
+    int status = 0;                                            ///< HTTP status, 0 on transport errors
+    std::string body;                                          ///< Response body
+    std::vector<std::pair<std::string, std::string>> headers;  ///< Response headers
+    std::string error;                                         ///< Transport error or timeout, empty on success
+
+    bool ok() const { return error.empty() && status >= 200 && status < 300; }
+};
+
+/**
+ * @brief Asynchronous keep-alive HTTP client for the opencode REST API
+ *
+ * One instance is shared by all sessions through Server. Requests are
+ * written on a small pool of persistent HTTP/1.1 connections (TCP or a Unix
+ * domain socket to a local opencode process); idempotent requests are
+ * pipelined on a connection up to the configured depth. Every request has
+ * its own timeout. Responses are delivered to the owning Wt session with
+ * WServer::post so no request thread ever waits on the agent.
+ */
+class Client {
+public:
+    using Callback = std::function<void(Response response)>;
+
+    struct Options {
+        std::string base_url = "http://127.0.0.1:4096";  ///< Used for the Host header and TCP transport
+        std::string unix_socket;                          ///< If set, connect to this socket instead of TCP
+        std::size_t max_connections = 4;                  ///< Upper bound of open connections
+        std::size_t pipeline_depth = 4;                   ///< Requests in flight per connection
+        std::chrono::milliseconds timeout = std::chrono::seconds(30);  ///< Default per-request timeout
+    };
+
+    /**
+     * @brief Constructor - creates an idle pool, connections are opened on demand
+     * @param server Server whose IO service and session posting are used
+     * @param options Transport and pool settings
+     */
+    Client(Wt::WServer& server, Options options);
+    ~Client();
+
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    /**
+     * @brief Issues a request
+     * @param method HTTP method, e.g. "GET"
+     * @param path Request target relative to the opencode server, e.g. "/session"
+     * @param body JSON request body, empty for none
+     * @param wt_session_id Session the callback is posted to; empty runs it on the IO thread
+     * @param callback Receives the response or the transport error
+     * @param timeout Per-request timeout, zero uses the default
+     */
+    void request(const std::string& method,
+                 const std::string& path,
+                 const std::string& body,
+                 const std::string& wt_session_id,
+                 Callback callback,
+                 std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
+    void get(const std::string& path, const std::string& wt_session_id, Callback callback,
+             std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+    void post(const std::string& path, const std::string& body, const std::string& wt_session_id,
+              Callback callback, std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+    void del(const std::string& path, const std::string& wt_session_id, Callback callback,
+             std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
+    /**
+     * @brief Closes all connections and fails outstanding requests
+     */
+    void shutdown();
+
+    /**
+     * @brief Base URL of the opencode server
+     */
+    const std::string& baseUrl() const { return options_.base_url; }
+
+private:
+    struct Request;
+    struct Connection;
+    using RequestPtr = std::shared_ptr<Request>;
+    using ConnectionPtr = std::shared_ptr<Connection>;
+
+    void dispatchPending();
+    bool assign(const RequestPtr& request);
+    ConnectionPtr openConnection();
+    void onConnected(const ConnectionPtr& connection, Wt::AsioWrapper::error_code ec);
+    void startWrite(const ConnectionPtr& connection);
+    void startRead(const ConnectionPtr& connection);
+    void onRead(const ConnectionPtr& connection, Wt::AsioWrapper::error_code ec, std::size_t bytes);
+    void closeConnection(const ConnectionPtr& connection, const std::string& reason);
+    void connectFailed(const ConnectionPtr& connection, const std::string& reason);
+    void onTimeout(const RequestPtr& request);
+    void complete(const RequestPtr& request, Response response);
+    void fail(const RequestPtr& request, const std::string& error);
+
+    std::string serialize(const Request& request) const;
+
+    Wt::WServer& server_;
+    Wt::AsioWrapper::asio::io_service& io_;
+    Options options_;
+    std::string host_;
+    std::string port_;
+
+    std::mutex mutex_;
+    std::vector<ConnectionPtr> connections_;
+    std::deque<RequestPtr> pending_;
+    std::vector<Wt::AsioWrapper::asio::ip::tcp::endpoint> endpoints_;
+    bool shutdown_ = false;
+};
+
+}
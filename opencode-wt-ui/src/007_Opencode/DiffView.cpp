@@ -0,0 +1,119 @@
+#include "007_Opencode/DiffView.h"
+
+#include <Wt/WLength.h>
+#include <Wt/WLogger.h>
+
+#include <algorithm>
+
+#include "005_Components/MonacoDiffEditor.h"
+
+namespace Opencode {
+
+namespace {
+
+const int line_height_px = 19;
+const std::size_t max_visible_lines = 30;
+
+}
+
+DiffView::DiffView()
+    : Wt::WContainerWidget()
+{
+    setStyleClass("flex flex-col gap-1 my-1 border rounded border-gray-300 dark:border-gray-700");
+    title_ = addNew<Wt::WText>();
+    title_->setTextFormat(Wt::TextFormat::Plain);
+    title_->setStyleClass("px-2 py-1 font-mono text-xs bg-gray-50 dark:bg-gray-900");
+}
+
+void DiffView::setDiff(const std::string& file_path, std::string old_text, std::string new_text)
+{
+    for (auto& hunk : hunks_) {
+        removeWidget(hunk.header);
+        removeWidget(hunk.body);
+    }
+    hunks_.clear();
+
+    // The line views point into the texts kept by this widget
+    old_text_ = std::move(old_text);
+    new_text_ = std::move(new_text);
+    old_lines_ = splitLines(old_text_);
+    new_lines_ = splitLines(new_text_);
+    language_ = languageOf(file_path);
+    diff_ = diffLines(old_text_, new_text_);
+
+    #ifdef DEBUG
+    Wt::log("debug") << "DiffView::setDiff() - " << file_path << ": " << diff_.hunks.size() << " hunks, +"
+                     << diff_.added << " -" << diff_.removed;
+    #endif
+
+    title_->setText(Wt::WString::fromUTF8(file_path + "  +" + std::to_string(diff_.added) +
+                                          " -" + std::to_string(diff_.removed)));
+
+    hunks_.resize(diff_.hunks.size());
+    for (std::size_t i = 0; i < diff_.hunks.size(); ++i) {
+        HunkView& view = hunks_[i];
+        view.header = addNew<Wt::WPushButton>(hunkHeader(diff_.hunks[i]));
+        view.header->setStyleClass("text-left px-2 font-mono text-xs text-blue-600 dark:text-blue-400 hover:bg-gray-100 dark:hover:bg-gray-800");
+        view.header->clicked().connect([this, i]() { toggleHunk(i); });
+        view.body = addNew<Wt::WContainerWidget>();
+        view.body->hide();
+        if (i < InitiallyExpanded) {
+            toggleHunk(i);
+        }
+    }
+}
+
+void DiffView::toggleHunk(std::size_t index)
+{
+    HunkView& view = hunks_[index];
+    if (view.editor) {
+        view.body->setHidden(!view.body->isHidden());
+        return;
+    }
+
+    const DiffHunk& hunk = diff_.hunks[index];
+    std::size_t lines = std::min<std::size_t>(std::max(hunk.old_count, hunk.new_count), max_visible_lines);
+    view.editor = view.body->addNew<MonacoDiffEditor>(language_);
+    view.editor->resize(Wt::WLength::Auto, Wt::WLength(static_cast<double>(lines * line_height_px + 8), Wt::LengthUnit::Pixel));
+    view.editor->setTexts(excerpt(old_lines_, hunk.old_start, hunk.old_count),
+                          excerpt(new_lines_, hunk.new_start, hunk.new_count),
+                          static_cast<int>(hunk.old_start) + 1,
+                          static_cast<int>(hunk.new_start) + 1);
+    view.body->show();
+}
+
+std::string DiffView::excerpt(const std::vector<std::string_view>& lines, std::size_t start, std::size_t count) const
+{
+    std::string text;
+    for (std::size_t i = start; i < start + count && i < lines.size(); ++i) {
+        text.append(lines[i].data(), lines[i].size());
+    }
+    return text;
+}
+
+std::string DiffView::languageOf(const std::string& file_path)
+{
+    std::string extension = file_path.substr(file_path.find_last_of('.') + 1);
+    if (extension == "cpp" || extension == "cc" || extension == "h" || extension == "hpp") {
+        return "cpp";
+    } else if (extension == "js" || extension == "mjs") {
+        return "javascript";
+    } else if (extension == "ts" || extension == "tsx") {
+        return "typescript";
+    } else if (extension == "py") {
+        return "python";
+    } else if (extension == "css") {
+        return "css";
+    } else if (extension == "xml") {
+        return "xml";
+    } else if (extension == "html") {
+        return "html";
+    } else if (extension == "json") {
+        return "json";
+    } else if (extension == "md") {
+        return "markdown";
+    }
+    return "plaintext";
+}
+
+}
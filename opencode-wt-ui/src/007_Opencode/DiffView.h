@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <Wt/WContainerWidget.h>
+#include <Wt/WPushButton.h>
+#include <Wt/WText.h>
+
+#include "007_Opencode/LineDiff.h"
+
+class MonacoDiffEditor;
+
+namespace Opencode {
+
+/**
+ * @brief Hunk by hunk view of a file edit
+ *
+ * The diff is computed on the server; only the lines of expanded hunks
+ * are sent to the browser, each hunk in its own read-only Monaco diff
+ * editor created when the hunk is first expanded.
+ */
+class DiffView : public Wt::WContainerWidget
+{
+public:
+    DiffView();
+
+    /**
+     * @brief Shows the edit of one file
+     * @param file_path Path of the edited file, used for the title and language
+     * @param old_text Text before the edit
+     * @param new_text Text after the edit
+     */
+    void setDiff(const std::string& file_path, std::string old_text, std::string new_text);
+
+    const FileDiff& diff() const { return diff_; }
+
+    /// Hunks expanded when a diff is set
+    static constexpr std::size_t InitiallyExpanded = 3;
+
+private:
+    struct HunkView {
+        Wt::WPushButton* header = nullptr;
+        Wt::WContainerWidget* body = nullptr;
+        MonacoDiffEditor* editor = nullptr;
+    };
+
+    void toggleHunk(std::size_t index);
+    std::string excerpt(const std::vector<std::string_view>& lines, std::size_t start, std::size_t count) const;
+    static std::string languageOf(const std::string& file_path);
+
+    std::string old_text_;
+    std::string new_text_;
+    std::vector<std::string_view> old_lines_;
+    std::vector<std::string_view> new_lines_;
+    std::string language_;
+    FileDiff diff_;
+
+    Wt::WText* title_ = nullptr;
+    std::vector<HunkView> hunks_;
+};
+
+}
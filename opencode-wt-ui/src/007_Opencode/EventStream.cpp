@@ -0,0 +1,352 @@
+#include "007_Opencode/EventStream.h"
+#include "000_Server/AsyncLog.h"
+#include "000_Server/Metrics.h"
+
+#include <Wt/WIOService.h>
+#include <Wt/WServer.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace Opencode {
+
+const std::string EventStream::AllSessions = "*";
+
+void SseParser::feed(const std::string& chunk, const Callback& callback)
+{
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < chunk.size(); ++i) {
+        if (chunk[i] != '\n') {
+            continue;
+        }
+        buffer_.append(chunk, start, i - start);
+        if (!buffer_.empty() && buffer_.back() == '\r') {
+            buffer_.pop_back();
+        }
+        processLine(buffer_, callback);
+        buffer_.clear();
+        start = i + 1;
+    }
+    buffer_.append(chunk, start, std::string::npos);
+}
+
+void SseParser::reset()
+{
+    buffer_.clear();
+    event_.clear();
+    data_.clear();
+    has_data_ = false;
+}
+
+void SseParser::processLine(const std::string& line, const Callback& callback)
+{
+    // An empty line terminates the event being assembled
+    if (line.empty()) {
+        if (has_data_) {
+            callback(last_event_id_, event_.empty() ? "message" : event_, data_);
+        }
+        event_.clear();
+        data_.clear();
+        has_data_ = false;
+        return;
+    }
+
+    // Lines starting with a colon are comments (used as keep-alive)
+    if (line[0] == ':') {
+        return;
+    }
+
+    std::string field;
+    std::string value;
+    std::size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+        field = line;
+    } else {
+        field = line.substr(0, colon);
+        std::size_t value_start = colon + 1;
+        if (value_start < line.size() && line[value_start] == ' ') {
+            ++value_start;
+        }
+        value = line.substr(value_start);
+    }
+
+    if (field == "data") {
+        if (has_data_) {
+            data_ += '\n';
+        }
+        data_ += value;
+        has_data_ = true;
+    } else if (field == "event") {
+        event_ = value;
+    } else if (field == "id") {
+        last_event_id_ = value;
+    }
+}
+
+EventStream::EventStream(Wt::WServer& server, const std::string& base_url)
+    : server_(server),
+      base_url_(base_url)
+{
+    client_ = std::make_unique<Wt::Http::Client>(server_.ioService());
+    // The stream stays open for the lifetime of the server, events are
+    // consumed through bodyDataReceived() so the body is never accumulated.
+    client_->setTimeout(std::chrono::seconds(90));
+    client_->setMaximumResponseSize(0);
+    client_->setFollowRedirect(true);
+
+    client_->headersReceived().connect([this](const Wt::Http::Message& response) {
+        onHeadersReceived(response);
+    });
+    client_->bodyDataReceived().connect([this](const std::string& chunk) {
+        onBodyData(chunk);
+    });
+    client_->done().connect([this](Wt::AsioWrapper::error_code ec, const Wt::Http::Message& response) {
+        onDone(ec, response);
+    });
+}
+
+EventStream::~EventStream()
+{
+    stop();
+}
+
+void EventStream::start()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            return;
+        }
+        running_ = true;
+        reconnect_attempts_ = 0;
+    }
+    APP_LOG(Info) << "Opencode::EventStream - subscribing to " << base_url_ << "/event";
+    connect();
+}
+
+void EventStream::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        connected_ = false;
+    }
+    client_->abort();
+}
+
+bool EventStream::connected() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return connected_;
+}
+
+void EventStream::connect()
+{
+    std::vector<Wt::Http::Message::Header> headers;
+    headers.emplace_back("Accept", "text/event-stream");
+    headers.emplace_back("Cache-Control", "no-cache");
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        if (!parser_.lastEventId().empty()) {
+            headers.emplace_back("Last-Event-ID", parser_.lastEventId());
+        }
+    }
+
+    parser_.reset();
+    if (!client_->get(base_url_ + "/event", headers)) {
+        APP_LOG(Error) << "Opencode::EventStream - invalid event stream URL: " << base_url_ << "/event";
+        scheduleReconnect();
+    }
+}
+
+void EventStream::scheduleReconnect()
+{
+    int attempt;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        connected_ = false;
+        attempt = reconnect_attempts_++;
+    }
+
+    // Exponential backoff: 250ms, 500ms, 1s ... capped at 10s
+    auto delay = std::chrono::milliseconds(std::min(250 << std::min(attempt, 6), 10000));
+    APP_LOG(Info) << "Opencode::EventStream - reconnecting in " << delay.count() << "ms";
+    server_.ioService().schedule(delay, [this]() { connect(); });
+}
+
+void EventStream::onHeadersReceived(const Wt::Http::Message& response)
+{
+    if (response.status() != 200) {
+        APP_LOG(Error) << "Opencode::EventStream - unexpected status " << response.status();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connected_ = true;
+        reconnect_attempts_ = 0;
+    }
+    APP_LOG(Info) << "Opencode::EventStream - connected to " << base_url_;
+}
+
+void EventStream::onBodyData(const std::string& chunk)
+{
+    parser_.feed(chunk, [this](std::string id, std::string type, std::string data) {
+        Event event;
+        event.id = std::move(id);
+        event.type = std::move(type);
+        dispatch(std::move(event), data);
+    });
+}
+
+void EventStream::onDone(Wt::AsioWrapper::error_code ec, const Wt::Http::Message& response)
+{
+    if (ec) {
+        APP_LOG(Warning) << "Opencode::EventStream - stream closed: " << ec.message();
+    } else {
+        APP_LOG(Warning) << "Opencode::EventStream - stream ended with status " << response.status();
+    }
+
+    markResync();
+    scheduleReconnect();
+}
+
+void EventStream::dispatch(Event event, const std::string& data)
+{
+    // Parsed once here, subscribers share the compact payload instead of
+    // copying the raw JSON
+    auto payload = std::make_shared<EventPayload>();
+    if (!parseEvent(data, *payload)) {
+        APP_LOG(Error) << "Opencode::EventStream - malformed event: " << data.substr(0, 200);
+        return;
+    }
+
+    // opencode sends the event type inside the JSON payload, the SSE event
+    // name is the generic "message"
+    if (event.type == "message" || event.type.empty()) {
+        event.type = payload->type;
+    }
+    event.session_id = payload->session_id;
+    event.payload = std::move(payload);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [id, subscriber] : subscribers_) {
+        if (event.type.compare(0, subscriber.type_prefix.size(), subscriber.type_prefix) != 0) {
+            continue;
+        }
+        // Global events (no session) go to everyone, session events only to
+        // the subscribers of that session or of all sessions
+        if (event.session_id.empty() ||
+            subscriber.filter == AllSessions ||
+            subscriber.filter == event.session_id) {
+            enqueue(id, subscriber, &event);
+        }
+    }
+}
+
+void EventStream::markResync()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [id, subscriber] : subscribers_) {
+        subscriber.resync = true;
+        enqueue(id, subscriber, nullptr);
+    }
+}
+
+void EventStream::enqueue(int subscription_id, Subscriber& subscriber, const Event* event)
+{
+    // Called with mutex_ held
+    if (event) {
+        if (subscriber.queue.size() >= queue_capacity_) {
+            subscriber.queue.pop_front();
+            ++subscriber.dropped;
+            subscriber.resync = true;
+        }
+        subscriber.queue.push_back(*event);
+    }
+
+    if (subscriber.post_pending) {
+        return;
+    }
+    subscriber.post_pending = true;
+    auto drain_subscriber = Metrics::trackPush(Metrics::PushSource::EventStream, [this, subscription_id]() {
+        drain(subscription_id);
+    });
+    if (subscriber.batch_window > std::chrono::milliseconds::zero()) {
+        server_.schedule(subscriber.batch_window, subscriber.wt_session_id, drain_subscriber);
+    } else {
+        server_.post(subscriber.wt_session_id, drain_subscriber);
+    }
+}
+
+void EventStream::drain(int subscription_id)
+{
+    EventBatch batch;
+    Handler handler;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = subscribers_.find(subscription_id);
+        if (it == subscribers_.end()) {
+            return;
+        }
+        Subscriber& subscriber = it->second;
+        batch.events.assign(std::make_move_iterator(subscriber.queue.begin()),
+                            std::make_move_iterator(subscriber.queue.end()));
+        batch.dropped = subscriber.dropped;
+        batch.resync = subscriber.resync;
+        subscriber.queue.clear();
+        subscriber.dropped = 0;
+        subscriber.resync = false;
+        subscriber.post_pending = false;
+        handler = subscriber.handler;
+    }
+
+    if (handler) {
+        handler(std::move(batch));
+    }
+}
+
+int EventStream::subscribe(const std::string& wt_session_id,
+                           const std::string& opencode_session_id,
+                           Handler handler,
+                           std::chrono::milliseconds batch_window,
+                           const std::string& type_prefix)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    int id = next_subscription_id_++;
+    Subscriber& subscriber = subscribers_[id];
+    subscriber.wt_session_id = wt_session_id;
+    subscriber.filter = opencode_session_id;
+    subscriber.handler = std::move(handler);
+    subscriber.batch_window = batch_window;
+    subscriber.type_prefix = type_prefix;
+    return id;
+}
+
+void EventStream::setFilter(int subscription_id, const std::string& opencode_session_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = subscribers_.find(subscription_id);
+    if (it != subscribers_.end()) {
+        it->second.filter = opencode_session_id;
+        it->second.queue.clear();
+    }
+}
+
+void EventStream::unsubscribe(int subscription_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    subscribers_.erase(subscription_id);
+}
+
+}
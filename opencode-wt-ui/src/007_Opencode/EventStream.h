@@ -0,0 +1,200 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <Wt/AsioWrapper/system_error.hpp>
+#include <Wt/Http/Client.h>
+#include <Wt/Http/Message.h>
+
+#include "007_Opencode/Payloads.h"
+
+namespace Wt {
+    class WServer;
+}
+
+namespace Opencode {
+
+/**
+ * @brief A single event received from the opencode `/event` stream
+ */
+struct Event {
+    std::string id;          ///< SSE event id, used as resume point on reconnect
+    std::string type;        ///< Event type, e.g. "message.part.updated"
+    std::string session_id;  ///< Opencode session the event belongs to, empty for global events
+    std::shared_ptr<const EventPayload> payload;  ///< Parsed payload, shared by all subscribers
+};
+
+/**
+ * @brief Batch of events handed to a subscriber on its own session thread
+ */
+struct EventBatch {
+    std::vector<Event> events;
+    std::size_t dropped = 0;  ///< Events discarded because the subscriber queue was full
+    bool resync = false;      ///< Stream reconnected or events were dropped, subscriber state may be stale
+};
+
+/**
+ * @brief Incremental parser for the `text/event-stream` wire format
+ *
+ * Chunks are fed as they arrive from the network; complete events are
+ * reported through the callback, partial lines are kept until the next chunk.
+ */
+class SseParser {
+public:
+    using Callback = std::function<void(std::string id, std::string event, std::string data)>;
+
+    /**
+     * @brief Feeds a chunk of the response body into the parser
+     * @param chunk Raw bytes received from the stream
+     * @param callback Invoked for every complete event in the chunk
+     */
+    void feed(const std::string& chunk, const Callback& callback);
+
+    /**
+     * @brief Discards any partially received event
+     */
+    void reset();
+
+    /**
+     * @brief Id of the last event that carried an `id:` field
+     */
+    const std::string& lastEventId() const { return last_event_id_; }
+
+private:
+    void processLine(const std::string& line, const Callback& callback);
+
+    std::string buffer_;         ///< Bytes of the current, not yet terminated line
+    std::string event_;          ///< `event:` field of the event being assembled
+    std::string data_;           ///< `data:` lines of the event being assembled
+    std::string last_event_id_;  ///< Last `id:` field seen on the stream
+    bool has_data_ = false;
+};
+
+/**
+ * @brief Shared upstream subscription to the opencode server event stream
+ *
+ * One instance per opencode server is owned by Server. It keeps a single
+ * HTTP connection to `/event`, demultiplexes the events by opencode session
+ * ID and fans them out to the subscribed UI sessions through WServer::post.
+ * Every subscriber has its own bounded queue so a slow browser tab can not
+ * hold back the others, and the connection is re-established with the last
+ * received event id when it drops.
+ */
+class EventStream {
+public:
+    using Handler = std::function<void(EventBatch batch)>;
+
+    /// Subscription filter that receives the events of every opencode session
+    static const std::string AllSessions;
+
+    /**
+     * @brief Constructor - prepares the stream for the given opencode server
+     * @param server Server whose IO service and session posting are used
+     * @param base_url Base URL of the opencode server, e.g. "http://127.0.0.1:4096"
+     */
+    EventStream(Wt::WServer& server, const std::string& base_url);
+    ~EventStream();
+
+    EventStream(const EventStream&) = delete;
+    EventStream& operator=(const EventStream&) = delete;
+
+    /**
+     * @brief Opens the upstream connection (called once the server is started)
+     */
+    void start();
+
+    /**
+     * @brief Closes the upstream connection and stops reconnecting
+     */
+    void stop();
+
+    /**
+     * @brief Registers a UI session as interested in opencode events
+     * @param wt_session_id Wt session the handler must run in
+     * @param opencode_session_id Opencode session to receive events for, or AllSessions
+     * @param handler Called inside the Wt session with queued events
+     * @param batch_window Delay before a push so that events arriving meanwhile
+     *        (e.g. streamed tokens) are delivered in the same batch; zero pushes at once
+     * @param type_prefix Only events whose type starts with it are delivered,
+     *        e.g. "session."; empty for every type
+     * @return Subscription id used to change the filter or unsubscribe
+     */
+    int subscribe(const std::string& wt_session_id,
+                  const std::string& opencode_session_id,
+                  Handler handler,
+                  std::chrono::milliseconds batch_window = std::chrono::milliseconds::zero(),
+                  const std::string& type_prefix = std::string());
+
+    /**
+     * @brief Changes the opencode session a subscription listens to
+     */
+    void setFilter(int subscription_id, const std::string& opencode_session_id);
+
+    /**
+     * @brief Removes a subscription, pending events are discarded
+     */
+    void unsubscribe(int subscription_id);
+
+    /**
+     * @brief Base URL of the opencode server this stream is connected to
+     */
+    const std::string& baseUrl() const { return base_url_; }
+
+    /**
+     * @brief Whether the upstream connection is currently established
+     */
+    bool connected() const;
+
+    /**
+     * @brief Maximum number of events queued per subscriber before dropping the oldest
+     */
+    void setQueueCapacity(std::size_t capacity) { queue_capacity_ = capacity; }
+
+private:
+    struct Subscriber {
+        std::string wt_session_id;
+        std::string filter;
+        std::string type_prefix;
+        Handler handler;
+        std::chrono::milliseconds batch_window{0};
+        std::deque<Event> queue;
+        std::size_t dropped = 0;
+        bool resync = false;
+        bool post_pending = false;
+    };
+
+    void connect();
+    void scheduleReconnect();
+    void onHeadersReceived(const Wt::Http::Message& response);
+    void onBodyData(const std::string& chunk);
+    void onDone(Wt::AsioWrapper::error_code ec, const Wt::Http::Message& response);
+
+    void dispatch(Event event, const std::string& data);
+    void markResync();
+    void enqueue(int subscription_id, Subscriber& subscriber, const Event* event);
+    void drain(int subscription_id);
+
+    Wt::WServer& server_;
+    std::string base_url_;
+    std::unique_ptr<Wt::Http::Client> client_;
+    SseParser parser_;
+
+    mutable std::mutex mutex_;
+    std::map<int, Subscriber> subscribers_;
+    int next_subscription_id_ = 1;
+    std::size_t queue_capacity_ = 512;
+
+    bool running_ = false;
+    bool connected_ = false;
+    int reconnect_attempts_ = 0;
+};
+
+}
@@ -0,0 +1,234 @@
+#include "007_Opencode/HttpResponseParser.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace Opencode {
+
+namespace {
+
+bool iequals(const std::string& a, const std::string& b)
+{
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) ==
+                      std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+std::string trim(const std::string& value)
+{
+    std::size_t begin = value.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return {};
+    }
+    std::size_t end = value.find_last_not_of(" \t");
+    return value.substr(begin, end - begin + 1);
+}
+
+}
+
+void HttpResponseParser::reset(bool head_request)
+{
+    state_ = State::StatusLine;
+    status_ = 0;
+    body_.clear();
+    headers_.clear();
+    remaining_ = 0;
+    keep_alive_ = true;
+    head_request_ = head_request;
+    received_ = false;
+}
+
+std::string HttpResponseParser::header(const std::string& name) const
+{
+    for (const auto& [key, value] : headers_) {
+        if (iequals(key, name)) {
+            return value;
+        }
+    }
+    return {};
+}
+
+bool HttpResponseParser::readLine(std::string& data, std::string& line)
+{
+    std::size_t end = data.find("\r\n");
+    if (end == std::string::npos) {
+        return false;
+    }
+    line.assign(data, 0, end);
+    data.erase(0, end + 2);
+    return true;
+}
+
+bool HttpResponseParser::headersComplete()
+{
+    std::string connection = header("Connection");
+    std::transform(connection.begin(), connection.end(), connection.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    keep_alive_ = connection.find("close") == std::string::npos;
+
+    // 101, 204 and 304 responses and replies to HEAD never carry a body
+    if (head_request_ || status_ == 101 || status_ == 204 || status_ == 304) {
+        state_ = State::Done;
+        return true;
+    }
+
+    std::string encoding = header("Transfer-Encoding");
+    std::transform(encoding.begin(), encoding.end(), encoding.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (encoding.find("chunked") != std::string::npos) {
+        state_ = State::ChunkSize;
+        return true;
+    }
+
+    std::string length = header("Content-Length");
+    if (!length.empty()) {
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(length.c_str(), &end, 10);
+        if (end == length.c_str() || *end != '\0') {
+            return false;
+        }
+        remaining_ = static_cast<std::size_t>(value);
+        body_.reserve(remaining_);
+        state_ = remaining_ == 0 ? State::Done : State::Body;
+        return true;
+    }
+
+    // No framing information: the body ends when the server closes
+    keep_alive_ = false;
+    state_ = State::UntilClose;
+    return true;
+}
+
+HttpResponseParser::Result HttpResponseParser::feed(std::string& data)
+{
+    if (!data.empty()) {
+        received_ = true;
+    }
+
+    std::string line;
+    for (;;) {
+        switch (state_) {
+        case State::StatusLine: {
+            if (!readLine(data, line)) {
+                return Result::NeedMore;
+            }
+            // "HTTP/1.1 200 OK"
+            if (line.compare(0, 5, "HTTP/") != 0) {
+                return Result::Error;
+            }
+            std::size_t space = line.find(' ');
+            if (space == std::string::npos) {
+                return Result::Error;
+            }
+            status_ = std::atoi(line.c_str() + space + 1);
+            if (status_ < 100 || status_ > 999) {
+                return Result::Error;
+            }
+            if (line.compare(0, 8, "HTTP/1.0") == 0) {
+                keep_alive_ = false;
+            }
+            state_ = State::Headers;
+            break;
+        }
+        case State::Headers:
+            if (!readLine(data, line)) {
+                return Result::NeedMore;
+            }
+            if (line.empty()) {
+                // 100 Continue, 103 Early Hints: interim, the final response follows
+                if (status_ >= 100 && status_ < 200 && status_ != 101) {
+                    status_ = 0;
+                    headers_.clear();
+                    state_ = State::StatusLine;
+                    break;
+                }
+                bool http10 = !keep_alive_;
+                if (!headersComplete()) {
+                    return Result::Error;
+                }
+                if (http10) {
+                    keep_alive_ = false;
+                }
+                break;
+            } else {
+                std::size_t colon = line.find(':');
+                if (colon == std::string::npos) {
+                    return Result::Error;
+                }
+                headers_.emplace_back(line.substr(0, colon), trim(line.substr(colon + 1)));
+            }
+            break;
+        case State::Body: {
+            std::size_t take = std::min(remaining_, data.size());
+            body_.append(data, 0, take);
+            data.erase(0, take);
+            remaining_ -= take;
+            if (remaining_ > 0) {
+                return Result::NeedMore;
+            }
+            state_ = State::Done;
+            break;
+        }
+        case State::ChunkSize: {
+            if (!readLine(data, line)) {
+                return Result::NeedMore;
+            }
+            char* end = nullptr;
+            remaining_ = static_cast<std::size_t>(std::strtoull(line.c_str(), &end, 16));
+            if (end == line.c_str()) {
+                return Result::Error;
+            }
+            state_ = remaining_ == 0 ? State::Trailers : State::ChunkData;
+            break;
+        }
+        case State::ChunkData: {
+            std::size_t take = std::min(remaining_, data.size());
+            body_.append(data, 0, take);
+            data.erase(0, take);
+            remaining_ -= take;
+            if (remaining_ > 0) {
+                return Result::NeedMore;
+            }
+            state_ = State::ChunkDataEnd;
+            break;
+        }
+        case State::ChunkDataEnd:
+            if (!readLine(data, line)) {
+                return Result::NeedMore;
+            }
+            if (!line.empty()) {
+                return Result::Error;
+            }
+            state_ = State::ChunkSize;
+            break;
+        case State::Trailers:
+            if (!readLine(data, line)) {
+                return Result::NeedMore;
+            }
+            if (line.empty()) {
+                state_ = State::Done;
+            }
+            break;
+        case State::UntilClose:
+            body_ += data;
+            data.clear();
+            return Result::NeedMore;
+        case State::Done:
+            return Result::Complete;
+        }
+    }
+}
+
+HttpResponseParser::Result HttpResponseParser::finish()
+{
+    if (state_ == State::UntilClose) {
+        state_ = State::Done;
+        return Result::Complete;
+    }
+    return state_ == State::Done ? Result::Complete : Result::Error;
+}
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Opencode {
+
+/**
+ * @brief Incremental HTTP/1.1 response parser
+ *
+ * Bytes are fed as they are read from a keep-alive connection. The parser
+ * handles Content-Length and chunked bodies and stops exactly at the end of
+ * one response, so pipelined responses that follow in the same buffer are
+ * left for the next parse.
+ */
+class HttpResponseParser {
+public:
+    enum class Result {
+        NeedMore,  ///< Response not complete yet, feed more bytes
+        Complete,  ///< A full response has been parsed
+        Error      ///< Malformed response, the connection must be dropped
+    };
+
+    /**
+     * @brief Prepares the parser for the next response
+     * @param head_request True if the request was HEAD (response carries no body)
+     */
+    void reset(bool head_request = false);
+
+    /**
+     * @brief Consumes bytes from the front of the buffer
+     * @param data Receive buffer, consumed bytes are erased from it
+     * @return Parse state after consuming as much as possible
+     */
+    Result feed(std::string& data);
+
+    /**
+     * @brief Signals end of stream, completes responses delimited by connection close
+     */
+    Result finish();
+
+    int status() const { return status_; }
+    const std::string& body() const { return body_; }
+    std::string takeBody() { return std::move(body_); }
+    const std::vector<std::pair<std::string, std::string>>& headers() const { return headers_; }
+
+    /**
+     * @brief Case-insensitive header lookup
+     * @return Header value, or an empty string if the header is absent
+     */
+    std::string header(const std::string& name) const;
+
+    /**
+     * @brief Whether the server keeps the connection open after this response
+     */
+    bool keepAlive() const { return keep_alive_; }
+
+    /**
+     * @brief Whether any byte of the current response has been received
+     */
+    bool started() const { return state_ != State::StatusLine || received_; }
+
+private:
+    enum class State {
+        StatusLine,
+        Headers,
+        Body,
+        ChunkSize,
+        ChunkData,
+        ChunkDataEnd,
+        Trailers,
+        UntilClose,
+        Done
+    };
+
+    bool readLine(std::string& data, std::string& line);
+    bool headersComplete();
+
+    State state_ = State::StatusLine;
+    int status_ = 0;
+    std::string body_;
+    std::vector<std::pair<std::string, std::string>> headers_;
+    std::size_t remaining_ = 0;
+    bool keep_alive_ = true;
+    bool head_request_ = false;
+    bool received_ = false;
+};
+
+}
@@ -0,0 +1,329 @@
+#include "007_Opencode/LineDiff.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Opencode {
+
+namespace {
+
+struct LineKey {
+    std::string_view text;
+    std::uint64_t hash;
+};
+
+struct LineKeyHash {
+    std::size_t operator()(const LineKey& key) const { return static_cast<std::size_t>(key.hash); }
+};
+
+struct LineKeyEqual {
+    bool operator()(const LineKey& a, const LineKey& b) const { return a.hash == b.hash && a.text == b.text; }
+};
+
+/**
+ * Myers' O((N+M)D) diff in linear space: find the middle snake of the edit
+ * graph, recurse on both halves. Common prefixes and suffixes are stripped
+ * at every level, which settles most of a typical agent edit up front.
+ */
+class Myers {
+public:
+    Myers(const std::vector<std::uint32_t>& a, const std::vector<std::uint32_t>& b, std::size_t max_cost)
+        : deleted(a.size(), false), inserted(b.size(), false),
+          a_(a), b_(b), max_cost_(max_cost)
+    {
+        std::size_t size = a.size() + b.size() + 5;
+        forward_.resize(size);
+        backward_.resize(size);
+    }
+
+    void compare(int a_lo, int a_hi, int b_lo, int b_hi)
+    {
+        while (a_lo < a_hi && b_lo < b_hi && a_[a_lo] == b_[b_lo]) {
+            ++a_lo;
+            ++b_lo;
+        }
+        while (a_lo < a_hi && b_lo < b_hi && a_[a_hi - 1] == b_[b_hi - 1]) {
+            --a_hi;
+            --b_hi;
+        }
+
+        if (a_lo == a_hi || b_lo == b_hi) {
+            std::fill(deleted.begin() + a_lo, deleted.begin() + a_hi, true);
+            std::fill(inserted.begin() + b_lo, inserted.begin() + b_hi, true);
+            return;
+        }
+
+        Snake snake;
+        if (!middleSnake(a_lo, a_hi, b_lo, b_hi, snake)) {
+            std::fill(deleted.begin() + a_lo, deleted.begin() + a_hi, true);
+            std::fill(inserted.begin() + b_lo, inserted.begin() + b_hi, true);
+            approximate = true;
+            return;
+        }
+        compare(a_lo, snake.x0, b_lo, snake.y0);
+        compare(snake.x1, a_hi, snake.y1, b_hi);
+    }
+
+    std::vector<bool> deleted;
+    std::vector<bool> inserted;
+    bool approximate = false;
+
+private:
+    struct Snake {
+        int x0, y0, x1, y1;
+    };
+
+    bool middleSnake(int a_lo, int a_hi, int b_lo, int b_hi, Snake& snake)
+    {
+        const int n = a_hi - a_lo;
+        const int m = b_hi - b_lo;
+        const int delta = n - m;
+        const bool odd = (delta & 1) != 0;
+        const int max = (n + m + 1) / 2;
+        const int limit = static_cast<int>(std::min<std::size_t>(max, max_cost_));
+
+        // Diagonal k is stored at offset + k
+        int* vf = forward_.data() + max + 1;
+        int* vb = backward_.data() + max + 1;
+        vf[1] = 0;
+        vb[1] = 0;
+
+        for (int d = 0; d <= limit; ++d) {
+            for (int k = -d; k <= d; k += 2) {
+                int x = (k == -d || (k != d && vf[k - 1] < vf[k + 1])) ? vf[k + 1] : vf[k - 1] + 1;
+                int y = x - k;
+                int x0 = x;
+                int y0 = y;
+                while (x < n && y < m && a_[a_lo + x] == b_[b_lo + y]) {
+                    ++x;
+                    ++y;
+                }
+                vf[k] = x;
+                int reverse = delta - k;
+                if (odd && reverse >= -(d - 1) && reverse <= d - 1 && vf[k] + vb[reverse] >= n) {
+                    snake = {a_lo + x0, b_lo + y0, a_lo + x, b_lo + y};
+                    return true;
+                }
+            }
+
+            for (int k = -d; k <= d; k += 2) {
+                int x = (k == -d || (k != d && vb[k - 1] < vb[k + 1])) ? vb[k + 1] : vb[k - 1] + 1;
+                int y = x - k;
+                int x0 = x;
+                int y0 = y;
+                while (x < n && y < m && a_[a_hi - 1 - x] == b_[b_hi - 1 - y]) {
+                    ++x;
+                    ++y;
+                }
+                vb[k] = x;
+                int forward = delta - k;
+                if (!odd && forward >= -d && forward <= d && vb[k] + vf[forward] >= n) {
+                    snake = {a_hi - x, b_hi - y, a_hi - x0, b_hi - y0};
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    const std::vector<std::uint32_t>& a_;
+    const std::vector<std::uint32_t>& b_;
+    std::size_t max_cost_;
+    std::vector<int> forward_;
+    std::vector<int> backward_;
+};
+
+void pushRun(std::vector<DiffRun>& runs, std::size_t first, DiffRun::Kind kind, std::uint32_t count)
+{
+    if (count == 0) {
+        return;
+    }
+    if (runs.size() > first && runs.back().kind == kind) {
+        runs.back().count += count;
+    } else {
+        runs.push_back({kind, count});
+    }
+}
+
+}
+
+std::vector<std::string_view> splitLines(std::string_view text)
+{
+    std::vector<std::string_view> lines;
+    lines.reserve(text.size() / 32 + 1);
+
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    const char* line = begin;
+    const char* p = begin;
+
+#if defined(__SSE2__)
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+        while (mask != 0) {
+            const char* nl = p + __builtin_ctz(mask);
+            lines.emplace_back(line, static_cast<std::size_t>(nl + 1 - line));
+            line = nl + 1;
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+        if (!nl) {
+            break;
+        }
+        lines.emplace_back(line, static_cast<std::size_t>(nl + 1 - line));
+        line = p = nl + 1;
+    }
+    if (line < end) {
+        lines.emplace_back(line, static_cast<std::size_t>(end - line));
+    }
+    return lines;
+}
+
+std::uint64_t hashLine(std::string_view line)
+{
+    const std::uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+    std::uint64_t hash = line.size() * multiplier;
+    const char* p = line.data();
+    std::size_t size = line.size();
+
+    for (; size >= 8; p += 8, size -= 8) {
+        std::uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 29;
+    }
+    if (size > 0) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, p, size);
+        hash = (hash ^ word) * multiplier;
+    }
+    hash ^= hash >> 32;
+    return hash;
+}
+
+FileDiff diffLines(std::string_view old_text, std::string_view new_text, const DiffOptions& options)
+{
+    FileDiff diff;
+    std::vector<std::string_view> old_lines = splitLines(old_text);
+    std::vector<std::string_view> new_lines = splitLines(new_text);
+    diff.old_lines = old_lines.size();
+    diff.new_lines = new_lines.size();
+
+    // Equal lines get equal ids; the diff compares ids only
+    std::unordered_map<LineKey, std::uint32_t, LineKeyHash, LineKeyEqual> ids;
+    ids.reserve(old_lines.size() + new_lines.size());
+    auto toIds = [&ids](const std::vector<std::string_view>& lines) {
+        std::vector<std::uint32_t> result;
+        result.reserve(lines.size());
+        for (std::string_view line : lines) {
+            auto it = ids.emplace(LineKey{line, hashLine(line)}, static_cast<std::uint32_t>(ids.size())).first;
+            result.push_back(it->second);
+        }
+        return result;
+    };
+    std::vector<std::uint32_t> a = toIds(old_lines);
+    std::vector<std::uint32_t> b = toIds(new_lines);
+
+    Myers myers(a, b, options.max_cost);
+    myers.compare(0, static_cast<int>(a.size()), 0, static_cast<int>(b.size()));
+    diff.approximate = myers.approximate;
+
+    // Whole-file runs, deletions before insertions within a change
+    std::vector<DiffRun> runs;
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < a.size() || j < b.size()) {
+        if (i < a.size() && myers.deleted[i]) {
+            pushRun(runs, 0, DiffRun::Kind::Delete, 1);
+            ++i;
+            ++diff.removed;
+        } else if (j < b.size() && myers.inserted[j]) {
+            pushRun(runs, 0, DiffRun::Kind::Insert, 1);
+            ++j;
+            ++diff.added;
+        } else {
+            pushRun(runs, 0, DiffRun::Kind::Equal, 1);
+            ++i;
+            ++j;
+        }
+    }
+
+    // Group changes into hunks, merging those separated by at most
+    // 2 * context unchanged lines
+    const std::uint32_t context = options.context;
+    std::uint32_t old_pos = 0;
+    std::uint32_t new_pos = 0;
+    DiffHunk* hunk = nullptr;
+    for (std::size_t r = 0; r < runs.size(); ++r) {
+        const DiffRun& run = runs[r];
+        if (run.kind == DiffRun::Kind::Equal) {
+            bool last = r + 1 == runs.size();
+            if (hunk && (last || run.count > 2 * context)) {
+                // Trailing context closes the hunk
+                std::uint32_t trailing = std::min(run.count, context);
+                pushRun(diff.runs, hunk->run_begin, DiffRun::Kind::Equal, trailing);
+                hunk->old_count += trailing;
+                hunk->new_count += trailing;
+                hunk->run_end = static_cast<std::uint32_t>(diff.runs.size());
+                hunk = nullptr;
+            } else if (hunk) {
+                pushRun(diff.runs, hunk->run_begin, DiffRun::Kind::Equal, run.count);
+                hunk->old_count += run.count;
+                hunk->new_count += run.count;
+            }
+            old_pos += run.count;
+            new_pos += run.count;
+            continue;
+        }
+
+        if (!hunk) {
+            std::uint32_t leading = 0;
+            if (r > 0 && runs[r - 1].kind == DiffRun::Kind::Equal) {
+                leading = std::min(runs[r - 1].count, context);
+            }
+            diff.hunks.push_back(DiffHunk());
+            hunk = &diff.hunks.back();
+            hunk->old_start = old_pos - leading;
+            hunk->new_start = new_pos - leading;
+            hunk->old_count = leading;
+            hunk->new_count = leading;
+            hunk->run_begin = static_cast<std::uint32_t>(diff.runs.size());
+            pushRun(diff.runs, hunk->run_begin, DiffRun::Kind::Equal, leading);
+        }
+
+        pushRun(diff.runs, hunk->run_begin, run.kind, run.count);
+        if (run.kind == DiffRun::Kind::Delete) {
+            hunk->old_count += run.count;
+            old_pos += run.count;
+        } else {
+            hunk->new_count += run.count;
+            new_pos += run.count;
+        }
+    }
+    if (hunk) {
+        hunk->run_end = static_cast<std::uint32_t>(diff.runs.size());
+    }
+    return diff;
+}
+
+std::string hunkHeader(const DiffHunk& hunk)
+{
+    // Unified diff numbers lines from 1; an empty side names the line before it
+    auto range = [](std::uint32_t start, std::uint32_t count) {
+        return std::to_string(count == 0 ? start : start + 1) + "," + std::to_string(count);
+    };
+    return "@@ -" + range(hunk.old_start, hunk.old_count) + " +" + range(hunk.new_start, hunk.new_count) + " @@";
+}
+
+}
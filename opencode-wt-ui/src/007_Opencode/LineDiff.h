@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Opencode {
+
+/**
+ * @brief Run of consecutive lines with the same edit
+ */
+struct DiffRun {
+    enum class Kind : std::uint8_t { Equal, Delete, Insert };
+
+    Kind kind;
+    std::uint32_t count;
+};
+
+/**
+ * @brief A changed region with its surrounding context lines
+ *
+ * Line numbers are 0-based. The edits of the hunk are the runs
+ * [run_begin, run_end) of the owning FileDiff.
+ */
+struct DiffHunk {
+    std::uint32_t old_start = 0;
+    std::uint32_t old_count = 0;
+    std::uint32_t new_start = 0;
+    std::uint32_t new_count = 0;
+    std::uint32_t run_begin = 0;
+    std::uint32_t run_end = 0;
+};
+
+/**
+ * @brief Line diff between two texts, as hunks of edit runs
+ */
+struct FileDiff {
+    std::vector<DiffHunk> hunks;
+    std::vector<DiffRun> runs;
+    std::size_t old_lines = 0;
+    std::size_t new_lines = 0;
+    std::size_t added = 0;
+    std::size_t removed = 0;
+    bool approximate = false;  ///< Part of the diff exceeded the cost limit and is not minimal
+};
+
+struct DiffOptions {
+    std::uint32_t context = 3;  ///< Unchanged lines kept around each change
+    std::size_t max_cost = 1024;  ///< Edit distance after which a region is reported as replaced
+};
+
+/**
+ * @brief Splits text into lines, each view including its '\n'
+ *
+ * Newlines are located 16 bytes at a time with SSE2 where available.
+ */
+std::vector<std::string_view> splitLines(std::string_view text);
+
+/**
+ * @brief 64-bit hash of a line, computed 8 bytes at a time
+ */
+std::uint64_t hashLine(std::string_view line);
+
+/**
+ * @brief Computes a line diff with Myers' linear-space algorithm
+ *
+ * Lines are compared as dense integer ids assigned from their hashes, so
+ * the O((N+M)D) search never touches the text itself.
+ */
+FileDiff diffLines(std::string_view old_text, std::string_view new_text, const DiffOptions& options = DiffOptions());
+
+/**
+ * @brief Unified diff style header of a hunk, e.g. "@@ -10,7 +10,8 @@"
+ */
+std::string hunkHeader(const DiffHunk& hunk);
+
+}
@@ -0,0 +1,96 @@
+#include "007_Opencode/MentionModel.h"
+#include "000_Server/Server.h"
+
+#include <Wt/Utils.h>
+#include <Wt/WLogger.h>
+
+namespace Opencode {
+
+const char* MentionModel::MatcherJS = R"(
+function(edit) {
+    var value = edit.value.substring(0, edit.selectionStart);
+    var at = value.lastIndexOf('@');
+    var word = null;
+    if (at >= 0 && (at === 0 || /\s/.test(value.charAt(at - 1))) && !/\s/.test(value.substring(at + 1))) {
+        word = value.substring(at + 1);
+    }
+    return function(suggestion) {
+        if (!suggestion) {
+            return word === null ? '' : '@' + word;
+        }
+        return { match: word !== null, suggestion: suggestion };
+    };
+}
+)";
+
+const char* MentionModel::ReplacerJS = R"(
+function(edit, suggestionText, suggestionValue) {
+    var caret = edit.selectionStart;
+    var value = edit.value;
+    var at = value.lastIndexOf('@', caret - 1);
+    if (at < 0) {
+        return;
+    }
+    var inserted = '@' + suggestionValue + ' ';
+    edit.value = value.substring(0, at) + inserted + value.substring(caret);
+    caret = at + inserted.length;
+    if (edit.setSelectionRange) {
+        edit.setSelectionRange(caret, caret);
+    }
+}
+)";
+
+MentionModel::MentionModel()
+    : Wt::WAbstractListModel()
+{
+}
+
+int MentionModel::rowCount(const Wt::WModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(matches_.size());
+}
+
+Wt::cpp17::any MentionModel::data(const Wt::WModelIndex& index, Wt::ItemDataRole role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= static_cast<int>(matches_.size())) {
+        return Wt::cpp17::any();
+    }
+
+    const Workspace::FuzzyMatch& match = matches_[index.row()];
+    if (role == Wt::ItemDataRole::Display) {
+        return Wt::WString::fromUTF8(highlight(match));
+    } else if (role == Wt::ItemDataRole::User) {
+        return Wt::WString::fromUTF8(match.path);
+    }
+    return Wt::cpp17::any();
+}
+
+std::string MentionModel::highlight(const Workspace::FuzzyMatch& match)
+{
+    std::string html;
+    std::size_t from = 0;
+    for (std::uint16_t position : match.positions) {
+        html += Wt::Utils::htmlEncode(match.path.substr(from, position - from));
+        html += "<b>" + Wt::Utils::htmlEncode(match.path.substr(position, 1)) + "</b>";
+        from = position + 1;
+    }
+    html += Wt::Utils::htmlEncode(match.path.substr(from));
+    return html;
+}
+
+void MentionModel::filter(const Wt::WString& text)
+{
+    std::string query = text.toUTF8();
+    if (!query.empty() && query[0] == '@') {
+        query.erase(0, 1);
+    }
+
+    matches_ = Server::instance()->fuzzyIndex().find(query, MaxSuggestions, &cache_);
+
+#ifdef DEBUG
+    Wt::log("debug") << "MentionModel::filter() - '" << query << "': " << matches_.size() << " suggestions";
+#endif
+    reset();
+}
+
+}
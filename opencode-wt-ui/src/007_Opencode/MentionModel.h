@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <Wt/WAbstractListModel.h>
+#include <Wt/WModelIndex.h>
+#include <Wt/WString.h>
+
+#include "008_Workspace/FuzzyIndex.h"
+
+namespace Opencode {
+
+/**
+ * @brief Suggestions for @-mentions of workspace files in the prompt
+ *
+ * Backs a WSuggestionPopup that filters server side on every keystroke:
+ * filter() queries the process-wide FuzzyIndex for the top matches and
+ * keeps the candidates so that a longer query only rescans those. The
+ * display role highlights the matched characters, the user role holds
+ * the path inserted into the prompt.
+ */
+class MentionModel : public Wt::WAbstractListModel {
+public:
+    /// Number of suggestions shown
+    static constexpr std::size_t MaxSuggestions = 20;
+
+    /// Client-side matcher: the text after the '@' before the cursor is the filter
+    static const char* MatcherJS;
+    /// Client-side replacer: swaps the mention being typed for the chosen path
+    static const char* ReplacerJS;
+
+    MentionModel();
+
+    int rowCount(const Wt::WModelIndex& parent = Wt::WModelIndex()) const override;
+    Wt::cpp17::any data(const Wt::WModelIndex& index, Wt::ItemDataRole role = Wt::ItemDataRole::Display) const override;
+
+    /**
+     * @brief Replaces the suggestions with the best matches of a query
+     */
+    void filter(const Wt::WString& text);
+
+private:
+    static std::string highlight(const Workspace::FuzzyMatch& match);
+
+    std::vector<Workspace::FuzzyMatch> matches_;
+    Workspace::FuzzyCache cache_;
+};
+
+}
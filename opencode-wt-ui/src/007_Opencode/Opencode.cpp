@@ -1,4 +1,5 @@
 #include "007_Opencode/Opencode.h"
+#include "000_Server/AsyncLog.h"
 #include <Wt/WLength.h>
 #include <Wt/WApplication.h>
 #include <Wt/WTemplate.h>
@@ -13,24 +14,18 @@ namespace Opencode
         : Wt::WDialog(),
           session_(session)
     {
-        #ifdef DEBUG
-        Wt::log("debug") << "Opencode::Opencode() - Constructor called";
-        #endif
+        APP_LOG(Debug) << "Opencode::Opencode() - Constructor called";
         
         initializeDialog();
         setupKeyboardShortcuts();
         setupContent();
         
-        #ifdef DEBUG
-        Wt::log("debug") << "Opencode::Opencode() - Constructor completed";
-        #endif
+        APP_LOG(Debug) << "Opencode::Opencode() - Constructor completed";
     }
 
     void Opencode::initializeDialog()
     {
-        #ifdef DEBUG
-        Wt::log("debug") << "Opencode::initializeDialog() - Initializing dialog";
-        #endif
+        APP_LOG(Debug) << "Opencode::initializeDialog() - Initializing dialog";
         
         setOffsets(0, Wt::Side::Top | Wt::Side::Bottom | Wt::Side::Left | Wt::Side::Right);
         titleBar()->children()[0]->removeFromParent();
@@ -46,16 +41,12 @@ namespace Opencode
                        Wt::WLength(100, Wt::LengthUnit::ViewportHeight));
         setLayoutSizeAware(true);
         
-        #ifdef DEBUG
-        Wt::log("debug") << "Opencode::initializeDialog() - Dialog initialization completed";
-        #endif
+        APP_LOG(Debug) << "Opencode::initializeDialog() - Dialog initialization completed";
     }
 
     void Opencode::setupKeyboardShortcuts()
     {
-        #ifdef DEBUG
-        Wt::log("debug") << "Opencode::setupKeyboardShortcuts() - Setting up keyboard shortcuts";
-        #endif
+        APP_LOG(Debug) << "Opencode::setupKeyboardShortcuts() - Setting up keyboard shortcuts";
         
         wApp->doJavaScript(WT_CLASS R"(
         .$(')" + id() + R"(').oncontextmenu = function() {
@@ -73,67 +64,73 @@ namespace Opencode
         });
     )");
 
-        wApp->globalKeyWentDown().connect([=](Wt::WKeyEvent e)
-                                          { keyWentDown(e); });
+        // Bound to this, so the connection goes with the dialog when a session hibernates
+        wApp->globalKeyWentDown().connect(this, &Opencode::keyWentDown);
         
-        #ifdef DEBUG
-        Wt::log("debug") << "Opencode::setupKeyboardShortcuts() - Keyboard shortcuts setup completed";
-        #endif
+        APP_LOG(Debug) << "Opencode::setupKeyboardShortcuts() - Keyboard shortcuts setup completed";
     }
 
     void Opencode::setupContent()
     {
-        #ifdef DEBUG
-        Wt::log("debug") << "Opencode::setupContent() - Setting up content";
-        #endif
+        APP_LOG(Debug) << "Opencode::setupContent() - Setting up content";
         
         sessions_widget_ = contents()->addWidget(std::make_unique<Sessions>(session_));
+        transcript_ = contents()->addWidget(std::make_unique<Transcript>(session_));
+        sessions_widget_->sessionLoaded().connect(transcript_, &Transcript::setSession);
         
-        #ifdef DEBUG
-        Wt::log("debug") << "Opencode::setupContent() - Sessions widget created: " << sessions_widget_;
-        Wt::log("debug") << "Opencode::setupContent() - Content setup completed";
-        #endif
+        APP_LOG(Debug) << "Opencode::setupContent() - Sessions widget created: " << sessions_widget_;
+        APP_LOG(Debug) << "Opencode::setupContent() - Content setup completed";
+    }
+
+    Opencode::State Opencode::state() const
+    {
+        State state;
+        state.visible = !isHidden();
+        state.opencode_session_id = transcript_->sessionId();
+        return state;
+    }
+
+    void Opencode::restoreState(const State& state)
+    {
+        APP_LOG(Debug) << "Opencode::restoreState() - Restoring session: '" << state.opencode_session_id << "'";
+
+        if (!state.opencode_session_id.empty())
+        {
+            sessions_widget_->showSession(state.opencode_session_id);
+        }
+        if (state.visible)
+        {
+            show();
+        }
     }
 
     void Opencode::keyWentDown(Wt::WKeyEvent e)
     {
-        #ifdef DEBUG
-        Wt::log("debug") << "Opencode::keyWentDown() - Key event received. Key: " << static_cast<int>(e.key()) << ", Modifiers: " << e.modifiers().value();
-        #endif
+        APP_LOG(Debug) << "Opencode::keyWentDown() - Key event received. Key: " << static_cast<int>(e.key()) << ", Modifiers: " << e.modifiers().value();
         
         if (e.modifiers().test(Wt::KeyboardModifier::Control))
         {
-            #ifdef DEBUG
-            Wt::log("debug") << "Opencode::keyWentDown() - Control key modifier detected";
-            #endif
+            APP_LOG(Debug) << "Opencode::keyWentDown() - Control key modifier detected";
             
             if (e.key() == Wt::Key::Q)
             {
-                #ifdef DEBUG
-                Wt::log("debug") << "Opencode::keyWentDown() - Ctrl+Q detected. Current state: " << (isHidden() ? "hidden" : "visible");
-                #endif
+                APP_LOG(Debug) << "Opencode::keyWentDown() - Ctrl+Q detected. Current state: " << (isHidden() ? "hidden" : "visible");
                 
                 if (isHidden())
                 {
-                    #ifdef DEBUG
-                    Wt::log("debug") << "Opencode::keyWentDown() - Showing Opencode dialog";
-                    #endif
+                    APP_LOG(Debug) << "Opencode::keyWentDown() - Showing Opencode dialog";
                     show();
                 }
                 else
                 {
-                    #ifdef DEBUG
-                    Wt::log("debug") << "Opencode::keyWentDown() - Hiding Opencode dialog";
-                    #endif
+                    APP_LOG(Debug) << "Opencode::keyWentDown() - Hiding Opencode dialog";
                     hide();
                 }
             }
 
             if (e.modifiers().test(Wt::KeyboardModifier::Shift))
             {
-                #ifdef DEBUG
-                Wt::log("debug") << "Opencode::keyWentDown() - Ctrl+Shift combination detected";
-                #endif
+                APP_LOG(Debug) << "Opencode::keyWentDown() - Ctrl+Shift combination detected";
                 // Future keyboard shortcuts with Ctrl+Shift combination
             }
         }
@@ -7,14 +7,26 @@
 #include <Wt/WStackedWidget.h>
 #include "002_Dbo/Session.h"
 #include "Sessions.h"
+#include "007_Opencode/Transcript.h"
 
 namespace Opencode {
 
 class Opencode : public Wt::WDialog
 {
 public:
+    /**
+     * @brief What a hibernating session keeps of the dialog
+     */
+    struct State {
+        bool visible = false;
+        std::string opencode_session_id;
+    };
+
     Opencode(Session& session);
 
+    State state() const;
+    void restoreState(const State& state);
+
 private:
     void initializeDialog();
     void setupContent();
@@ -31,6 +43,7 @@ private:
     // Wt::WContainerWidget* main_content_;
     
     Sessions* sessions_widget_;
+    Transcript* transcript_;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,288 @@
+#include "007_Opencode/Payloads.h"
+
+#include <algorithm>
+
+namespace Opencode {
+
+namespace {
+
+/// Stores a field of an edit tool input, keyed by its member name
+void assignEditField(const std::string& key, std::string& value, PartData& part)
+{
+    if (key == "filePath") {
+        part.file_path = std::move(value);
+    } else if (key == "oldString") {
+        part.old_text = std::move(value);
+    } else if (key == "newString") {
+        part.new_text = std::move(value);
+    }
+}
+
+/// Stores a field of a part object, keyed by its member name
+void assignPartField(const std::string& key, std::string& value, PartData& part)
+{
+    if (key == "text") {
+        part.text = std::move(value);
+    } else if (key == "id") {
+        part.id = std::move(value);
+    } else if (key == "messageID") {
+        part.message_id = std::move(value);
+    } else if (key == "sessionID") {
+        part.session_id = std::move(value);
+    } else if (key == "type") {
+        part.type = std::move(value);
+    } else if (key == "tool") {
+        part.tool = std::move(value);
+    }
+}
+
+class EventSax : public PayloadSax {
+public:
+    explicit EventSax(EventPayload& out) : out_(out) {}
+
+    void finish()
+    {
+        // The session id lives in a different place depending on the event
+        // type: properties.sessionID, properties.part.sessionID,
+        // properties.info.sessionID, or properties.info.id for session.*
+        if (out_.session_id.empty()) {
+            if (!out_.part.session_id.empty()) {
+                out_.session_id = out_.part.session_id;
+            } else if (!info_session_id_.empty()) {
+                out_.session_id = info_session_id_;
+            } else if (out_.type.rfind("session.", 0) == 0) {
+                out_.session_id = info_id_;
+            }
+        }
+        if (out_.message_id.empty() && out_.type == "message.updated") {
+            out_.message_id = info_id_;
+        }
+    }
+
+protected:
+    void onString(std::string& value) override
+    {
+        if (at({"type"})) {
+            out_.type = std::move(value);
+        } else if (at({"properties", "delta"})) {
+            out_.delta = std::move(value);
+        } else if (at({"properties", "sessionID"})) {
+            out_.session_id = std::move(value);
+        } else if (at({"properties", "messageID"})) {
+            out_.message_id = std::move(value);
+        } else if (at({"properties", "partID"})) {
+            out_.part_id = std::move(value);
+        } else if (at({"properties", "info", "id"})) {
+            info_id_ = std::move(value);
+        } else if (at({"properties", "info", "sessionID"})) {
+            info_session_id_ = std::move(value);
+        } else if (at({"properties", "info", "role"})) {
+            out_.role = std::move(value);
+        } else if (at({"properties", "part", "state", "status"})) {
+            out_.part.status = std::move(value);
+        } else if (in({"properties", "part", "state", "input"})) {
+            assignEditField(currentKey(), value, out_.part);
+        } else if (in({"properties", "part"})) {
+            assignPartField(currentKey(), value, out_.part);
+        }
+    }
+
+    void onBeginObject() override
+    {
+        if (in({"properties", "part"})) {
+            out_.has_part = true;
+        }
+    }
+
+private:
+    EventPayload& out_;
+    std::string info_id_;
+    std::string info_session_id_;
+};
+
+class SessionListSax : public PayloadSax {
+public:
+    explicit SessionListSax(std::vector<SessionInfo>& out) : out_(out) {}
+
+protected:
+    void onString(std::string& value) override
+    {
+        if (at({"*", "id"})) {
+            current_.id = std::move(value);
+        } else if (at({"*", "title"})) {
+            current_.title = std::move(value);
+        }
+    }
+
+    void onNumber(double value) override
+    {
+        if (at({"*", "time", "updated"})) {
+            current_.updated = value;
+        }
+    }
+
+    void onBeginObject() override
+    {
+        if (in({"*"})) {
+            current_ = SessionInfo();
+        }
+    }
+
+    void onEndObject() override
+    {
+        if (in({"*"}) && !current_.id.empty()) {
+            out_.push_back(std::move(current_));
+        }
+    }
+
+private:
+    std::vector<SessionInfo>& out_;
+    SessionInfo current_;
+};
+
+class MessageListSax : public PayloadSax {
+public:
+    explicit MessageListSax(std::vector<MessageData>& out) : out_(out) {}
+
+protected:
+    void onString(std::string& value) override
+    {
+        if (out_.empty()) {
+            return;
+        }
+        MessageData& message = out_.back();
+        if (at({"*", "info", "id"})) {
+            message.id = std::move(value);
+        } else if (at({"*", "info", "role"})) {
+            message.role = std::move(value);
+        } else if (message.parts.empty()) {
+            return;
+        } else if (at({"*", "parts", "*", "state", "status"})) {
+            message.parts.back().status = std::move(value);
+        } else if (in({"*", "parts", "*", "state", "input"})) {
+            assignEditField(currentKey(), value, message.parts.back());
+        } else if (in({"*", "parts", "*"})) {
+            assignPartField(currentKey(), value, message.parts.back());
+        }
+    }
+
+    void onBeginObject() override
+    {
+        if (in({"*"})) {
+            out_.emplace_back();
+        } else if (in({"*", "parts", "*"}) && !out_.empty()) {
+            out_.back().parts.emplace_back();
+        }
+    }
+
+private:
+    std::vector<MessageData>& out_;
+};
+
+}
+
+bool PayloadSax::string(string_t& value)
+{
+    onString(value);
+    return true;
+}
+
+bool PayloadSax::number(double value)
+{
+    onNumber(value);
+    return true;
+}
+
+bool PayloadSax::start_object(std::size_t)
+{
+    frames_.push_back(Frame{false, std::string()});
+    onBeginObject();
+    return true;
+}
+
+bool PayloadSax::key(string_t& value)
+{
+    frames_.back().key.swap(value);
+    return true;
+}
+
+bool PayloadSax::end_object()
+{
+    frames_.back().key.clear();
+    onEndObject();
+    frames_.pop_back();
+    return true;
+}
+
+bool PayloadSax::start_array(std::size_t)
+{
+    frames_.push_back(Frame{true, std::string()});
+    return true;
+}
+
+bool PayloadSax::end_array()
+{
+    frames_.pop_back();
+    return true;
+}
+
+bool PayloadSax::parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& e)
+{
+    error_ = e.what();
+    return false;
+}
+
+const std::string& PayloadSax::currentKey() const
+{
+    static const std::string none;
+    return frames_.empty() || frames_.back().array ? none : frames_.back().key;
+}
+
+bool PayloadSax::matches(std::initializer_list<std::string_view> path, std::size_t frames) const
+{
+    if (frames != frames_.size()) {
+        return false;
+    }
+    std::size_t i = 0;
+    for (std::string_view step : path) {
+        const Frame& frame = frames_[i++];
+        if (frame.array ? step != "*" : step != frame.key) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PayloadSax::at(std::initializer_list<std::string_view> path) const
+{
+    return matches(path, path.size());
+}
+
+bool PayloadSax::in(std::initializer_list<std::string_view> path) const
+{
+    return matches(path, path.size() + 1);
+}
+
+bool parseEvent(std::string_view data, EventPayload& out)
+{
+    EventSax sax(out);
+    if (!nlohmann::json::sax_parse(data.begin(), data.end(), &sax)) {
+        return false;
+    }
+    sax.finish();
+    return true;
+}
+
+bool parseSessionList(std::string_view body, std::vector<SessionInfo>& out)
+{
+    SessionListSax sax(out);
+    return nlohmann::json::sax_parse(body.begin(), body.end(), &sax);
+}
+
+bool parseMessageList(std::string_view body, std::vector<MessageData>& out)
+{
+    MessageListSax sax(out);
+    return nlohmann::json::sax_parse(body.begin(), body.end(), &sax);
+}
+
+}
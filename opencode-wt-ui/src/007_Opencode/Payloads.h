@@ -0,0 +1,139 @@
+#pragma once
+
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace Opencode {
+
+/**
+ * @brief Session fields shown by the UI
+ */
+struct SessionInfo {
+    std::string id;
+    std::string title;
+    double updated = 0;
+};
+
+/**
+ * @brief Message part fields shown by the UI
+ *
+ * Tool input and output are not kept, only the tool name and its status,
+ * and for file edits the path and the replaced and replacing text.
+ */
+struct PartData {
+    std::string id;
+    std::string message_id;
+    std::string session_id;
+    std::string type;
+    std::string text;
+    std::string tool;
+    std::string status;
+    std::string file_path;  ///< state.input.filePath of edit tools
+    std::string old_text;   ///< state.input.oldString of edit tools
+    std::string new_text;   ///< state.input.newString of edit tools
+};
+
+/**
+ * @brief A message with its parts, as returned by `/session/{id}/message`
+ */
+struct MessageData {
+    std::string id;
+    std::string role;
+    std::vector<PartData> parts;
+};
+
+/**
+ * @brief Fields of an opencode event used for routing and rendering
+ */
+struct EventPayload {
+    std::string type;
+    std::string session_id;  ///< Resolved from wherever the event type carries it
+    std::string message_id;  ///< properties.messageID, or properties.info.id for message.updated
+    std::string part_id;     ///< properties.partID of message.part.removed
+    std::string role;        ///< properties.info.role of message.updated
+    std::string delta;       ///< properties.delta of message.part.updated
+    PartData part;           ///< properties.part of message.part.updated
+    bool has_part = false;
+};
+
+/**
+ * @brief Base SAX handler that tracks the key path of the current value
+ *
+ * Payloads are parsed with nlohmann's SAX interface: no json tree is built,
+ * values outside the paths a handler asks for are discarded as soon as the
+ * lexer has produced them, and wanted strings are moved out of the lexer
+ * buffer instead of being copied.
+ *
+ * Paths are matched from the document root; "*" stands for any array element.
+ */
+class PayloadSax : public nlohmann::json_sax<nlohmann::json> {
+public:
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t value) override { return number(static_cast<double>(value)); }
+    bool number_unsigned(number_unsigned_t value) override { return number(static_cast<double>(value)); }
+    bool number_float(number_float_t value, const string_t&) override { return number(value); }
+    bool string(string_t& value) override;
+    bool binary(binary_t&) override { return true; }
+    bool start_object(std::size_t) override;
+    bool key(string_t& value) override;
+    bool end_object() override;
+    bool start_array(std::size_t) override;
+    bool end_array() override;
+    bool parse_error(std::size_t position, const std::string& last_token, const nlohmann::detail::exception& e) override;
+
+    const std::string& error() const { return error_; }
+
+protected:
+    /// A string value was read at the current path
+    virtual void onString(std::string& value) { (void)value; }
+    /// A number value was read at the current path
+    virtual void onNumber(double value) { (void)value; }
+    /// An object was opened, the current path leads to it
+    virtual void onBeginObject() {}
+    /// An object is about to be closed, the current path leads to it
+    virtual void onEndObject() {}
+
+    /// The current value is reached through exactly this path
+    bool at(std::initializer_list<std::string_view> path) const;
+    /// The current object is reached through exactly this path
+    bool in(std::initializer_list<std::string_view> path) const;
+    /// Member name of the current value, empty inside arrays
+    const std::string& currentKey() const;
+
+private:
+    struct Frame {
+        bool array = false;
+        std::string key;  ///< Key of the current member, objects only
+    };
+
+    bool number(double value);
+    bool matches(std::initializer_list<std::string_view> path, std::size_t frames) const;
+
+    std::vector<Frame> frames_;
+    std::string error_;
+};
+
+/**
+ * @brief Parses one opencode event payload
+ * @return false if the payload is not valid JSON
+ */
+bool parseEvent(std::string_view data, EventPayload& out);
+
+/**
+ * @brief Parses the `/session` list
+ * @return false if the body is not valid JSON
+ */
+bool parseSessionList(std::string_view body, std::vector<SessionInfo>& out);
+
+/**
+ * @brief Parses the `/session/{id}/message` list
+ * @return false if the body is not valid JSON
+ */
+bool parseMessageList(std::string_view body, std::vector<MessageData>& out);
+
+}
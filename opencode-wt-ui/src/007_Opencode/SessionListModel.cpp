@@ -0,0 +1,173 @@
+#include "007_Opencode/SessionListModel.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace Opencode {
+
+namespace {
+
+const char* row_style = "px-2 py-2 text-left border-b border-gray-200 dark:border-gray-700 cursor-pointer truncate hover:bg-gray-100 dark:hover:bg-gray-800";
+const char* selected_row_style = "px-2 py-2 text-left border-b border-blue-300 cursor-pointer truncate bg-blue-100 dark:bg-blue-900";
+
+}
+
+SessionListModel::SessionListModel()
+    : Wt::WAbstractListModel()
+{
+}
+
+int SessionListModel::rowCount(const Wt::WModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(sessions_.size());
+}
+
+Wt::cpp17::any SessionListModel::data(const Wt::WModelIndex& index, Wt::ItemDataRole role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= static_cast<int>(sessions_.size())) {
+        return Wt::cpp17::any();
+    }
+
+    const SessionInfo& info = sessions_[index.row()];
+    if (role == Wt::ItemDataRole::Display) {
+        return Wt::WString::fromUTF8(displayName(info));
+    } else if (role == Wt::ItemDataRole::User) {
+        return info.id;
+    } else if (role == Wt::ItemDataRole::ToolTip) {
+        return Wt::WString::fromUTF8(info.id);
+    } else if (role == Wt::ItemDataRole::StyleClass) {
+        return Wt::WString::fromUTF8(info.id == selected_id_ ? selected_row_style : row_style);
+    }
+    return Wt::cpp17::any();
+}
+
+std::string SessionListModel::displayName(const SessionInfo& info)
+{
+    return info.title.empty() ? info.id : info.title;
+}
+
+int SessionListModel::rowOf(const std::string& id) const
+{
+    auto it = rows_.find(id);
+    return it == rows_.end() ? -1 : it->second;
+}
+
+const SessionInfo* SessionListModel::find(const std::string& id) const
+{
+    auto it = rows_.find(id);
+    return it == rows_.end() ? nullptr : &sessions_[it->second];
+}
+
+void SessionListModel::reindex(int from)
+{
+    for (int row = from; row < static_cast<int>(sessions_.size()); ++row) {
+        rows_[sessions_[row].id] = row;
+    }
+}
+
+void SessionListModel::rowChanged(int row)
+{
+    Wt::WModelIndex changed = index(row, 0);
+    dataChanged().emit(changed, changed);
+}
+
+void SessionListModel::update(std::vector<SessionInfo> sessions)
+{
+    // Drop duplicate ids, keeping the first occurrence
+    std::unordered_set<std::string> wanted;
+    sessions.erase(std::remove_if(sessions.begin(), sessions.end(), [&](const SessionInfo& info) {
+        return !wanted.insert(info.id).second;
+    }), sessions.end());
+
+    // 1. Remove the rows that disappeared, one signal per contiguous run
+    for (int row = static_cast<int>(sessions_.size()) - 1; row >= 0; --row) {
+        if (wanted.count(sessions_[row].id)) {
+            continue;
+        }
+        int first = row;
+        while (first > 0 && !wanted.count(sessions_[first - 1].id)) {
+            --first;
+        }
+        beginRemoveRows(Wt::WModelIndex(), first, row);
+        for (int i = first; i <= row; ++i) {
+            rows_.erase(sessions_[i].id);
+        }
+        sessions_.erase(sessions_.begin() + first, sessions_.begin() + row + 1);
+        endRemoveRows();
+        row = first;
+    }
+    reindex(0);
+
+    // 2. Walk the new order: rows before i already match. Unknown sessions
+    //    are inserted in runs, known sessions out of place are moved.
+    for (int i = 0; i < static_cast<int>(sessions.size());) {
+        const SessionInfo& next = sessions[i];
+
+        if (i < static_cast<int>(sessions_.size()) && sessions_[i].id == next.id) {
+            if (sessions_[i].title != next.title || sessions_[i].updated != next.updated) {
+                sessions_[i] = next;
+                rowChanged(i);
+            }
+            ++i;
+            continue;
+        }
+
+        if (rows_.count(next.id) == 0) {
+            int last = i;
+            while (last + 1 < static_cast<int>(sessions.size()) && rows_.count(sessions[last + 1].id) == 0) {
+                ++last;
+            }
+            beginInsertRows(Wt::WModelIndex(), i, last);
+            sessions_.insert(sessions_.begin() + i, sessions.begin() + i, sessions.begin() + last + 1);
+            endInsertRows();
+            reindex(i);
+            i = last + 1;
+            continue;
+        }
+
+        int from = rows_[next.id];
+        beginRemoveRows(Wt::WModelIndex(), from, from);
+        sessions_.erase(sessions_.begin() + from);
+        endRemoveRows();
+        beginInsertRows(Wt::WModelIndex(), i, i);
+        sessions_.insert(sessions_.begin() + i, next);
+        endInsertRows();
+        reindex(i);
+        ++i;
+    }
+}
+
+void SessionListModel::remove(const std::string& id)
+{
+    int row = rowOf(id);
+    if (row < 0) {
+        return;
+    }
+    beginRemoveRows(Wt::WModelIndex(), row, row);
+    rows_.erase(id);
+    sessions_.erase(sessions_.begin() + row);
+    endRemoveRows();
+    reindex(row);
+
+    if (selected_id_ == id) {
+        selected_id_.clear();
+    }
+}
+
+void SessionListModel::setSelectedId(const std::string& id)
+{
+    if (id == selected_id_) {
+        return;
+    }
+    int previous = rowOf(selected_id_);
+    selected_id_ = id;
+    if (previous >= 0) {
+        rowChanged(previous);
+    }
+    int current = rowOf(selected_id_);
+    if (current >= 0) {
+        rowChanged(current);
+    }
+}
+
+}
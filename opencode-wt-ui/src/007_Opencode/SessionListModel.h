@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Wt/WAbstractListModel.h>
+#include <Wt/WModelIndex.h>
+
+#include "007_Opencode/Payloads.h"
+
+namespace Opencode {
+
+/**
+ * @brief List model of the opencode sessions shown in Sessions
+ *
+ * The model backs a virtualized WTableView: only the visible rows are
+ * rendered and row widgets are recycled by the view. A refresh is applied
+ * as a keyed diff against the current rows, so only inserted, removed,
+ * moved or renamed sessions are sent to the browser.
+ */
+class SessionListModel : public Wt::WAbstractListModel {
+public:
+    SessionListModel();
+
+    int rowCount(const Wt::WModelIndex& parent = Wt::WModelIndex()) const override;
+    Wt::cpp17::any data(const Wt::WModelIndex& index, Wt::ItemDataRole role = Wt::ItemDataRole::Display) const override;
+
+    /**
+     * @brief Replaces the rows with the given list, emitting minimal change signals
+     * @param sessions New session list, in display order
+     */
+    void update(std::vector<SessionInfo> sessions);
+
+    /**
+     * @brief Removes a single session
+     */
+    void remove(const std::string& id);
+
+    /**
+     * @brief Highlights the row of the given session, empty for no selection
+     */
+    void setSelectedId(const std::string& id);
+    const std::string& selectedId() const { return selected_id_; }
+
+    /**
+     * @brief Session shown at the given row
+     */
+    const SessionInfo& sessionAt(int row) const { return sessions_[row]; }
+
+    /**
+     * @brief Row of the session with the given id, -1 if absent
+     */
+    int rowOf(const std::string& id) const;
+
+    /**
+     * @brief Session with the given id, nullptr if absent
+     */
+    const SessionInfo* find(const std::string& id) const;
+
+    /**
+     * @brief Display name of a session: its title, or its id when untitled
+     */
+    static std::string displayName(const SessionInfo& info);
+
+private:
+    void reindex(int from);
+    void rowChanged(int row);
+
+    std::vector<SessionInfo> sessions_;
+    std::unordered_map<std::string, int> rows_;  ///< Session id to row
+    std::string selected_id_;
+};
+
+}
@@ -4,6 +4,18 @@
 #include <Wt/WMessageBox.h>
 #include <Wt/WApplication.h>
 #include <Wt/WLogger.h>
+#include <Wt/Utils.h>
+#include <Wt/Core/observing_ptr.hpp>
+#include <Wt/Dbo/Transaction.h>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+
+#include "000_Server/AsyncLog.h"
+#include "000_Server/Server.h"
+#include "000_Server/Trace.h"
+#include "002_Dbo/Tables/OpencodeSession.h"
 
 namespace Opencode {
 
@@ -11,299 +23,270 @@ Sessions::Sessions(Session& session)
     : Wt::WContainerWidget(), 
       session_(session)
 {
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::Sessions() - Constructor called";
-    #endif
+    APP_LOG(Debug) << "Sessions::Sessions() - Constructor called";
     
     setupLayout();
     setupSessionList();
     setupSessionControls();
     refreshSessionList();
+    subscribeToEvents();
     
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::Sessions() - Constructor completed";
-    #endif
+    APP_LOG(Debug) << "Sessions::Sessions() - Constructor completed";
+}
+
+Sessions::~Sessions()
+{
+    if (events_subscription_ != 0) {
+        Server::instance()->opencodeEvents().unsubscribe(events_subscription_);
+    }
 }
 
 void Sessions::setupLayout()
 {
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::setupLayout() - Setting up layout";
-    #endif
+    APP_LOG(Debug) << "Sessions::setupLayout() - Setting up layout";
     
     setStyleClass("p-4 h-full");
     setLayout(std::make_unique<Wt::WVBoxLayout>());
     
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::setupLayout() - Layout setup completed";
-    #endif
+    APP_LOG(Debug) << "Sessions::setupLayout() - Layout setup completed";
 }
 
 void Sessions::setupSessionList()
 {
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::setupSessionList() - Setting up session list";
-    #endif
+    APP_LOG(Debug) << "Sessions::setupSessionList() - Setting up session list";
     
     // Title
     title_ = addNew<Wt::WText>("Sessions");
     title_->setStyleClass("text-lg font-bold mb-2");
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::setupSessionList() - Title widget created: " << title_;
-    #endif
+    APP_LOG(Debug) << "Sessions::setupSessionList() - Title widget created: " << title_;
     
     // Session name input
     session_name_edit_ = addNew<Wt::WLineEdit>();
     session_name_edit_->setPlaceholderText("Session name...");
     session_name_edit_->setStyleClass("w-full p-2 border rounded mb-2");
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::setupSessionList() - Session name input created: " << session_name_edit_;
-    #endif
-    
-    // Session list container
-    session_list_ = addNew<Wt::WContainerWidget>();
-    session_list_->setStyleClass("flex-1 w-full border rounded p-2 bg-white overflow-y-auto");
-    session_list_->setLayout(std::make_unique<Wt::WVBoxLayout>());
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::setupSessionList() - Session list container created: " << session_list_;
-    #endif
-    
-    selected_session_ = nullptr;
-    
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::setupSessionList() - Session list setup completed";
-    #endif
+    APP_LOG(Debug) << "Sessions::setupSessionList() - Session name input created: " << session_name_edit_;
+    
+    // Session list: a virtualized view that only renders the visible rows and
+    // recycles them while scrolling, with one click handler for all rows
+    session_model_ = std::make_shared<SessionListModel>();
+    session_view_ = addNew<Wt::WTableView>();
+    session_view_->setModel(session_model_);
+    session_view_->setStyleClass("flex-1 w-full border rounded bg-white dark:bg-gray-900");
+    session_view_->setHeaderHeight(0);
+    session_view_->setRowHeight(36);
+    session_view_->setColumnWidth(0, 280);
+    session_view_->setColumnResizeEnabled(false);
+    session_view_->setAlternatingRowColors(false);
+    session_view_->setSelectionMode(Wt::SelectionMode::None);
+    session_view_->setEditTriggers(Wt::EditTrigger::None);
+    session_view_->setHeight(Wt::WLength(60, Wt::LengthUnit::ViewportHeight));
+    session_view_->clicked().connect([this](const Wt::WModelIndex& index, const Wt::WMouseEvent&) {
+        sessionClicked(index);
+    });
+    APP_LOG(Debug) << "Sessions::setupSessionList() - Session list view created: " << session_view_;
+    
+    APP_LOG(Debug) << "Sessions::setupSessionList() - Session list setup completed";
 }
 
 void Sessions::setupSessionControls()
 {
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::setupSessionControls() - Setting up session controls";
-    #endif
+    APP_LOG(Debug) << "Sessions::setupSessionControls() - Setting up session controls";
     
     // Button container
     auto button_container = addNew<Wt::WContainerWidget>();
     button_container->setLayout(std::make_unique<Wt::WVBoxLayout>());
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::setupSessionControls() - Button container created: " << button_container;
-    #endif
+    APP_LOG(Debug) << "Sessions::setupSessionControls() - Button container created: " << button_container;
     
     // New session button
     new_session_btn_ = button_container->addNew<Wt::WPushButton>("New Session");
     new_session_btn_->setStyleClass("w-full p-2 bg-blue-500 text-white rounded hover:bg-blue-600");
     new_session_btn_->clicked().connect([=]() {
-        #ifdef DEBUG
-        Wt::log("debug") << "Sessions::setupSessionControls() - New Session button clicked";
-        #endif
+        APP_LOG(Debug) << "Sessions::setupSessionControls() - New Session button clicked";
         createNewSession();
     });
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::setupSessionControls() - New session button created: " << new_session_btn_;
-    #endif
+    APP_LOG(Debug) << "Sessions::setupSessionControls() - New session button created: " << new_session_btn_;
     
     // Load session button
     load_session_btn_ = button_container->addNew<Wt::WPushButton>("Load Session");
     load_session_btn_->setStyleClass("w-full p-2 bg-green-500 text-white rounded hover:bg-green-600");
     load_session_btn_->setEnabled(false);
     load_session_btn_->clicked().connect([=]() {
-        #ifdef DEBUG
-        Wt::log("debug") << "Sessions::setupSessionControls() - Load Session button clicked";
-        #endif
+        APP_LOG(Debug) << "Sessions::setupSessionControls() - Load Session button clicked";
         loadSession();
     });
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::setupSessionControls() - Load session button created: " << load_session_btn_;
-    #endif
+    APP_LOG(Debug) << "Sessions::setupSessionControls() - Load session button created: " << load_session_btn_;
     
     // Delete session button
     delete_session_btn_ = button_container->addNew<Wt::WPushButton>("Delete Session");
     delete_session_btn_->setStyleClass("w-full p-2 bg-red-500 text-white rounded hover:bg-red-600");
     delete_session_btn_->setEnabled(false);
     delete_session_btn_->clicked().connect([=]() {
-        #ifdef DEBUG
-        Wt::log("debug") << "Sessions::setupSessionControls() - Delete Session button clicked";
-        #endif
+        APP_LOG(Debug) << "Sessions::setupSessionControls() - Delete Session button clicked";
         deleteSession();
     });
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::setupSessionControls() - Delete session button created: " << delete_session_btn_;
-    #endif
+    APP_LOG(Debug) << "Sessions::setupSessionControls() - Delete session button created: " << delete_session_btn_;
     
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::setupSessionControls() - Session controls setup completed";
-    #endif
+    APP_LOG(Debug) << "Sessions::setupSessionControls() - Session controls setup completed";
 }
 
 void Sessions::refreshSessionList()
 {
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::refreshSessionList() - Refreshing session list";
-    #endif
+    // At most one request in flight, changes meanwhile are picked up by a single follow-up
+    if (refreshing_) {
+        refresh_again_ = true;
+        return;
+    }
+    refreshing_ = true;
+
+    APP_LOG(Debug) << "Sessions::refreshSessionList() - Requesting session list from opencode";
     
-    session_list_->clear();
-    selected_session_ = nullptr;
+    Wt::Core::observing_ptr<Sessions> self(this);
+    Server::instance()->opencodeClient().get("/session", wApp->sessionId(), [self](Response response) {
+        if (!self) {
+            return;
+        }
+        self->refreshing_ = false;
+        if (self->refresh_again_) {
+            self->refresh_again_ = false;
+            self->refreshSessionList();
+            return;
+        }
+        if (!response.ok()) {
+            APP_LOG(Error) << "Sessions::refreshSessionList() - Failed to list sessions: "
+                           << (response.error.empty() ? std::to_string(response.status) : response.error);
+            return;
+        }
+        // Applied as a diff, only changed rows are re-rendered
+        self->session_model_->update(parseSessionList(response.body));
+        if (self->session_model_->rowOf(self->selected_session_id_) < 0) {
+            self->selected_session_id_.clear();
+        }
+        self->session_model_->setSelectedId(self->selected_session_id_);
+        self->sessionSelected();
+        wApp->triggerUpdate();
+    });
+}
+
+void Sessions::sessionClicked(const Wt::WModelIndex& index)
+{
+    if (!index.isValid()) {
+        return;
+    }
     
-    // TODO: Replace with actual database query to get sessions
-    // For now, add some sample sessions
-    std::vector<std::string> session_names = {"Default Session", "Project Alpha", "Experimental"};
+    const SessionInfo& info = session_model_->sessionAt(index.row());
     
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::refreshSessionList() - Adding " << session_names.size() << " sample sessions";
-    #endif
+    APP_LOG(Debug) << "Sessions::sessionClicked() - Session clicked: " << info.id;
     
-    for (const auto& name : session_names) {
-        auto session_btn = session_list_->addNew<Wt::WPushButton>(name);
-        session_btn->setStyleClass("w-full p-2 text-left border rounded mb-1 hover:bg-gray-100");
-        
-        #ifdef DEBUG
-        Wt::log("debug") << "Sessions::refreshSessionList() - Created session button: " << name << " (" << session_btn << ")";
-        #endif
-        
-        session_btn->clicked().connect([=, this]() {
-            #ifdef DEBUG
-            Wt::log("debug") << "Sessions::refreshSessionList() - Session button clicked: " << name;
-            #endif
-            
-            // Deselect previous selection
-            if (selected_session_) {
-                selected_session_->setStyleClass("w-full p-2 text-left border rounded mb-1 hover:bg-gray-100");
-                #ifdef DEBUG
-                Wt::log("debug") << "Sessions::refreshSessionList() - Deselected previous session: " << selected_session_->text().toUTF8();
-                #endif
-            }
-            
-            // Select new session
-            selected_session_ = session_btn;
-            session_btn->setStyleClass("w-full p-2 text-left border rounded mb-1 bg-blue-100 border-blue-300");
-            
-            #ifdef DEBUG
-            Wt::log("debug") << "Sessions::refreshSessionList() - Selected new session: " << name;
-            #endif
-            
-            sessionSelected();
-        });
-    }
-    
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::refreshSessionList() - Session list refresh completed";
-    #endif
+    selected_session_id_ = info.id;
+    session_model_->setSelectedId(selected_session_id_);
+    sessionSelected();
+}
+
+void Sessions::showSession(const std::string& opencode_session_id)
+{
+    APP_LOG(Debug) << "Sessions::showSession() - Showing session: " << opencode_session_id;
+
+    // A session deleted meanwhile is unselected by the next list refresh
+    selected_session_id_ = opencode_session_id;
+    session_model_->setSelectedId(selected_session_id_);
+    sessionSelected();
+    sessionLoaded_.emit(opencode_session_id);
 }
 
 void Sessions::createNewSession()
 {
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::createNewSession() - Creating new session";
-    #endif
+    APP_LOG(Debug) << "Sessions::createNewSession() - Creating new session";
     
     std::string session_name = session_name_edit_->text().toUTF8();
     
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::createNewSession() - Session name: '" << session_name << "'";
-    #endif
+    APP_LOG(Debug) << "Sessions::createNewSession() - Session name: '" << session_name << "'";
     
     if (session_name.empty()) {
-        #ifdef DEBUG
-        Wt::log("debug") << "Sessions::createNewSession() - Session name is empty, showing error";
-        #endif
+        APP_LOG(Debug) << "Sessions::createNewSession() - Session name is empty, showing error";
         
-        auto messageBox = addChild(std::make_unique<Wt::WMessageBox>(
-            "Error", 
-            "Please enter a session name.", 
-            Wt::Icon::Warning, 
-            Wt::StandardButton::Ok
-        ));
-        messageBox->show();
+        showMessage("Error", "Please enter a session name.", Wt::Icon::Warning);
         return;
     }
     
-    // TODO: Add session to database
-    // For now, just add to the list
-    auto session_btn = session_list_->addNew<Wt::WPushButton>(session_name);
-    session_btn->setStyleClass("w-full p-2 text-left border rounded mb-1 hover:bg-gray-100");
+    new_session_btn_->setEnabled(false);
     
-    session_btn->clicked().connect([=, this]() {
-        // Deselect previous selection
-        if (selected_session_) {
-            selected_session_->setStyleClass("w-full p-2 text-left border rounded mb-1 hover:bg-gray-100");
+    nlohmann::json body = {{"title", session_name}};
+    Wt::Core::observing_ptr<Sessions> self(this);
+    Server::instance()->opencodeClient().post("/session", body.dump(), wApp->sessionId(), [self, session_name](Response response) {
+        if (!self) {
+            return;
         }
+        self->new_session_btn_->setEnabled(true);
         
-        // Select new session
-        selected_session_ = session_btn;
-        session_btn->setStyleClass("w-full p-2 text-left border rounded mb-1 bg-blue-100 border-blue-300");
+        if (!response.ok()) {
+            APP_LOG(Error) << "Sessions::createNewSession() - Failed to create session '" << session_name << "': "
+                           << (response.error.empty() ? std::to_string(response.status) : response.error);
+            self->showMessage("Error", "Could not create session '" + session_name + "'.", Wt::Icon::Critical);
+            wApp->triggerUpdate();
+            return;
+        }
+        
+        APP_LOG(Debug) << "Sessions::createNewSession() - Session '" << session_name << "' created successfully";
         
-        sessionSelected();
+        // Clear input field
+        self->session_name_edit_->setText("");
+        self->showMessage("Success", "Session '" + session_name + "' created successfully.", Wt::Icon::Information);
+        self->refreshSessionList();
+        wApp->triggerUpdate();
     });
-    
-    // Clear input field
-    session_name_edit_->setText("");
-    
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::createNewSession() - Session '" << session_name << "' created successfully";
-    #endif
-    
-    // Show success message
-    auto messageBox = addChild(std::make_unique<Wt::WMessageBox>(
-        "Success", 
-        "Session '" + session_name + "' created successfully.", 
-        Wt::Icon::Information, 
-        Wt::StandardButton::Ok
-    ));
-    messageBox->show();
 }
 
 void Sessions::loadSession()
 {
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::loadSession() - Loading session";
-    #endif
-    
-    if (!selected_session_) {
-        #ifdef DEBUG
-        Wt::log("debug") << "Sessions::loadSession() - No session selected, returning";
-        #endif
+    APP_LOG(Debug) << "Sessions::loadSession() - Loading session";
+    
+    if (selected_session_id_.empty()) {
+        APP_LOG(Debug) << "Sessions::loadSession() - No session selected, returning";
         return;
     }
     
-    std::string session_name = selected_session_->text().toUTF8();
-    
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::loadSession() - Loading session: '" << session_name << "'";
-    #endif
-    
-    // TODO: Load session data from database
+    // The session may have been dropped from the list by a refresh meanwhile
+    const SessionInfo* info = session_model_->find(selected_session_id_);
+    std::string session_name = info ? SessionListModel::displayName(*info) : selected_session_id_;
     
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::loadSession() - Session '" << session_name << "' loaded successfully";
-    #endif
+    APP_LOG(Debug) << "Sessions::loadSession() - Loading session: '" << session_name << "'";
     
-    // Show success message
-    auto messageBox = addChild(std::make_unique<Wt::WMessageBox>(
-        "Session Loaded", 
-        "Session '" + session_name + "' loaded successfully.", 
-        Wt::Icon::Information, 
-        Wt::StandardButton::Ok
-    ));
-    messageBox->show();
+    std::string session_id = selected_session_id_;
+    Wt::Core::observing_ptr<Sessions> self(this);
+    Server::instance()->opencodeClient().get("/session/" + Wt::Utils::urlEncode(session_id), wApp->sessionId(), [self, session_id, session_name](Response response) {
+        if (!self) {
+            return;
+        }
+        
+        if (!response.ok()) {
+            APP_LOG(Error) << "Sessions::loadSession() - Failed to load session '" << session_name << "': "
+                           << (response.error.empty() ? std::to_string(response.status) : response.error);
+            self->showMessage("Error", "Could not load session '" + session_name + "'.", Wt::Icon::Critical);
+            wApp->triggerUpdate();
+            return;
+        }
+        
+        APP_LOG(Debug) << "Sessions::loadSession() - Session '" << session_name << "' loaded successfully";
+        
+        self->sessionLoaded_.emit(session_id);
+        wApp->triggerUpdate();
+    });
 }
 
 void Sessions::deleteSession()
 {
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::deleteSession() - Deleting session";
-    #endif
-    
-    if (!selected_session_) {
-        #ifdef DEBUG
-        Wt::log("debug") << "Sessions::deleteSession() - No session selected, returning";
-        #endif
+    APP_LOG(Debug) << "Sessions::deleteSession() - Deleting session";
+    
+    if (selected_session_id_.empty()) {
+        APP_LOG(Debug) << "Sessions::deleteSession() - No session selected, returning";
         return;
     }
     
-    std::string session_name = selected_session_->text().toUTF8();
+    std::string session_id = selected_session_id_;
+    const SessionInfo* info = session_model_->find(session_id);
+    std::string session_name = info ? SessionListModel::displayName(*info) : session_id;
     
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::deleteSession() - Deleting session: '" << session_name << "'";
-    #endif
+    APP_LOG(Debug) << "Sessions::deleteSession() - Deleting session: '" << session_name << "'";
     
     // Show confirmation dialog
     auto messageBox = addChild(std::make_unique<Wt::WMessageBox>(
@@ -314,54 +297,138 @@ void Sessions::deleteSession()
     ));
     
     messageBox->buttonClicked().connect([=](Wt::StandardButton button) {
-        #ifdef DEBUG
-        Wt::log("debug") << "Sessions::deleteSession() - Confirmation dialog result: " << (button == Wt::StandardButton::Yes ? "Yes" : "No");
-        #endif
+        APP_LOG(Debug) << "Sessions::deleteSession() - Confirmation dialog result: " << (button == Wt::StandardButton::Yes ? "Yes" : "No");
         
-        if (button == Wt::StandardButton::Yes) {
-            // TODO: Delete from database
-            
-            #ifdef DEBUG
-            Wt::log("debug") << "Sessions::deleteSession() - Removing session from UI: '" << session_name << "'";
-            #endif
+        if (button != Wt::StandardButton::Yes) {
+            return;
+        }
+        
+        Wt::Core::observing_ptr<Sessions> self(this);
+        Server::instance()->opencodeClient().del("/session/" + Wt::Utils::urlEncode(session_id), wApp->sessionId(), [self, session_id, session_name](Response response) {
+            if (!self) {
+                return;
+            }
             
-            // Remove from list
-            if (selected_session_) {
-                selected_session_->removeFromParent();
-                selected_session_ = nullptr;
+            if (!response.ok()) {
+                APP_LOG(Error) << "Sessions::deleteSession() - Failed to delete session '" << session_name << "': "
+                               << (response.error.empty() ? std::to_string(response.status) : response.error);
+                self->showMessage("Error", "Could not delete session '" + session_name + "'.", Wt::Icon::Critical);
+                wApp->triggerUpdate();
+                return;
             }
             
-            // Disable buttons
-            load_session_btn_->setEnabled(false);
-            delete_session_btn_->setEnabled(false);
+            APP_LOG(Debug) << "Sessions::deleteSession() - Session '" << session_name << "' deleted successfully";
             
-            #ifdef DEBUG
-            Wt::log("debug") << "Sessions::deleteSession() - Session '" << session_name << "' deleted successfully";
-            #endif
-        }
+            self->removeStoredTranscript(session_id);
+
+            // Remove from list
+            self->session_model_->remove(session_id);
+            if (self->selected_session_id_ == session_id) {
+                self->selected_session_id_.clear();
+            }
+            self->sessionSelected();
+            wApp->triggerUpdate();
+        });
     });
     
     messageBox->show();
 }
 
+void Sessions::removeStoredTranscript(const std::string& session_id)
+{
+    Server::instance()->transcriptStore().remove(session_id);
+
+    try {
+        Trace::Span span("Dbo::Transaction", "dbo", "Sessions::removeStoredTranscript");
+        Wt::Dbo::Transaction t(session_);
+        Wt::Dbo::ptr<OpencodeSession> row = session_.find<OpencodeSession>()
+            .where("opencode_id = ?")
+            .bind(session_id);
+        if (row) {
+            row.remove();
+        }
+        t.commit();
+    } catch (const Wt::Dbo::Exception& e) {
+        APP_LOG(Error) << "Sessions::removeStoredTranscript() - Could not remove session row: " << e.what();
+    }
+}
+
+void Sessions::showMessage(const std::string& title, const std::string& text, Wt::Icon icon)
+{
+    auto messageBox = addChild(std::make_unique<Wt::WMessageBox>(
+        title, 
+        text, 
+        icon, 
+        Wt::StandardButton::Ok
+    ));
+    messageBox->buttonClicked().connect([this, messageBox]() {
+        removeChild(messageBox);
+    });
+    messageBox->show();
+}
+
+std::vector<SessionInfo> Sessions::parseSessionList(const std::string& body)
+{
+    std::vector<SessionInfo> sessions;
+    if (!::Opencode::parseSessionList(body, sessions)) {
+        APP_LOG(Error) << "Sessions::parseSessionList() - Malformed session list";
+    }
+    
+    // Most recently updated first
+    std::stable_sort(sessions.begin(), sessions.end(), [](const SessionInfo& a, const SessionInfo& b) {
+        return a.updated > b.updated;
+    });
+    return sessions;
+}
+
 void Sessions::sessionSelected()
 {
-    bool has_selection = (selected_session_ != nullptr);
+    bool has_selection = !selected_session_id_.empty();
     
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::sessionSelected() - Session selection changed. Has selection: " << (has_selection ? "true" : "false");
+    APP_LOG(Debug) << "Sessions::sessionSelected() - Session selection changed. Has selection: " << (has_selection ? "true" : "false");
     if (has_selection) {
-        Wt::log("debug") << "Sessions::sessionSelected() - Selected session: '" << selected_session_->text().toUTF8() << "'";
+        APP_LOG(Debug) << "Sessions::sessionSelected() - Selected session: '" << selected_session_id_ << "'";
     }
-    #endif
     
     load_session_btn_->setEnabled(has_selection);
     delete_session_btn_->setEnabled(has_selection);
     
-    #ifdef DEBUG
-    Wt::log("debug") << "Sessions::sessionSelected() - Load button enabled: " << (has_selection ? "true" : "false");
-    Wt::log("debug") << "Sessions::sessionSelected() - Delete button enabled: " << (has_selection ? "true" : "false");
-    #endif
+    APP_LOG(Debug) << "Sessions::sessionSelected() - Load button enabled: " << (has_selection ? "true" : "false");
+    APP_LOG(Debug) << "Sessions::sessionSelected() - Delete button enabled: " << (has_selection ? "true" : "false");
 }
 
-}
\ No newline at end of file
+void Sessions::subscribeToEvents()
+{
+    APP_LOG(Debug) << "Sessions::subscribeToEvents() - Subscribing to opencode session events";
+
+    // The session list reacts to session.* events of every opencode session,
+    // the streamed message parts of those sessions never reach it. A burst
+    // of them is pushed as one batch and refreshes the list once.
+    events_subscription_ = Server::instance()->opencodeEvents().subscribe(
+        wApp->sessionId(),
+        EventStream::AllSessions,
+        [this](EventBatch batch) { eventsReceived(std::move(batch)); },
+        RefreshWindow,
+        "session.");
+}
+
+void Sessions::eventsReceived(EventBatch batch)
+{
+    APP_LOG(Debug) << "Sessions::eventsReceived() - " << batch.events.size() << " events, dropped: " << batch.dropped << ", resync: " << (batch.resync ? "true" : "false");
+
+    bool list_changed = batch.resync;
+    for (const auto& event : batch.events) {
+        if (event.type == "session.created" ||
+            event.type == "session.updated" ||
+            event.type == "session.deleted") {
+            list_changed = true;
+        }
+    }
+
+    if (list_changed) {
+        refreshSessionList();
+        wApp->triggerUpdate();
+    }
+}
+
+}
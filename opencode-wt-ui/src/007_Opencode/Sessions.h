@@ -6,7 +6,17 @@
 #include <Wt/WText.h>
 #include <Wt/WPushButton.h>
 #include <Wt/WLineEdit.h>
+#include <Wt/WMessageBox.h>
+#include <Wt/WTableView.h>
+#include <Wt/WSignal.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
 #include "002_Dbo/Session.h"
+#include "007_Opencode/Client.h"
+#include "007_Opencode/EventStream.h"
+#include "007_Opencode/SessionListModel.h"
 
 namespace Opencode {
 
@@ -14,6 +24,25 @@ class Sessions : public Wt::WContainerWidget
 {
 public:
     Sessions(Session& session);
+    ~Sessions() override;
+
+    /**
+     * @brief Emitted with the opencode session id once a session was loaded
+     */
+    Wt::Signal<std::string>& sessionLoaded() { return sessionLoaded_; }
+
+    /**
+     * @brief Selects and shows a session known to exist, without asking opencode first
+     */
+    void showSession(const std::string& opencode_session_id);
+
+    /**
+     * @brief Sessions of an opencode /session response, most recently updated first
+     */
+    static std::vector<SessionInfo> parseSessionList(const std::string& body);
+
+    /// Push interval that collapses a burst of session events into one list refresh
+    static constexpr std::chrono::milliseconds RefreshWindow{500};
 
 private:
     void setupLayout();
@@ -24,16 +53,28 @@ private:
     void loadSession();
     void deleteSession();
     void sessionSelected();
+    void sessionClicked(const Wt::WModelIndex& index);
+    void subscribeToEvents();
+    void eventsReceived(EventBatch batch);
+    void removeStoredTranscript(const std::string& session_id);
+    void showMessage(const std::string& title, const std::string& text, Wt::Icon icon);
 
     Session& session_;
     
     Wt::WText* title_;
-    Wt::WContainerWidget* session_list_;
+    Wt::WTableView* session_view_;
+    std::shared_ptr<SessionListModel> session_model_;
     Wt::WPushButton* new_session_btn_;
     Wt::WPushButton* load_session_btn_;
     Wt::WPushButton* delete_session_btn_;
     Wt::WLineEdit* session_name_edit_;
-    Wt::WPushButton* selected_session_;
+    std::string selected_session_id_;
+
+    int events_subscription_ = 0;
+    bool refreshing_ = false;       ///< A /session request is in flight
+    bool refresh_again_ = false;    ///< The list changed while it was, refresh once more
+
+    Wt::Signal<std::string> sessionLoaded_;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,717 @@
+#include "007_Opencode/Transcript.h"
+
+#include <Wt/WApplication.h>
+#include <Wt/WString.h>
+#include <Wt/WWebWidget.h>
+#include <Wt/Utils.h>
+#include <Wt/Core/observing_ptr.hpp>
+#include <Wt/Dbo/Transaction.h>
+#include <Wt/WDateTime.h>
+#include <Wt/WEvent.h>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "000_Server/AsyncLog.h"
+#include "000_Server/Server.h"
+#include "000_Server/Trace.h"
+#include "002_Dbo/Tables/OpencodeSession.h"
+
+namespace Opencode {
+
+namespace {
+
+const std::size_t earlier_page_size = 20;
+const std::size_t tail_page_size = 50;
+const auto prompt_timeout = std::chrono::minutes(10);
+
+bool isRenderedPartType(const std::string& type)
+{
+    return type == "text" || type == "reasoning" || type == "tool";
+}
+
+std::string partStyle(const std::string& type)
+{
+    if (type == "reasoning") {
+        return "block whitespace-pre-wrap break-words italic text-sm text-gray-500 dark:text-gray-400";
+    } else if (type == "tool") {
+        return "block font-mono text-xs text-gray-500 dark:text-gray-400";
+    }
+    return "block whitespace-pre-wrap break-words";
+}
+
+}
+
+Transcript::Transcript(Session& session)
+    : Wt::WContainerWidget(),
+      session_(session)
+{
+    APP_LOG(Debug) << "Transcript::Transcript() - Constructor called";
+
+    setupContent();
+}
+
+Transcript::~Transcript()
+{
+    if (events_subscription_ != 0) {
+        Server::instance()->opencodeEvents().unsubscribe(events_subscription_);
+    }
+}
+
+void Transcript::setupContent()
+{
+    setStyleClass("flex-1 flex flex-col h-full min-w-0 p-4 gap-2");
+
+    earlier_btn_ = addNew<Wt::WPushButton>();
+    earlier_btn_->setStyleClass("self-center text-sm px-3 py-1 rounded border hover:bg-gray-100 dark:hover:bg-gray-800");
+    earlier_btn_->clicked().connect(this, &Transcript::loadEarlierMessages);
+    earlier_btn_->hide();
+
+    messages_container_ = addNew<Wt::WContainerWidget>();
+    messages_container_->setStyleClass("flex-1 overflow-y-auto flex flex-col gap-3");
+
+    auto prompt_wrapper = addNew<Wt::WContainerWidget>();
+    prompt_wrapper->setStyleClass("flex gap-2 items-end");
+
+    prompt_edit_ = prompt_wrapper->addNew<Wt::WTextArea>();
+    prompt_edit_->setPlaceholderText("Ask the agent... (Ctrl+Enter to send)");
+    prompt_edit_->setStyleClass("flex-1 p-2 border rounded resize-none");
+    prompt_edit_->setRows(3);
+    prompt_edit_->setEnabled(false);
+
+    send_btn_ = prompt_wrapper->addNew<Wt::WPushButton>("Send");
+    send_btn_->setStyleClass("px-4 py-2 bg-blue-500 text-white rounded hover:bg-blue-600");
+    send_btn_->setEnabled(false);
+    send_btn_->clicked().connect(this, &Transcript::sendPrompt);
+
+    // Enter keeps its newline (and picks a mention), Ctrl/Cmd+Enter sends
+    prompt_edit_->keyWentDown().connect([this](const Wt::WKeyEvent& e) {
+        if (e.key() == Wt::Key::Enter &&
+            (e.modifiers().test(Wt::KeyboardModifier::Control) || e.modifiers().test(Wt::KeyboardModifier::Meta))) {
+            sendPrompt();
+        }
+    });
+
+    // @-mentions complete workspace file paths, filtered server side on every keystroke
+    mention_model_ = std::make_shared<MentionModel>();
+    mention_popup_ = addChild(std::make_unique<Wt::WSuggestionPopup>(MentionModel::MatcherJS, MentionModel::ReplacerJS));
+    mention_popup_->setModel(mention_model_);
+    // Negative: refilter on every keystroke once "@" plus one character is typed
+    mention_popup_->setFilterLength(-2);
+    mention_popup_->filterModel().connect(mention_model_.get(), &MentionModel::filter);
+    mention_popup_->forEdit(prompt_edit_, Wt::PopupTrigger::Editing);
+}
+
+void Transcript::setLimits(std::size_t max_messages, std::size_t max_bytes)
+{
+    max_messages_ = std::max<std::size_t>(1, max_messages);
+    max_bytes_ = max_bytes;
+    pinned_ = 0;
+    enforceLimits();
+}
+
+void Transcript::refresh()
+{
+    // A full render uses the server side text, which must include the appends
+    syncAppendedText(true);
+    Wt::WContainerWidget::refresh();
+}
+
+void Transcript::setSession(const std::string& opencode_session_id)
+{
+    APP_LOG(Debug) << "Transcript::setSession() - Showing session: '" << opencode_session_id << "'";
+
+    session_id_ = opencode_session_id;
+    clearMessages();
+
+    auto& events = Server::instance()->opencodeEvents();
+    if (events_subscription_ == 0) {
+        events_subscription_ = events.subscribe(
+            wApp->sessionId(),
+            session_id_,
+            [this](EventBatch batch) { eventsReceived(std::move(batch)); },
+            BatchWindow);
+    } else {
+        events.setFilter(events_subscription_, session_id_);
+    }
+
+    bool has_session = !session_id_.empty();
+    prompt_edit_->setEnabled(has_session);
+    send_btn_->setEnabled(has_session);
+
+    if (has_session) {
+        loadHistory();
+    }
+}
+
+void Transcript::clearMessages()
+{
+    messages_container_->clear();
+    messages_.clear();
+    evicted_count_ = 0;
+    pinned_ = 0;
+    retained_bytes_ = 0;
+    ++load_generation_;
+    updateEarlierButton();
+}
+
+void Transcript::loadHistory(bool whole)
+{
+    int generation = ++load_generation_;
+
+    // Show what the local log already has right away; only the visible
+    // window is read from it
+    auto& store = Server::instance()->transcriptStore();
+    std::size_t stored = store.messageCount(session_id_);
+    if (stored > 0 && messages_.empty()) {
+        std::size_t first = stored > max_messages_ ? stored - max_messages_ : 0;
+        showLatest(store.read(session_id_, first, stored - first), stored);
+    }
+
+    // With a local log only the newest page is fetched and matched against
+    // it; the whole list only on the first load, or when more than a page is new
+    bool tail = !whole && stored > 0;
+    std::string path = "/session/" + Wt::Utils::urlEncode(session_id_) + "/message";
+    if (tail) {
+        path += "?limit=" + std::to_string(tail_page_size);
+    }
+
+    Wt::Core::observing_ptr<Transcript> self(this);
+    Server::instance()->opencodeClient().get(
+        path,
+        wApp->sessionId(),
+        [self, generation, tail](Response response) {
+            if (!self || generation != self->load_generation_) {
+                return;
+            }
+            if (!response.ok()) {
+                APP_LOG(Error) << "Transcript::loadHistory() - Failed to load messages: "
+                               << (response.error.empty() ? std::to_string(response.status) : response.error);
+                return;
+            }
+
+            auto messages = parseMessages(response.body);
+            if (tail) {
+                if (!self->showTail(messages)) {
+                    self->loadHistory(true);
+                }
+            } else {
+                self->persistMessages(messages, 0);
+                self->showLatest(messages, messages.size());
+            }
+            wApp->triggerUpdate();
+        });
+}
+
+bool Transcript::showTail(const std::vector<MessageData>& tail)
+{
+    // A short page is the whole history, a long one means the limit was ignored
+    if (tail.size() != tail_page_size) {
+        persistMessages(tail, 0);
+        showLatest(tail, tail.size());
+        return true;
+    }
+
+    // Number the page by finding its first message among the newest stored ones
+    auto& store = Server::instance()->transcriptStore();
+    std::size_t stored = store.messageCount(session_id_);
+    std::size_t from = stored > tail_page_size ? stored - tail_page_size : 0;
+    std::vector<MessageData> known = store.read(session_id_, from, stored - from);
+    auto match = std::find_if(known.begin(), known.end(),
+                              [&tail](const MessageData& m) { return m.id == tail.front().id; });
+    if (match == known.end()) {
+        return false;
+    }
+    std::size_t first = from + static_cast<std::size_t>(match - known.begin());
+    persistMessages(tail, first);
+
+    // The rest of the window comes from the log
+    std::size_t older = std::min(first, max_messages_ > tail.size() ? max_messages_ - tail.size() : 0);
+    std::vector<MessageData> window = store.read(session_id_, first - older, older);
+    window.insert(window.end(), tail.begin(), tail.end());
+    showLatest(window, first + tail.size());
+    return true;
+}
+
+void Transcript::showLatest(const std::vector<MessageData>& messages, std::size_t total)
+{
+    messages_container_->clear();
+    messages_.clear();
+    pinned_ = 0;
+    retained_bytes_ = 0;
+
+    // Only the most recent messages that fit the budget are rendered
+    std::size_t start = messages.size();
+    std::size_t bytes = 0;
+    while (start > 0 && messages.size() - start < max_messages_) {
+        std::size_t size = messageBytes(messages[start - 1]);
+        if (bytes + size > max_bytes_ && start != messages.size()) {
+            break;
+        }
+        bytes += size;
+        --start;
+    }
+    evicted_count_ = total - (messages.size() - start);
+
+    for (std::size_t i = start; i < messages.size(); ++i) {
+        ensureMessage(messages[i].id, messages[i].role);
+        for (const auto& part : messages[i].parts) {
+            updatePart(part, std::string());
+        }
+    }
+
+    markRendered();
+    updateEarlierButton();
+    messages_container_->doJavaScript(
+        messages_container_->jsRef() + ".scrollTop = " + messages_container_->jsRef() + ".scrollHeight;");
+}
+
+void Transcript::loadEarlierMessages()
+{
+    if (evicted_count_ == 0 || session_id_.empty()) {
+        return;
+    }
+
+    std::size_t end = evicted_count_;
+    std::size_t start = end > earlier_page_size ? end - earlier_page_size : 0;
+
+    // Earlier pages come from the local log when it covers them
+    auto& store = Server::instance()->transcriptStore();
+    if (store.messageCount(session_id_) >= end) {
+        insertEarlier(store.read(session_id_, start, end - start), start);
+        return;
+    }
+
+    int generation = load_generation_;
+    Wt::Core::observing_ptr<Transcript> self(this);
+    Server::instance()->opencodeClient().get(
+        "/session/" + Wt::Utils::urlEncode(session_id_) + "/message",
+        wApp->sessionId(),
+        [self, generation](Response response) {
+            if (!self || generation != self->load_generation_ || !response.ok()) {
+                return;
+            }
+
+            auto messages = parseMessages(response.body);
+            self->persistMessages(messages, 0);
+
+            std::size_t end = std::min(self->evicted_count_, messages.size());
+            std::size_t start = end > earlier_page_size ? end - earlier_page_size : 0;
+            self->insertEarlier(std::vector<MessageData>(messages.begin() + start, messages.begin() + end), start);
+            wApp->triggerUpdate();
+        });
+}
+
+void Transcript::insertEarlier(const std::vector<MessageData>& messages, std::size_t first)
+{
+    // Insert newest first at the top, within the byte budget. They stay
+    // pinned, new output does not evict them until the user prompts again.
+    std::size_t inserted = 0;
+    for (std::size_t i = messages.size(); i > 0; --i) {
+        const MessageData& message = messages[i - 1];
+        std::size_t size = messageBytes(message);
+        if (inserted > 0 && retained_bytes_ + size > max_bytes_) {
+            break;
+        }
+        ensureMessage(message.id, message.role, true);
+        for (const auto& part : message.parts) {
+            updatePart(part, std::string());
+        }
+        evicted_count_ = first + i - 1;
+        ++inserted;
+    }
+    pinned_ += inserted;
+
+    markRendered();
+    updateEarlierButton();
+}
+
+void Transcript::persistMessages(const std::vector<MessageData>& messages, std::size_t first)
+{
+    // The newest message may still be streaming, it is stored on a later load
+    if (messages.size() < 2) {
+        return;
+    }
+
+    // Only what follows the log without a gap is stored; the store writes
+    // its blocks once they are full or have waited long enough
+    auto& store = Server::instance()->transcriptStore();
+    std::size_t stored = store.messageCount(session_id_);
+    if (first > stored || stored >= first + messages.size() - 1) {
+        return;
+    }
+
+    std::vector<MessageData> completed(messages.begin() + (stored - first), messages.end() - 1);
+    std::size_t count = store.append(session_id_, stored, completed);
+
+    try {
+        Trace::Span span("Dbo::Transaction", "dbo", "Transcript::persistMessages");
+        Wt::Dbo::Transaction t(session_);
+        Wt::Dbo::ptr<OpencodeSession> row = session_.find<OpencodeSession>()
+            .where("opencode_id = ?")
+            .bind(session_id_);
+        if (!row) {
+            row = session_.add(std::make_unique<OpencodeSession>(session_id_));
+        }
+        OpencodeSession* data = row.modify();
+        data->logFile_ = store.logPath(session_id_);
+        data->logSize_ = static_cast<long long>(store.logSize(session_id_));
+        data->messageCount_ = static_cast<int>(count);
+        data->updated_ = Wt::WDateTime::currentDateTime();
+        t.commit();
+    } catch (const Wt::Dbo::Exception& e) {
+        APP_LOG(Error) << "Transcript::persistMessages() - Could not update session row: " << e.what();
+    }
+
+    APP_LOG(Debug) << "Transcript::persistMessages() - Stored " << completed.size() << " messages, " << count << " in log";
+}
+
+std::size_t Transcript::messageBytes(const MessageData& message)
+{
+    std::size_t size = 0;
+    for (const auto& part : message.parts) {
+        size += part.text.size() + part.old_text.size() + part.new_text.size();
+    }
+    return size;
+}
+
+void Transcript::sendPrompt()
+{
+    std::string text = prompt_edit_->text().toUTF8();
+    if (text.empty() || session_id_.empty()) {
+        return;
+    }
+
+    APP_LOG(Debug) << "Transcript::sendPrompt() - Sending prompt to session '" << session_id_ << "'";
+
+    nlohmann::json body = {
+        {"parts", nlohmann::json::array({{{"type", "text"}, {"text", text}}})}
+    };
+
+    prompt_edit_->setText("");
+    pinned_ = 0;
+    send_btn_->setEnabled(false);
+
+    // The request completes when the agent has finished answering; the
+    // answer itself arrives through the event stream while it is produced.
+    Wt::Core::observing_ptr<Transcript> self(this);
+    Server::instance()->opencodeClient().post(
+        "/session/" + Wt::Utils::urlEncode(session_id_) + "/message",
+        body.dump(),
+        wApp->sessionId(),
+        [self](Response response) {
+            if (!self) {
+                return;
+            }
+            if (!response.ok()) {
+                APP_LOG(Error) << "Transcript::sendPrompt() - Prompt failed: "
+                               << (response.error.empty() ? std::to_string(response.status) : response.error);
+            }
+            self->send_btn_->setEnabled(!self->session_id_.empty());
+            wApp->triggerUpdate();
+        },
+        prompt_timeout);
+}
+
+void Transcript::eventsReceived(EventBatch batch)
+{
+    if (batch.resync) {
+        // Events were lost (reconnect or slow consumer): reload the window
+        APP_LOG(Debug) << "Transcript::eventsReceived() - Resync, dropped " << batch.dropped << " events";
+        loadHistory();
+        return;
+    }
+
+    // Coalesce the batch: consecutive deltas of a part are merged into one
+    // append, a full update of a part supersedes its earlier deltas.
+    struct PendingPart {
+        const PartData* part;
+        std::string delta;
+    };
+    std::vector<PendingPart> pending;
+    std::unordered_map<std::string, std::size_t> pending_index;
+
+    auto flush = [&]() {
+        for (const auto& item : pending) {
+            updatePart(*item.part, item.delta);
+        }
+        pending.clear();
+        pending_index.clear();
+    };
+
+    for (const auto& event : batch.events) {
+        if (!event.payload) {
+            continue;
+        }
+        const EventPayload& payload = *event.payload;
+
+        if (event.type == "session.deleted") {
+            setSession(std::string());
+            return;
+        } else if (event.type == "message.part.updated" && payload.has_part) {
+            auto it = pending_index.find(payload.part.id);
+            if (it == pending_index.end()) {
+                pending_index.emplace(payload.part.id, pending.size());
+                pending.push_back({&payload.part, payload.delta});
+            } else {
+                PendingPart& item = pending[it->second];
+                item.delta = payload.delta.empty() ? std::string() : item.delta + payload.delta;
+                item.part = &payload.part;
+            }
+        } else if (event.type == "message.updated") {
+            ensureMessage(payload.message_id, payload.role.empty() ? std::string("assistant") : payload.role);
+        } else if (event.type == "message.removed") {
+            flush();
+            removeMessage(payload.message_id);
+        } else if (event.type == "message.part.removed") {
+            flush();
+            removePart(payload.message_id, payload.part_id);
+        }
+    }
+    flush();
+
+    syncAppendedText(false);
+    enforceLimits();
+    markRendered();
+
+    // Follow the output if the user is at the bottom of the transcript
+    messages_container_->doJavaScript(
+        "var e = " + messages_container_->jsRef() + ";"
+        "if (e.scrollHeight - e.scrollTop - e.clientHeight < 200) e.scrollTop = e.scrollHeight;");
+    wApp->triggerUpdate();
+}
+
+Transcript::MessageView& Transcript::ensureMessage(const std::string& id, const std::string& role, bool at_front)
+{
+    if (MessageView* existing = findMessage(id)) {
+        if (!role.empty() && existing->role != role) {
+            existing->role = role;
+        }
+        return *existing;
+    }
+
+    std::unique_ptr<Wt::WContainerWidget> widget = std::make_unique<Wt::WContainerWidget>();
+    widget->setStyleClass(role == "user"
+        ? "self-end max-w-[80%] rounded-lg px-3 py-2 bg-blue-100 dark:bg-blue-900"
+        : "self-start max-w-full rounded-lg px-3 py-2 bg-gray-100 dark:bg-gray-800");
+
+    MessageView view;
+    view.id = id;
+    view.role = role;
+    if (at_front) {
+        view.widget = messages_container_->insertWidget(0, std::move(widget));
+        messages_.push_front(std::move(view));
+        return messages_.front();
+    }
+    view.widget = messages_container_->addWidget(std::move(widget));
+    messages_.push_back(std::move(view));
+    return messages_.back();
+}
+
+Transcript::MessageView* Transcript::findMessage(const std::string& id)
+{
+    // Updates almost always target the newest messages
+    for (auto it = messages_.rbegin(); it != messages_.rend(); ++it) {
+        if (it->id == id) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+void Transcript::removeMessage(const std::string& id)
+{
+    auto it = std::find_if(messages_.begin(), messages_.end(), [&](const MessageView& m) { return m.id == id; });
+    if (it == messages_.end()) {
+        return;
+    }
+    if (static_cast<std::size_t>(it - messages_.begin()) < pinned_) {
+        --pinned_;
+    }
+    retained_bytes_ -= it->bytes;
+    messages_container_->removeWidget(it->widget);
+    messages_.erase(it);
+}
+
+void Transcript::updatePart(const PartData& part, const std::string& delta)
+{
+    if (part.id.empty() || part.message_id.empty() || !isRenderedPartType(part.type)) {
+        return;
+    }
+
+    MessageView& message = ensureMessage(part.message_id, std::string());
+    auto view = std::find_if(message.parts.begin(), message.parts.end(),
+                             [&](const PartView& p) { return p.id == part.id; });
+    if (view == message.parts.end()) {
+        message.parts.emplace_back();
+        PartView& created = message.parts.back();
+        created.id = part.id;
+        created.type = part.type;
+        renderPart(message, created, part);
+        return;
+    }
+
+    if (part.type == "tool") {
+        renderPart(message, *view, part);
+        return;
+    }
+
+    // The delta extends exactly what the browser already shows: append it
+    if (!delta.empty() && view->rendered && view->bytes + delta.size() == part.text.size()) {
+        appendText(message, *view, delta);
+        return;
+    }
+
+    if (view->bytes != part.text.size() || !view->rendered) {
+        renderPart(message, *view, part);
+    }
+}
+
+void Transcript::removePart(const std::string& message_id, const std::string& part_id)
+{
+    MessageView* message = findMessage(message_id);
+    if (!message) {
+        return;
+    }
+    auto view = std::find_if(message->parts.begin(), message->parts.end(),
+                             [&](const PartView& p) { return p.id == part_id; });
+    if (view == message->parts.end()) {
+        return;
+    }
+    message->bytes -= view->bytes;
+    retained_bytes_ -= view->bytes;
+    message->widget->removeWidget(view->text);
+    if (view->diff) {
+        message->widget->removeWidget(view->diff);
+    }
+    message->parts.erase(view);
+}
+
+void Transcript::renderPart(MessageView& message, PartView& view, const PartData& part)
+{
+    std::string text = part.type == "tool" ? partLabel(part) : part.text;
+    if (!view.text) {
+        view.text = message.widget->addNew<Wt::WText>();
+        view.text->setTextFormat(Wt::TextFormat::Plain);
+        view.text->setStyleClass(partStyle(part.type));
+    }
+    view.text->setText(Wt::WString::fromUTF8(text));
+    view.appended.clear();
+    std::size_t bytes = text.size();
+
+    // Completed file edits show their diff below the tool label
+    if (part.tool == "edit" && part.status == "completed" && !view.diff &&
+        (!part.old_text.empty() || !part.new_text.empty())) {
+        auto diff = std::make_unique<DiffView>();
+        diff->setDiff(part.file_path, part.old_text, part.new_text);
+        view.diff = message.widget->insertWidget(message.widget->indexOf(view.text) + 1, std::move(diff));
+    }
+    if (view.diff) {
+        bytes += part.old_text.size() + part.new_text.size();
+    }
+
+    message.bytes = message.bytes - view.bytes + bytes;
+    retained_bytes_ = retained_bytes_ - view.bytes + bytes;
+    view.bytes = bytes;
+}
+
+void Transcript::appendText(MessageView& message, PartView& view, const std::string& delta)
+{
+    // Only the new text travels to the browser. The WText catches up once
+    // the part stops streaming, see syncAppendedText().
+    view.text->doJavaScript(
+        view.text->jsRef() + ".appendChild(document.createTextNode(" +
+        Wt::WWebWidget::jsStringLiteral(delta) + "));");
+    view.appended += delta;
+    view.streaming = true;
+
+    view.bytes += delta.size();
+    message.bytes += delta.size();
+    retained_bytes_ += delta.size();
+}
+
+void Transcript::syncAppendedText(bool all)
+{
+    // Parts that got no delta in this batch paused or finished streaming:
+    // their WText takes over the appended text, re-sent to the browser once
+    for (auto& message : messages_) {
+        for (auto& part : message.parts) {
+            if (!part.appended.empty() && (all || !part.streaming)) {
+                part.text->setText(Wt::WString::fromUTF8(part.text->text().toUTF8() + part.appended));
+                part.appended.clear();
+            }
+            part.streaming = false;
+        }
+    }
+}
+
+void Transcript::enforceLimits()
+{
+    // Pinned messages do not count against the budget
+    std::size_t pinned_bytes = 0;
+    for (std::size_t i = 0; i < pinned_ && i < messages_.size(); ++i) {
+        pinned_bytes += messages_[i].bytes;
+    }
+
+    // Always keep the newest message, even if it alone exceeds the budget
+    bool evicted = false;
+    while (messages_.size() > 1 &&
+           (messages_.size() > max_messages_ + pinned_ || retained_bytes_ > max_bytes_ + pinned_bytes)) {
+        MessageView& oldest = messages_.front();
+        retained_bytes_ -= oldest.bytes;
+        if (pinned_ > 0) {
+            --pinned_;
+            pinned_bytes -= oldest.bytes;
+        }
+        messages_container_->removeWidget(oldest.widget);
+        messages_.pop_front();
+        ++evicted_count_;
+        evicted = true;
+    }
+    if (evicted) {
+        updateEarlierButton();
+    }
+}
+
+void Transcript::updateEarlierButton()
+{
+    if (evicted_count_ == 0) {
+        earlier_btn_->hide();
+        return;
+    }
+    earlier_btn_->setText("Show " + std::to_string(std::min(evicted_count_, earlier_page_size)) +
+                          " earlier messages (" + std::to_string(evicted_count_) + " hidden)");
+    earlier_btn_->show();
+}
+
+void Transcript::markRendered()
+{
+    for (auto& message : messages_) {
+        for (auto& part : message.parts) {
+            part.rendered = true;
+        }
+    }
+}
+
+std::vector<MessageData> Transcript::parseMessages(const std::string& body)
+{
+    std::vector<MessageData> messages;
+    if (!parseMessageList(body, messages)) {
+        APP_LOG(Error) << "Transcript::parseMessages() - Malformed message list";
+    }
+    for (auto& message : messages) {
+        if (message.role.empty()) {
+            message.role = "assistant";
+        }
+    }
+    return messages;
+}
+
+std::string Transcript::partLabel(const PartData& part)
+{
+    return "⚙ " + part.tool + (part.status.empty() ? "" : " (" + part.status + ")");
+}
+
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Wt/WContainerWidget.h>
+#include <Wt/WPushButton.h>
+#include <Wt/WSuggestionPopup.h>
+#include <Wt/WText.h>
+#include <Wt/WTextArea.h>
+
+#include "002_Dbo/Session.h"
+#include "007_Opencode/DiffView.h"
+#include "007_Opencode/EventStream.h"
+#include "007_Opencode/MentionModel.h"
+#include "007_Opencode/Payloads.h"
+
+namespace Opencode {
+
+/**
+ * @brief Streaming transcript of one opencode session
+ *
+ * Message parts are appended incrementally as their deltas arrive from the
+ * shared EventStream: token chunks are coalesced into ~30 ms batches per
+ * push and only the new text is sent to the browser. Old messages are
+ * dropped from the widget tree once the session exceeds its message or
+ * byte budget, and can be reloaded from opencode on demand.
+ */
+class Transcript : public Wt::WContainerWidget
+{
+public:
+    explicit Transcript(Session& session);
+    ~Transcript() override;
+
+    /**
+     * @brief Shows the given opencode session, loading its recent history
+     * @param opencode_session_id Session to display, empty to clear
+     */
+    void setSession(const std::string& opencode_session_id);
+
+    /**
+     * @brief Opencode session currently shown
+     */
+    const std::string& sessionId() const { return session_id_; }
+
+    /**
+     * @brief Limits on what is kept in the widget tree
+     * @param max_messages Maximum number of rendered messages
+     * @param max_bytes Maximum bytes of rendered message text
+     */
+    void setLimits(std::size_t max_messages, std::size_t max_bytes);
+
+    /**
+     * @brief Bytes of message text currently held by the rendered messages
+     */
+    std::size_t retainedBytes() const { return retained_bytes_; }
+
+    /**
+     * @brief Moves text appended client side into the widgets before a full render
+     */
+    void refresh() override;
+
+    /// Push interval used to coalesce streamed token chunks
+    static constexpr std::chrono::milliseconds BatchWindow{30};
+
+private:
+    struct PartView {
+        std::string id;
+        std::string type;
+        Wt::WText* text = nullptr;
+        DiffView* diff = nullptr;  ///< Diff of a completed file edit
+        std::size_t bytes = 0;
+        bool rendered = false;  ///< Sent to the browser, further text is appended client side
+        std::string appended;   ///< Text appended client side, not yet in the WText
+        bool streaming = false; ///< Text was appended in the current batch
+    };
+
+    struct MessageView {
+        std::string id;
+        std::string role;
+        Wt::WContainerWidget* widget = nullptr;
+        std::vector<PartView> parts;
+        std::size_t bytes = 0;
+    };
+
+    void setupContent();
+    void clearMessages();
+    void loadHistory(bool whole = false);
+    bool showTail(const std::vector<MessageData>& tail);
+    void showLatest(const std::vector<MessageData>& messages, std::size_t total);
+    void loadEarlierMessages();
+    void insertEarlier(const std::vector<MessageData>& messages, std::size_t first);
+    void persistMessages(const std::vector<MessageData>& messages, std::size_t first);
+    void sendPrompt();
+
+    void eventsReceived(EventBatch batch);
+    MessageView& ensureMessage(const std::string& id, const std::string& role, bool at_front = false);
+    MessageView* findMessage(const std::string& id);
+    void removeMessage(const std::string& id);
+    void updatePart(const PartData& part, const std::string& delta);
+    void removePart(const std::string& message_id, const std::string& part_id);
+    void renderPart(MessageView& message, PartView& view, const PartData& part);
+    void appendText(MessageView& message, PartView& view, const std::string& delta);
+    void syncAppendedText(bool all);
+    void enforceLimits();
+    void updateEarlierButton();
+    void markRendered();
+
+    static std::vector<MessageData> parseMessages(const std::string& body);
+    static std::string partLabel(const PartData& part);
+    static std::size_t messageBytes(const MessageData& message);
+
+    Session& session_;
+
+    std::string session_id_;
+    int events_subscription_ = 0;
+    int load_generation_ = 0;
+
+    Wt::WPushButton* earlier_btn_ = nullptr;
+    Wt::WContainerWidget* messages_container_ = nullptr;
+    Wt::WTextArea* prompt_edit_ = nullptr;
+    Wt::WPushButton* send_btn_ = nullptr;
+    Wt::WSuggestionPopup* mention_popup_ = nullptr;
+    std::shared_ptr<MentionModel> mention_model_;
+
+    std::deque<MessageView> messages_;  ///< Rendered messages, oldest first
+    std::size_t evicted_count_ = 0;     ///< Older messages not in the widget tree
+    std::size_t pinned_ = 0;            ///< Oldest messages, loaded on request and kept out of eviction
+    std::size_t retained_bytes_ = 0;
+    std::size_t max_messages_ = 100;
+    std::size_t max_bytes_ = 2 * 1024 * 1024;
+};
+
+}
@@ -0,0 +1,532 @@
+#include "007_Opencode/TranscriptStore.h"
+
+#include <Wt/WLogger.h>
+
+#include <zstd.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+namespace Opencode {
+
+namespace {
+
+const int compression_level = 3;
+
+std::uint32_t checksum(const char* data, std::size_t size)
+{
+    std::uint32_t hash = 2166136261u;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+    }
+    return hash;
+}
+
+void putU32(std::string& out, std::uint32_t value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void putString(std::string& out, const std::string& value)
+{
+    putU32(out, static_cast<std::uint32_t>(value.size()));
+    out += value;
+}
+
+bool getU32(const char*& it, const char* end, std::uint32_t& value)
+{
+    if (end - it < static_cast<std::ptrdiff_t>(sizeof(value))) {
+        return false;
+    }
+    std::memcpy(&value, it, sizeof(value));
+    it += sizeof(value);
+    return true;
+}
+
+bool getString(const char*& it, const char* end, std::string& value)
+{
+    std::uint32_t size = 0;
+    if (!getU32(it, end, size) || end - it < static_cast<std::ptrdiff_t>(size)) {
+        return false;
+    }
+    value.assign(it, size);
+    it += size;
+    return true;
+}
+
+bool writeAll(int fd, const char* data, std::size_t size, off_t offset)
+{
+    while (size > 0) {
+        ssize_t written = ::pwrite(fd, data, size, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+        offset += written;
+    }
+    return true;
+}
+
+}
+
+bool TranscriptStore::MappedFile::remap(std::size_t new_size)
+{
+    if (data) {
+        ::munmap(const_cast<char*>(data), size);
+        data = nullptr;
+    }
+    size = new_size;
+    if (size == 0) {
+        return true;
+    }
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        size = 0;
+        return false;
+    }
+    data = static_cast<const char*>(mapped);
+    return true;
+}
+
+void TranscriptStore::MappedFile::close()
+{
+    remap(0);
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+TranscriptStore::Log::~Log()
+{
+    log.close();
+    index.close();
+}
+
+TranscriptStore::TranscriptStore(std::string directory)
+    : directory_(std::move(directory))
+{
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    if (ec) {
+        Wt::log("error") << "Opencode::TranscriptStore - cannot create " << directory_ << ": " << ec.message();
+    }
+}
+
+TranscriptStore::~TranscriptStore()
+{
+    flushAll();
+}
+
+bool TranscriptStore::validId(const std::string& session_id)
+{
+    return !session_id.empty() && session_id.size() <= 128 &&
+           std::all_of(session_id.begin(), session_id.end(), [](char c) {
+               return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-';
+           });
+}
+
+std::string TranscriptStore::logPath(const std::string& session_id) const
+{
+    return validId(session_id) ? directory_ + "/" + session_id + ".log" : std::string();
+}
+
+std::shared_ptr<TranscriptStore::Log> TranscriptStore::open(const std::string& session_id)
+{
+    if (!validId(session_id)) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = logs_.find(session_id);
+    if (it != logs_.end()) {
+        if (!it->second->broken) {
+            it->second->used = std::chrono::steady_clock::now();
+            return it->second;
+        }
+        // Its files are intact up to the last complete block, read them again
+        logs_.erase(it);
+    }
+    if (logs_.size() >= MaxOpenLogs) {
+        evictIdle(MaxOpenLogs - 1, std::chrono::steady_clock::duration::zero());
+    }
+
+    auto log = std::make_shared<Log>();
+    std::string base = directory_ + "/" + session_id;
+    log->log.fd = ::open((base + ".log").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    log->index.fd = ::open((base + ".idx").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (log->log.fd < 0 || log->index.fd < 0) {
+        Wt::log("error") << "Opencode::TranscriptStore - cannot open " << base << ": " << std::strerror(errno);
+        return nullptr;
+    }
+
+    if (!recover(*log)) {
+        return nullptr;
+    }
+
+    log->used = std::chrono::steady_clock::now();
+    logs_.emplace(session_id, log);
+    return log;
+}
+
+void TranscriptStore::evictIdle(std::size_t keep, std::chrono::steady_clock::duration idle)
+{
+    // Called with mutex_ held. Only logs nobody holds are closed: a Log is
+    // handed out under mutex_, so a use count of one cannot change meanwhile.
+    auto now = std::chrono::steady_clock::now();
+    while (logs_.size() > keep) {
+        auto oldest = logs_.end();
+        for (auto it = logs_.begin(); it != logs_.end(); ++it) {
+            if (it->second.use_count() == 1 && now - it->second->used >= idle &&
+                (oldest == logs_.end() || it->second->used < oldest->second->used)) {
+                oldest = it;
+            }
+        }
+        if (oldest == logs_.end()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> log_lock(oldest->second->mutex);
+            writeBlock(*oldest->second);
+        }
+        logs_.erase(oldest);
+    }
+}
+
+bool TranscriptStore::recover(Log& log)
+{
+    struct stat log_stat;
+    struct stat index_stat;
+    if (::fstat(log.log.fd, &log_stat) != 0 || ::fstat(log.index.fd, &index_stat) != 0) {
+        return false;
+    }
+    if (!log.log.remap(static_cast<std::size_t>(log_stat.st_size)) ||
+        !log.index.remap(static_cast<std::size_t>(index_stat.st_size))) {
+        Wt::log("error") << "Opencode::TranscriptStore - mmap failed: " << std::strerror(errno);
+        return false;
+    }
+
+    // Keep the longest prefix of blocks that are complete and intact; a
+    // crash during a write leaves at most one torn block at the end.
+    std::size_t total = log.index.size / sizeof(IndexEntry);
+    std::size_t valid = 0;
+    std::uint64_t end = 0;
+    std::uint64_t count = 0;
+    for (; valid < total; ++valid) {
+        IndexEntry entry;
+        std::memcpy(&entry, log.index.data + valid * sizeof(IndexEntry), sizeof(entry));
+        if (entry.offset != end || entry.first != count || entry.offset + entry.size > log.log.size ||
+            checksum(log.log.data + entry.offset, entry.size) != entry.checksum) {
+            break;
+        }
+        end += entry.size;
+        count += entry.count;
+    }
+
+    if (valid != total || log.index.size != valid * sizeof(IndexEntry) || log.log.size != end) {
+        Wt::log("warning") << "Opencode::TranscriptStore - truncating damaged log after " << count << " messages";
+        if (::ftruncate(log.index.fd, static_cast<off_t>(valid * sizeof(IndexEntry))) != 0 ||
+            ::ftruncate(log.log.fd, static_cast<off_t>(end)) != 0) {
+            return false;
+        }
+        if (!log.log.remap(end) || !log.index.remap(valid * sizeof(IndexEntry))) {
+            return false;
+        }
+    }
+
+    log.flushed_count = count;
+    return true;
+}
+
+const TranscriptStore::IndexEntry* TranscriptStore::entries(const Log& log) const
+{
+    return reinterpret_cast<const IndexEntry*>(log.index.data);
+}
+
+std::size_t TranscriptStore::entryCount(const Log& log) const
+{
+    return log.index.size / sizeof(IndexEntry);
+}
+
+std::size_t TranscriptStore::messageCount(const std::string& session_id)
+{
+    auto log = open(session_id);
+    if (!log) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(log->mutex);
+    return log->flushed_count + log->pending.size();
+}
+
+std::uint64_t TranscriptStore::logSize(const std::string& session_id)
+{
+    auto log = open(session_id);
+    if (!log) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(log->mutex);
+    return log->log.size;
+}
+
+std::size_t TranscriptStore::append(const std::string& session_id, std::size_t first, const std::vector<MessageData>& messages)
+{
+    auto log = open(session_id);
+    if (!log) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(log->mutex);
+    std::size_t count = log->flushed_count + log->pending.size();
+    if (first > count || log->broken) {
+        return count;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    for (std::size_t i = count - first; i < messages.size(); ++i) {
+        std::string record;
+        encode(messages[i], record);
+        if (log->pending.empty()) {
+            log->pending_since = now;
+        }
+        log->pending_bytes += record.size();
+        log->pending.push_back(std::move(record));
+
+        if (log->pending.size() >= BlockRecords || log->pending_bytes >= BlockBytes) {
+            writeBlock(*log);
+        }
+    }
+    if (!log->pending.empty() && now - log->pending_since >= FlushAfter) {
+        writeBlock(*log);
+    }
+    return log->flushed_count + log->pending.size();
+}
+
+void TranscriptStore::writeBlock(Log& log)
+{
+    if (log.pending.empty() || log.broken) {
+        return;
+    }
+
+    std::string raw;
+    raw.reserve(log.pending_bytes + log.pending.size() * sizeof(std::uint32_t));
+    for (const auto& record : log.pending) {
+        putString(raw, record);
+    }
+
+    std::string compressed(ZSTD_compressBound(raw.size()), '\0');
+    std::size_t size = ZSTD_compress(compressed.data(), compressed.size(), raw.data(), raw.size(), compression_level);
+    if (ZSTD_isError(size)) {
+        Wt::log("error") << "Opencode::TranscriptStore - compression failed: " << ZSTD_getErrorName(size);
+        return;
+    }
+
+    IndexEntry entry;
+    entry.offset = log.log.size;
+    entry.first = log.flushed_count;
+    entry.size = static_cast<std::uint32_t>(size);
+    entry.raw_size = static_cast<std::uint32_t>(raw.size());
+    entry.count = static_cast<std::uint32_t>(log.pending.size());
+    entry.checksum = checksum(compressed.data(), size);
+
+    // Block first, then its index entry: an entry never points past the log
+    std::size_t index_size = log.index.size;
+    if (!writeAll(log.log.fd, compressed.data(), size, static_cast<off_t>(entry.offset)) ||
+        !writeAll(log.index.fd, reinterpret_cast<const char*>(&entry), sizeof(entry), static_cast<off_t>(index_size))) {
+        Wt::log("error") << "Opencode::TranscriptStore - write failed: " << std::strerror(errno);
+        return;
+    }
+
+    if (!log.log.remap(entry.offset + size) || !log.index.remap(index_size + sizeof(entry))) {
+        // The block and its entry are on disk, only the maps are gone. Nothing
+        // is counted here: the next open() recovers the log from its files.
+        Wt::log("error") << "Opencode::TranscriptStore - mmap failed: " << std::strerror(errno);
+        log.broken = true;
+        return;
+    }
+
+    log.flushed_count += log.pending.size();
+    log.pending.clear();
+    log.pending_bytes = 0;
+}
+
+std::vector<MessageData> TranscriptStore::read(const std::string& session_id, std::size_t first, std::size_t count)
+{
+    std::vector<MessageData> messages;
+    auto log = open(session_id);
+    if (!log) {
+        return messages;
+    }
+
+    std::lock_guard<std::mutex> lock(log->mutex);
+    if (log->broken) {
+        return messages;
+    }
+    std::size_t total = log->flushed_count + log->pending.size();
+    std::size_t end = std::min(total, first + count);
+    if (first >= end) {
+        return messages;
+    }
+    messages.reserve(end - first);
+
+    // Blocks covering [first, end): the last block starting at or before first
+    const IndexEntry* begin_entry = entries(*log);
+    const IndexEntry* end_entry = begin_entry + entryCount(*log);
+    const IndexEntry* entry = std::upper_bound(begin_entry, end_entry, first,
+        [](std::size_t number, const IndexEntry& e) { return number < e.first; });
+    if (entry != begin_entry) {
+        --entry;
+    }
+
+    std::string raw;
+    std::size_t number = first;
+    for (; entry != end_entry && number < end; ++entry) {
+        raw.resize(entry->raw_size);
+        std::size_t size = ZSTD_decompress(raw.data(), raw.size(), log->log.data + entry->offset, entry->size);
+        if (ZSTD_isError(size) || size != entry->raw_size) {
+            Wt::log("error") << "Opencode::TranscriptStore - corrupt block at " << entry->offset << " in " << session_id;
+            return messages;
+        }
+
+        const char* it = raw.data();
+        const char* block_end = raw.data() + raw.size();
+        for (std::size_t n = entry->first; n < entry->first + entry->count && number < end; ++n) {
+            std::uint32_t record_size = 0;
+            if (!getU32(it, block_end, record_size) || block_end - it < static_cast<std::ptrdiff_t>(record_size)) {
+                return messages;
+            }
+            const char* record = it;
+            it += record_size;
+            if (n < number) {
+                continue;
+            }
+            MessageData message;
+            if (!decode(record, it, message)) {
+                return messages;
+            }
+            messages.push_back(std::move(message));
+            ++number;
+        }
+    }
+
+    // The tail that has not been written as a block yet
+    for (; number < end; ++number) {
+        const std::string& record = log->pending[number - log->flushed_count];
+        const char* it = record.data();
+        MessageData message;
+        if (!decode(it, record.data() + record.size(), message)) {
+            break;
+        }
+        messages.push_back(std::move(message));
+    }
+    return messages;
+}
+
+void TranscriptStore::flush(const std::string& session_id)
+{
+    auto log = open(session_id);
+    if (log) {
+        std::lock_guard<std::mutex> lock(log->mutex);
+        writeBlock(*log);
+    }
+}
+
+void TranscriptStore::flushAll()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [id, log] : logs_) {
+        std::lock_guard<std::mutex> log_lock(log->mutex);
+        writeBlock(*log);
+    }
+}
+
+void TranscriptStore::maintain()
+{
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [id, log] : logs_) {
+        std::lock_guard<std::mutex> log_lock(log->mutex);
+        if (!log->pending.empty() && now - log->pending_since >= FlushAfter) {
+            writeBlock(*log);
+        }
+    }
+    evictIdle(0, IdleAfter);
+}
+
+void TranscriptStore::remove(const std::string& session_id)
+{
+    if (!validId(session_id)) {
+        return;
+    }
+
+    std::shared_ptr<Log> log;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = logs_.find(session_id);
+        if (it != logs_.end()) {
+            log = it->second;
+            logs_.erase(it);
+        }
+    }
+    if (log) {
+        std::lock_guard<std::mutex> lock(log->mutex);
+        log->log.close();
+        log->index.close();
+    }
+
+    std::string base = directory_ + "/" + session_id;
+    ::unlink((base + ".log").c_str());
+    ::unlink((base + ".idx").c_str());
+}
+
+void TranscriptStore::encode(const MessageData& message, std::string& out)
+{
+    putString(out, message.id);
+    putString(out, message.role);
+    putU32(out, static_cast<std::uint32_t>(message.parts.size()));
+    for (const auto& part : message.parts) {
+        putString(out, part.id);
+        putString(out, part.message_id);
+        putString(out, part.session_id);
+        putString(out, part.type);
+        putString(out, part.text);
+        putString(out, part.tool);
+        putString(out, part.status);
+        putString(out, part.file_path);
+        putString(out, part.old_text);
+        putString(out, part.new_text);
+    }
+}
+
+bool TranscriptStore::decode(const char*& it, const char* end, MessageData& message)
+{
+    std::uint32_t parts = 0;
+    if (!getString(it, end, message.id) || !getString(it, end, message.role) || !getU32(it, end, parts) ||
+        parts > static_cast<std::size_t>(end - it) / (10 * sizeof(std::uint32_t))) {
+        return false;
+    }
+    message.parts.resize(parts);
+    for (auto& part : message.parts) {
+        if (!getString(it, end, part.id) || !getString(it, end, part.message_id) ||
+            !getString(it, end, part.session_id) || !getString(it, end, part.type) ||
+            !getString(it, end, part.text) || !getString(it, end, part.tool) ||
+            !getString(it, end, part.status) || !getString(it, end, part.file_path) ||
+            !getString(it, end, part.old_text) || !getString(it, end, part.new_text)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "007_Opencode/Payloads.h"
+
+namespace Opencode {
+
+/**
+ * @brief Append-only on-disk transcript log, one per opencode session
+ *
+ * Messages are appended as records to `<directory>/<session>.log` in
+ * zstd-compressed blocks of a few dozen records. `<session>.idx` holds one
+ * fixed-size entry per block (offset, sizes, first message number), so a
+ * window of messages is read by decompressing only the blocks covering it.
+ * Both files are read through `mmap`; records not yet filling a block are
+ * kept in memory until the block is full, FlushAfter has passed, or flush().
+ * At most MaxOpenLogs logs keep their files open, and maintain() closes the
+ * ones unused for IdleAfter, so the descriptors stay bounded however many
+ * sessions the server has seen.
+ *
+ * Shared by all UI sessions, all methods are thread safe.
+ */
+class TranscriptStore {
+public:
+    explicit TranscriptStore(std::string directory);
+    ~TranscriptStore();
+
+    TranscriptStore(const TranscriptStore&) = delete;
+    TranscriptStore& operator=(const TranscriptStore&) = delete;
+
+    /**
+     * @brief Number of messages stored for the session, including unflushed ones
+     */
+    std::size_t messageCount(const std::string& session_id);
+
+    /**
+     * @brief Bytes of compressed blocks written to the session log
+     */
+    std::uint64_t logSize(const std::string& session_id);
+
+    /**
+     * @brief Stores messages, skipping the ones already in the log
+     * @param first Message number of messages[0]; nothing is stored if it
+     *              would leave a gap after the last stored message
+     * @return New message count
+     */
+    std::size_t append(const std::string& session_id, std::size_t first, const std::vector<MessageData>& messages);
+
+    /**
+     * @brief Reads up to count messages starting at message number first
+     */
+    std::vector<MessageData> read(const std::string& session_id, std::size_t first, std::size_t count);
+
+    /**
+     * @brief Writes out pending records of one session, or of all sessions
+     */
+    void flush(const std::string& session_id);
+    void flushAll();
+
+    /**
+     * @brief Writes out records pending for FlushAfter and closes logs idle for IdleAfter
+     *
+     * Called periodically by the server.
+     */
+    void maintain();
+
+    /**
+     * @brief Deletes the log of a session
+     */
+    void remove(const std::string& session_id);
+
+    /**
+     * @brief Path of the log file of a session, empty if the id is not a valid file name
+     */
+    std::string logPath(const std::string& session_id) const;
+
+    /// Block is compressed once it holds this many records...
+    static constexpr std::size_t BlockRecords = 32;
+    /// ...or this many uncompressed bytes
+    static constexpr std::size_t BlockBytes = 256 * 1024;
+    /// ...or its oldest record waited this long
+    static constexpr std::chrono::seconds FlushAfter{30};
+
+    /// Logs whose files are kept open
+    static constexpr std::size_t MaxOpenLogs = 64;
+    /// A log not used for this long is closed by maintain()
+    static constexpr std::chrono::minutes IdleAfter{5};
+
+private:
+    struct IndexEntry {
+        std::uint64_t offset;      ///< Start of the block in the log
+        std::uint64_t first;       ///< Number of the first message in the block
+        std::uint32_t size;        ///< Compressed size
+        std::uint32_t raw_size;    ///< Uncompressed size
+        std::uint32_t count;       ///< Messages in the block
+        std::uint32_t checksum;    ///< FNV-1a of the compressed bytes
+    };
+
+    struct MappedFile {
+        int fd = -1;
+        const char* data = nullptr;
+        std::size_t size = 0;
+
+        bool remap(std::size_t new_size);
+        void close();
+    };
+
+    struct Log {
+        ~Log();
+
+        std::mutex mutex;
+        MappedFile log;
+        MappedFile index;
+        std::size_t flushed_count = 0;          ///< Messages in written blocks
+        std::vector<std::string> pending;       ///< Encoded records not yet in a block
+        std::size_t pending_bytes = 0;
+        std::chrono::steady_clock::time_point pending_since;  ///< When the oldest pending record was added
+        std::chrono::steady_clock::time_point used;           ///< Last open(), guarded by the store mutex
+        std::atomic<bool> broken{false};        ///< Maps lost after a write, reopened from disk by open()
+    };
+
+    std::shared_ptr<Log> open(const std::string& session_id);
+    void evictIdle(std::size_t keep, std::chrono::steady_clock::duration idle);
+    bool recover(Log& log);
+    void writeBlock(Log& log);
+    const IndexEntry* entries(const Log& log) const;
+    std::size_t entryCount(const Log& log) const;
+
+    static bool validId(const std::string& session_id);
+    static void encode(const MessageData& message, std::string& out);
+    static bool decode(const char*& it, const char* end, MessageData& message);
+
+    std::string directory_;
+    std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<Log>> logs_;
+};
+
+}
@@ -0,0 +1,322 @@
+#include "008_Workspace/CollabDocuments.h"
+#include "000_Server/AsyncLog.h"
+#include "000_Server/Metrics.h"
+
+#include <Wt/WIOService.h>
+#include <Wt/WServer.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace Workspace {
+
+namespace {
+
+bool validPath(const std::string& path)
+{
+    if (path.empty() || path.front() == '/') {
+        return false;
+    }
+    std::size_t start = 0;
+    while (start <= path.size()) {
+        std::size_t end = path.find('/', start);
+        if (end == std::string::npos) {
+            end = path.size();
+        }
+        std::string part = path.substr(start, end - start);
+        if (part.empty() || part == "." || part == "..") {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+}
+
+CollabDocuments::CollabDocuments(Wt::WServer& server, std::string root)
+    : server_(server),
+      root_(std::move(root))
+{
+}
+
+CollabDocuments::~CollabDocuments()
+{
+    persistAll();
+}
+
+CollabDocuments::Joined CollabDocuments::join(const std::string& path, const std::string& wt_session_id, Handler handler)
+{
+    Joined joined;
+    if (!validPath(path)) {
+        return joined;
+    }
+
+    // Not while a snapshot is being written, the file could still be the old one
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = documents_.find(path);
+    if (it == documents_.end()) {
+        std::ifstream file(root_ + "/" + path, std::ios::binary);
+        if (!file) {
+            APP_LOG(Error) << "Workspace::CollabDocuments - cannot read " << path;
+            return joined;
+        }
+        std::ostringstream content;
+        content << file.rdbuf();
+        it = documents_.emplace(path, Document()).first;
+        it->second.text = TextOperation::fromUtf8(content.str());
+    }
+
+    Document& document = it->second;
+    joined.subscription_id = next_subscription_id_++;
+    joined.revision = document.revision;
+    joined.text = TextOperation::toUtf8(document.text);
+    document.subscribers.insert(joined.subscription_id);
+
+    Subscriber& subscriber = subscribers_[joined.subscription_id];
+    subscriber.wt_session_id = wt_session_id;
+    subscriber.path = path;
+    subscriber.handler = std::move(handler);
+    APP_LOG(Debug) << "CollabDocuments::join() - " << path << " at revision " << document.revision
+                   << ", " << document.subscribers.size() << " editor(s)";
+    return joined;
+}
+
+void CollabDocuments::leave(int subscription_id)
+{
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = subscribers_.find(subscription_id);
+        if (it == subscribers_.end()) {
+            return;
+        }
+        path = it->second.path;
+        subscribers_.erase(it);
+
+        auto document = documents_.find(path);
+        if (document == documents_.end()) {
+            return;
+        }
+        document->second.subscribers.erase(subscription_id);
+        if (!document->second.subscribers.empty()) {
+            return;
+        }
+        if (!document->second.dirty) {
+            documents_.erase(document);
+            return;
+        }
+    }
+    // The last editor left: write the document out, which also unloads it
+    persist(path);
+}
+
+void CollabDocuments::submit(int subscription_id, std::uint64_t revision, const TextOperation& operation)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = subscribers_.find(subscription_id);
+    if (it == subscribers_.end()) {
+        return;
+    }
+    Subscriber& author = it->second;
+    Document& document = documents_[author.path];
+
+    // Bring the edit up to the current revision
+    std::uint64_t oldest = document.revision - document.history.size();
+    TextOperation transformed = operation;
+    bool valid = revision <= document.revision && revision >= oldest;
+    for (std::uint64_t r = revision; valid && r < document.revision; ++r) {
+        TextOperation concurrent_prime;
+        TextOperation next;
+        valid = TextOperation::transform(transformed, document.history[r - oldest], next, concurrent_prime);
+        transformed = std::move(next);
+    }
+    if (!valid || !transformed.apply(document.text)) {
+        APP_LOG(Error) << "Workspace::CollabDocuments - rejected edit of " << author.path << " on revision "
+                       << revision << " (now " << document.revision << "), resyncing the session";
+        enqueue(subscription_id, author, resetEvent(document));
+        return;
+    }
+
+    if (!transformed.isNoop()) {
+        broadcast(document, transformed, subscription_id);
+        document.dirty = true;
+        if (!document.persist_scheduled) {
+            document.persist_scheduled = true;
+            std::string path = author.path;
+            server_.ioService().schedule(SnapshotInterval, [this, path]() { persist(path); });
+        }
+    }
+    enqueue(subscription_id, author, nlohmann::json({{"a", document.revision}}).dump());
+}
+
+void CollabDocuments::persist(const std::string& path)
+{
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    std::string text;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = documents_.find(path);
+        if (it == documents_.end()) {
+            return;
+        }
+        Document& document = it->second;
+        document.persist_scheduled = false;
+        if (!document.dirty) {
+            return;
+        }
+        document.dirty = false;
+        text = TextOperation::toUtf8(document.text);
+        if (document.subscribers.empty()) {
+            documents_.erase(it);
+        }
+    }
+    writeFile(path, text);
+}
+
+void CollabDocuments::persistAll()
+{
+    std::vector<std::string> paths;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [path, document] : documents_) {
+            if (document.dirty) {
+                paths.push_back(path);
+            }
+        }
+    }
+    for (const std::string& path : paths) {
+        persist(path);
+    }
+}
+
+std::string CollabDocuments::text(const std::string& path)
+{
+    if (!validPath(path)) {
+        return {};
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = documents_.find(path);
+        if (it != documents_.end()) {
+            return TextOperation::toUtf8(it->second.text);
+        }
+    }
+    std::ifstream file(root_ + "/" + path, std::ios::binary);
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+bool CollabDocuments::replace(const std::string& path, const std::string& text)
+{
+    if (!validPath(path)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = documents_.find(path);
+        if (it != documents_.end()) {
+            Document& document = it->second;
+            TextOperation operation;
+            operation.remove(document.text.size());
+            operation.insert(TextOperation::fromUtf8(text));
+            operation.apply(document.text);
+            broadcast(document, operation, 0);
+            // Written below
+            document.dirty = false;
+        }
+    }
+    return writeFile(path, text);
+}
+
+void CollabDocuments::broadcast(Document& document, const TextOperation& operation, int author)
+{
+    // Called with mutex_ held, after operation was applied; author is the
+    // subscription that made the edit, 0 for none
+    ++document.revision;
+    document.history.push_back(operation);
+    if (document.history.size() > HistoryLimit) {
+        document.history.pop_front();
+    }
+
+    nlohmann::json remote = {{"r", document.revision}, {"o", operation.toJson()}};
+    std::string event = remote.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+    for (int id : document.subscribers) {
+        if (id != author) {
+            enqueue(id, subscribers_[id], event);
+        }
+    }
+}
+
+bool CollabDocuments::writeFile(const std::string& path, const std::string& text)
+{
+    // Written aside and renamed, so readers never see a partial file
+    std::string file_path = root_ + "/" + path;
+    std::string temporary = file_path + ".collab.tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.write(text.data(), static_cast<std::streamsize>(text.size()))) {
+            APP_LOG(Error) << "Workspace::CollabDocuments - cannot write " << temporary;
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), file_path.c_str()) != 0) {
+        APP_LOG(Error) << "Workspace::CollabDocuments - cannot replace " << file_path << ": " << std::strerror(errno);
+        std::remove(temporary.c_str());
+        return false;
+    }
+    APP_LOG(Debug) << "CollabDocuments::writeFile() - wrote " << path << " (" << text.size() << " bytes)";
+    return true;
+}
+
+std::string CollabDocuments::resetEvent(const Document& document) const
+{
+    nlohmann::json reset = {{"s", document.revision}, {"t", TextOperation::toUtf8(document.text)}};
+    return reset.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+void CollabDocuments::enqueue(int subscription_id, Subscriber& subscriber, std::string event)
+{
+    // Called with mutex_ held
+    subscriber.queue.push_back(std::move(event));
+    if (subscriber.post_pending) {
+        return;
+    }
+    subscriber.post_pending = true;
+    server_.schedule(FrameInterval, subscriber.wt_session_id,
+                     Metrics::trackPush(Metrics::PushSource::CollabDocuments, [this, subscription_id]() { drain(subscription_id); }));
+}
+
+void CollabDocuments::drain(int subscription_id)
+{
+    std::string events;
+    Handler handler;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = subscribers_.find(subscription_id);
+        if (it == subscribers_.end()) {
+            return;
+        }
+        Subscriber& subscriber = it->second;
+        subscriber.post_pending = false;
+        events = "[";
+        for (std::size_t i = 0; i < subscriber.queue.size(); ++i) {
+            if (i > 0) {
+                events += ',';
+            }
+            events += subscriber.queue[i];
+        }
+        events += ']';
+        subscriber.queue.clear();
+        handler = subscriber.handler;
+    }
+    handler(std::move(events));
+}
+
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "008_Workspace/TextOperation.h"
+
+namespace Wt {
+    class WServer;
+}
+
+namespace Workspace {
+
+/**
+ * @brief Workspace files edited by several sessions at once
+ *
+ * Each open file is held in memory with a revision number and the recent
+ * operations. An edit is submitted against the revision its author last
+ * saw, transformed against the operations accepted since, applied, and
+ * forwarded to the other editors of the file; its author gets an ack. Events
+ * for a session are collected for one frame and pushed together as a JSON
+ * array of:
+ *   {"a":rev}          ack of the session's own edit, now at rev
+ *   {"r":rev,"o":op}   edit of another session, producing rev
+ *   {"s":rev,"t":text} full text, sent when the session fell out of step
+ * Dirty documents are written back to their file a few seconds after an
+ * edit, on save, and when the last editor leaves.
+ */
+class CollabDocuments {
+public:
+    using Handler = std::function<void(std::string events)>;
+
+    struct Joined {
+        int subscription_id = 0;  ///< 0 if the file could not be read
+        std::uint64_t revision = 0;
+        std::string text;
+    };
+
+    /**
+     * @param root Workspace root the document paths are relative to
+     */
+    CollabDocuments(Wt::WServer& server, std::string root);
+    ~CollabDocuments();
+
+    CollabDocuments(const CollabDocuments&) = delete;
+    CollabDocuments& operator=(const CollabDocuments&) = delete;
+
+    /**
+     * @brief Starts editing a workspace file from a session
+     * @param path Workspace relative path
+     * @param handler Called on the session thread with each batch of events
+     */
+    Joined join(const std::string& path, const std::string& wt_session_id, Handler handler);
+    void leave(int subscription_id);
+
+    /**
+     * @brief Submits an edit made on the given revision of the document
+     */
+    void submit(int subscription_id, std::uint64_t revision, const TextOperation& operation);
+
+    /**
+     * @brief Writes a document to its file now if it has unwritten edits
+     */
+    void persist(const std::string& path);
+    void persistAll();
+
+    /**
+     * @brief Current text of a file, from memory while it is being edited
+     */
+    std::string text(const std::string& path);
+
+    /**
+     * @brief Replaces the whole text of a file, e.g. with a past revision
+     *
+     * Editors of the file receive the replacement like any other edit.
+     */
+    bool replace(const std::string& path, const std::string& text);
+
+    /// Events arriving within this window are pushed together
+    static constexpr std::chrono::milliseconds FrameInterval{16};
+    /// Delay between an edit and the snapshot written to disk
+    static constexpr std::chrono::seconds SnapshotInterval{2};
+    /// Operations kept to transform edits made on older revisions
+    static constexpr std::size_t HistoryLimit = 1000;
+
+private:
+    struct Document {
+        std::u16string text;
+        std::uint64_t revision = 0;
+        std::deque<TextOperation> history;  ///< Operations producing the last history.size() revisions
+        std::set<int> subscribers;
+        bool dirty = false;
+        bool persist_scheduled = false;
+    };
+
+    struct Subscriber {
+        std::string wt_session_id;
+        std::string path;
+        Handler handler;
+        std::vector<std::string> queue;
+        bool post_pending = false;
+    };
+
+    void enqueue(int subscription_id, Subscriber& subscriber, std::string event);
+    void drain(int subscription_id);
+    std::string resetEvent(const Document& document) const;
+    void broadcast(Document& document, const TextOperation& operation, int author);
+    bool writeFile(const std::string& path, const std::string& text);
+
+    Wt::WServer& server_;
+    std::string root_;
+
+    std::mutex mutex_;
+    std::map<std::string, Document> documents_;
+    std::map<int, Subscriber> subscribers_;
+    int next_subscription_id_ = 1;
+
+    std::mutex write_mutex_;  ///< Orders snapshot writes of the same document
+};
+
+}
@@ -0,0 +1,502 @@
+#include "008_Workspace/FileIndex.h"
+#include "000_Server/Metrics.h"
+
+#include <Wt/WLogger.h>
+#include <Wt/WServer.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iterator>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Workspace {
+
+namespace {
+
+/// Saves within the same second must still look modified
+std::int64_t modifiedTime(const struct stat& st)
+{
+    return static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+constexpr std::uint32_t WatchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+                                  | IN_CLOSE_WRITE | IN_ATTRIB | IN_ONLYDIR;
+
+/// Quiet period after the last inotify event before changes are applied
+constexpr std::chrono::milliseconds Debounce(50);
+/// Upper bound on how long a steady stream of events can delay an update
+constexpr std::chrono::milliseconds MaxDelay(500);
+
+std::string join(const std::string& directory, const std::string& name)
+{
+    return directory.empty() ? name : directory + "/" + name;
+}
+
+bool below(const std::string& path, const std::string& directory)
+{
+    return directory.empty()
+        || (path.size() > directory.size() && path[directory.size()] == '/' && path.compare(0, directory.size(), directory) == 0);
+}
+
+}
+
+Snapshot::Snapshot(std::string root, std::vector<FileEntry> entries, std::uint64_t version)
+    : root_(std::move(root)),
+      entries_(std::move(entries)),
+      version_(version)
+{
+}
+
+bool Snapshot::pathLess(const std::string& a, const std::string& b)
+{
+    // '/' sorts before every other character, so "a/b" < "a-b" < "a0"
+    // and a directory's subtree is never interleaved with its siblings
+    std::size_t size = std::min(a.size(), b.size());
+    for (std::size_t i = 0; i < size; ++i) {
+        if (a[i] != b[i]) {
+            if (a[i] == '/') {
+                return true;
+            }
+            if (b[i] == '/') {
+                return false;
+            }
+            return static_cast<unsigned char>(a[i]) < static_cast<unsigned char>(b[i]);
+        }
+    }
+    return a.size() < b.size();
+}
+
+const FileEntry* Snapshot::find(const std::string& path) const
+{
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), path,
+                               [](const FileEntry& entry, const std::string& key) { return pathLess(entry.path, key); });
+    return it != entries_.end() && it->path == path ? &*it : nullptr;
+}
+
+std::vector<const FileEntry*> Snapshot::files(const std::string& directory, const std::vector<std::string>& extensions) const
+{
+    std::vector<const FileEntry*> result;
+    auto it = directory.empty()
+        ? entries_.begin()
+        : std::upper_bound(entries_.begin(), entries_.end(), directory,
+                           [](const std::string& key, const FileEntry& entry) { return pathLess(key, entry.path); });
+
+    for (; it != entries_.end() && below(it->path, directory); ++it) {
+        if (it->directory) {
+            continue;
+        }
+        if (!extensions.empty()) {
+            std::size_t dot = it->path.find_last_of("./");
+            if (dot == std::string::npos || it->path[dot] != '.') {
+                continue;
+            }
+            std::string extension = it->path.substr(dot + 1);
+            std::transform(extension.begin(), extension.end(), extension.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            if (std::find(extensions.begin(), extensions.end(), extension) == extensions.end()) {
+                continue;
+            }
+        }
+        result.push_back(&*it);
+    }
+    return result;
+}
+
+FileIndex::FileIndex(Wt::WServer& server, std::string root, std::set<std::string> ignored)
+    : server_(server),
+      root_(std::move(root)),
+      ignored_(std::move(ignored))
+{
+    while (root_.size() > 1 && root_.back() == '/') {
+        root_.pop_back();
+    }
+    snapshot_ = std::make_shared<const Snapshot>(root_, std::vector<FileEntry>(), 0);
+}
+
+FileIndex::~FileIndex()
+{
+    stop();
+}
+
+const std::set<std::string>& FileIndex::defaultIgnored()
+{
+    static const std::set<std::string> names = {
+        ".git", ".cache", "node_modules", "build", "_gate_build", "opencode-transcripts"
+    };
+    return names;
+}
+
+void FileIndex::start()
+{
+    if (running_) {
+        return;
+    }
+
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotify_fd_ < 0 || wake_fd_ < 0) {
+        Wt::log("error") << "Workspace::FileIndex - inotify unavailable: " << std::strerror(errno);
+    }
+
+    // Watches go in before the walk so nothing created meanwhile is missed
+    auto begin = std::chrono::steady_clock::now();
+    addWatch("");
+    std::vector<FileEntry> entries = walk("");
+    watchTree(entries, "");
+    publish(std::move(entries));
+
+    Wt::log("info") << "Workspace::FileIndex - indexed " << snapshot()->entries().size() << " entries under " << root_
+                    << " in " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count()
+                    << " ms";
+
+    if (inotify_fd_ >= 0 && wake_fd_ >= 0) {
+        running_ = true;
+        watcher_ = std::thread(&FileIndex::watchLoop, this);
+    }
+}
+
+void FileIndex::stop()
+{
+    if (running_.exchange(false)) {
+        std::uint64_t one = 1;
+        if (::write(wake_fd_, &one, sizeof(one)) < 0) {
+            Wt::log("error") << "Workspace::FileIndex - cannot wake watcher: " << std::strerror(errno);
+        }
+    }
+    if (watcher_.joinable()) {
+        watcher_.join();
+    }
+    if (inotify_fd_ >= 0) {
+        ::close(inotify_fd_);
+        inotify_fd_ = -1;
+    }
+    if (wake_fd_ >= 0) {
+        ::close(wake_fd_);
+        wake_fd_ = -1;
+    }
+    watches_.clear();
+}
+
+SnapshotPtr FileIndex::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    return snapshot_;
+}
+
+int FileIndex::subscribe(const std::string& wt_session_id, Handler handler)
+{
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    int id = next_subscription_id_++;
+    subscribers_[id] = Subscriber{wt_session_id, std::move(handler)};
+    return id;
+}
+
+void FileIndex::unsubscribe(int subscription_id)
+{
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    subscribers_.erase(subscription_id);
+}
+
+int FileIndex::listen(Listener listener)
+{
+    std::lock_guard<std::mutex> lock(listeners_mutex_);
+    int id = next_listener_id_++;
+    listeners_[id] = std::move(listener);
+    return id;
+}
+
+void FileIndex::unlisten(int listener_id)
+{
+    std::lock_guard<std::mutex> lock(listeners_mutex_);
+    listeners_.erase(listener_id);
+}
+
+bool FileIndex::ignored(const std::string& name) const
+{
+    return ignored_.count(name) != 0;
+}
+
+std::string FileIndex::absolute(const std::string& relative) const
+{
+    return relative.empty() ? root_ : root_ + "/" + relative;
+}
+
+bool FileIndex::stat(const std::string& relative, FileEntry& entry) const
+{
+    struct stat st;
+    if (::lstat(absolute(relative).c_str(), &st) != 0) {
+        return false;
+    }
+    entry.path = relative;
+    entry.directory = S_ISDIR(st.st_mode);
+    entry.size = entry.directory ? 0 : static_cast<std::uint64_t>(st.st_size);
+    entry.modified = modifiedTime(st);
+    return true;
+}
+
+std::vector<FileEntry> FileIndex::walk(const std::string& relative)
+{
+    // Directories are handed out to a small pool of threads through a shared
+    // queue; each thread collects its own entries, merged and sorted at the end
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::string> pending{relative};
+    std::size_t busy = 0;
+    std::vector<std::vector<FileEntry>> found;
+
+    auto worker = [&](std::vector<FileEntry>& out) {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait(lock, [&]() { return !pending.empty() || busy == 0; });
+            if (pending.empty()) {
+                return;
+            }
+            std::string directory = std::move(pending.front());
+            pending.pop_front();
+            ++busy;
+            lock.unlock();
+
+            std::vector<std::string> subdirectories;
+            if (DIR* dir = ::opendir(absolute(directory).c_str())) {
+                int fd = ::dirfd(dir);
+                while (dirent* item = ::readdir(dir)) {
+                    if (std::strcmp(item->d_name, ".") == 0 || std::strcmp(item->d_name, "..") == 0 || ignored(item->d_name)) {
+                        continue;
+                    }
+                    struct stat st;
+                    if (::fstatat(fd, item->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                        continue;
+                    }
+                    FileEntry entry;
+                    entry.path = join(directory, item->d_name);
+                    entry.directory = S_ISDIR(st.st_mode);
+                    entry.size = entry.directory ? 0 : static_cast<std::uint64_t>(st.st_size);
+                    entry.modified = modifiedTime(st);
+                    if (entry.directory) {
+                        subdirectories.push_back(entry.path);
+                    }
+                    out.push_back(std::move(entry));
+                }
+                ::closedir(dir);
+            }
+
+            lock.lock();
+            for (std::string& subdirectory : subdirectories) {
+                pending.push_back(std::move(subdirectory));
+            }
+            --busy;
+            wake.notify_all();
+        }
+    };
+
+    unsigned threads = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+    found.resize(threads);
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i) {
+        pool.emplace_back(worker, std::ref(found[i]));
+    }
+    worker(found[0]);
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+
+    std::vector<FileEntry> entries;
+    for (std::vector<FileEntry>& part : found) {
+        std::move(part.begin(), part.end(), std::back_inserter(entries));
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const FileEntry& a, const FileEntry& b) { return Snapshot::pathLess(a.path, b.path); });
+    return entries;
+}
+
+void FileIndex::addWatch(const std::string& relative)
+{
+    if (inotify_fd_ < 0) {
+        return;
+    }
+    int wd = inotify_add_watch(inotify_fd_, absolute(relative).c_str(), WatchMask);
+    if (wd < 0) {
+        Wt::log("warning") << "Workspace::FileIndex - cannot watch " << absolute(relative) << ": " << std::strerror(errno);
+        return;
+    }
+    watches_[wd] = relative;
+}
+
+void FileIndex::watchTree(const std::vector<FileEntry>& entries, const std::string& relative)
+{
+    for (const FileEntry& entry : entries) {
+        if (entry.directory && below(entry.path, relative)) {
+            addWatch(entry.path);
+        }
+    }
+}
+
+void FileIndex::watchLoop()
+{
+    alignas(inotify_event) char buffer[64 * 1024];
+    std::set<std::string> changed;
+    bool rescan = false;
+    std::chrono::steady_clock::time_point first_event;
+
+    while (running_) {
+        bool waiting = !changed.empty() || rescan;
+        int timeout = -1;
+        if (waiting) {
+            auto now = std::chrono::steady_clock::now();
+            timeout = static_cast<int>(std::min(Debounce, std::chrono::duration_cast<std::chrono::milliseconds>(first_event + MaxDelay - now)).count());
+            timeout = std::max(timeout, 0);
+        }
+
+        pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+        int ready = ::poll(fds, 2, timeout);
+        if (ready < 0 && errno != EINTR) {
+            Wt::log("error") << "Workspace::FileIndex - poll failed: " << std::strerror(errno);
+            break;
+        }
+        if (!running_) {
+            break;
+        }
+
+        bool quiet = ready == 0;
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            ssize_t size;
+            while ((size = ::read(inotify_fd_, buffer, sizeof(buffer))) > 0) {
+                for (char* p = buffer; p < buffer + size;) {
+                    const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                    p += sizeof(inotify_event) + event->len;
+
+                    if (event->mask & IN_Q_OVERFLOW) {
+                        rescan = true;
+                        continue;
+                    }
+                    auto watch = watches_.find(event->wd);
+                    if (watch == watches_.end()) {
+                        continue;
+                    }
+                    if (event->mask & IN_IGNORED) {
+                        watches_.erase(watch);
+                        continue;
+                    }
+                    if (event->len == 0 || ignored(event->name)) {
+                        continue;
+                    }
+                    changed.insert(join(watch->second, event->name));
+                }
+            }
+            if (!waiting && (!changed.empty() || rescan)) {
+                first_event = std::chrono::steady_clock::now();
+            }
+        }
+
+        bool overdue = (!changed.empty() || rescan) && std::chrono::steady_clock::now() - first_event >= MaxDelay;
+        if ((quiet || overdue) && (!changed.empty() || rescan)) {
+            applyChanges(changed, rescan);
+            changed.clear();
+            rescan = false;
+        }
+    }
+}
+
+void FileIndex::applyChanges(const std::set<std::string>& changed, bool rescan)
+{
+    if (rescan) {
+        Wt::log("warning") << "Workspace::FileIndex - inotify queue overflow, rescanning " << root_;
+        std::vector<FileEntry> entries = walk("");
+        watchTree(entries, "");
+        publish(std::move(entries));
+        return;
+    }
+
+    // Copy-on-write: the published snapshot stays untouched for its readers
+    std::vector<FileEntry> entries = snapshot()->entries();
+    std::vector<FileEntry> added;
+    auto less = [](const FileEntry& a, const FileEntry& b) { return Snapshot::pathLess(a.path, b.path); };
+
+    for (const std::string& path : changed) {
+        // Drop the path and, for a directory, its whole subtree
+        FileEntry key;
+        key.path = path;
+        auto first = std::lower_bound(entries.begin(), entries.end(), key, less);
+        auto last = first;
+        while (last != entries.end() && (last->path == path || below(last->path, path))) {
+            ++last;
+        }
+        entries.erase(first, last);
+
+        FileEntry entry;
+        if (!stat(path, entry)) {
+            continue;
+        }
+        if (entry.directory) {
+            // A new or moved-in directory: index and watch everything below it
+            addWatch(path);
+            std::vector<FileEntry> subtree = walk(path);
+            watchTree(subtree, path);
+            std::move(subtree.begin(), subtree.end(), std::back_inserter(added));
+        }
+        added.push_back(std::move(entry));
+    }
+
+    std::sort(added.begin(), added.end(), less);
+    std::vector<FileEntry> merged;
+    merged.reserve(entries.size() + added.size());
+    std::merge(std::make_move_iterator(entries.begin()), std::make_move_iterator(entries.end()),
+               std::make_move_iterator(added.begin()), std::make_move_iterator(added.end()),
+               std::back_inserter(merged), less);
+    merged.erase(std::unique(merged.begin(), merged.end(),
+                             [](const FileEntry& a, const FileEntry& b) { return a.path == b.path; }),
+                 merged.end());
+
+#ifdef DEBUG
+    Wt::log("debug") << "Workspace::FileIndex::applyChanges() - " << changed.size() << " changed paths, " << merged.size() << " entries";
+#endif
+    publish(std::move(merged));
+}
+
+void FileIndex::publish(std::vector<FileEntry> entries)
+{
+    SnapshotPtr snapshot;
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        snapshot = std::make_shared<const Snapshot>(root_, std::move(entries), ++version_);
+        snapshot_ = snapshot;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(listeners_mutex_);
+        for (const auto& [id, listener] : listeners_) {
+            listener(snapshot);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    for (const auto& [id, subscriber] : subscribers_) {
+        int subscription_id = id;
+        server_.post(subscriber.session_id, Metrics::trackPush(Metrics::PushSource::FileIndex, [this, subscription_id, snapshot]() {
+            Handler handler;
+            {
+                std::lock_guard<std::mutex> lock(subscribers_mutex_);
+                auto it = subscribers_.find(subscription_id);
+                if (it == subscribers_.end()) {
+                    return;
+                }
+                handler = it->second.handler;
+            }
+            handler(snapshot);
+        }));
+    }
+}
+
+}
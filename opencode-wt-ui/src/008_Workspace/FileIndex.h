@@ -0,0 +1,164 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Wt {
+    class WServer;
+}
+
+namespace Workspace {
+
+/**
+ * @brief A file or directory of the workspace
+ */
+struct FileEntry {
+    std::string path;        ///< Relative to the workspace root, '/' separated
+    bool directory = false;
+    std::uint64_t size = 0;
+    std::int64_t modified = 0;  ///< mtime, nanoseconds since the epoch
+
+    /// Name of the entry, the last path component
+    std::string name() const { return path.substr(path.find_last_of('/') + 1); }
+};
+
+/**
+ * @brief Immutable view of the workspace at one point in time
+ *
+ * Entries are sorted so that every directory is directly followed by its
+ * whole subtree. Snapshots are shared between sessions and never change;
+ * an update publishes a new snapshot.
+ */
+class Snapshot {
+public:
+    Snapshot(std::string root, std::vector<FileEntry> entries, std::uint64_t version);
+
+    const std::string& root() const { return root_; }
+    const std::vector<FileEntry>& entries() const { return entries_; }
+    std::uint64_t version() const { return version_; }
+
+    /**
+     * @brief Entry with the given relative path, nullptr if absent
+     */
+    const FileEntry* find(const std::string& path) const;
+
+    /**
+     * @brief Files below a directory ("" for the root) with one of the extensions
+     * @param extensions Lower case extensions without the dot, empty for all files
+     */
+    std::vector<const FileEntry*> files(const std::string& directory, const std::vector<std::string>& extensions = {}) const;
+
+    /// Orders paths so that a directory's subtree follows it contiguously
+    static bool pathLess(const std::string& a, const std::string& b);
+
+private:
+    std::string root_;
+    std::vector<FileEntry> entries_;
+    std::uint64_t version_;
+};
+
+using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+/**
+ * @brief Process-wide index of the files under a workspace root
+ *
+ * The tree is walked once by a pool of threads, then kept current with
+ * inotify: changes are debounced, applied to a copy of the current
+ * snapshot and published atomically. Sessions read snapshot() without
+ * touching the file system and are notified of new snapshots on their
+ * own session thread.
+ */
+class FileIndex {
+public:
+    using Handler = std::function<void(SnapshotPtr)>;
+    using Listener = std::function<void(const SnapshotPtr&)>;
+
+    /**
+     * @param server Used to post change notifications to sessions
+     * @param root Workspace root directory
+     * @param ignored Directory names that are not indexed (e.g. ".git")
+     */
+    FileIndex(Wt::WServer& server, std::string root, std::set<std::string> ignored);
+    ~FileIndex();
+
+    /**
+     * @brief Builds the index and starts watching for changes
+     */
+    void start();
+
+    /**
+     * @brief Stops watching; the last snapshot stays available
+     */
+    void stop();
+
+    /**
+     * @brief Current snapshot, never null once start() returned
+     */
+    SnapshotPtr snapshot() const;
+
+    /**
+     * @brief Registers a handler called with every new snapshot
+     * @return Subscription id for unsubscribe()
+     */
+    int subscribe(const std::string& wt_session_id, Handler handler);
+    void unsubscribe(int subscription_id);
+
+    /**
+     * @brief Registers a server-side callback run on the indexing thread,
+     * before sessions are notified, with every new snapshot
+     * @return Listener id for unlisten()
+     */
+    int listen(Listener listener);
+    void unlisten(int listener_id);
+
+    static const std::set<std::string>& defaultIgnored();
+
+private:
+    struct Subscriber {
+        std::string session_id;
+        Handler handler;
+    };
+
+    std::vector<FileEntry> walk(const std::string& relative);
+    void watchTree(const std::vector<FileEntry>& entries, const std::string& relative);
+    void addWatch(const std::string& relative);
+    void watchLoop();
+    void applyChanges(const std::set<std::string>& changed, bool rescan);
+    void publish(std::vector<FileEntry> entries);
+    bool ignored(const std::string& name) const;
+    std::string absolute(const std::string& relative) const;
+    bool stat(const std::string& relative, FileEntry& entry) const;
+
+    Wt::WServer& server_;
+    std::string root_;
+    std::set<std::string> ignored_;
+
+    mutable std::mutex snapshot_mutex_;
+    SnapshotPtr snapshot_;
+    std::uint64_t version_ = 0;
+
+    int inotify_fd_ = -1;
+    int wake_fd_ = -1;
+    std::unordered_map<int, std::string> watches_;  ///< Watch descriptor to relative directory
+    std::thread watcher_;
+    std::atomic<bool> running_{false};
+
+    std::mutex subscribers_mutex_;
+    std::map<int, Subscriber> subscribers_;
+    int next_subscription_id_ = 1;
+
+    std::mutex listeners_mutex_;
+    std::map<int, Listener> listeners_;
+    int next_listener_id_ = 1;
+};
+
+}
@@ -0,0 +1,383 @@
+#include "008_Workspace/FuzzyIndex.h"
+
+#include <Wt/WLogger.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <mutex>
+
+namespace Workspace {
+
+namespace {
+
+// Scoring constants follow fzf
+constexpr int ScoreMatch = 16;
+constexpr int GapStart = -3;
+constexpr int GapExtension = -1;
+constexpr int BonusBoundary = 8;
+constexpr int BonusDelimiter = 9;
+constexpr int BonusCamel = 7;
+constexpr int BonusConsecutive = 4;
+constexpr int FirstCharMultiplier = 2;
+/// Extra score when the whole match lies in the file name
+constexpr int BonusFileName = 16;
+
+enum class CharClass { Word, Upper, Digit, Delimiter, NonWord };
+
+const std::array<CharClass, 256> CharClasses = []() {
+    std::array<CharClass, 256> classes;
+    for (int c = 0; c < 256; ++c) {
+        if (c >= 'A' && c <= 'Z') {
+            classes[c] = CharClass::Upper;
+        } else if (c >= '0' && c <= '9') {
+            classes[c] = CharClass::Digit;
+        } else if (c == '/') {
+            classes[c] = CharClass::Delimiter;
+        } else if (c == '_' || c == '-' || c == '.' || c == ' ') {
+            classes[c] = CharClass::NonWord;
+        } else {
+            classes[c] = CharClass::Word;
+        }
+    }
+    return classes;
+}();
+
+CharClass classOf(char c)
+{
+    return CharClasses[static_cast<unsigned char>(c)];
+}
+
+int bonusFor(CharClass previous, CharClass current)
+{
+    if (current == CharClass::Delimiter || current == CharClass::NonWord) {
+        return 0;
+    }
+    if (previous == CharClass::Delimiter) {
+        return BonusDelimiter;
+    }
+    if (previous == CharClass::NonWord) {
+        return BonusBoundary;
+    }
+    if ((previous == CharClass::Word && current == CharClass::Upper)
+        || (previous != CharClass::Digit && current == CharClass::Digit)) {
+        return BonusCamel;
+    }
+    return 0;
+}
+
+char lowerChar(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+std::string toLower(std::string_view text)
+{
+    std::string lower(text);
+    std::transform(lower.begin(), lower.end(), lower.begin(), lowerChar);
+    return lower;
+}
+
+}
+
+FuzzyIndex::FuzzyIndex()
+{
+}
+
+FuzzyIndex::FuzzyIndex(FileIndex& files)
+    : files_(&files)
+{
+    update(files_->snapshot());
+    listener_ = files_->listen([this](const SnapshotPtr& snapshot) { update(snapshot); });
+}
+
+FuzzyIndex::~FuzzyIndex()
+{
+    if (files_) {
+        files_->unlisten(listener_);
+    }
+}
+
+std::uint64_t FuzzyIndex::characterMask(std::string_view lower)
+{
+    std::uint64_t mask = 0;
+    for (char c : lower) {
+        unsigned bit;
+        if (c >= 'a' && c <= 'z') {
+            bit = static_cast<unsigned>(c - 'a');
+        } else if (c >= '0' && c <= '9') {
+            bit = 26 + static_cast<unsigned>(c - '0');
+        } else {
+            bit = 36 + static_cast<unsigned char>(c) % 28;
+        }
+        mask |= std::uint64_t(1) << bit;
+    }
+    return mask;
+}
+
+bool FuzzyIndex::score(std::string_view query, std::string_view path, std::string_view lower,
+                       std::size_t name_offset, int& score, std::vector<std::uint16_t>* positions)
+{
+    const std::size_t m = query.size();
+    const std::size_t n = lower.size();
+    if (m == 0 || m > n) {
+        return false;
+    }
+
+    // Leftmost end of a match, then walk back to the shortest window ending
+    // there; both scans jump from one query character to the next
+    const char* text = lower.data();
+    const char* p = text;
+    const char* limit = text + n;
+    for (std::size_t q = 0; q < m; ++q) {
+        p = static_cast<const char*>(std::memchr(p, query[q], static_cast<std::size_t>(limit - p)));
+        if (!p) {
+            return false;
+        }
+        ++p;
+    }
+    const std::size_t end = static_cast<std::size_t>(p - text);
+    --p;
+    for (std::size_t q = m - 1; q-- > 0;) {
+        p = static_cast<const char*>(::memrchr(text, query[q], static_cast<std::size_t>(p - text)));
+    }
+    const std::size_t start = static_cast<std::size_t>(p - text);
+
+    score = 0;
+    std::size_t q = 0;
+    bool in_gap = false;
+    int consecutive = 0;
+    int first_bonus = 0;
+    CharClass previous = start > 0 ? classOf(path[start - 1]) : CharClass::Delimiter;
+    for (std::size_t i = start; i < end; ++i) {
+        CharClass current = classOf(path[i]);
+        if (q < m && lower[i] == query[q]) {
+            int bonus = bonusFor(previous, current);
+            if (consecutive == 0) {
+                first_bonus = bonus;
+            } else {
+                // A run keeps the bonus of its first character
+                if (bonus >= BonusBoundary && bonus > first_bonus) {
+                    first_bonus = bonus;
+                }
+                bonus = std::max({bonus, first_bonus, BonusConsecutive});
+            }
+            score += ScoreMatch + (q == 0 ? bonus * FirstCharMultiplier : bonus);
+            if (positions) {
+                positions->push_back(static_cast<std::uint16_t>(i));
+            }
+            ++consecutive;
+            in_gap = false;
+            ++q;
+        } else {
+            score += in_gap ? GapExtension : GapStart;
+            in_gap = true;
+            consecutive = 0;
+            first_bonus = 0;
+        }
+        previous = current;
+    }
+    if (start >= name_offset) {
+        score += BonusFileName;
+    }
+    return true;
+}
+
+std::vector<FuzzyMatch> FuzzyIndex::find(std::string_view query, std::size_t limit, FuzzyCache* cache) const
+{
+    std::string needle;
+    for (char c : query) {
+        if (c != ' ') {
+            needle.push_back(lowerChar(c));
+        }
+    }
+    std::vector<FuzzyMatch> results;
+    if (needle.empty() || limit == 0) {
+        if (cache) {
+            cache->query.clear();
+            cache->items.clear();
+        }
+        return results;
+    }
+    const std::uint64_t needle_mask = characterMask(needle);
+
+    // Ranked by score, then by shorter path; scores can be negative, so they are not packed into one key
+    struct Candidate {
+        int score;
+        std::uint32_t length;
+        std::uint32_t item;
+    };
+    std::vector<Candidate> candidates;
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const std::uint64_t* masks = masks_.data();
+    const Item* items = items_.data();
+    auto consider = [&](std::uint32_t i) {
+        if ((masks[i] & needle_mask) != needle_mask) {
+            return;
+        }
+        const Item& item = items[i];
+        int value;
+        if (score(needle, pathOf(item), lowerOf(item), item.name_offset, value, nullptr)) {
+            candidates.push_back({value, item.length, i});
+        }
+    };
+
+    bool narrowing = cache && cache->generation == generation_ && !cache->query.empty()
+                  && needle.compare(0, cache->query.size(), cache->query) == 0;
+    if (narrowing) {
+        candidates.reserve(cache->items.size());
+        for (std::uint32_t i : cache->items) {
+            consider(i);
+        }
+    } else {
+        const std::uint32_t count = static_cast<std::uint32_t>(masks_.size());
+        for (std::uint32_t i = 0; i < count; ++i) {
+            consider(i);
+        }
+    }
+    if (cache) {
+        cache->query = needle;
+        cache->generation = generation_;
+        cache->items.clear();
+        for (const Candidate& candidate : candidates) {
+            cache->items.push_back(candidate.item);
+        }
+    }
+
+    auto better = [this](const Candidate& a, const Candidate& b) {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        if (a.length != b.length) {
+            return a.length < b.length;
+        }
+        return pathOf(items_[a.item]) < pathOf(items_[b.item]);
+    };
+    std::size_t keep = std::min(limit, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(), better);
+
+    results.reserve(keep);
+    for (std::size_t i = 0; i < keep; ++i) {
+        const Item& item = items_[candidates[i].item];
+        FuzzyMatch match;
+        match.path = std::string(pathOf(item));
+        score(needle, pathOf(item), lowerOf(item), item.name_offset, match.score, &match.positions);
+        results.push_back(std::move(match));
+    }
+    return results;
+}
+
+std::size_t FuzzyIndex::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return slots_.size();
+}
+
+void FuzzyIndex::add(const std::string& path)
+{
+    if (path.size() > UINT16_MAX || slots_.count(path)) {
+        return;
+    }
+    std::uint32_t slot;
+    if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        slot = static_cast<std::uint32_t>(items_.size());
+        items_.emplace_back();
+        masks_.push_back(0);
+    }
+    std::string lower = toLower(path);
+    std::size_t slash = path.find_last_of('/');
+
+    Item& item = items_[slot];
+    item.offset = static_cast<std::uint32_t>(text_.size());
+    item.length = static_cast<std::uint16_t>(path.size());
+    item.name_offset = static_cast<std::uint16_t>(slash == std::string::npos ? 0 : slash + 1);
+    text_ += path;
+    text_ += lower;
+    masks_[slot] = characterMask(lower);
+    slots_[path] = slot;
+}
+
+void FuzzyIndex::remove(const std::string& path)
+{
+    auto it = slots_.find(path);
+    if (it == slots_.end()) {
+        return;
+    }
+    std::uint32_t slot = it->second;
+    slots_.erase(it);
+    dead_bytes_ += 2 * items_[slot].length;
+    items_[slot] = Item();
+    masks_[slot] = 0;
+    free_slots_.push_back(slot);
+}
+
+void FuzzyIndex::compact()
+{
+    std::string text;
+    text.reserve(text_.size() - dead_bytes_);
+    for (std::size_t i = 0; i < items_.size(); ++i) {
+        if (masks_[i] == 0) {
+            continue;
+        }
+        Item& item = items_[i];
+        std::uint32_t offset = static_cast<std::uint32_t>(text.size());
+        text.append(text_, item.offset, 2 * item.length);
+        item.offset = offset;
+    }
+    text_.swap(text);
+    dead_bytes_ = 0;
+}
+
+void FuzzyIndex::update(const SnapshotPtr& snapshot)
+{
+    // Both snapshots are sorted the same way, so one merge pass finds the
+    // added and removed files without touching the unchanged ones
+    static const std::vector<FileEntry> none;
+    const std::vector<FileEntry>& before = indexed_ ? indexed_->entries() : none;
+    const std::vector<FileEntry>& after = snapshot->entries();
+
+    std::vector<const std::string*> added;
+    std::vector<const std::string*> removed;
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < before.size() || j < after.size()) {
+        if (i < before.size() && before[i].directory) {
+            ++i;
+        } else if (j < after.size() && after[j].directory) {
+            ++j;
+        } else if (j == after.size() || (i < before.size() && Snapshot::pathLess(before[i].path, after[j].path))) {
+            removed.push_back(&before[i++].path);
+        } else if (i == before.size() || Snapshot::pathLess(after[j].path, before[i].path)) {
+            added.push_back(&after[j++].path);
+        } else {
+            ++i;
+            ++j;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    for (const std::string* path : removed) {
+        remove(*path);
+    }
+    for (const std::string* path : added) {
+        add(*path);
+    }
+    if (dead_bytes_ > text_.size() / 2) {
+        compact();
+    }
+    if (!added.empty() || !removed.empty()) {
+        ++generation_;
+    }
+    indexed_ = snapshot;
+
+#ifdef DEBUG
+    Wt::log("debug") << "Workspace::FuzzyIndex::update() - +" << added.size() << " -" << removed.size()
+                     << ", " << slots_.size() << " files";
+#endif
+}
+
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "008_Workspace/FileIndex.h"
+
+namespace Workspace {
+
+struct FuzzyMatch {
+    std::string path;
+    int score = 0;
+    std::vector<std::uint16_t> positions;  ///< Byte offsets of the matched characters in path
+};
+
+/**
+ * @brief Candidates of a caller's previous query
+ *
+ * When a query extends the previous one, as it does while typing, only the
+ * paths that matched before can match again, so find() rescans those.
+ */
+struct FuzzyCache {
+    std::string query;
+    std::uint64_t generation = 0;
+    std::vector<std::uint32_t> items;
+};
+
+/**
+ * @brief In-memory fuzzy finder over the workspace file paths
+ *
+ * Every path carries a 64-bit mask of the characters it contains; a query
+ * first rejects all paths missing one of its characters with a linear scan
+ * over the packed masks, then scores the survivors fzf-style (shortest
+ * matching window, boundary/camelCase/consecutive bonuses, gap penalties)
+ * and keeps the top K. The index follows the FileIndex: each published
+ * snapshot is diffed against the previous one and only added or removed
+ * paths are touched.
+ */
+class FuzzyIndex {
+public:
+    /**
+     * @brief Empty index, filled through update()
+     */
+    FuzzyIndex();
+
+    /**
+     * @brief Index that follows every snapshot published by files
+     */
+    explicit FuzzyIndex(FileIndex& files);
+    ~FuzzyIndex();
+
+    FuzzyIndex(const FuzzyIndex&) = delete;
+    FuzzyIndex& operator=(const FuzzyIndex&) = delete;
+
+    /**
+     * @brief Best matches of a query, highest score first
+     * @param query Characters to match in order; case-insensitive, spaces ignored
+     * @param limit Maximum number of results
+     * @param cache Optional per-caller cache that narrows follow-up queries
+     */
+    std::vector<FuzzyMatch> find(std::string_view query, std::size_t limit, FuzzyCache* cache = nullptr) const;
+
+    /**
+     * @brief Applies the difference between the indexed paths and a snapshot
+     */
+    void update(const SnapshotPtr& snapshot);
+
+    std::size_t size() const;
+
+    /**
+     * @brief Scores one path against a lower case query
+     * @param lower The path in lower case
+     * @param name_offset Offset of the file name in path
+     * @param positions If not null, receives the matched offsets
+     * @return false if the query is not a subsequence of the path
+     */
+    static bool score(std::string_view query, std::string_view path, std::string_view lower,
+                      std::size_t name_offset, int& score, std::vector<std::uint16_t>* positions);
+
+    /**
+     * @brief Mask of the (lower case) characters of a text
+     */
+    static std::uint64_t characterMask(std::string_view lower);
+
+private:
+    /// A path and its lower case copy, stored back to back in text_
+    struct Item {
+        std::uint32_t offset = 0;
+        std::uint16_t length = 0;
+        std::uint16_t name_offset = 0;
+    };
+
+    std::string_view pathOf(const Item& item) const { return std::string_view(text_).substr(item.offset, item.length); }
+    std::string_view lowerOf(const Item& item) const { return std::string_view(text_).substr(item.offset + item.length, item.length); }
+
+    void add(const std::string& path);
+    void remove(const std::string& path);
+    void compact();
+
+    FileIndex* files_ = nullptr;
+    int listener_ = 0;
+
+    mutable std::shared_mutex mutex_;
+    std::string text_;  ///< All paths in one buffer, so a query scans contiguous memory
+    std::size_t dead_bytes_ = 0;  ///< Bytes of text_ left by removed paths
+    std::vector<Item> items_;
+    std::vector<std::uint64_t> masks_;  ///< Parallel to items_, 0 for free slots
+    std::vector<std::uint32_t> free_slots_;
+    std::unordered_map<std::string, std::uint32_t> slots_;  ///< Path to item index
+    SnapshotPtr indexed_;  ///< Snapshot the index currently reflects
+    std::uint64_t generation_ = 1;  ///< Bumped by every change, invalidates FuzzyCache
+};
+
+}
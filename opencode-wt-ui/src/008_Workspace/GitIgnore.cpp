@@ -0,0 +1,211 @@
+#include "008_Workspace/GitIgnore.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace Workspace {
+
+namespace {
+
+std::size_t depth(const std::string& path)
+{
+    return path.empty() ? 0 : std::count(path.begin(), path.end(), '/') + 1;
+}
+
+/// Matches one bracket expression at *pattern against c, advancing pattern past it
+bool matchClass(const char*& pattern, char c)
+{
+    const char* p = pattern + 1;
+    bool negate = *p == '!' || *p == '^';
+    if (negate) {
+        ++p;
+    }
+    bool found = false;
+    bool first = true;
+    for (; *p && (first || *p != ']'); ++p, first = false) {
+        if (p[1] == '-' && p[2] && p[2] != ']') {
+            found = found || (c >= p[0] && c <= p[2]);
+            p += 2;
+        } else {
+            found = found || c == *p;
+        }
+    }
+    pattern = *p ? p + 1 : p;
+    return found != negate;
+}
+
+}
+
+bool GitIgnore::match(const char* pattern, const char* text)
+{
+    while (*pattern) {
+        if (pattern[0] == '*' && pattern[1] == '*') {
+            pattern += 2;
+            if (*pattern == '/') {
+                // "**/" matches zero or more whole directories
+                ++pattern;
+                for (const char* s = text;; ++s) {
+                    if ((s == text || s[-1] == '/') && match(pattern, s)) {
+                        return true;
+                    }
+                    if (!*s) {
+                        return false;
+                    }
+                }
+            }
+            for (const char* s = text;; ++s) {
+                if (match(pattern, s)) {
+                    return true;
+                }
+                if (!*s) {
+                    return false;
+                }
+            }
+        }
+        if (*pattern == '*') {
+            ++pattern;
+            for (const char* s = text;; ++s) {
+                if (match(pattern, s)) {
+                    return true;
+                }
+                if (!*s || *s == '/') {
+                    return false;
+                }
+            }
+        }
+        if (!*text) {
+            return false;
+        }
+        if (*pattern == '?') {
+            if (*text == '/') {
+                return false;
+            }
+        } else if (*pattern == '[') {
+            if (*text == '/' || !matchClass(pattern, *text)) {
+                return false;
+            }
+            ++text;
+            continue;
+        } else {
+            if (*pattern == '\\' && pattern[1]) {
+                ++pattern;
+            }
+            if (*pattern != *text) {
+                return false;
+            }
+        }
+        ++pattern;
+        ++text;
+    }
+    return !*text;
+}
+
+GitIgnore GitIgnore::load(const Snapshot& snapshot)
+{
+    GitIgnore ignore;
+    for (const FileEntry& entry : snapshot.entries()) {
+        if (entry.directory || entry.name() != ".gitignore") {
+            continue;
+        }
+        std::ifstream file(snapshot.root() + "/" + entry.path);
+        if (!file) {
+            continue;
+        }
+        std::ostringstream content;
+        content << file.rdbuf();
+        std::size_t slash = entry.path.find_last_of('/');
+        ignore.add(slash == std::string::npos ? std::string() : entry.path.substr(0, slash), content.str());
+    }
+    return ignore;
+}
+
+void GitIgnore::add(const std::string& base, std::string_view content)
+{
+    std::size_t begin = 0;
+    while (begin < content.size()) {
+        std::size_t end = content.find('\n', begin);
+        if (end == std::string_view::npos) {
+            end = content.size();
+        }
+        std::string line(content.substr(begin, end - begin));
+        begin = end + 1;
+
+        while (!line.empty() && (line.back() == '\r' || (line.back() == ' ' && (line.size() < 2 || line[line.size() - 2] != '\\')))) {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        Rule rule;
+        rule.base = base;
+        if (line[0] == '!') {
+            rule.negate = true;
+            line.erase(0, 1);
+        } else if (line[0] == '\\') {
+            line.erase(0, 1);
+        }
+        if (!line.empty() && line.back() == '/') {
+            rule.directory_only = true;
+            line.pop_back();
+        }
+        // A slash anywhere but at the end anchors the pattern to base
+        rule.anchored = line.find('/') != std::string::npos;
+        if (!line.empty() && line[0] == '/') {
+            line.erase(0, 1);
+        }
+        if (line.empty()) {
+            continue;
+        }
+        rule.pattern = std::move(line);
+        rules_.push_back(std::move(rule));
+    }
+
+    // Deeper files override shallower ones; within a file, later lines win
+    std::stable_sort(rules_.begin(), rules_.end(),
+                     [](const Rule& a, const Rule& b) { return depth(a.base) < depth(b.base); });
+}
+
+bool GitIgnore::matches(const std::string& path, bool directory, bool& result) const
+{
+    bool matched = false;
+    for (const Rule& rule : rules_) {
+        if (rule.directory_only && !directory) {
+            continue;
+        }
+        if (!rule.base.empty()
+            && (path.size() <= rule.base.size() || path[rule.base.size()] != '/' || path.compare(0, rule.base.size(), rule.base) != 0)) {
+            continue;
+        }
+        const char* relative = path.c_str() + (rule.base.empty() ? 0 : rule.base.size() + 1);
+        if (!rule.anchored) {
+            const char* slash = std::strrchr(relative, '/');
+            relative = slash ? slash + 1 : relative;
+        }
+        if (match(rule.pattern.c_str(), relative)) {
+            matched = true;
+            result = !rule.negate;
+        }
+    }
+    return matched;
+}
+
+bool GitIgnore::ignored(const std::string& path, bool directory) const
+{
+    if (rules_.empty()) {
+        return false;
+    }
+    // Nothing below an ignored directory can be re-included
+    for (std::size_t slash = path.find('/'); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+        bool result = false;
+        if (matches(path.substr(0, slash), true, result) && result) {
+            return true;
+        }
+    }
+    bool result = false;
+    return matches(path, directory, result) && result;
+}
+
+}
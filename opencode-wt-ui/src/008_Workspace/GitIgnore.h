@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "008_Workspace/FileIndex.h"
+
+namespace Workspace {
+
+/**
+ * @brief The .gitignore rules of a workspace
+ *
+ * Supports the usual gitignore syntax: comments, negation with '!',
+ * directory-only patterns ending in '/', patterns anchored by a '/',
+ * and the '*', '?', '[...]' and '**' wildcards. Rules of nested
+ * .gitignore files apply below their directory and take precedence.
+ */
+class GitIgnore {
+public:
+    /**
+     * @brief Reads every .gitignore file listed in a snapshot
+     */
+    static GitIgnore load(const Snapshot& snapshot);
+
+    /**
+     * @brief Adds the rules of a .gitignore located in directory base
+     */
+    void add(const std::string& base, std::string_view content);
+
+    /**
+     * @brief Whether a workspace relative path, or one of its parents, is ignored
+     */
+    bool ignored(const std::string& path, bool directory) const;
+
+    bool empty() const { return rules_.empty(); }
+
+    /**
+     * @brief Glob match where '*' and '?' stop at '/' and '**' does not
+     */
+    static bool match(const char* pattern, const char* text);
+
+private:
+    struct Rule {
+        std::string base;
+        std::string pattern;
+        bool negate = false;
+        bool directory_only = false;
+        bool anchored = false;
+    };
+
+    bool matches(const std::string& path, bool directory, bool& result) const;
+
+    std::vector<Rule> rules_;
+};
+
+}
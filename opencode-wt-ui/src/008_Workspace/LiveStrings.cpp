@@ -0,0 +1,177 @@
+#include "008_Workspace/LiveStrings.h"
+
+#include <Wt/WAbstractToggleButton.h>
+#include <Wt/WAnchor.h>
+#include <Wt/WApplication.h>
+#include <Wt/WCombinedLocalizedStrings.h>
+#include <Wt/WFormWidget.h>
+#include <Wt/WLabel.h>
+#include <Wt/WLogger.h>
+#include <Wt/WMessageResourceBundle.h>
+#include <Wt/WPushButton.h>
+#include <Wt/WTemplate.h>
+#include <Wt/WText.h>
+
+#include <algorithm>
+
+namespace Workspace {
+
+namespace {
+
+bool showsKey(const Wt::WString& text, const std::set<std::string>& keys)
+{
+    return !text.empty() && !text.literal() && keys.count(text.key()) != 0;
+}
+
+/// Whether the template source pulls one of the keys in with ${tr:key}
+bool referencesKey(const std::string& source, const std::set<std::string>& keys)
+{
+    for (std::size_t pos = source.find("${tr:"); pos != std::string::npos; pos = source.find("${tr:", pos + 5)) {
+        std::size_t end = source.find_first_of("} ", pos + 5);
+        if (end != std::string::npos && keys.count(source.substr(pos + 5, end - pos - 5)) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Whether any string the widget renders is one of the changed messages
+bool showsChangedKey(Wt::WWidget* widget, const std::set<std::string>& keys)
+{
+    if (showsKey(widget->toolTip(), keys)) {
+        return true;
+    }
+    if (auto text = dynamic_cast<Wt::WText*>(widget)) {
+        return showsKey(text->text(), keys);
+    }
+    if (auto tmpl = dynamic_cast<Wt::WTemplate*>(widget)) {
+        const Wt::WString& source = tmpl->templateText();
+        return showsKey(source, keys) || referencesKey(source.toUTF8(), keys);
+    }
+    if (auto button = dynamic_cast<Wt::WPushButton*>(widget)) {
+        return showsKey(button->text(), keys);
+    }
+    if (auto anchor = dynamic_cast<Wt::WAnchor*>(widget)) {
+        return showsKey(anchor->text(), keys);
+    }
+    if (auto label = dynamic_cast<Wt::WLabel*>(widget)) {
+        return showsKey(label->text(), keys);
+    }
+    if (auto toggle = dynamic_cast<Wt::WAbstractToggleButton*>(widget)) {
+        return showsKey(toggle->text(), keys);
+    }
+    if (auto field = dynamic_cast<Wt::WFormWidget*>(widget)) {
+        return showsKey(field->placeholderText(), keys);
+    }
+    return false;
+}
+
+}
+
+LiveStrings::LiveStrings(MessageBundles& bundles)
+    : bundles_(bundles)
+{
+    subscription_ = bundles_.subscribe(wApp->sessionId(), [this](std::shared_ptr<const MessageBundleChange> change) {
+        changed(change);
+    });
+}
+
+LiveStrings::~LiveStrings()
+{
+    bundles_.unsubscribe(subscription_);
+}
+
+void LiveStrings::install(MessageBundles& bundles)
+{
+    auto live = std::make_shared<LiveStrings>(bundles);
+    auto combined = std::dynamic_pointer_cast<Wt::WCombinedLocalizedStrings>(wApp->localizedStrings());
+    if (combined) {
+        combined->insert(0, live);
+        return;
+    }
+    combined = std::make_shared<Wt::WCombinedLocalizedStrings>();
+    combined->add(live);
+    if (wApp->localizedStrings()) {
+        combined->add(wApp->localizedStrings());
+    }
+    wApp->setLocalizedStrings(combined);
+}
+
+void LiveStrings::use(const std::string& path)
+{
+    std::shared_ptr<LiveStrings> live;
+    if (auto combined = std::dynamic_pointer_cast<Wt::WCombinedLocalizedStrings>(wApp->localizedStrings())) {
+        for (const auto& strings : combined->items()) {
+            if ((live = std::dynamic_pointer_cast<LiveStrings>(strings))) {
+                break;
+            }
+        }
+    }
+
+    MessageBundlePtr bundle;
+    if (live) {
+        std::string relative = live->bundles_.relativePath(path);
+        bundle = relative.empty() ? nullptr : live->bundles_.bundle(relative);
+    }
+    if (!bundle) {
+        wApp->messageResourceBundle().use(path);
+        return;
+    }
+    for (const MessageBundlePtr& used : live->used_) {
+        if (used->path == bundle->path) {
+            return;
+        }
+    }
+    live->used_.push_back(std::move(bundle));
+}
+
+Wt::LocalizedString LiveStrings::resolveKey(const Wt::WLocale&, const std::string& key)
+{
+    for (const MessageBundlePtr& bundle : used_) {
+        auto it = bundle->messages.find(key);
+        if (it != bundle->messages.end()) {
+            Wt::LocalizedString result;
+            result.value = it->second;
+            result.format = Wt::TextFormat::XHTML;
+            result.success = true;
+            return result;
+        }
+    }
+    return Wt::LocalizedString{};
+}
+
+void LiveStrings::changed(const std::shared_ptr<const MessageBundleChange>& change)
+{
+    auto used = std::find_if(used_.begin(), used_.end(), [&](const MessageBundlePtr& bundle) {
+        return bundle->path == change->bundle->path;
+    });
+    if (used == used_.end() || (*used)->version >= change->bundle->version) {
+        return;
+    }
+    *used = change->bundle;
+
+    std::set<std::string> keys(change->changed.begin(), change->changed.end());
+#ifdef DEBUG
+    Wt::log("debug") << "LiveStrings::changed() - " << change->bundle->path << " v" << change->bundle->version
+                     << ", refreshing widgets bound to " << keys.size() << " message(s)";
+#endif
+    refreshWidgets(wApp->domRoot(), keys);
+    wApp->triggerUpdate();
+}
+
+void LiveStrings::refreshWidgets(Wt::WWidget* widget, const std::set<std::string>& keys)
+{
+    if (!widget) {
+        return;
+    }
+    if (showsChangedKey(widget, keys)) {
+        // Refreshing a widget re-resolves its whole subtree
+        widget->refresh();
+        return;
+    }
+    for (Wt::WWidget* child : widget->children()) {
+        refreshWidgets(child, keys);
+    }
+}
+
+}
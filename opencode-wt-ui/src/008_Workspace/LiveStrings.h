@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Wt/WLocalizedStrings.h>
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "008_Workspace/MessageBundles.h"
+
+namespace Wt {
+    class WWidget;
+}
+
+namespace Workspace {
+
+/**
+ * @brief Session view of the shared message bundles
+ *
+ * Sits in front of the application's WMessageResourceBundle and resolves
+ * the keys of the bundles registered with use() from the parsed copies in
+ * MessageBundles, so a bundle is parsed once per process instead of once per
+ * session. When a bundle changes, only the widgets showing one of the
+ * changed messages are refreshed.
+ */
+class LiveStrings : public Wt::WLocalizedStrings {
+public:
+    explicit LiveStrings(MessageBundles& bundles);
+    ~LiveStrings() override;
+
+    /**
+     * @brief Installs a LiveStrings in front of the current application's strings
+     */
+    static void install(MessageBundles& bundles);
+
+    /**
+     * @brief Drop-in for WApplication::messageResourceBundle().use()
+     *
+     * Bundles outside the shared workspace, or that never parsed, are handed
+     * to Wt's own bundle instead.
+     */
+    static void use(const std::string& path);
+
+    Wt::LocalizedString resolveKey(const Wt::WLocale& locale, const std::string& key) override;
+
+private:
+    void changed(const std::shared_ptr<const MessageBundleChange>& change);
+    void refreshWidgets(Wt::WWidget* widget, const std::set<std::string>& keys);
+
+    MessageBundles& bundles_;
+    std::vector<MessageBundlePtr> used_;  ///< In use() order, the first match wins
+    int subscription_ = 0;
+};
+
+}
@@ -0,0 +1,487 @@
+#include "008_Workspace/MessageBundles.h"
+#include "000_Server/Metrics.h"
+
+#include <Wt/WLogger.h>
+#include <Wt/WIOService.h>
+#include <Wt/WServer.h>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+namespace Workspace {
+
+namespace {
+
+/// Larger bundles are not loaded
+constexpr std::uint64_t MaxBundleSize = 4 * 1024 * 1024;
+
+bool readFile(const std::string& path, std::string& text)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    text = content.str();
+    return true;
+}
+
+bool isNameChar(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-' || c == '.' || c == ':';
+}
+
+/// Minimal XML reader for message bundles: tracks the line for errors
+class Reader {
+public:
+    explicit Reader(std::string_view text) : text_(text) {}
+
+    bool atEnd() const { return pos_ >= text_.size(); }
+    std::size_t pos() const { return pos_; }
+    bool startsWith(std::string_view s) const { return text_.compare(pos_, s.size(), s) == 0; }
+
+    void advance(std::size_t n)
+    {
+        std::size_t end = std::min(text_.size(), pos_ + n);
+        line_ += std::count(text_.begin() + pos_, text_.begin() + end, '\n');
+        pos_ = end;
+    }
+
+    void skipSpace()
+    {
+        while (!atEnd() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            advance(1);
+        }
+    }
+
+    /// Moves past the next occurrence of end, false if there is none
+    bool skipPast(std::string_view end)
+    {
+        std::size_t found = text_.find(end, pos_);
+        if (found == std::string_view::npos) {
+            return false;
+        }
+        advance(found + end.size() - pos_);
+        return true;
+    }
+
+    std::string_view name()
+    {
+        std::size_t start = pos_;
+        while (!atEnd() && isNameChar(text_[pos_])) {
+            ++pos_;
+        }
+        return text_.substr(start, pos_ - start);
+    }
+
+    /// Reads the attributes up to '>' or "/>"; false if the tag is malformed
+    bool attributes(std::unordered_map<std::string, std::string>& out, bool& self_closing)
+    {
+        for (;;) {
+            skipSpace();
+            if (atEnd()) {
+                return false;
+            }
+            if (startsWith("/>")) {
+                advance(2);
+                self_closing = true;
+                return true;
+            }
+            if (text_[pos_] == '>') {
+                advance(1);
+                self_closing = false;
+                return true;
+            }
+            std::string attribute(name());
+            if (attribute.empty()) {
+                return false;
+            }
+            skipSpace();
+            if (atEnd() || text_[pos_] != '=') {
+                return false;
+            }
+            advance(1);
+            skipSpace();
+            if (atEnd() || (text_[pos_] != '"' && text_[pos_] != '\'')) {
+                return false;
+            }
+            char quote = text_[pos_];
+            std::size_t close = text_.find(quote, pos_ + 1);
+            if (close == std::string_view::npos) {
+                return false;
+            }
+            out[attribute] = std::string(text_.substr(pos_ + 1, close - pos_ - 1));
+            advance(close + 1 - pos_);
+        }
+    }
+
+    std::string_view slice(std::size_t from, std::size_t to) const { return text_.substr(from, to - from); }
+
+    std::string error(const std::string& what) const
+    {
+        return what + " at line " + std::to_string(line_);
+    }
+
+private:
+    std::string_view text_;
+    std::size_t pos_ = 0;
+    std::size_t line_ = 1;
+};
+
+/// Skips the prolog, comments and doctype before or after the root element
+bool skipMisc(Reader& reader, std::string& error)
+{
+    for (;;) {
+        reader.skipSpace();
+        if (reader.startsWith("<?")) {
+            if (!reader.skipPast("?>")) {
+                error = reader.error("Unterminated processing instruction");
+                return false;
+            }
+        } else if (reader.startsWith("<!--")) {
+            if (!reader.skipPast("-->")) {
+                error = reader.error("Unterminated comment");
+                return false;
+            }
+        } else if (reader.startsWith("<!DOCTYPE")) {
+            if (!reader.skipPast(">")) {
+                error = reader.error("Unterminated doctype");
+                return false;
+            }
+        } else {
+            return true;
+        }
+    }
+}
+
+/// Reads the content of a <message> up to its end tag, checking the nesting
+bool messageContent(Reader& reader, std::string_view& content, std::string& error)
+{
+    std::size_t start = reader.pos();
+    std::vector<std::string> open;
+    while (!reader.atEnd()) {
+        if (reader.startsWith("<!--")) {
+            if (!reader.skipPast("-->")) {
+                error = reader.error("Unterminated comment");
+                return false;
+            }
+        } else if (reader.startsWith("<![CDATA[")) {
+            if (!reader.skipPast("]]>")) {
+                error = reader.error("Unterminated CDATA section");
+                return false;
+            }
+        } else if (reader.startsWith("</")) {
+            std::size_t end = reader.pos();
+            reader.advance(2);
+            std::string tag(reader.name());
+            reader.skipSpace();
+            if (!reader.startsWith(">")) {
+                error = reader.error("Malformed end tag </" + tag + ">");
+                return false;
+            }
+            reader.advance(1);
+            if (open.empty()) {
+                if (tag != "message") {
+                    error = reader.error("Unexpected </" + tag + ">");
+                    return false;
+                }
+                content = reader.slice(start, end);
+                return true;
+            }
+            if (open.back() != tag) {
+                error = reader.error("</" + tag + "> closes <" + open.back() + ">");
+                return false;
+            }
+            open.pop_back();
+        } else if (reader.startsWith("<")) {
+            reader.advance(1);
+            std::string tag(reader.name());
+            if (tag.empty()) {
+                error = reader.error("Malformed tag");
+                return false;
+            }
+            std::unordered_map<std::string, std::string> attributes;
+            bool self_closing = false;
+            if (!reader.attributes(attributes, self_closing)) {
+                error = reader.error("Malformed tag <" + tag + ">");
+                return false;
+            }
+            if (!self_closing) {
+                open.push_back(std::move(tag));
+            }
+        } else {
+            reader.advance(1);
+        }
+    }
+    error = reader.error("Unterminated <message>");
+    return false;
+}
+
+}
+
+MessageBundles::MessageBundles(Wt::WServer& server, FileIndex& files, std::string directory)
+    : server_(server),
+      files_(files),
+      directory_(std::move(directory))
+{
+    if (!directory_.empty() && directory_.back() != '/') {
+        directory_ += '/';
+    }
+    std::error_code ec;
+    SnapshotPtr snapshot = files_.snapshot();
+    root_ = std::filesystem::weakly_canonical(snapshot->root(), ec).string();
+    if (snapshot->version() != 0) {
+        update(snapshot);
+    }
+    listener_ = files_.listen([this](const SnapshotPtr& snapshot) { snapshotChanged(snapshot); });
+}
+
+MessageBundles::~MessageBundles()
+{
+    files_.unlisten(listener_);
+    std::lock_guard<std::mutex> lock(update_mutex_);
+}
+
+void MessageBundles::snapshotChanged(const SnapshotPtr& snapshot)
+{
+    // Called on the watcher thread with the FileIndex listeners locked:
+    // only note the snapshot, the bundles are read and parsed elsewhere
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    pending_ = snapshot;
+    if (!update_scheduled_) {
+        update_scheduled_ = true;
+        server_.ioService().schedule(UpdateDelay, [this]() { runPendingUpdate(); });
+    }
+}
+
+void MessageBundles::runPendingUpdate()
+{
+    std::lock_guard<std::mutex> update_lock(update_mutex_);
+    SnapshotPtr snapshot;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        snapshot.swap(pending_);
+        update_scheduled_ = false;
+    }
+    if (snapshot) {
+        update(snapshot);
+    }
+}
+
+MessageBundlePtr MessageBundles::bundle(const std::string& path) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = bundles_.find(path);
+    return it == bundles_.end() ? nullptr : it->second.bundle;
+}
+
+std::string MessageBundles::relativePath(const std::string& bundle_path) const
+{
+    std::error_code ec;
+    std::filesystem::path path = std::filesystem::weakly_canonical(bundle_path + ".xml", ec);
+    if (ec) {
+        return {};
+    }
+    std::filesystem::path relative = path.lexically_relative(root_);
+    if (relative.empty() || *relative.begin() == "..") {
+        return {};
+    }
+    return relative.generic_string();
+}
+
+int MessageBundles::subscribe(const std::string& wt_session_id, Handler handler)
+{
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    int id = next_subscription_id_++;
+    subscribers_[id] = {wt_session_id, std::move(handler)};
+    return id;
+}
+
+void MessageBundles::unsubscribe(int subscription_id)
+{
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    subscribers_.erase(subscription_id);
+}
+
+bool MessageBundles::parse(std::string_view text, std::unordered_map<std::string, std::string>& messages, std::string& error)
+{
+    Reader reader(text);
+    if (!skipMisc(reader, error)) {
+        return false;
+    }
+    if (!reader.startsWith("<messages")) {
+        error = reader.error("Expected <messages>");
+        return false;
+    }
+    reader.advance(1);
+    reader.name();
+    std::unordered_map<std::string, std::string> attributes;
+    bool self_closing = false;
+    if (!reader.attributes(attributes, self_closing)) {
+        error = reader.error("Malformed <messages>");
+        return false;
+    }
+
+    while (!self_closing) {
+        if (!skipMisc(reader, error)) {
+            return false;
+        }
+        if (reader.atEnd()) {
+            error = reader.error("Unterminated <messages>");
+            return false;
+        }
+        if (reader.startsWith("</messages")) {
+            reader.advance(10);
+            reader.skipSpace();
+            if (!reader.startsWith(">")) {
+                error = reader.error("Malformed </messages>");
+                return false;
+            }
+            reader.advance(1);
+            break;
+        }
+        if (!reader.startsWith("<message")) {
+            error = reader.error("Expected <message>");
+            return false;
+        }
+        reader.advance(1);
+        if (reader.name() != "message") {
+            error = reader.error("Expected <message>");
+            return false;
+        }
+        attributes.clear();
+        bool empty = false;
+        if (!reader.attributes(attributes, empty)) {
+            error = reader.error("Malformed <message>");
+            return false;
+        }
+        auto id = attributes.find("id");
+        if (id == attributes.end() || id->second.empty()) {
+            error = reader.error("<message> without id");
+            return false;
+        }
+        std::string_view content;
+        if (!empty && !messageContent(reader, content, error)) {
+            return false;
+        }
+        if (!messages.emplace(id->second, std::string(content)).second) {
+            error = reader.error("Duplicate message id \"" + id->second + "\"");
+            return false;
+        }
+    }
+
+    if (!skipMisc(reader, error)) {
+        return false;
+    }
+    if (!reader.atEnd()) {
+        error = reader.error("Content after </messages>");
+        return false;
+    }
+    return true;
+}
+
+void MessageBundles::update(const SnapshotPtr& snapshot)
+{
+    const std::string& root = snapshot->root();
+    std::vector<std::shared_ptr<const MessageBundleChange>> changes;
+    std::set<std::string> present;
+
+    for (const FileEntry* entry : snapshot->files(directory_.substr(0, directory_.size() - 1), {"xml"})) {
+        if (entry->size > MaxBundleSize) {
+            continue;
+        }
+        present.insert(entry->path);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = bundles_.find(entry->path);
+            if (it != bundles_.end() && it->second.size == entry->size && it->second.modified == entry->modified) {
+                continue;
+            }
+        }
+
+        std::string text;
+        std::unordered_map<std::string, std::string> messages;
+        std::string error;
+        bool valid = readFile(root + "/" + entry->path, text) && parse(text, messages, error);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        Loaded& loaded = bundles_[entry->path];
+        loaded.size = entry->size;
+        loaded.modified = entry->modified;
+        if (!valid) {
+            // Keep serving the last valid version until the file is fixed
+            Wt::log("error") << "Workspace::MessageBundles - " << entry->path << " rejected: "
+                             << (error.empty() ? "unreadable" : error);
+            continue;
+        }
+
+        MessageBundlePtr previous = loaded.bundle;
+        auto bundle = std::make_shared<MessageBundle>();
+        bundle->path = entry->path;
+        bundle->version = previous ? previous->version + 1 : 1;
+        bundle->messages = std::move(messages);
+        loaded.bundle = bundle;
+        if (!previous) {
+            continue;
+        }
+
+        auto change = std::make_shared<MessageBundleChange>();
+        change->bundle = bundle;
+        for (const auto& [id, content] : bundle->messages) {
+            auto old = previous->messages.find(id);
+            if (old == previous->messages.end() || old->second != content) {
+                change->changed.push_back(id);
+            }
+        }
+        for (const auto& [id, content] : previous->messages) {
+            if (bundle->messages.count(id) == 0) {
+                change->changed.push_back(id);
+            }
+        }
+        if (!change->changed.empty()) {
+#ifdef DEBUG
+            Wt::log("debug") << "MessageBundles::update() - " << entry->path << " v" << bundle->version
+                             << ", " << change->changed.size() << " message(s) changed";
+#endif
+            changes.push_back(std::move(change));
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = bundles_.begin(); it != bundles_.end();) {
+            it = present.count(it->first) ? std::next(it) : bundles_.erase(it);
+        }
+    }
+
+    for (auto& change : changes) {
+        publish(std::move(change));
+    }
+}
+
+void MessageBundles::publish(std::shared_ptr<const MessageBundleChange> change)
+{
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    for (const auto& [id, subscriber] : subscribers_) {
+        int subscription_id = id;
+        server_.post(subscriber.first, Metrics::trackPush(Metrics::PushSource::MessageBundles, [this, subscription_id, change]() {
+            Handler handler;
+            {
+                std::lock_guard<std::mutex> lock(subscribers_mutex_);
+                auto it = subscribers_.find(subscription_id);
+                if (it == subscribers_.end()) {
+                    return;
+                }
+                handler = it->second.second;
+            }
+            handler(change);
+        }));
+    }
+}
+
+}
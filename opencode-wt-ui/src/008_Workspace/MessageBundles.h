@@ -0,0 +1,121 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "008_Workspace/FileIndex.h"
+
+namespace Wt {
+    class WServer;
+}
+
+namespace Workspace {
+
+/**
+ * @brief One parsed XML message bundle
+ */
+struct MessageBundle {
+    std::string path;  ///< Workspace relative, with the .xml extension
+    std::uint64_t version = 0;  ///< Bumped by every accepted change
+    std::unordered_map<std::string, std::string> messages;  ///< Message id to its inner XML
+};
+
+using MessageBundlePtr = std::shared_ptr<const MessageBundle>;
+
+/**
+ * @brief A new version of a bundle and the message ids it changed
+ */
+struct MessageBundleChange {
+    MessageBundlePtr bundle;
+    std::vector<std::string> changed;  ///< Added, removed or modified ids
+};
+
+/**
+ * @brief Process-wide copy of the XML message bundles under a directory
+ *
+ * Bundles are parsed once when the FileIndex reports them changed, instead
+ * of once per session. A version that does not parse is rejected and the
+ * previous one stays in use. Accepted versions are posted to the subscribed
+ * sessions together with the ids that changed. Parsing runs on the server
+ * thread pool, UpdateDelay after a change, never on the watcher thread.
+ */
+class MessageBundles {
+public:
+    using Handler = std::function<void(std::shared_ptr<const MessageBundleChange>)>;
+
+    /**
+     * @param directory Workspace relative directory holding the bundles
+     */
+    MessageBundles(Wt::WServer& server, FileIndex& files, std::string directory = "static/0_stylus/xml");
+    ~MessageBundles();
+
+    MessageBundles(const MessageBundles&) = delete;
+    MessageBundles& operator=(const MessageBundles&) = delete;
+
+    /**
+     * @brief Current version of a bundle, nullptr if unknown or never valid
+     * @param path Workspace relative path, with the .xml extension
+     */
+    MessageBundlePtr bundle(const std::string& path) const;
+
+    /**
+     * @brief Workspace relative .xml path of a bundle as given to
+     * WMessageResourceBundle::use(), or "" if it is outside the workspace
+     */
+    std::string relativePath(const std::string& bundle_path) const;
+
+    /**
+     * @brief Registers a handler called with every accepted bundle change
+     * @return Subscription id for unsubscribe()
+     */
+    int subscribe(const std::string& wt_session_id, Handler handler);
+    void unsubscribe(int subscription_id);
+
+    /**
+     * @brief Parses the <messages> document of a bundle
+     * @param error Receives the reason and line when the document is malformed
+     */
+    static bool parse(std::string_view text, std::unordered_map<std::string, std::string>& messages, std::string& error);
+
+    /// Delay between a FileIndex change and the parse that follows it
+    static constexpr std::chrono::milliseconds UpdateDelay{200};
+
+private:
+    struct Loaded {
+        std::uint64_t size = 0;
+        std::int64_t modified = 0;
+        MessageBundlePtr bundle;  ///< Last valid version
+    };
+
+    void snapshotChanged(const SnapshotPtr& snapshot);
+    void runPendingUpdate();
+    void update(const SnapshotPtr& snapshot);
+    void publish(std::shared_ptr<const MessageBundleChange> change);
+
+    Wt::WServer& server_;
+    FileIndex& files_;
+    std::string directory_;
+    std::string root_;  ///< Canonical workspace root
+    int listener_ = 0;
+
+    std::mutex update_mutex_;  ///< Held by the running update
+    std::mutex pending_mutex_;
+    SnapshotPtr pending_;  ///< Latest snapshot not yet parsed
+    bool update_scheduled_ = false;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Loaded> bundles_;
+
+    std::mutex subscribers_mutex_;
+    std::map<int, std::pair<std::string, Handler>> subscribers_;  ///< Id to Wt session id and handler
+    int next_subscription_id_ = 1;
+};
+
+}
@@ -0,0 +1,333 @@
+#include "008_Workspace/RevisionStore.h"
+
+#include <Wt/Utils.h>
+#include <Wt/WLogger.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <zstd.h>
+
+namespace Workspace {
+
+namespace {
+
+constexpr int CompressionLevel = 3;
+
+/// Random 64-bit value per byte for the gear hash, fixed so chunk boundaries are stable across runs
+const std::array<std::uint64_t, 256>& gearTable()
+{
+    static const std::array<std::uint64_t, 256> table = []() {
+        std::array<std::uint64_t, 256> values{};
+        std::uint64_t state = 0x9E3779B97F4A7C15ull;
+        for (std::uint64_t& value : values) {
+            // splitmix64
+            std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            value = z ^ (z >> 31);
+        }
+        return values;
+    }();
+    return table;
+}
+
+std::string escapePath(const std::string& path)
+{
+    static const char* hex = "0123456789ABCDEF";
+    std::string escaped;
+    for (unsigned char c : path) {
+        if (std::isalnum(c) || c == '.' || c == '_' || c == '-') {
+            escaped += static_cast<char>(c);
+        } else {
+            escaped += '%';
+            escaped += hex[c >> 4];
+            escaped += hex[c & 0xF];
+        }
+    }
+    return escaped;
+}
+
+std::string cleanAuthor(std::string author)
+{
+    for (char& c : author) {
+        if (c == '\t' || c == '\n' || c == '\r') {
+            c = ' ';
+        }
+    }
+    return author;
+}
+
+/// Cuts a torn last line left by a crash, so the next append starts on a line of its own
+bool dropTornLine(const std::string& file)
+{
+    std::ifstream in(file, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return true;
+    }
+    std::streamoff end = in.tellg();
+    std::streamoff keep = end;
+    char block[4096];
+    while (keep > 0) {
+        std::streamoff length = std::min<std::streamoff>(keep, sizeof(block));
+        in.seekg(keep - length);
+        if (!in.read(block, length)) {
+            return false;
+        }
+        const char* newline = nullptr;
+        for (std::streamoff i = length; i > 0 && !newline; --i) {
+            if (block[i - 1] == '\n') {
+                newline = block + i - 1;
+            }
+        }
+        if (newline) {
+            keep = keep - length + (newline - block) + 1;
+            break;
+        }
+        keep -= length;
+    }
+    in.close();
+    if (keep == end) {
+        return true;
+    }
+    std::error_code ec;
+    std::filesystem::resize_file(file, static_cast<std::uintmax_t>(keep), ec);
+    return !ec;
+}
+
+bool parseLine(const std::string& line, FileRevision& revision)
+{
+    std::vector<std::string> fields;
+    std::size_t start = 0;
+    for (;;) {
+        std::size_t tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab == std::string::npos ? std::string::npos : tab - start));
+        if (tab == std::string::npos) {
+            break;
+        }
+        start = tab + 1;
+    }
+    if (fields.size() != 5) {
+        return false;
+    }
+    try {
+        revision.number = std::stoull(fields[0]);
+        revision.time = std::stoll(fields[1]);
+        revision.size = std::stoull(fields[2]);
+    } catch (const std::exception&) {
+        return false;
+    }
+    revision.author = fields[3];
+    revision.chunks.clear();
+    std::istringstream hashes(fields[4]);
+    for (std::string hash; std::getline(hashes, hash, ',');) {
+        if (hash.size() != 40) {
+            return false;
+        }
+        revision.chunks.push_back(hash);
+    }
+    return true;
+}
+
+}
+
+RevisionStore::RevisionStore(std::string directory)
+    : directory_(std::move(directory))
+{
+    std::error_code ec;
+    std::filesystem::create_directories(directory_ + "/objects", ec);
+    std::filesystem::create_directories(directory_ + "/logs", ec);
+    if (ec) {
+        Wt::log("error") << "Workspace::RevisionStore - cannot create " << directory_ << ": " << ec.message();
+    }
+}
+
+std::vector<std::size_t> RevisionStore::chunkEnds(std::string_view content)
+{
+    const std::array<std::uint64_t, 256>& gear = gearTable();
+    std::vector<std::size_t> ends;
+    std::size_t start = 0;
+    while (start < content.size()) {
+        std::size_t end = std::min(content.size(), start + MaxChunk);
+        std::size_t cut = end;
+        std::uint64_t hash = 0;
+        for (std::size_t i = start + std::min(MinChunk, end - start); i < end; ++i) {
+            hash = (hash << 1) + gear[static_cast<unsigned char>(content[i])];
+            if ((hash & ChunkMask) == 0) {
+                cut = i + 1;
+                break;
+            }
+        }
+        ends.push_back(cut);
+        start = cut;
+    }
+    return ends;
+}
+
+std::uint64_t RevisionStore::record(const std::string& path, std::string_view content, const std::string& author)
+{
+    FileRevision revision;
+    revision.size = content.size();
+    revision.author = cleanAuthor(author);
+    revision.time = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::vector<std::string_view> chunks;
+    std::size_t start = 0;
+    for (std::size_t end : chunkEnds(content)) {
+        chunks.push_back(content.substr(start, end - start));
+        revision.chunks.push_back(Wt::Utils::hexEncode(Wt::Utils::sha1(std::string(chunks.back()))));
+        start = end;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<FileRevision> existing = readLog(path);
+    if (!existing.empty() && existing.back().chunks == revision.chunks) {
+        return existing.back().number;
+    }
+    revision.number = existing.empty() ? 1 : existing.back().number + 1;
+
+    std::size_t new_chunks = 0;
+    std::size_t written = 0;
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        std::size_t before = written;
+        if (!writeObject(revision.chunks[i], chunks[i], written)) {
+            return 0;
+        }
+        new_chunks += written != before;
+    }
+
+    if (!dropTornLine(logPath(path))) {
+        Wt::log("error") << "Workspace::RevisionStore - cannot repair the log of " << path;
+        return 0;
+    }
+    std::ofstream log(logPath(path), std::ios::binary | std::ios::app);
+    log << revision.number << '\t' << revision.time << '\t' << revision.size << '\t' << revision.author << '\t';
+    for (std::size_t i = 0; i < revision.chunks.size(); ++i) {
+        log << (i ? "," : "") << revision.chunks[i];
+    }
+    log << '\n';
+    if (!log.flush()) {
+        Wt::log("error") << "Workspace::RevisionStore - cannot append to the log of " << path;
+        return 0;
+    }
+
+#ifdef DEBUG
+    Wt::log("debug") << "RevisionStore::record() - " << path << " #" << revision.number << ": "
+                     << new_chunks << " of " << chunks.size() << " chunks new, " << written << " bytes stored";
+#endif
+    return revision.number;
+}
+
+std::vector<FileRevision> RevisionStore::revisions(const std::string& path) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return readLog(path);
+}
+
+bool RevisionStore::read(const std::string& path, std::uint64_t number, std::string& content) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const FileRevision& revision : readLog(path)) {
+        if (revision.number != number) {
+            continue;
+        }
+        content.clear();
+        content.reserve(revision.size);
+        std::string chunk;
+        for (const std::string& hash : revision.chunks) {
+            if (!readObject(hash, chunk)) {
+                Wt::log("error") << "Workspace::RevisionStore - missing chunk " << hash << " of " << path << " #" << number;
+                return false;
+            }
+            content += chunk;
+        }
+        return content.size() == revision.size;
+    }
+    return false;
+}
+
+std::string RevisionStore::logPath(const std::string& path) const
+{
+    return directory_ + "/logs/" + escapePath(path) + ".log";
+}
+
+std::string RevisionStore::objectPath(const std::string& hash) const
+{
+    return directory_ + "/objects/" + hash.substr(0, 2) + "/" + hash.substr(2);
+}
+
+bool RevisionStore::writeObject(const std::string& hash, std::string_view chunk, std::size_t& written)
+{
+    std::string path = objectPath(hash);
+    std::error_code ec;
+    if (std::filesystem::exists(path, ec)) {
+        return true;
+    }
+    std::filesystem::create_directories(directory_ + "/objects/" + hash.substr(0, 2), ec);
+
+    std::string compressed(ZSTD_compressBound(chunk.size()), '\0');
+    std::size_t size = ZSTD_compress(compressed.data(), compressed.size(), chunk.data(), chunk.size(), CompressionLevel);
+    if (ZSTD_isError(size)) {
+        Wt::log("error") << "Workspace::RevisionStore - compression failed: " << ZSTD_getErrorName(size);
+        return false;
+    }
+
+    // Written aside and renamed, so a crash never leaves a truncated object under its hash
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.write(compressed.data(), static_cast<std::streamsize>(size))) {
+            Wt::log("error") << "Workspace::RevisionStore - cannot write " << temporary;
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        Wt::log("error") << "Workspace::RevisionStore - cannot store object " << hash;
+        std::remove(temporary.c_str());
+        return false;
+    }
+    written += size;
+    return true;
+}
+
+bool RevisionStore::readObject(const std::string& hash, std::string& out) const
+{
+    std::ifstream file(objectPath(hash), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    const std::string compressed = buffer.str();
+
+    unsigned long long size = ZSTD_getFrameContentSize(compressed.data(), compressed.size());
+    if (size == ZSTD_CONTENTSIZE_ERROR || size == ZSTD_CONTENTSIZE_UNKNOWN || size > MaxChunk) {
+        return false;
+    }
+    out.assign(size, '\0');
+    std::size_t result = ZSTD_decompress(out.data(), out.size(), compressed.data(), compressed.size());
+    return !ZSTD_isError(result) && result == size;
+}
+
+std::vector<FileRevision> RevisionStore::readLog(const std::string& path) const
+{
+    std::vector<FileRevision> revisions;
+    std::ifstream log(logPath(path), std::ios::binary);
+    std::string line;
+    while (std::getline(log, line)) {
+        FileRevision revision;
+        // A torn last line from a crash is skipped
+        if (parseLine(line, revision)) {
+            revisions.push_back(std::move(revision));
+        }
+    }
+    return revisions;
+}
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Workspace {
+
+/**
+ * @brief One saved version of a workspace file
+ */
+struct FileRevision {
+    std::uint64_t number = 0;  ///< 1 for the first saved version
+    std::int64_t time = 0;     ///< Milliseconds since the epoch
+    std::uint64_t size = 0;
+    std::string author;
+    std::vector<std::string> chunks;  ///< Hex SHA-1 of each chunk, in order
+};
+
+/**
+ * @brief Content-addressed history of the files saved through Stylus
+ *
+ * A saved file is cut into chunks at content-defined boundaries (a gear
+ * rolling hash), so an edit only changes the chunks around it. Chunks are
+ * stored once under their SHA-1 in `<directory>/objects`, compressed with
+ * zstd; a revision is a line in `<directory>/logs/<file>.log` listing the
+ * hashes of its chunks. Storage thus grows with the changed content, not
+ * with the file size.
+ *
+ * Shared by all sessions, all methods are thread safe.
+ */
+class RevisionStore {
+public:
+    explicit RevisionStore(std::string directory);
+
+    RevisionStore(const RevisionStore&) = delete;
+    RevisionStore& operator=(const RevisionStore&) = delete;
+
+    /**
+     * @brief Stores content as the newest revision of a file
+     * @param path Workspace relative path of the file
+     * @return Number of the revision, the newest one if content did not
+     *         change, 0 if it could not be stored
+     */
+    std::uint64_t record(const std::string& path, std::string_view content, const std::string& author);
+
+    /**
+     * @brief Revisions of a file, oldest first
+     */
+    std::vector<FileRevision> revisions(const std::string& path) const;
+
+    /**
+     * @brief Reassembles the content of a revision
+     */
+    bool read(const std::string& path, std::uint64_t number, std::string& content) const;
+
+    /**
+     * @brief End offsets of the chunks content is cut into
+     */
+    static std::vector<std::size_t> chunkEnds(std::string_view content);
+
+    static constexpr std::size_t MinChunk = 512;
+    static constexpr std::size_t MaxChunk = 16 * 1024;
+    /// Boundary when the rolling hash has these bits clear: about 2 KiB past MinChunk on average.
+    /// High bits, which depend on the last 64 bytes rather than the last few
+    static constexpr std::uint64_t ChunkMask = ((1ull << 11) - 1) << 53;
+
+private:
+    std::string logPath(const std::string& path) const;
+    std::string objectPath(const std::string& hash) const;
+    bool writeObject(const std::string& hash, std::string_view chunk, std::size_t& written);
+    bool readObject(const std::string& hash, std::string& out) const;
+    std::vector<FileRevision> readLog(const std::string& path) const;
+
+    std::string directory_;
+    mutable std::mutex mutex_;
+};
+
+}
@@ -0,0 +1,392 @@
+#include "008_Workspace/Search.h"
+#include "000_Server/Metrics.h"
+
+#include <Wt/WLogger.h>
+#include <Wt/WServer.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Workspace {
+
+namespace {
+
+/// Bytes inspected for a NUL to classify a file as binary, like git does
+constexpr std::size_t BinaryProbe = 8000;
+/// Longest line text reported with a match
+constexpr std::size_t MaxLineText = 240;
+
+char fold(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+bool equalAt(const char* text, std::string_view needle, bool case_sensitive)
+{
+    if (case_sensitive) {
+        return std::memcmp(text, needle.data(), needle.size()) == 0;
+    }
+    for (std::size_t i = 0; i < needle.size(); ++i) {
+        if (fold(text[i]) != needle[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isLetter(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+bool readFile(const std::string& path, std::uint64_t size, std::string& buffer)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    buffer.resize(size);
+    std::size_t total = 0;
+    while (total < size) {
+        ssize_t count = ::read(fd, &buffer[total], size - total);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            break;
+        }
+        total += static_cast<std::size_t>(count);
+    }
+    ::close(fd);
+    // The file may have shrunk since it was indexed
+    buffer.resize(total);
+    return true;
+}
+
+}
+
+std::size_t SearchService::findLiteral(std::string_view haystack, std::string_view needle, bool case_sensitive)
+{
+    const std::size_t n = needle.size();
+    if (n == 0) {
+        return 0;
+    }
+    if (haystack.size() < n) {
+        return std::string_view::npos;
+    }
+    const char* text = haystack.data();
+    const std::size_t last = haystack.size() - n;  // Last possible start
+    std::size_t i = 0;
+
+    if (case_sensitive && n == 1) {
+        const void* hit = std::memchr(text, needle[0], haystack.size());
+        return hit ? static_cast<std::size_t>(static_cast<const char*>(hit) - text) : std::string_view::npos;
+    }
+
+#if defined(__SSE2__)
+    // Setting bit 0x20 maps 'A'..'Z' onto 'a'..'z', so a letter of the
+    // needle is found in either case with one compare
+    const char first_case = (!case_sensitive && isLetter(needle[0])) ? 0x20 : 0;
+    const char last_case = (!case_sensitive && isLetter(needle[n - 1])) ? 0x20 : 0;
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i final = _mm_set1_epi8(needle[n - 1]);
+    const __m128i first_fold = _mm_set1_epi8(first_case);
+    const __m128i final_fold = _mm_set1_epi8(last_case);
+
+    for (; i + 16 <= last + 1; i += 16) {
+        __m128i head = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i)), first_fold);
+        __m128i tail = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + n - 1)), final_fold);
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, final))));
+        while (mask != 0) {
+            std::size_t candidate = i + static_cast<std::size_t>(__builtin_ctz(mask));
+            if (equalAt(text + candidate, needle, case_sensitive)) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    if (case_sensitive) {
+        while (i <= last) {
+            const void* hit = std::memchr(text + i, needle[0], last - i + 1);
+            if (!hit) {
+                return std::string_view::npos;
+            }
+            i = static_cast<std::size_t>(static_cast<const char*>(hit) - text);
+            if (std::memcmp(text + i, needle.data(), n) == 0) {
+                return i;
+            }
+            ++i;
+        }
+        return std::string_view::npos;
+    }
+    for (; i <= last; ++i) {
+        if (equalAt(text + i, needle, false)) {
+            return i;
+        }
+    }
+    return std::string_view::npos;
+}
+
+SearchService::SearchService(Wt::WServer& server, FileIndex& index, unsigned threads)
+    : server_(server),
+      index_(index)
+{
+    if (threads == 0) {
+        threads = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        threads_.emplace_back(&SearchService::workerLoop, this);
+    }
+}
+
+SearchService::~SearchService()
+{
+    stop();
+}
+
+void SearchService::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        for (auto& [id, job] : jobs_) {
+            job->cancelled = true;
+        }
+        jobs_.clear();
+        tasks_.clear();
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads_.clear();
+}
+
+std::shared_ptr<const GitIgnore> SearchService::gitIgnore(const SnapshotPtr& snapshot)
+{
+    std::lock_guard<std::mutex> lock(ignore_mutex_);
+    if (!ignore_ || ignore_version_ != snapshot->version()) {
+        ignore_ = std::make_shared<const GitIgnore>(GitIgnore::load(*snapshot));
+        ignore_version_ = snapshot->version();
+    }
+    return ignore_;
+}
+
+int SearchService::search(const std::string& wt_session_id, SearchQuery query, Handler handler)
+{
+    auto job = std::make_shared<Job>();
+    job->wt_session_id = wt_session_id;
+    job->handler = std::move(handler);
+    job->needle = query.pattern;
+    if (!query.case_sensitive) {
+        std::transform(job->needle.begin(), job->needle.end(), job->needle.begin(), fold);
+    }
+    job->query = std::move(query);
+    job->snapshot = index_.snapshot();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    job->id = next_search_id_++;
+    if (stopping_ || job->needle.empty()) {
+        return job->id;
+    }
+    jobs_[job->id] = job;
+
+    // Every worker joins the search and pulls files from its shared cursor
+    job->workers = static_cast<unsigned>(threads_.size());
+    for (std::size_t i = 0; i < threads_.size(); ++i) {
+        tasks_.push_back(job);
+    }
+    wake_.notify_all();
+    return job->id;
+}
+
+void SearchService::cancel(int search_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = jobs_.find(search_id);
+    if (it == jobs_.end()) {
+        return;
+    }
+    it->second->cancelled = true;
+    jobs_.erase(it);
+}
+
+void SearchService::workerLoop()
+{
+    for (;;) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            job = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        run(job);
+    }
+}
+
+void SearchService::run(const std::shared_ptr<Job>& job)
+{
+    // The first worker to arrive selects the files; the others wait for it
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        if (!job->selected) {
+            job->selected = true;
+            std::shared_ptr<const GitIgnore> ignore = gitIgnore(job->snapshot);
+            for (const FileEntry* entry : job->snapshot->files(job->query.directory)) {
+                if (entry->size > 0 && entry->size <= MaxFileSize && !ignore->ignored(entry->path, false)) {
+                    job->files.push_back(entry);
+                }
+            }
+        }
+    }
+
+    std::string buffer;
+    std::vector<SearchMatch> matches;
+    auto flushed = std::chrono::steady_clock::now();
+    for (;;) {
+        if (job->cancelled) {
+            break;
+        }
+        std::size_t index = job->next++;
+        if (index >= job->files.size()) {
+            break;
+        }
+        scanFile(*job, *job->files[index], buffer, matches);
+        ++job->scanned;
+
+        auto now = std::chrono::steady_clock::now();
+        if (!matches.empty() && now - flushed >= BatchWindow) {
+            deliver(job, std::move(matches), false);
+            matches.clear();
+            flushed = now;
+        }
+    }
+
+    bool last = --job->workers == 0;
+    if (!matches.empty() || last) {
+        deliver(job, std::move(matches), last);
+    }
+}
+
+void SearchService::scanFile(Job& job, const FileEntry& entry, std::string& buffer, std::vector<SearchMatch>& matches)
+{
+    if (!readFile(job.snapshot->root() + "/" + entry.path, entry.size, buffer)) {
+        return;
+    }
+    if (std::memchr(buffer.data(), '\0', std::min(buffer.size(), BinaryProbe))) {
+        return;
+    }
+
+    std::string_view text(buffer);
+    std::size_t position = 0;
+    std::size_t counted = 0;      // Newlines are counted up to here
+    std::uint32_t line = 1;
+    while (position < text.size()) {
+        std::size_t hit = findLiteral(text.substr(position), job.needle, job.query.case_sensitive);
+        if (hit == std::string_view::npos) {
+            break;
+        }
+        hit += position;
+        line += static_cast<std::uint32_t>(std::count(text.begin() + counted, text.begin() + hit, '\n'));
+        counted = hit;
+
+        std::size_t line_start = text.rfind('\n', hit);
+        line_start = line_start == std::string_view::npos ? 0 : line_start + 1;
+        std::size_t line_end = text.find('\n', hit);
+        if (line_end == std::string_view::npos) {
+            line_end = text.size();
+        }
+
+        SearchMatch match;
+        match.path = entry.path;
+        match.line = line;
+        match.column = static_cast<std::uint32_t>(hit - line_start);
+        std::size_t length = std::min(line_end - line_start, MaxLineText);
+        while (length < line_end - line_start && length > 0 && (text[line_start + length] & 0xC0) == 0x80) {
+            --length;  // Do not cut a UTF-8 sequence
+        }
+        match.text = std::string(text.substr(line_start, length));
+        matches.push_back(std::move(match));
+
+        if (++job.found >= job.query.max_results) {
+            job.cancelled = true;
+            std::lock_guard<std::mutex> lock(job.mutex);
+            job.pending.truncated = true;
+            return;
+        }
+        // One match per line
+        position = line_end + 1;
+    }
+}
+
+void SearchService::deliver(const std::shared_ptr<Job>& job, std::vector<SearchMatch> matches, bool done)
+{
+    std::lock_guard<std::mutex> lock(job->mutex);
+    std::move(matches.begin(), matches.end(), std::back_inserter(job->pending.matches));
+    job->pending.done = job->pending.done || done;
+    if (job->post_pending) {
+        return;
+    }
+    job->post_pending = true;
+    int search_id = job->id;
+    server_.schedule(BatchWindow, job->wt_session_id, Metrics::trackPush(Metrics::PushSource::Search, [this, search_id]() {
+        drain(search_id);
+    }));
+}
+
+void SearchService::drain(int search_id)
+{
+    std::shared_ptr<Job> job;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = jobs_.find(search_id);
+        if (it == jobs_.end()) {
+            return;
+        }
+        job = it->second;
+    }
+
+    SearchBatch batch;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        batch.matches.swap(job->pending.matches);
+        batch.done = job->pending.done;
+        batch.truncated = job->pending.truncated;
+        batch.files_total = job->files.size();
+        batch.files_scanned = std::min(job->scanned.load(), batch.files_total);
+        job->post_pending = false;
+    }
+
+    if (batch.done) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.erase(search_id);
+    }
+#ifdef DEBUG
+    if (batch.done) {
+        Wt::log("debug") << "Workspace::SearchService::drain() - search " << search_id << " done, "
+                         << job->found.load() << " matches in " << batch.files_scanned << " files";
+    }
+#endif
+    job->handler(std::move(batch));
+}
+
+}
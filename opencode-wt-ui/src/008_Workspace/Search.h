@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "008_Workspace/FileIndex.h"
+#include "008_Workspace/GitIgnore.h"
+
+namespace Wt {
+    class WServer;
+}
+
+namespace Workspace {
+
+struct SearchQuery {
+    std::string pattern;          ///< Literal text to find
+    bool case_sensitive = false;
+    std::string directory;        ///< Workspace relative directory to search, empty for all
+    std::size_t max_results = 2000;
+};
+
+struct SearchMatch {
+    std::string path;
+    std::uint32_t line = 0;    ///< 1-based
+    std::uint32_t column = 0;  ///< 0-based byte offset in the line
+    std::string text;          ///< The matching line, truncated
+};
+
+/**
+ * @brief Matches found since the previous batch of a search
+ */
+struct SearchBatch {
+    std::vector<SearchMatch> matches;
+    std::size_t files_scanned = 0;  ///< Total so far
+    std::size_t files_total = 0;
+    bool done = false;              ///< Last batch of the search
+    bool truncated = false;         ///< Stopped at max_results
+};
+
+/**
+ * @brief Grep-like literal search over the workspace
+ *
+ * Files come from the FileIndex snapshot minus the .gitignore'd ones and
+ * are scanned by a fixed pool of threads. Results are streamed to the
+ * requesting session in batches through WServer::schedule; a search can be
+ * cancelled at any time, e.g. when the query text changes.
+ */
+class SearchService {
+public:
+    using Handler = std::function<void(SearchBatch)>;
+
+    /// Delay used to coalesce matches into one server push
+    static constexpr std::chrono::milliseconds BatchWindow{50};
+    /// Files larger than this are not searched
+    static constexpr std::uint64_t MaxFileSize = 4 * 1024 * 1024;
+
+    /**
+     * @param threads Worker count, 0 for one per core (at most 8)
+     */
+    SearchService(Wt::WServer& server, FileIndex& index, unsigned threads = 0);
+    ~SearchService();
+
+    /**
+     * @brief Stops the worker threads, cancelling running searches
+     */
+    void stop();
+
+    /**
+     * @brief Starts a search
+     * @param wt_session_id Wt session the handler must run in
+     * @param handler Called inside the Wt session with each batch of results
+     * @return Search id for cancel()
+     */
+    int search(const std::string& wt_session_id, SearchQuery query, Handler handler);
+
+    /**
+     * @brief Cancels a search; no further batches are delivered for it
+     */
+    void cancel(int search_id);
+
+    /**
+     * @brief Offset of needle in haystack, or npos
+     *
+     * Candidates are located 16 bytes at a time by comparing the first and
+     * last needle bytes with SSE2, then verified. Case-insensitive matching
+     * folds ASCII letters only; the needle must then be lower case.
+     */
+    static std::size_t findLiteral(std::string_view haystack, std::string_view needle, bool case_sensitive);
+
+private:
+    struct Job {
+        int id = 0;
+        std::string wt_session_id;
+        SearchQuery query;
+        std::string needle;
+        SnapshotPtr snapshot;
+        std::vector<const FileEntry*> files;  ///< Selected by the first worker, under mutex
+        bool selected = false;
+        Handler handler;
+
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> scanned{0};
+        std::atomic<std::size_t> found{0};
+        std::atomic<unsigned> workers{0};
+        std::atomic<bool> cancelled{false};
+
+        std::mutex mutex;
+        SearchBatch pending;
+        bool post_pending = false;
+    };
+
+    void workerLoop();
+    void run(const std::shared_ptr<Job>& job);
+    void scanFile(Job& job, const FileEntry& entry, std::string& buffer, std::vector<SearchMatch>& matches);
+    void deliver(const std::shared_ptr<Job>& job, std::vector<SearchMatch> matches, bool done);
+    void drain(int search_id);
+    std::shared_ptr<const GitIgnore> gitIgnore(const SnapshotPtr& snapshot);
+
+    Wt::WServer& server_;
+    FileIndex& index_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::shared_ptr<Job>> tasks_;
+    std::map<int, std::shared_ptr<Job>> jobs_;
+    int next_search_id_ = 1;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+
+    std::mutex ignore_mutex_;
+    std::uint64_t ignore_version_ = 0;
+    std::shared_ptr<const GitIgnore> ignore_;
+};
+
+}
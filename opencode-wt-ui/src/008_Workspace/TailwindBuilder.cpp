@@ -0,0 +1,648 @@
+#include "008_Workspace/TailwindBuilder.h"
+#include "000_Server/Metrics.h"
+
+#include <Wt/WLogger.h>
+#include <Wt/WIOService.h>
+#include <Wt/WServer.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+namespace Workspace {
+
+namespace {
+
+/// Mirrors the @source entries of static/0_stylus/tailwind/input.css
+const std::vector<std::pair<std::string, std::vector<std::string>>> Sources = {
+    {"src/", {"cpp", "h"}},
+    {"static/0_stylus/xml/", {"xml"}},
+};
+const std::string InputCss = "static/0_stylus/tailwind/input.css";
+const std::string DefaultThemeCss = "static/0_stylus/tailwind/node_modules/tailwindcss/theme.css";
+const std::string BaseName = "tailwind.css";
+
+/// Larger sources are not scanned
+constexpr std::uint64_t MaxSourceSize = 1024 * 1024;
+constexpr std::size_t MaxClassLength = 128;
+
+bool readFile(const std::string& path, std::string& text)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    text = content.str();
+    return true;
+}
+
+std::pair<std::uint64_t, std::int64_t> stamp(const std::string& path)
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return {0, 0};
+    }
+    return {static_cast<std::uint64_t>(st.st_size),
+            static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec};
+}
+
+const std::vector<std::string>* sourceExtensions(const FileEntry& entry)
+{
+    if (entry.directory || entry.size > MaxSourceSize) {
+        return nullptr;
+    }
+    for (const auto& [prefix, extensions] : Sources) {
+        if (entry.path.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        std::size_t dot = entry.path.find_last_of('.');
+        if (dot != std::string::npos
+            && std::find(extensions.begin(), extensions.end(), entry.path.substr(dot + 1)) != extensions.end()) {
+            return &extensions;
+        }
+    }
+    return nullptr;
+}
+
+/// Offset of the brace closing the one at open, or npos
+std::size_t closingBrace(const std::string& text, std::size_t open)
+{
+    int depth = 0;
+    char quote = 0;
+    for (std::size_t i = open; i < text.size(); ++i) {
+        char c = text[i];
+        if (c == '\\') {
+            // Escaped, in a string or a selector like .content-\[\'x\'\]
+            ++i;
+        } else if (quote) {
+            if (c == quote) {
+                quote = 0;
+            }
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '{') {
+            ++depth;
+        } else if (c == '}' && --depth == 0) {
+            return i;
+        }
+    }
+    return std::string::npos;
+}
+
+std::size_t lineStart(const std::string& text, std::size_t at)
+{
+    std::size_t newline = text.rfind('\n', at);
+    return newline == std::string::npos ? 0 : newline + 1;
+}
+
+/// Class name of a ".escaped\:name" selector, empty for other rules
+std::string selectorClass(std::string_view selector)
+{
+    std::string name;
+    if (selector.empty() || selector.front() != '.') {
+        return name;
+    }
+    for (std::size_t i = 1; i < selector.size(); ++i) {
+        char c = selector[i];
+        if (c == '\\' && i + 1 < selector.size()) {
+            // Hex escapes (e.g. "\32 xl" for a leading digit) end with an optional space
+            std::size_t hex = i + 1;
+            while (hex < selector.size() && hex - i <= 6 && std::isxdigit(static_cast<unsigned char>(selector[hex]))) {
+                ++hex;
+            }
+            if (hex > i + 1) {
+                name += static_cast<char>(std::stoi(std::string(selector.substr(i + 1, hex - i - 1)), nullptr, 16));
+                i = (hex < selector.size() && selector[hex] == ' ') ? hex : hex - 1;
+            } else {
+                name += selector[++i];
+            }
+        } else if (std::isspace(static_cast<unsigned char>(c)) || c == ',' || c == ':' || c == '{') {
+            break;
+        } else {
+            name += c;
+        }
+    }
+    return name;
+}
+
+/// "--name: value;" declarations directly inside a block
+void readDeclarations(const std::string& text, std::size_t open, std::size_t close, TailwindRules::Theme& theme)
+{
+    int depth = 0;
+    for (std::size_t i = open + 1; i < close; ++i) {
+        char c = text[i];
+        if (c == '{') {
+            ++depth;
+        } else if (c == '}') {
+            --depth;
+        } else if (depth == 0 && c == '-' && text.compare(i, 2, "--") == 0
+                   && (i == 0 || std::isspace(static_cast<unsigned char>(text[i - 1])) || text[i - 1] == ';' || text[i - 1] == '{')) {
+            std::size_t colon = text.find(':', i);
+            std::size_t end = text.find(';', i);
+            if (colon == std::string::npos || end == std::string::npos || end > close || colon > end) {
+                return;
+            }
+            std::string value = text.substr(colon + 1, end - colon - 1);
+            value.erase(0, value.find_first_not_of(" \t\n"));
+            if (value != "initial") {
+                theme[text.substr(i, colon - i)] = value;
+            }
+            i = end;
+        }
+    }
+}
+
+/// Variables of the @theme blocks of a Tailwind input file
+void readThemeBlocks(const std::string& text, TailwindRules::Theme& theme)
+{
+    for (std::size_t at = text.find("@theme"); at != std::string::npos; at = text.find("@theme", at + 1)) {
+        std::size_t open = text.find('{', at);
+        std::size_t close = open == std::string::npos ? open : closingBrace(text, open);
+        if (close == std::string::npos) {
+            return;
+        }
+        readDeclarations(text, open, close, theme);
+        at = close;
+    }
+}
+
+bool hasVariant(const std::string& class_name)
+{
+    int depth = 0;
+    for (char c : class_name) {
+        if (c == '[') {
+            ++depth;
+        } else if (c == ']') {
+            --depth;
+        } else if (c == ':' && depth == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool classCharacter(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || std::strchr("-_:/.[]()#%!&>~'=,+*@", c) != nullptr;
+}
+
+bool isCandidate(std::string_view word)
+{
+    if (word.empty() || word.size() > MaxClassLength) {
+        return false;
+    }
+    char first = word.front();
+    if (!(std::isalnum(static_cast<unsigned char>(first)) || first == '!' || first == '-' || first == '[')) {
+        return false;
+    }
+    bool lower = false;
+    for (char c : word) {
+        if (!classCharacter(c)) {
+            return false;
+        }
+        lower = lower || (c >= 'a' && c <= 'z');
+    }
+    return lower;
+}
+
+std::string hashName(const std::string& css)
+{
+    // FNV-1a
+    std::uint64_t hash = 14695981039346656037ull;
+    for (char c : css) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    return "tailwind." + std::string(hex) + ".css";
+}
+
+bool isGeneratedName(const std::string& name)
+{
+    return name.size() == 30 && name.compare(0, 9, "tailwind.") == 0 && name.compare(25, 4, ".css") == 0
+        && std::all_of(name.begin() + 9, name.begin() + 25, [](char c) { return std::isxdigit(static_cast<unsigned char>(c)); });
+}
+
+}
+
+TailwindBuilder::TailwindBuilder(Wt::WServer& server, FileIndex& files, std::string css_dir, std::string css_url)
+    : server_(server),
+      files_(files),
+      css_dir_(std::move(css_dir)),
+      css_url_(std::move(css_url))
+{
+    SnapshotPtr snapshot = files_.snapshot();
+    if (snapshot && snapshot->version() != 0) {
+        update(snapshot);
+    }
+    listener_ = files_.listen([this](const SnapshotPtr& snapshot) { snapshotChanged(snapshot); });
+}
+
+TailwindBuilder::~TailwindBuilder()
+{
+    files_.unlisten(listener_);
+    std::lock_guard<std::mutex> lock(update_mutex_);
+}
+
+void TailwindBuilder::snapshotChanged(const SnapshotPtr& snapshot)
+{
+    // Called on the watcher thread with the FileIndex listeners locked:
+    // only note the snapshot, the sources are read and the sheet built elsewhere
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    pending_ = snapshot;
+    if (!update_scheduled_) {
+        update_scheduled_ = true;
+        server_.ioService().schedule(UpdateDelay, [this]() { runPendingUpdate(); });
+    }
+}
+
+void TailwindBuilder::runPendingUpdate()
+{
+    std::lock_guard<std::mutex> update_lock(update_mutex_);
+    SnapshotPtr snapshot;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        snapshot.swap(pending_);
+        update_scheduled_ = false;
+    }
+    if (snapshot) {
+        update(snapshot);
+    }
+}
+
+std::string TailwindBuilder::styleSheetUrl() const
+{
+    std::lock_guard<std::mutex> lock(url_mutex_);
+    return url_;
+}
+
+int TailwindBuilder::subscribe(const std::string& wt_session_id, Handler handler)
+{
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    int id = next_subscription_id_++;
+    subscribers_[id] = {wt_session_id, std::move(handler)};
+    return id;
+}
+
+void TailwindBuilder::unsubscribe(int subscription_id)
+{
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    subscribers_.erase(subscription_id);
+}
+
+std::vector<std::string> TailwindBuilder::extractClasses(std::string_view text, bool xml)
+{
+    std::vector<std::string> classes;
+    auto addWords = [&classes](std::string_view words) {
+        std::size_t i = 0;
+        while (i < words.size()) {
+            while (i < words.size() && std::isspace(static_cast<unsigned char>(words[i]))) {
+                ++i;
+            }
+            std::size_t start = i;
+            while (i < words.size() && !std::isspace(static_cast<unsigned char>(words[i]))) {
+                ++i;
+            }
+            std::string_view word = words.substr(start, i - start);
+            if (isCandidate(word)) {
+                classes.emplace_back(word);
+            }
+        }
+    };
+
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c == '"') {
+            std::size_t end = i + 1;
+            while (end < text.size() && text[end] != '"' && (xml || text[end] != '\n')) {
+                end += (text[end] == '\\' && !xml) ? 2 : 1;
+            }
+            if (end >= text.size()) {
+                break;
+            }
+            addWords(text.substr(i + 1, end - i - 1));
+            i = end;
+        } else if (!xml && c == '\'') {
+            // Character literal, so '"' does not open a string
+            i += (i + 1 < text.size() && text[i + 1] == '\\') ? 3 : 2;
+        } else if (xml && c == '>') {
+            std::size_t end = text.find('<', i + 1);
+            if (end == std::string_view::npos) {
+                end = text.size();
+            }
+            addWords(text.substr(i + 1, end - i - 1));
+            i = end - 1;
+        }
+    }
+    std::sort(classes.begin(), classes.end());
+    classes.erase(std::unique(classes.begin(), classes.end()), classes.end());
+    return classes;
+}
+
+bool TailwindBuilder::loadBase(const std::string& root)
+{
+    std::string text;
+    if (!readFile(css_dir_ + "/" + BaseName, text)) {
+        Wt::log("error") << "Workspace::TailwindBuilder - cannot read " << css_dir_ << "/" << BaseName;
+        return false;
+    }
+
+    const std::string theme_layer = "@layer theme {";
+    const std::string root_block = ":root, :host {";
+    const std::string utilities_layer = "@layer utilities {";
+    std::size_t theme_at = text.find(theme_layer);
+    std::size_t root_open = theme_at == std::string::npos ? theme_at : text.find(root_block, theme_at);
+    std::size_t utilities_at = text.find(utilities_layer);
+    if (root_open == std::string::npos || utilities_at == std::string::npos) {
+        Wt::log("error") << "Workspace::TailwindBuilder - " << BaseName << " has no theme or utilities layer";
+        return false;
+    }
+    root_open += root_block.size() - 1;
+    std::size_t root_close = closingBrace(text, root_open);
+    std::size_t utilities_open = utilities_at + utilities_layer.size() - 1;
+    std::size_t utilities_close = closingBrace(text, utilities_open);
+    if (root_close == std::string::npos || utilities_close == std::string::npos || root_close > utilities_open) {
+        Wt::log("error") << "Workspace::TailwindBuilder - cannot parse " << BaseName;
+        return false;
+    }
+
+    BaseSheet base;
+    std::size_t root_close_line = lineStart(text, root_close);
+    base.head = text.substr(0, root_open + 1);
+    base.variables = text.substr(root_open + 1, root_close_line - root_open - 1);
+    base.middle = text.substr(root_close_line, utilities_open + 1 - root_close_line);
+    readDeclarations(text, root_open, root_close, base.theme);
+
+    std::size_t at = utilities_open + 1;
+    while (true) {
+        while (at < utilities_close && std::isspace(static_cast<unsigned char>(text[at]))) {
+            ++at;
+        }
+        if (at >= utilities_close) {
+            break;
+        }
+        std::size_t open = text.find('{', at);
+        std::size_t close = open == std::string::npos ? open : closingBrace(text, open);
+        if (close == std::string::npos || close > utilities_close) {
+            Wt::log("error") << "Workspace::TailwindBuilder - cannot parse the utilities of " << BaseName;
+            return false;
+        }
+        std::string name = selectorClass(std::string_view(text).substr(at, open - at));
+        std::size_t start = lineStart(text, at);
+        base.rules.emplace_back(name, text.substr(start, close + 1 - start) + "\n");
+        if (!name.empty()) {
+            base.classes.insert(name);
+        }
+        at = close + 1;
+    }
+    base.tail = text.substr(lineStart(text, utilities_close));
+
+    const std::string property = "@property ";
+    for (std::size_t found = text.find(property); found != std::string::npos; found = text.find(property, found + 1)) {
+        std::size_t begin = found + property.size();
+        std::size_t end = text.find_first_of(" {", begin);
+        base.properties.insert(text.substr(begin, end - begin));
+    }
+
+    // Values for the variables a new rule may need: Tailwind's default
+    // theme when the npm packages are installed, then the project @theme
+    TailwindRules::Theme theme;
+    std::string input;
+    if (readFile(root + "/" + DefaultThemeCss, input)) {
+        readThemeBlocks(input, theme);
+    }
+    if (readFile(root + "/" + InputCss, input)) {
+        readThemeBlocks(input, theme);
+    }
+    for (const auto& [name, value] : base.theme) {
+        theme[name] = value;
+    }
+    rules_.setTheme(std::move(theme));
+    base_ = std::move(base);
+
+    Wt::log("info") << "Workspace::TailwindBuilder - base has " << base_.classes.size() << " utilities, "
+                    << rules_.theme().size() << " theme variables known";
+    return true;
+}
+
+void TailwindBuilder::update(const SnapshotPtr& snapshot)
+{
+    const std::string& root = snapshot->root();
+    bool changed = false;
+
+    std::pair<std::uint64_t, std::int64_t> base_stamp = stamp(css_dir_ + "/" + BaseName);
+    std::pair<std::uint64_t, std::int64_t> theme_stamp{0, 0};
+    if (const FileEntry* input = snapshot->find(InputCss)) {
+        theme_stamp = {input->size, input->modified};
+    }
+    if (base_stamp != base_stamp_ || theme_stamp != theme_stamp_) {
+        if (!loadBase(root)) {
+            return;
+        }
+        base_stamp_ = base_stamp;
+        theme_stamp_ = theme_stamp;
+        generated_.clear();
+        changed = true;
+    }
+
+    auto count = [this](const std::vector<std::string>& classes, int delta) {
+        for (const std::string& name : classes) {
+            int& uses = class_counts_[name];
+            uses += delta;
+            if (uses <= 0) {
+                class_counts_.erase(name);
+            }
+        }
+    };
+
+    std::set<std::string> unseen;
+    for (const auto& [path, source] : sources_) {
+        unseen.insert(path);
+    }
+    std::size_t scanned = 0;
+    std::string text;
+    for (const FileEntry& entry : snapshot->entries()) {
+        const std::vector<std::string>* extensions = sourceExtensions(entry);
+        if (!extensions) {
+            continue;
+        }
+        unseen.erase(entry.path);
+        auto it = sources_.find(entry.path);
+        if (it != sources_.end() && it->second.size == entry.size && it->second.modified == entry.modified) {
+            continue;
+        }
+        if (!readFile(root + "/" + entry.path, text)) {
+            continue;
+        }
+        Source source;
+        source.size = entry.size;
+        source.modified = entry.modified;
+        source.classes = extractClasses(text, entry.path.compare(entry.path.size() - 4, 4, ".xml") == 0);
+        if (it != sources_.end()) {
+            count(it->second.classes, -1);
+        }
+        count(source.classes, 1);
+        sources_[entry.path] = std::move(source);
+        ++scanned;
+        changed = true;
+    }
+    for (const std::string& path : unseen) {
+        count(sources_[path].classes, -1);
+        sources_.erase(path);
+        changed = true;
+    }
+    if (!changed) {
+        return;
+    }
+
+    // Only classes that appeared since the last build get a new rule
+    std::size_t created = 0;
+    for (auto it = generated_.begin(); it != generated_.end();) {
+        it = class_counts_.count(it->first) ? std::next(it) : generated_.erase(it);
+    }
+    for (const auto& [name, uses] : class_counts_) {
+        if (base_.classes.count(name) || generated_.count(name)) {
+            continue;
+        }
+        Generated generated;
+        generated.rule = rules_.rule(name, &generated.variables);
+        created += generated.rule.empty() ? 0 : 1;
+        generated_.emplace(name, std::move(generated));
+    }
+
+#ifdef DEBUG
+    Wt::log("debug") << "Workspace::TailwindBuilder::update() - scanned " << scanned << " files, removed "
+                     << unseen.size() << ", " << created << " new rules";
+#endif
+    write(render());
+}
+
+std::string TailwindBuilder::render() const
+{
+    std::vector<const std::pair<const std::string, Generated>*> rules;
+    std::set<std::string> variables;
+    for (const auto& entry : generated_) {
+        if (!entry.second.rule.empty()) {
+            rules.push_back(&entry);
+            variables.insert(entry.second.variables.begin(), entry.second.variables.end());
+        }
+    }
+    std::sort(rules.begin(), rules.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+    std::string theme;
+    std::string properties;
+    for (const std::string& variable : variables) {
+        if (variable.compare(0, 5, "--tw-") == 0) {
+            const char* initial = TailwindRules::propertyInitialValue(variable);
+            if (initial && !base_.properties.count(variable)) {
+                properties += "@property " + variable + " {\n  syntax: \"*\";\n  inherits: false;\n  initial-value: "
+                            + initial + ";\n}\n";
+            }
+        } else if (!base_.theme.count(variable)) {
+            auto value = rules_.theme().find(variable);
+            if (value != rules_.theme().end()) {
+                theme += "    " + variable + ": " + value->second + ";\n";
+            }
+        }
+    }
+
+    std::string css = base_.head + base_.variables + theme + base_.middle;
+    // Variant rules follow the plain ones, as in the CLI output
+    auto plain = std::stable_partition(rules.begin(), rules.end(), [](const auto* rule) { return !hasVariant(rule->first); });
+    bool plain_written = false;
+    for (const auto& [name, rule] : base_.rules) {
+        if (!plain_written && hasVariant(name)) {
+            for (auto it = rules.begin(); it != plain; ++it) {
+                css += (*it)->second.rule;
+            }
+            plain_written = true;
+        }
+        css += rule;
+    }
+    for (auto it = plain_written ? plain : rules.begin(); it != rules.end(); ++it) {
+        css += (*it)->second.rule;
+    }
+    css += base_.tail;
+    if (!css.empty() && css.back() != '\n') {
+        css += '\n';
+    }
+    css += properties;
+    return css;
+}
+
+void TailwindBuilder::write(const std::string& css)
+{
+    std::string name = hashName(css);
+    if (name == written_) {
+        return;
+    }
+
+    // Written aside and renamed, so a session never loads a partial sheet
+    std::string path = css_dir_ + "/" + name;
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.write(css.data(), static_cast<std::streamsize>(css.size()))) {
+            Wt::log("error") << "Workspace::TailwindBuilder - cannot write " << temporary;
+            return;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        Wt::log("error") << "Workspace::TailwindBuilder - cannot replace " << path << ": " << std::strerror(errno);
+        return;
+    }
+
+    std::error_code ec;
+    if (written_.empty()) {
+        // Sheets left by a previous run
+        for (const auto& file : std::filesystem::directory_iterator(css_dir_, ec)) {
+            std::string file_name = file.path().filename().string();
+            if (isGeneratedName(file_name) && file_name != name) {
+                std::filesystem::remove(file.path(), ec);
+            }
+        }
+    } else if (!previous_.empty() && previous_ != name) {
+        std::filesystem::remove(css_dir_ + "/" + previous_, ec);
+    }
+    previous_ = written_;
+    written_ = name;
+
+    Wt::log("info") << "Workspace::TailwindBuilder - wrote " << name << " (" << css.size() << " bytes)";
+    publish(css_url_ + name);
+}
+
+void TailwindBuilder::publish(const std::string& url)
+{
+    {
+        std::lock_guard<std::mutex> lock(url_mutex_);
+        url_ = url;
+    }
+
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    for (const auto& [id, subscriber] : subscribers_) {
+        int subscription_id = id;
+        server_.post(subscriber.first, Metrics::trackPush(Metrics::PushSource::Tailwind, [this, subscription_id, url]() {
+            Handler handler;
+            {
+                std::lock_guard<std::mutex> lock(subscribers_mutex_);
+                auto it = subscribers_.find(subscription_id);
+                if (it == subscribers_.end()) {
+                    return;
+                }
+                handler = it->second.second;
+            }
+            handler(url);
+        }));
+    }
+}
+
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "008_Workspace/FileIndex.h"
+#include "008_Workspace/TailwindRules.h"
+
+namespace Wt {
+    class WServer;
+}
+
+namespace Workspace {
+
+/**
+ * @brief Keeps a Tailwind stylesheet in step with the classes used in the sources
+ *
+ * The C++ sources under src/ and the XML bundles under static/0_stylus/xml
+ * (the @source directories of static/0_stylus/tailwind/input.css) are
+ * scanned for class candidates; only files whose size or mtime changed are
+ * re-read. The stylesheet built by the npm pipeline (tailwind.css) stays the
+ * base: classes it lacks get a rule from TailwindRules, and those rules are
+ * dropped again when the class disappears from the sources. Each distinct
+ * result is written to tailwind.<hash>.css and pushed to the sessions, which
+ * swap their stylesheet link without a reload. Rebuilds run on the server
+ * thread pool, UpdateDelay after a change, never on the watcher thread.
+ */
+class TailwindBuilder {
+public:
+    using Handler = std::function<void(std::string)>;
+
+    /**
+     * @param server Used to post stylesheet changes to sessions
+     * @param files Index to follow
+     * @param css_dir Directory holding tailwind.css; generated sheets are written there too
+     * @param css_url URL of css_dir relative to the docroot, with a trailing '/'
+     */
+    TailwindBuilder(Wt::WServer& server, FileIndex& files, std::string css_dir, std::string css_url);
+    ~TailwindBuilder();
+
+    TailwindBuilder(const TailwindBuilder&) = delete;
+    TailwindBuilder& operator=(const TailwindBuilder&) = delete;
+
+    /**
+     * @brief URL of the current generated stylesheet, empty until one was written
+     */
+    std::string styleSheetUrl() const;
+
+    /**
+     * @brief Registers a handler called with the URL of every new stylesheet
+     * @return Subscription id for unsubscribe()
+     */
+    int subscribe(const std::string& wt_session_id, Handler handler);
+    void unsubscribe(int subscription_id);
+
+    /**
+     * @brief Class candidates of a source file: the words of its string
+     * literals and, for XML, of its text content
+     */
+    static std::vector<std::string> extractClasses(std::string_view text, bool xml);
+
+    /// Delay between a FileIndex change and the rebuild that follows it
+    static constexpr std::chrono::milliseconds UpdateDelay{300};
+
+private:
+    struct Source {
+        std::uint64_t size = 0;
+        std::int64_t modified = 0;
+        std::vector<std::string> classes;  ///< Sorted, distinct
+    };
+
+    struct Generated {
+        std::string rule;  ///< Empty if the class is not a supported utility
+        std::set<std::string> variables;
+    };
+
+    /// tailwind.css split around the blocks that are rewritten
+    struct BaseSheet {
+        std::string head;       ///< Up to the theme variables
+        std::string variables;  ///< Declarations of the ":root, :host" theme block
+        std::string middle;     ///< From the end of the theme block into "@layer utilities {"
+        std::vector<std::pair<std::string, std::string>> rules;  ///< Class name and rule text
+        std::string tail;       ///< From the end of the utilities layer
+        std::set<std::string> classes;
+        std::set<std::string> properties;  ///< Variables registered with @property
+        TailwindRules::Theme theme;
+    };
+
+    void snapshotChanged(const SnapshotPtr& snapshot);
+    void runPendingUpdate();
+    void update(const SnapshotPtr& snapshot);
+    bool loadBase(const std::string& root);
+    std::string render() const;
+    void write(const std::string& css);
+    void publish(const std::string& url);
+
+    Wt::WServer& server_;
+    FileIndex& files_;
+    std::string css_dir_;
+    std::string css_url_;
+    int listener_ = 0;
+
+    std::mutex update_mutex_;  ///< Held by the running update
+    std::mutex pending_mutex_;
+    SnapshotPtr pending_;  ///< Latest snapshot not yet built
+    bool update_scheduled_ = false;
+
+    // Only touched by the running update
+    std::unordered_map<std::string, Source> sources_;
+    std::unordered_map<std::string, int> class_counts_;  ///< Class to number of sources using it
+    std::unordered_map<std::string, Generated> generated_;  ///< Rules of the classes missing from the base
+    BaseSheet base_;
+    TailwindRules rules_;
+    std::pair<std::uint64_t, std::int64_t> base_stamp_{0, 0};   ///< Size and mtime of tailwind.css
+    std::pair<std::uint64_t, std::int64_t> theme_stamp_{0, 0};  ///< Size and mtime of input.css
+    std::string written_;   ///< File name of the current sheet
+    std::string previous_;  ///< File name of the sheet before, kept for sessions still loading it
+
+    mutable std::mutex url_mutex_;
+    std::string url_;
+
+    std::mutex subscribers_mutex_;
+    std::map<int, std::pair<std::string, Handler>> subscribers_;  ///< Id to Wt session id and handler
+    int next_subscription_id_ = 1;
+};
+
+}
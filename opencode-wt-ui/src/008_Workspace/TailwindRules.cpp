@@ -0,0 +1,869 @@
+#include "008_Workspace/TailwindRules.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace Workspace {
+
+namespace {
+
+using Declarations = std::vector<std::pair<std::string, std::string>>;
+
+const std::string TransitionTiming = "var(--tw-ease, var(--default-transition-timing-function))";
+const std::string TransitionDuration = "var(--tw-duration, var(--default-transition-duration))";
+
+Declarations transition(const std::string& properties)
+{
+    return {
+        {"transition-property", properties},
+        {"transition-timing-function", TransitionTiming},
+        {"transition-duration", TransitionDuration},
+    };
+}
+
+/// Utilities without a value
+const std::map<std::string, Declarations, std::less<>>& keywords()
+{
+    static const std::map<std::string, Declarations, std::less<>> table = {
+        {"block", {{"display", "block"}}},
+        {"inline-block", {{"display", "inline-block"}}},
+        {"inline", {{"display", "inline"}}},
+        {"flex", {{"display", "flex"}}},
+        {"inline-flex", {{"display", "inline-flex"}}},
+        {"grid", {{"display", "grid"}}},
+        {"inline-grid", {{"display", "inline-grid"}}},
+        {"contents", {{"display", "contents"}}},
+        {"hidden", {{"display", "none"}}},
+        {"static", {{"position", "static"}}},
+        {"fixed", {{"position", "fixed"}}},
+        {"absolute", {{"position", "absolute"}}},
+        {"relative", {{"position", "relative"}}},
+        {"sticky", {{"position", "sticky"}}},
+        {"visible", {{"visibility", "visible"}}},
+        {"invisible", {{"visibility", "hidden"}}},
+        {"flex-row", {{"flex-direction", "row"}}},
+        {"flex-row-reverse", {{"flex-direction", "row-reverse"}}},
+        {"flex-col", {{"flex-direction", "column"}}},
+        {"flex-col-reverse", {{"flex-direction", "column-reverse"}}},
+        {"flex-wrap", {{"flex-wrap", "wrap"}}},
+        {"flex-nowrap", {{"flex-wrap", "nowrap"}}},
+        {"flex-1", {{"flex", "1"}}},
+        {"flex-auto", {{"flex", "auto"}}},
+        {"flex-initial", {{"flex", "0 auto"}}},
+        {"flex-none", {{"flex", "none"}}},
+        {"grow", {{"flex-grow", "1"}}},
+        {"grow-0", {{"flex-grow", "0"}}},
+        {"shrink", {{"flex-shrink", "1"}}},
+        {"shrink-0", {{"flex-shrink", "0"}}},
+        {"items-start", {{"align-items", "flex-start"}}},
+        {"items-end", {{"align-items", "flex-end"}}},
+        {"items-center", {{"align-items", "center"}}},
+        {"items-baseline", {{"align-items", "baseline"}}},
+        {"items-stretch", {{"align-items", "stretch"}}},
+        {"justify-start", {{"justify-content", "flex-start"}}},
+        {"justify-end", {{"justify-content", "flex-end"}}},
+        {"justify-center", {{"justify-content", "center"}}},
+        {"justify-between", {{"justify-content", "space-between"}}},
+        {"justify-around", {{"justify-content", "space-around"}}},
+        {"justify-evenly", {{"justify-content", "space-evenly"}}},
+        {"self-auto", {{"align-self", "auto"}}},
+        {"self-start", {{"align-self", "flex-start"}}},
+        {"self-end", {{"align-self", "flex-end"}}},
+        {"self-center", {{"align-self", "center"}}},
+        {"self-stretch", {{"align-self", "stretch"}}},
+        {"overflow-auto", {{"overflow", "auto"}}},
+        {"overflow-hidden", {{"overflow", "hidden"}}},
+        {"overflow-visible", {{"overflow", "visible"}}},
+        {"overflow-scroll", {{"overflow", "scroll"}}},
+        {"overflow-x-auto", {{"overflow-x", "auto"}}},
+        {"overflow-x-hidden", {{"overflow-x", "hidden"}}},
+        {"overflow-x-visible", {{"overflow-x", "visible"}}},
+        {"overflow-x-scroll", {{"overflow-x", "scroll"}}},
+        {"overflow-y-auto", {{"overflow-y", "auto"}}},
+        {"overflow-y-hidden", {{"overflow-y", "hidden"}}},
+        {"overflow-y-visible", {{"overflow-y", "visible"}}},
+        {"overflow-y-scroll", {{"overflow-y", "scroll"}}},
+        {"box-border", {{"box-sizing", "border-box"}}},
+        {"box-content", {{"box-sizing", "content-box"}}},
+        {"aspect-auto", {{"aspect-ratio", "auto"}}},
+        {"aspect-square", {{"aspect-ratio", "1 / 1"}}},
+        {"aspect-video", {{"aspect-ratio", "var(--aspect-video)"}}},
+        {"text-left", {{"text-align", "left"}}},
+        {"text-center", {{"text-align", "center"}}},
+        {"text-right", {{"text-align", "right"}}},
+        {"text-justify", {{"text-align", "justify"}}},
+        {"truncate", {{"overflow", "hidden"}, {"text-overflow", "ellipsis"}, {"white-space", "nowrap"}}},
+        {"whitespace-normal", {{"white-space", "normal"}}},
+        {"whitespace-nowrap", {{"white-space", "nowrap"}}},
+        {"whitespace-pre", {{"white-space", "pre"}}},
+        {"whitespace-pre-line", {{"white-space", "pre-line"}}},
+        {"whitespace-pre-wrap", {{"white-space", "pre-wrap"}}},
+        {"break-words", {{"overflow-wrap", "break-word"}}},
+        {"break-all", {{"word-break", "break-all"}}},
+        {"uppercase", {{"text-transform", "uppercase"}}},
+        {"lowercase", {{"text-transform", "lowercase"}}},
+        {"capitalize", {{"text-transform", "capitalize"}}},
+        {"italic", {{"font-style", "italic"}}},
+        {"not-italic", {{"font-style", "normal"}}},
+        {"underline", {{"text-decoration-line", "underline"}}},
+        {"line-through", {{"text-decoration-line", "line-through"}}},
+        {"no-underline", {{"text-decoration-line", "none"}}},
+        {"antialiased", {{"-webkit-font-smoothing", "antialiased"}, {"-moz-osx-font-smoothing", "grayscale"}}},
+        {"select-none", {{"-webkit-user-select", "none"}, {"user-select", "none"}}},
+        {"select-text", {{"-webkit-user-select", "text"}, {"user-select", "text"}}},
+        {"select-all", {{"-webkit-user-select", "all"}, {"user-select", "all"}}},
+        {"pointer-events-none", {{"pointer-events", "none"}}},
+        {"pointer-events-auto", {{"pointer-events", "auto"}}},
+        {"resize", {{"resize", "both"}}},
+        {"resize-none", {{"resize", "none"}}},
+        {"resize-x", {{"resize", "horizontal"}}},
+        {"resize-y", {{"resize", "vertical"}}},
+        {"appearance-none", {{"appearance", "none"}}},
+        {"border-solid", {{"--tw-border-style", "solid"}, {"border-style", "solid"}}},
+        {"border-dashed", {{"--tw-border-style", "dashed"}, {"border-style", "dashed"}}},
+        {"border-dotted", {{"--tw-border-style", "dotted"}, {"border-style", "dotted"}}},
+        {"border-none", {{"--tw-border-style", "none"}, {"border-style", "none"}}},
+        {"outline", {{"outline-style", "var(--tw-outline-style)"}, {"outline-width", "1px"}}},
+        {"outline-none", {{"--tw-outline-style", "none"}, {"outline-style", "none"}}},
+        {"transition", transition("color, background-color, border-color, outline-color, text-decoration-color, fill, stroke, "
+                                  "--tw-gradient-from, --tw-gradient-via, --tw-gradient-to, opacity, box-shadow, transform, "
+                                  "translate, scale, rotate, filter, -webkit-backdrop-filter, backdrop-filter, display, "
+                                  "content-visibility, overlay, pointer-events")},
+        {"transition-all", transition("all")},
+        {"transition-colors", transition("color, background-color, border-color, outline-color, text-decoration-color, fill, "
+                                         "stroke, --tw-gradient-from, --tw-gradient-via, --tw-gradient-to")},
+        {"transition-opacity", transition("opacity")},
+        {"transition-transform", transition("transform, translate, scale, rotate")},
+        {"transition-none", {{"transition-property", "none"}}},
+    };
+    return table;
+}
+
+const std::map<std::string, std::string, std::less<>>& cursors()
+{
+    static const std::map<std::string, std::string, std::less<>> table = {
+        {"auto", "auto"}, {"default", "default"}, {"pointer", "pointer"}, {"wait", "wait"},
+        {"text", "text"}, {"move", "move"}, {"help", "help"}, {"not-allowed", "not-allowed"},
+        {"grab", "grab"}, {"grabbing", "grabbing"}, {"col-resize", "col-resize"}, {"row-resize", "row-resize"},
+    };
+    return table;
+}
+
+/// Variant name to the wrappers it nests the declarations in, outermost first
+const std::map<std::string, std::vector<std::string>, std::less<>>& variants()
+{
+    static const std::map<std::string, std::vector<std::string>, std::less<>> table = {
+        {"hover", {"&:hover", "@media (hover: hover)"}},
+        {"group-hover", {"&:is(:where(.group):hover *)", "@media (hover: hover)"}},
+        {"focus", {"&:focus"}},
+        {"focus-visible", {"&:focus-visible"}},
+        {"focus-within", {"&:focus-within"}},
+        {"active", {"&:active"}},
+        {"disabled", {"&:disabled"}},
+        {"checked", {"&:checked"}},
+        {"first", {"&:first-child"}},
+        {"last", {"&:last-child"}},
+        {"odd", {"&:nth-child(odd)"}},
+        {"even", {"&:nth-child(even)"}},
+        {"placeholder", {"&::placeholder"}},
+        // Matches the custom variant declared in static/0_stylus/tailwind/input.css
+        {"dark", {"&:where(.dark, .dark *)"}},
+        {"sm", {"@media (width >= 40rem)"}},
+        {"md", {"@media (width >= 48rem)"}},
+        {"lg", {"@media (width >= 64rem)"}},
+        {"xl", {"@media (width >= 80rem)"}},
+        {"2xl", {"@media (width >= 96rem)"}},
+    };
+    return table;
+}
+
+/// --tw-* variables read through var() without a fallback, with their initial values
+const std::map<std::string, std::string>& registeredProperties()
+{
+    static const std::map<std::string, std::string> table = {
+        {"--tw-border-style", "solid"},
+        {"--tw-outline-style", "solid"},
+        {"--tw-translate-x", "0"},
+        {"--tw-translate-y", "0"},
+        {"--tw-space-x-reverse", "0"},
+        {"--tw-space-y-reverse", "0"},
+        {"--tw-divide-x-reverse", "0"},
+        {"--tw-divide-y-reverse", "0"},
+    };
+    return table;
+}
+
+bool isNumber(std::string_view text)
+{
+    if (text.empty() || text.front() == '.' || text.back() == '.') {
+        return false;
+    }
+    bool dot = false;
+    for (char c : text) {
+        if (c == '.') {
+            if (dot) {
+                return false;
+            }
+            dot = true;
+        } else if (!std::isdigit(static_cast<unsigned char>(c))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isInteger(std::string_view text)
+{
+    return !text.empty() && std::all_of(text.begin(), text.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); });
+}
+
+bool isFraction(std::string_view text)
+{
+    std::size_t slash = text.find('/');
+    return slash != std::string_view::npos && isInteger(text.substr(0, slash)) && isInteger(text.substr(slash + 1));
+}
+
+/// Value of an arbitrary "[...]" value, with underscores standing for spaces
+bool arbitrary(std::string_view value, std::string& out)
+{
+    if (value.size() < 3 || value.front() != '[' || value.back() != ']') {
+        return false;
+    }
+    out.assign(value.substr(1, value.size() - 2));
+    std::replace(out.begin(), out.end(), '_', ' ');
+    return true;
+}
+
+bool startsWith(std::string_view text, std::string_view prefix)
+{
+    return text.size() >= prefix.size() && text.compare(0, prefix.size(), prefix) == 0;
+}
+
+/// Splits "hover:dark:bg-x" on the colons outside brackets
+std::vector<std::string_view> splitVariants(std::string_view class_name)
+{
+    std::vector<std::string_view> parts;
+    int depth = 0;
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < class_name.size(); ++i) {
+        char c = class_name[i];
+        if (c == '[' || c == '(') {
+            ++depth;
+        } else if (c == ']' || c == ')') {
+            --depth;
+        } else if (c == ':' && depth == 0) {
+            parts.push_back(class_name.substr(start, i - start));
+            start = i + 1;
+        }
+    }
+    parts.push_back(class_name.substr(start));
+    return parts;
+}
+
+void collectVariables(const std::string& text, std::set<std::string>& variables)
+{
+    for (std::size_t at = text.find("var(--"); at != std::string::npos; at = text.find("var(--", at + 1)) {
+        std::size_t begin = at + 4;
+        std::size_t end = begin;
+        while (end < text.size() && (std::isalnum(static_cast<unsigned char>(text[end])) || text[end] == '-' || text[end] == '_')) {
+            ++end;
+        }
+        variables.insert(text.substr(begin, end - begin));
+    }
+}
+
+}
+
+TailwindRules::TailwindRules(Theme theme)
+    : theme_(std::move(theme))
+{
+}
+
+std::string TailwindRules::escape(std::string_view class_name)
+{
+    std::string escaped;
+    for (std::size_t i = 0; i < class_name.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(class_name[i]);
+        if (i == 0 && std::isdigit(c)) {
+            escaped += "\\3";
+            escaped += static_cast<char>(c);
+            escaped += ' ';
+        } else if (std::isalnum(c) || c == '-' || c == '_' || c >= 0x80) {
+            escaped += static_cast<char>(c);
+        } else {
+            escaped += '\\';
+            escaped += static_cast<char>(c);
+        }
+    }
+    return escaped;
+}
+
+const char* TailwindRules::propertyInitialValue(const std::string& variable)
+{
+    auto it = registeredProperties().find(variable);
+    return it == registeredProperties().end() ? nullptr : it->second.c_str();
+}
+
+bool TailwindRules::spacing(std::string_view value, bool negative, std::string& out) const
+{
+    if (value == "px") {
+        out = negative ? "-1px" : "1px";
+        return true;
+    }
+    if (isNumber(value)) {
+        if (!has("--spacing")) {
+            return false;
+        }
+        out = "calc(var(--spacing) * " + std::string(negative ? "-" : "") + std::string(value) + ")";
+        return true;
+    }
+    if (arbitrary(value, out)) {
+        if (negative) {
+            out = "calc(" + out + " * -1)";
+        }
+        return true;
+    }
+    return false;
+}
+
+bool TailwindRules::size(std::string_view value, bool negative, bool vertical, std::string& out) const
+{
+    if (spacing(value, negative, out)) {
+        return true;
+    }
+    if (isFraction(value)) {
+        out = "calc(" + std::string(value) + " * 100%)";
+    } else if (value == "full") {
+        out = "100%";
+    } else if (value == "auto") {
+        out = "auto";
+    } else if (value == "screen") {
+        out = vertical ? "100vh" : "100vw";
+    } else if (value == "min") {
+        out = "min-content";
+    } else if (value == "max") {
+        out = "max-content";
+    } else if (value == "fit") {
+        out = "fit-content";
+    } else if (!vertical && has("--container-" + std::string(value))) {
+        out = "var(--container-" + std::string(value) + ")";
+    } else {
+        return false;
+    }
+    if (negative) {
+        out = "calc(" + out + " * -1)";
+    }
+    return true;
+}
+
+bool TailwindRules::color(std::string_view value, std::string& out) const
+{
+    std::string_view name = value;
+    std::string alpha;
+    std::size_t slash = value.rfind('/');
+    if (slash != std::string_view::npos && slash + 1 < value.size() && value.back() != ']') {
+        std::string_view opacity = value.substr(slash + 1);
+        if (!isNumber(opacity)) {
+            return false;
+        }
+        alpha = std::string(opacity) + "%";
+        name = value.substr(0, slash);
+    } else if (slash != std::string_view::npos && value.back() == ']' && value[slash + 1] == '[') {
+        if (!arbitrary(value.substr(slash + 1), alpha)) {
+            return false;
+        }
+        name = value.substr(0, slash);
+    }
+
+    if (name == "transparent") {
+        out = "transparent";
+    } else if (name == "current") {
+        out = "currentcolor";
+    } else if (name == "inherit") {
+        out = "inherit";
+    } else if (arbitrary(name, out)) {
+        // Only colors; lengths and other values go to the size utilities
+        if (out.empty() || !(out[0] == '#' || startsWith(out, "rgb") || startsWith(out, "hsl") || startsWith(out, "oklch")
+                             || startsWith(out, "color-mix") || startsWith(out, "var("))) {
+            return false;
+        }
+    } else if (has("--color-" + std::string(name))) {
+        out = "var(--color-" + std::string(name) + ")";
+    } else {
+        return false;
+    }
+    if (!alpha.empty()) {
+        out = "color-mix(in oklab, " + out + " " + alpha + ", transparent)";
+    }
+    return true;
+}
+
+bool TailwindRules::utility(std::string_view name, bool negative, Utility& out) const
+{
+    Declarations& d = out.declarations;
+    std::string value;
+
+    // Arbitrary property, e.g. [mask-type:luminance]
+    if (!negative && name.size() > 2 && name.front() == '[' && name.back() == ']') {
+        std::size_t colon = name.find(':');
+        if (colon == std::string_view::npos || colon < 2) {
+            return false;
+        }
+        std::string property(name.substr(1, colon - 1));
+        if (!std::all_of(property.begin(), property.end(), [](char c) { return std::isalpha(static_cast<unsigned char>(c)) || c == '-'; })) {
+            return false;
+        }
+        value.assign(name.substr(colon + 1, name.size() - colon - 2));
+        std::replace(value.begin(), value.end(), '_', ' ');
+        d.push_back({property, value});
+        return true;
+    }
+
+    if (!negative) {
+        auto keyword = keywords().find(name);
+        if (keyword != keywords().end()) {
+            d = keyword->second;
+            return true;
+        }
+    }
+
+    // Prefix utilities; longer prefixes first where they overlap
+    struct SpacingUtility {
+        const char* prefix;
+        std::vector<const char*> properties;
+        bool negative;
+    };
+    static const std::vector<SpacingUtility> spacings = {
+        {"px-", {"padding-inline"}, false}, {"py-", {"padding-block"}, false},
+        {"pt-", {"padding-top"}, false}, {"pr-", {"padding-right"}, false},
+        {"pb-", {"padding-bottom"}, false}, {"pl-", {"padding-left"}, false},
+        {"ps-", {"padding-inline-start"}, false}, {"pe-", {"padding-inline-end"}, false},
+        {"p-", {"padding"}, false},
+        {"mx-", {"margin-inline"}, true}, {"my-", {"margin-block"}, true},
+        {"mt-", {"margin-top"}, true}, {"mr-", {"margin-right"}, true},
+        {"mb-", {"margin-bottom"}, true}, {"ml-", {"margin-left"}, true},
+        {"ms-", {"margin-inline-start"}, true}, {"me-", {"margin-inline-end"}, true},
+        {"m-", {"margin"}, true},
+        {"gap-x-", {"column-gap"}, false}, {"gap-y-", {"row-gap"}, false}, {"gap-", {"gap"}, false},
+    };
+    for (const SpacingUtility& spacing_utility : spacings) {
+        if (!startsWith(name, spacing_utility.prefix) || (negative && !spacing_utility.negative)) {
+            continue;
+        }
+        std::string_view v = name.substr(std::char_traits<char>::length(spacing_utility.prefix));
+        bool margin = spacing_utility.prefix[0] == 'm';
+        if (margin && v == "auto" && !negative) {
+            value = "auto";
+        } else if (!spacing(v, negative, value)) {
+            return false;
+        }
+        for (const char* property : spacing_utility.properties) {
+            d.push_back({property, value});
+        }
+        return true;
+    }
+
+    struct SizeUtility {
+        const char* prefix;
+        std::vector<const char*> properties;
+        bool vertical;
+        bool negative;
+    };
+    static const std::vector<SizeUtility> sizes = {
+        {"min-w-", {"min-width"}, false, false}, {"max-w-", {"max-width"}, false, false},
+        {"min-h-", {"min-height"}, true, false}, {"max-h-", {"max-height"}, true, false},
+        {"w-", {"width"}, false, false}, {"h-", {"height"}, true, false},
+        {"size-", {"width", "height"}, false, false}, {"basis-", {"flex-basis"}, false, false},
+        {"inset-x-", {"inset-inline"}, false, true}, {"inset-y-", {"inset-block"}, true, true},
+        {"inset-", {"inset"}, false, true},
+        {"top-", {"top"}, true, true}, {"bottom-", {"bottom"}, true, true},
+        {"left-", {"left"}, false, true}, {"right-", {"right"}, false, true},
+    };
+    for (const SizeUtility& size_utility : sizes) {
+        if (!startsWith(name, size_utility.prefix) || (negative && !size_utility.negative)) {
+            continue;
+        }
+        std::string_view v = name.substr(std::char_traits<char>::length(size_utility.prefix));
+        if (!size(v, negative, size_utility.vertical, value)) {
+            return false;
+        }
+        for (const char* property : size_utility.properties) {
+            d.push_back({property, value});
+        }
+        return true;
+    }
+
+    if (startsWith(name, "space-x-") || startsWith(name, "space-y-")) {
+        bool y = name[6] == 'y';
+        if (!spacing(name.substr(8), negative, value)) {
+            return false;
+        }
+        std::string reverse = y ? "--tw-space-y-reverse" : "--tw-space-x-reverse";
+        std::string side = y ? "margin-block" : "margin-inline";
+        out.nested = ":where(& > :not(:last-child))";
+        d.push_back({reverse, "0"});
+        d.push_back({side + "-start", "calc(" + value + " * var(" + reverse + "))"});
+        d.push_back({side + "-end", "calc(" + value + " * calc(1 - var(" + reverse + ")))"});
+        return true;
+    }
+
+    if (startsWith(name, "translate-x-") || startsWith(name, "translate-y-")) {
+        bool y = name[10] == 'y';
+        if (!size(name.substr(12), negative, y, value)) {
+            return false;
+        }
+        d.push_back({y ? "--tw-translate-y" : "--tw-translate-x", value});
+        d.push_back({"translate", "var(--tw-translate-x) var(--tw-translate-y)"});
+        return true;
+    }
+
+    if (negative) {
+        return false;
+    }
+
+    if (startsWith(name, "cursor-")) {
+        auto cursor = cursors().find(name.substr(7));
+        if (cursor == cursors().end()) {
+            return false;
+        }
+        d.push_back({"cursor", cursor->second});
+        return true;
+    }
+
+    if (startsWith(name, "z-") || startsWith(name, "order-")) {
+        std::string_view v = name.substr(name[0] == 'z' ? 2 : 6);
+        if (isInteger(v) || v == "auto") {
+            value = v;
+        } else if (!arbitrary(v, value)) {
+            return false;
+        }
+        d.push_back({name[0] == 'z' ? "z-index" : "order", value});
+        return true;
+    }
+
+    if (startsWith(name, "opacity-")) {
+        std::string_view v = name.substr(8);
+        if (isNumber(v)) {
+            value = std::string(v) + "%";
+        } else if (!arbitrary(v, value)) {
+            return false;
+        }
+        d.push_back({"opacity", value});
+        return true;
+    }
+
+    if (name == "rounded" || startsWith(name, "rounded-")) {
+        static const std::vector<std::pair<const char*, std::vector<const char*>>> corners = {
+            {"tl", {"border-top-left-radius"}}, {"tr", {"border-top-right-radius"}},
+            {"br", {"border-bottom-right-radius"}}, {"bl", {"border-bottom-left-radius"}},
+            {"t", {"border-top-left-radius", "border-top-right-radius"}},
+            {"r", {"border-top-right-radius", "border-bottom-right-radius"}},
+            {"b", {"border-bottom-right-radius", "border-bottom-left-radius"}},
+            {"l", {"border-top-left-radius", "border-bottom-left-radius"}},
+        };
+        std::vector<const char*> properties = {"border-radius"};
+        std::string_view v = name.size() > 8 ? name.substr(8) : std::string_view();
+        for (const auto& [corner, corner_properties] : corners) {
+            std::string_view c(corner);
+            if (v == c || startsWith(v, std::string(c) + "-")) {
+                properties = corner_properties;
+                v = v.size() > c.size() ? v.substr(c.size() + 1) : std::string_view();
+                break;
+            }
+        }
+        if (v.empty()) {
+            value = "0.25rem";
+        } else if (v == "none") {
+            value = "0";
+        } else if (v == "full") {
+            value = "calc(infinity * 1px)";
+        } else if (has("--radius-" + std::string(v))) {
+            value = "var(--radius-" + std::string(v) + ")";
+        } else if (!arbitrary(v, value)) {
+            return false;
+        }
+        for (const char* property : properties) {
+            d.push_back({property, value});
+        }
+        return true;
+    }
+
+    if (name == "border" || startsWith(name, "border-")) {
+        static const std::vector<std::pair<const char*, std::vector<const char*>>> sides = {
+            {"x", {"border-inline"}}, {"y", {"border-block"}},
+            {"t", {"border-top"}}, {"r", {"border-right"}}, {"b", {"border-bottom"}}, {"l", {"border-left"}},
+        };
+        std::vector<const char*> prefixes = {"border"};
+        std::string_view v = name.size() > 7 ? name.substr(7) : std::string_view();
+        for (const auto& [side, side_prefixes] : sides) {
+            std::string_view s(side);
+            if (v == s || startsWith(v, std::string(s) + "-")) {
+                prefixes = side_prefixes;
+                v = v.size() > s.size() ? v.substr(s.size() + 1) : std::string_view();
+                break;
+            }
+        }
+        if (v.empty() || isInteger(v)) {
+            value = v.empty() ? "1px" : std::string(v) + "px";
+            for (const char* prefix : prefixes) {
+                d.push_back({std::string(prefix) + "-style", "var(--tw-border-style)"});
+                d.push_back({std::string(prefix) + "-width", value});
+            }
+            return true;
+        }
+        if (prefixes.size() == 1 && prefixes[0] == std::string("border") && color(v, value)) {
+            d.push_back({"border-color", value});
+            return true;
+        }
+        return false;
+    }
+
+    if (name == "divide-x" || name == "divide-y" || startsWith(name, "divide-x-") || startsWith(name, "divide-y-")) {
+        bool y = name[7] == 'y';
+        std::string_view v = name.size() > 9 ? name.substr(9) : std::string_view();
+        if (!v.empty() && !isInteger(v)) {
+            return false;
+        }
+        std::string width = v.empty() ? "1px" : std::string(v) + "px";
+        std::string reverse = y ? "--tw-divide-y-reverse" : "--tw-divide-x-reverse";
+        std::string first = y ? "border-top" : "border-inline-start";
+        std::string last = y ? "border-bottom" : "border-inline-end";
+        out.nested = ":where(& > :not(:last-child))";
+        d.push_back({reverse, "0"});
+        d.push_back({last + "-style", "var(--tw-border-style)"});
+        d.push_back({first + "-style", "var(--tw-border-style)"});
+        d.push_back({first + "-width", "calc(" + width + " * var(" + reverse + "))"});
+        d.push_back({last + "-width", "calc(" + width + " * calc(1 - var(" + reverse + ")))"});
+        return true;
+    }
+
+    if (startsWith(name, "divide-") && color(name.substr(7), value)) {
+        out.nested = ":where(& > :not(:last-child))";
+        d.push_back({"border-color", value});
+        return true;
+    }
+
+    if (startsWith(name, "bg-") && color(name.substr(3), value)) {
+        d.push_back({"background-color", value});
+        return true;
+    }
+
+    if (startsWith(name, "text-")) {
+        std::string v(name.substr(5));
+        if (has("--text-" + v)) {
+            d.push_back({"font-size", "var(--text-" + v + ")"});
+            if (has("--text-" + v + "--line-height")) {
+                d.push_back({"line-height", "var(--tw-leading, var(--text-" + v + "--line-height))"});
+            }
+            return true;
+        }
+        if (color(v, value)) {
+            d.push_back({"color", value});
+            return true;
+        }
+        if (arbitrary(v, value) && !value.empty() && (std::isdigit(static_cast<unsigned char>(value[0])) || value[0] == '.'
+                                                      || startsWith(value, "calc(") || startsWith(value, "clamp("))) {
+            d.push_back({"font-size", value});
+            return true;
+        }
+        return false;
+    }
+
+    if (startsWith(name, "font-")) {
+        std::string v(name.substr(5));
+        if (has("--font-weight-" + v)) {
+            d.push_back({"--tw-font-weight", "var(--font-weight-" + v + ")"});
+            d.push_back({"font-weight", "var(--font-weight-" + v + ")"});
+            return true;
+        }
+        if (has("--font-" + v)) {
+            d.push_back({"font-family", "var(--font-" + v + ")"});
+            return true;
+        }
+        return false;
+    }
+
+    if (startsWith(name, "leading-")) {
+        std::string_view v = name.substr(8);
+        if (has("--leading-" + std::string(v))) {
+            value = "var(--leading-" + std::string(v) + ")";
+        } else if (v == "none") {
+            value = "1";
+        } else if (!spacing(v, false, value)) {
+            return false;
+        }
+        d.push_back({"--tw-leading", value});
+        d.push_back({"line-height", value});
+        return true;
+    }
+
+    if (startsWith(name, "tracking-")) {
+        std::string v(name.substr(9));
+        if (has("--tracking-" + v)) {
+            value = "var(--tracking-" + v + ")";
+        } else if (!arbitrary(v, value)) {
+            return false;
+        }
+        d.push_back({"--tw-tracking", value});
+        d.push_back({"letter-spacing", value});
+        return true;
+    }
+
+    if (startsWith(name, "fill-") && color(name.substr(5), value)) {
+        d.push_back({"fill", value});
+        return true;
+    }
+    if (startsWith(name, "stroke-") && color(name.substr(7), value)) {
+        d.push_back({"stroke", value});
+        return true;
+    }
+
+    if (startsWith(name, "outline-offset-")) {
+        std::string_view v = name.substr(15);
+        if (!isInteger(v)) {
+            return false;
+        }
+        d.push_back({"outline-offset", std::string(v) + "px"});
+        return true;
+    }
+    if (startsWith(name, "outline-")) {
+        std::string_view v = name.substr(8);
+        if (isInteger(v)) {
+            d.push_back({"outline-style", "var(--tw-outline-style)"});
+            d.push_back({"outline-width", std::string(v) + "px"});
+            return true;
+        }
+        if (color(v, value)) {
+            d.push_back({"outline-color", value});
+            return true;
+        }
+        return false;
+    }
+
+    if (startsWith(name, "ring-") && color(name.substr(5), value)) {
+        d.push_back({"--tw-ring-color", value});
+        return true;
+    }
+
+    if (startsWith(name, "duration-") || startsWith(name, "delay-")) {
+        bool duration = name[0] == 'd' && name[1] == 'u';
+        std::string_view v = name.substr(duration ? 9 : 6);
+        if (isInteger(v)) {
+            value = std::string(v) + "ms";
+        } else if (!arbitrary(v, value)) {
+            return false;
+        }
+        if (duration) {
+            d.push_back({"--tw-duration", value});
+            d.push_back({"transition-duration", value});
+        } else {
+            d.push_back({"transition-delay", value});
+        }
+        return true;
+    }
+
+    if (startsWith(name, "ease-")) {
+        std::string v(name.substr(5));
+        if (v == "linear") {
+            value = "linear";
+        } else if (has("--ease-" + v)) {
+            value = "var(--ease-" + v + ")";
+        } else {
+            return false;
+        }
+        d.push_back({"--tw-ease", value});
+        d.push_back({"transition-timing-function", value});
+        return true;
+    }
+
+    if (startsWith(name, "grid-cols-") || startsWith(name, "grid-rows-")) {
+        std::string_view v = name.substr(10);
+        if (isInteger(v)) {
+            value = "repeat(" + std::string(v) + ", minmax(0, 1fr))";
+        } else if (v == "none") {
+            value = "none";
+        } else if (!arbitrary(v, value)) {
+            return false;
+        }
+        d.push_back({name[5] == 'c' ? "grid-template-columns" : "grid-template-rows", value});
+        return true;
+    }
+
+    if (startsWith(name, "col-span-") || startsWith(name, "row-span-")) {
+        std::string_view v = name.substr(9);
+        if (isInteger(v)) {
+            value = "span " + std::string(v) + " / span " + std::string(v);
+        } else if (v == "full") {
+            value = "1 / -1";
+        } else {
+            return false;
+        }
+        d.push_back({name[0] == 'c' ? "grid-column" : "grid-row", value});
+        return true;
+    }
+
+    return false;
+}
+
+std::string TailwindRules::rule(std::string_view class_name, std::set<std::string>* variables) const
+{
+    std::vector<std::string_view> parts = splitVariants(class_name);
+    std::string_view name = parts.back();
+    parts.pop_back();
+
+    std::vector<std::string> wrappers;
+    for (std::string_view variant : parts) {
+        auto it = variants().find(variant);
+        if (it == variants().end()) {
+            return std::string();
+        }
+        wrappers.insert(wrappers.end(), it->second.begin(), it->second.end());
+    }
+
+    bool important = false;
+    if (!name.empty() && name.front() == '!') {
+        important = true;
+        name.remove_prefix(1);
+    } else if (!name.empty() && name.back() == '!') {
+        important = true;
+        name.remove_suffix(1);
+    }
+    bool negative = false;
+    if (!name.empty() && name.front() == '-') {
+        negative = true;
+        name.remove_prefix(1);
+    }
+    if (name.empty() || name.back() == '-') {
+        return std::string();
+    }
+
+    Utility utility_rule;
+    if (!utility(name, negative, utility_rule) || utility_rule.declarations.empty()) {
+        return std::string();
+    }
+    if (!utility_rule.nested.empty()) {
+        wrappers.push_back(utility_rule.nested);
+    }
+
+    std::string css = "  ." + escape(class_name) + " {\n";
+    std::string indent = "    ";
+    for (const std::string& wrapper : wrappers) {
+        css += indent + wrapper + " {\n";
+        indent += "  ";
+    }
+    for (const auto& [property, value] : utility_rule.declarations) {
+        css += indent + property + ": " + value + (important ? " !important" : "") + ";\n";
+    }
+    for (std::size_t i = 0; i < wrappers.size(); ++i) {
+        indent.resize(indent.size() - 2);
+        css += indent + "}\n";
+    }
+    css += "  }\n";
+
+    if (variables) {
+        collectVariables(css, *variables);
+    }
+    return css;
+}
+
+}
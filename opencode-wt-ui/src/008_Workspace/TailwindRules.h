@@ -0,0 +1,67 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Workspace {
+
+/**
+ * @brief Generates Tailwind v4 utility rules for single class names
+ *
+ * Covers the utilities this project uses (layout, flexbox, spacing, sizing,
+ * typography, colors, borders, transitions, translate) with the pseudo-class,
+ * dark and responsive variants, arbitrary values and the important modifier.
+ * Values come from the theme variables, so a rule is only produced when the
+ * variables it references are known. Rules are laid out like the output of
+ * the Tailwind CLI, with native CSS nesting for variants.
+ */
+class TailwindRules {
+public:
+    /// Theme variable name (e.g. "--color-gray-200") to value
+    using Theme = std::map<std::string, std::string>;
+
+    explicit TailwindRules(Theme theme = {});
+
+    void setTheme(Theme theme) { theme_ = std::move(theme); }
+    const Theme& theme() const { return theme_; }
+
+    /**
+     * @brief Rule for one class, indented for an "@layer utilities" block
+     * @param variables Receives the variables the rule references with var()
+     * @return Empty if the class is not a supported utility
+     */
+    std::string rule(std::string_view class_name, std::set<std::string>* variables = nullptr) const;
+
+    /**
+     * @brief Class name escaped for use in a CSS selector
+     */
+    static std::string escape(std::string_view class_name);
+
+    /**
+     * @brief Initial value of a --tw-* variable that must be registered with
+     * \@property, or nullptr if the variable needs no registration
+     */
+    static const char* propertyInitialValue(const std::string& variable);
+
+private:
+    using Declarations = std::vector<std::pair<std::string, std::string>>;
+
+    struct Utility {
+        std::string nested;  ///< Inner selector, e.g. for space-y, empty for none
+        Declarations declarations;
+    };
+
+    bool utility(std::string_view name, bool negative, Utility& out) const;
+    bool has(const std::string& variable) const { return theme_.count(variable) != 0; }
+    bool spacing(std::string_view value, bool negative, std::string& out) const;
+    bool size(std::string_view value, bool negative, bool vertical, std::string& out) const;
+    bool color(std::string_view value, std::string& out) const;
+
+    Theme theme_;
+};
+
+}
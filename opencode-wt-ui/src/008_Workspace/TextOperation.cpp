@@ -0,0 +1,295 @@
+#include "008_Workspace/TextOperation.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace Workspace {
+
+namespace {
+
+using Kind = TextOperation::Component::Kind;
+
+/// Walks the components of an operation, allowing partial consumption
+class Cursor {
+public:
+    explicit Cursor(const TextOperation& operation) : components_(operation.components()) { load(); }
+
+    bool done() const { return index_ >= components_.size(); }
+    Kind kind() const { return components_[index_].kind; }
+    const std::u16string& text() const { return components_[index_].text; }
+    std::size_t remaining() const { return remaining_; }
+
+    void consume(std::size_t count)
+    {
+        remaining_ -= count;
+        if (remaining_ == 0) {
+            ++index_;
+            load();
+        }
+    }
+
+    void next()
+    {
+        ++index_;
+        load();
+    }
+
+private:
+    void load()
+    {
+        if (!done()) {
+            remaining_ = kind() == Kind::Insert ? text().size() : components_[index_].count;
+        }
+    }
+
+    const std::vector<TextOperation::Component>& components_;
+    std::size_t index_ = 0;
+    std::size_t remaining_ = 0;
+};
+
+}
+
+TextOperation& TextOperation::retain(std::size_t count)
+{
+    if (count == 0) {
+        return *this;
+    }
+    base_length_ += count;
+    target_length_ += count;
+    if (!components_.empty() && components_.back().kind == Kind::Retain) {
+        components_.back().count += count;
+    } else {
+        components_.push_back({Kind::Retain, count, {}});
+    }
+    return *this;
+}
+
+TextOperation& TextOperation::insert(std::u16string_view text)
+{
+    if (text.empty()) {
+        return *this;
+    }
+    target_length_ += text.size();
+    // Inserts are kept in front of an adjacent delete so equal edits compare equal
+    if (!components_.empty() && components_.back().kind == Kind::Insert) {
+        components_.back().text.append(text);
+    } else if (!components_.empty() && components_.back().kind == Kind::Delete) {
+        if (components_.size() >= 2 && components_[components_.size() - 2].kind == Kind::Insert) {
+            components_[components_.size() - 2].text.append(text);
+        } else {
+            components_.insert(components_.end() - 1, Component{Kind::Insert, 0, std::u16string(text)});
+        }
+    } else {
+        components_.push_back({Kind::Insert, 0, std::u16string(text)});
+    }
+    return *this;
+}
+
+TextOperation& TextOperation::remove(std::size_t count)
+{
+    if (count == 0) {
+        return *this;
+    }
+    base_length_ += count;
+    if (!components_.empty() && components_.back().kind == Kind::Delete) {
+        components_.back().count += count;
+    } else {
+        components_.push_back({Kind::Delete, count, {}});
+    }
+    return *this;
+}
+
+bool TextOperation::isNoop() const
+{
+    return components_.empty() || (components_.size() == 1 && components_[0].kind == Kind::Retain);
+}
+
+bool TextOperation::apply(std::u16string& text) const
+{
+    if (text.size() != base_length_) {
+        return false;
+    }
+    std::u16string result;
+    result.reserve(target_length_);
+    std::size_t pos = 0;
+    for (const Component& component : components_) {
+        switch (component.kind) {
+        case Kind::Retain:
+            result.append(text, pos, component.count);
+            pos += component.count;
+            break;
+        case Kind::Insert:
+            result.append(component.text);
+            break;
+        case Kind::Delete:
+            pos += component.count;
+            break;
+        }
+    }
+    text = std::move(result);
+    return true;
+}
+
+bool TextOperation::transform(const TextOperation& a, const TextOperation& b, TextOperation& a_prime, TextOperation& b_prime)
+{
+    if (a.base_length_ != b.base_length_) {
+        return false;
+    }
+    a_prime = TextOperation();
+    b_prime = TextOperation();
+    Cursor i(a);
+    Cursor j(b);
+    while (!i.done() || !j.done()) {
+        if (!i.done() && i.kind() == Kind::Insert) {
+            a_prime.insert(i.text());
+            b_prime.retain(i.text().size());
+            i.next();
+            continue;
+        }
+        if (!j.done() && j.kind() == Kind::Insert) {
+            a_prime.retain(j.text().size());
+            b_prime.insert(j.text());
+            j.next();
+            continue;
+        }
+        if (i.done() || j.done()) {
+            return false;
+        }
+
+        std::size_t count = std::min(i.remaining(), j.remaining());
+        if (i.kind() == Kind::Retain && j.kind() == Kind::Retain) {
+            a_prime.retain(count);
+            b_prime.retain(count);
+        } else if (i.kind() == Kind::Delete && j.kind() == Kind::Retain) {
+            a_prime.remove(count);
+        } else if (i.kind() == Kind::Retain && j.kind() == Kind::Delete) {
+            b_prime.remove(count);
+        }
+        // Both deleting the same range leaves nothing for either side
+        i.consume(count);
+        j.consume(count);
+    }
+    return true;
+}
+
+nlohmann::json TextOperation::toJson() const
+{
+    nlohmann::json json = nlohmann::json::array();
+    for (const Component& component : components_) {
+        switch (component.kind) {
+        case Kind::Retain:
+            json.push_back(static_cast<std::int64_t>(component.count));
+            break;
+        case Kind::Insert:
+            json.push_back(toUtf8(component.text));
+            break;
+        case Kind::Delete:
+            json.push_back(-static_cast<std::int64_t>(component.count));
+            break;
+        }
+    }
+    return json;
+}
+
+bool TextOperation::fromJson(const nlohmann::json& json, TextOperation& out)
+{
+    if (!json.is_array()) {
+        return false;
+    }
+    out = TextOperation();
+    for (const nlohmann::json& item : json) {
+        if (item.is_string()) {
+            out.insert(fromUtf8(item.get_ref<const std::string&>()));
+        } else if (item.is_number_integer()) {
+            std::int64_t count = item.get<std::int64_t>();
+            if (count == 0) {
+                return false;
+            }
+            if (count > 0) {
+                out.retain(static_cast<std::size_t>(count));
+            } else {
+                out.remove(static_cast<std::size_t>(-count));
+            }
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::u16string TextOperation::fromUtf8(std::string_view text)
+{
+    std::u16string result;
+    result.reserve(text.size());
+    for (std::size_t i = 0; i < text.size();) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        std::uint32_t code = 0xFFFD;
+        std::size_t length = 1;
+        if (c < 0x80) {
+            code = c;
+        } else if ((c >> 5) == 0x6) {
+            length = 2;
+        } else if ((c >> 4) == 0xE) {
+            length = 3;
+        } else if ((c >> 3) == 0x1E) {
+            length = 4;
+        }
+        if (length > 1) {
+            bool valid = i + length <= text.size();
+            std::uint32_t value = c & (0xFF >> (length + 1));
+            for (std::size_t k = 1; valid && k < length; ++k) {
+                unsigned char next = static_cast<unsigned char>(text[i + k]);
+                valid = (next >> 6) == 0x2;
+                value = (value << 6) | (next & 0x3F);
+            }
+            if (valid) {
+                code = value;
+            } else {
+                length = 1;
+            }
+        }
+        i += length;
+
+        if (code >= 0x10000) {
+            code -= 0x10000;
+            result.push_back(static_cast<char16_t>(0xD800 + (code >> 10)));
+            result.push_back(static_cast<char16_t>(0xDC00 + (code & 0x3FF)));
+        } else {
+            result.push_back(static_cast<char16_t>(code));
+        }
+    }
+    return result;
+}
+
+std::string TextOperation::toUtf8(std::u16string_view text)
+{
+    std::string result;
+    result.reserve(text.size());
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        std::uint32_t code = text[i];
+        if (code >= 0xD800 && code < 0xDC00 && i + 1 < text.size() && text[i + 1] >= 0xDC00 && text[i + 1] < 0xE000) {
+            code = 0x10000 + ((code - 0xD800) << 10) + (text[i + 1] - 0xDC00);
+            ++i;
+        } else if (code >= 0xD800 && code < 0xE000) {
+            code = 0xFFFD;
+        }
+        if (code < 0x80) {
+            result.push_back(static_cast<char>(code));
+        } else if (code < 0x800) {
+            result.push_back(static_cast<char>(0xC0 | (code >> 6)));
+            result.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+            result.push_back(static_cast<char>(0xE0 | (code >> 12)));
+            result.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else {
+            result.push_back(static_cast<char>(0xF0 | (code >> 18)));
+            result.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace Workspace {
+
+/**
+ * @brief An edit of a whole text: a sequence of retain, insert and delete
+ *
+ * Lengths count UTF-16 code units, the unit of the browser editors, so
+ * offsets line up with Monaco without conversion. In JSON an operation is
+ * an array where a positive number retains, a negative number deletes and
+ * a string inserts, as in ot.js.
+ */
+class TextOperation {
+public:
+    struct Component {
+        enum class Kind { Retain, Insert, Delete };
+        Kind kind;
+        std::size_t count = 0;  ///< Retained or deleted units
+        std::u16string text;    ///< Inserted text
+    };
+
+    TextOperation& retain(std::size_t count);
+    TextOperation& insert(std::u16string_view text);
+    TextOperation& remove(std::size_t count);
+
+    const std::vector<Component>& components() const { return components_; }
+
+    /// Length of the text the operation applies to
+    std::size_t baseLength() const { return base_length_; }
+    /// Length of the text after applying it
+    std::size_t targetLength() const { return target_length_; }
+    /// Whether the operation leaves every text unchanged
+    bool isNoop() const;
+
+    /**
+     * @brief Applies the operation in place
+     * @return False, leaving text unchanged, if the lengths do not match
+     */
+    bool apply(std::u16string& text) const;
+
+    /**
+     * @brief Transforms two operations made concurrently on the same text
+     *
+     * a' applies after b and b' after a, with the same result. When both
+     * insert at the same offset, a's insert goes first.
+     * @return False if a and b do not apply to the same text
+     */
+    static bool transform(const TextOperation& a, const TextOperation& b, TextOperation& a_prime, TextOperation& b_prime);
+
+    nlohmann::json toJson() const;
+    static bool fromJson(const nlohmann::json& json, TextOperation& out);
+
+    static std::u16string fromUtf8(std::string_view text);
+    static std::string toUtf8(std::u16string_view text);
+
+private:
+    std::vector<Component> components_;
+    std::size_t base_length_ = 0;
+    std::size_t target_length_ = 0;
+};
+
+}
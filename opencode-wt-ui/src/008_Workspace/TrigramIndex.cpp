@@ -0,0 +1,483 @@
+#include "008_Workspace/TrigramIndex.h"
+#include "000_Server/AsyncLog.h"
+
+#include <Wt/WLogger.h>
+#include <Wt/WIOService.h>
+#include <Wt/WServer.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace Workspace {
+
+namespace {
+
+constexpr char Magic[4] = {'W', 'T', 'R', 'I'};
+constexpr std::uint32_t FormatVersion = 1;
+
+/// Bytes inspected for a NUL to classify a file as binary
+constexpr std::size_t BinaryProbe = 8000;
+/// Longest line text reported with a hit
+constexpr std::size_t MaxLineText = 240;
+
+const std::vector<std::string> TextExtensions = {
+    "xml", "css", "js", "json", "html", "svg", "md", "txt", "cpp", "h", "hpp", "c", "cc"
+};
+
+std::uint32_t trigramAt(const char* p)
+{
+    return (static_cast<std::uint32_t>(static_cast<unsigned char>(p[0])) << 16)
+         | (static_cast<std::uint32_t>(static_cast<unsigned char>(p[1])) << 8)
+         | static_cast<std::uint32_t>(static_cast<unsigned char>(p[2]));
+}
+
+std::vector<std::uint32_t> trigramsOf(std::string_view text)
+{
+    std::vector<std::uint32_t> trigrams;
+    if (text.size() < 3) {
+        return trigrams;
+    }
+    trigrams.reserve(text.size() - 2);
+    for (std::size_t i = 0; i + 3 <= text.size(); ++i) {
+        trigrams.push_back(trigramAt(text.data() + i));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+bool identifierChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-';
+}
+
+bool readText(const std::string& path, std::string& text)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    text = content.str();
+    return std::memchr(text.data(), '\0', std::min(text.size(), BinaryProbe)) == nullptr;
+}
+
+template <typename T>
+void put(std::string& out, T value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool get(std::string_view& in, T& value)
+{
+    if (in.size() < sizeof(value)) {
+        return false;
+    }
+    std::memcpy(&value, in.data(), sizeof(value));
+    in.remove_prefix(sizeof(value));
+    return true;
+}
+
+}
+
+TrigramIndex::TrigramIndex(Wt::WServer& server, FileIndex& files, std::string path, std::vector<std::string> roots)
+    : server_(server),
+      files_(files),
+      path_(std::move(path)),
+      roots_(std::move(roots))
+{
+    load();
+    SnapshotPtr snapshot = files_.snapshot();
+    if (snapshot->version() > 0) {
+        update(snapshot);
+    }
+    listener_ = files_.listen([this](const SnapshotPtr& snapshot) { snapshotChanged(snapshot); });
+}
+
+TrigramIndex::~TrigramIndex()
+{
+    files_.unlisten(listener_);
+    std::lock_guard<std::mutex> lock(update_mutex_);
+}
+
+void TrigramIndex::snapshotChanged(const SnapshotPtr& snapshot)
+{
+    // Called on the watcher thread with the FileIndex listeners locked:
+    // only note the snapshot, reading files and saving happen elsewhere
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    pending_ = snapshot;
+    if (!update_scheduled_) {
+        update_scheduled_ = true;
+        server_.ioService().schedule(UpdateDelay, [this]() { runPendingUpdate(); });
+    }
+}
+
+void TrigramIndex::runPendingUpdate()
+{
+    std::lock_guard<std::mutex> update_lock(update_mutex_);
+    SnapshotPtr snapshot;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        snapshot.swap(pending_);
+        update_scheduled_ = false;
+    }
+    if (snapshot) {
+        update(snapshot);
+    }
+}
+
+std::size_t TrigramIndex::fileCount() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return ids_.size();
+}
+
+bool TrigramIndex::indexable(const FileEntry& entry) const
+{
+    if (entry.directory || entry.size == 0 || entry.size > MaxFileSize) {
+        return false;
+    }
+    bool in_root = std::any_of(roots_.begin(), roots_.end(), [&entry](const std::string& root) {
+        return entry.path.size() > root.size() && entry.path[root.size()] == '/' && entry.path.compare(0, root.size(), root) == 0;
+    });
+    if (!in_root) {
+        return false;
+    }
+    std::size_t dot = entry.path.find_last_of("./");
+    if (dot == std::string::npos || entry.path[dot] != '.') {
+        return false;
+    }
+    std::string extension = entry.path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return std::find(TextExtensions.begin(), TextExtensions.end(), extension) != TextExtensions.end();
+}
+
+bool TrigramIndex::readDocument(const std::string& root, Document& document) const
+{
+    std::string text;
+    if (!readText(root + "/" + document.path, text)) {
+        return false;
+    }
+    document.trigrams = trigramsOf(text);
+    document.alive = true;
+    return true;
+}
+
+void TrigramIndex::addDocument(Document document)
+{
+    // Ids only grow, so appending keeps every posting list sorted
+    std::uint32_t id = static_cast<std::uint32_t>(documents_.size());
+    for (std::uint32_t trigram : document.trigrams) {
+        postings_[trigram].push_back(id);
+    }
+    ids_[document.path] = id;
+    documents_.push_back(std::move(document));
+}
+
+void TrigramIndex::removeDocument(std::uint32_t id)
+{
+    Document& document = documents_[id];
+    for (std::uint32_t trigram : document.trigrams) {
+        auto posting = postings_.find(trigram);
+        if (posting == postings_.end()) {
+            continue;
+        }
+        std::vector<std::uint32_t>& ids = posting->second;
+        auto it = std::lower_bound(ids.begin(), ids.end(), id);
+        if (it != ids.end() && *it == id) {
+            ids.erase(it);
+        }
+        if (ids.empty()) {
+            postings_.erase(posting);
+        }
+    }
+    ids_.erase(document.path);
+    document = Document();
+    ++dead_;
+}
+
+void TrigramIndex::update(const SnapshotPtr& snapshot)
+{
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        root_ = snapshot->root();
+    }
+
+    // Decide what changed under a shared lock; this is the only writer
+    std::vector<Document> changed;
+    std::vector<std::uint32_t> removed;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::unordered_map<std::string, std::uint32_t> unseen = ids_;
+        for (const FileEntry& entry : snapshot->entries()) {
+            if (!indexable(entry)) {
+                continue;
+            }
+            auto it = ids_.find(entry.path);
+            if (it != ids_.end()) {
+                unseen.erase(entry.path);
+                const Document& document = documents_[it->second];
+                if (document.size == entry.size && document.modified == entry.modified) {
+                    continue;
+                }
+                removed.push_back(it->second);
+            }
+            Document document;
+            document.path = entry.path;
+            document.size = entry.size;
+            document.modified = entry.modified;
+            changed.push_back(std::move(document));
+        }
+        for (const auto& [path, id] : unseen) {
+            removed.push_back(id);
+        }
+    }
+    if (changed.empty() && removed.empty()) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        built_ = true;
+        return;
+    }
+
+    // Files are read without holding the lock
+    std::vector<Document> added;
+    added.reserve(changed.size());
+    for (Document& document : changed) {
+        if (readDocument(snapshot->root(), document)) {
+            added.push_back(std::move(document));
+        }
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        for (std::uint32_t id : removed) {
+            removeDocument(id);
+        }
+        for (Document& document : added) {
+            addDocument(std::move(document));
+        }
+
+        // Renumber once removed documents outweigh live ones
+        if (dead_ > ids_.size()) {
+            std::vector<Document> documents;
+            documents.swap(documents_);
+            ids_.clear();
+            postings_.clear();
+            dead_ = 0;
+            for (Document& document : documents) {
+                if (document.alive) {
+                    addDocument(std::move(document));
+                }
+            }
+        }
+        built_ = true;
+    }
+
+    APP_LOG(Debug) << "Workspace::TrigramIndex - indexed " << added.size() << " changed files, dropped "
+                   << removed.size() << " old entries, " << fileCount() << " files indexed";
+    save();
+}
+
+std::vector<UsageHit> TrigramIndex::find(std::string_view term, bool whole_word, std::size_t max_hits) const
+{
+    std::vector<UsageHit> hits;
+    if (term.empty()) {
+        return hits;
+    }
+
+    std::vector<std::string> candidates;
+    std::string root;
+    bool built = false;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        built = built_;
+    }
+    if (!built) {
+        // No update has run yet, the loaded index may be stale: scan every indexable file
+        SnapshotPtr snapshot = files_.snapshot();
+        root = snapshot->root();
+        for (const FileEntry& entry : snapshot->entries()) {
+            if (indexable(entry)) {
+                candidates.push_back(entry.path);
+            }
+        }
+    } else {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        root = root_;
+        std::vector<std::uint32_t> ids;
+        if (term.size() < 3) {
+            for (const auto& [path, id] : ids_) {
+                ids.push_back(id);
+            }
+        } else {
+            // Intersect the posting lists, smallest first
+            std::vector<const std::vector<std::uint32_t>*> lists;
+            for (std::uint32_t trigram : trigramsOf(term)) {
+                auto posting = postings_.find(trigram);
+                if (posting == postings_.end()) {
+                    return hits;
+                }
+                lists.push_back(&posting->second);
+            }
+            std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+            ids = *lists.front();
+            for (std::size_t i = 1; i < lists.size() && !ids.empty(); ++i) {
+                std::vector<std::uint32_t> both;
+                std::set_intersection(ids.begin(), ids.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(both));
+                ids.swap(both);
+            }
+        }
+        for (std::uint32_t id : ids) {
+            candidates.push_back(documents_[id].path);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), Snapshot::pathLess);
+
+    // Trigrams only say a file may contain the term; confirm and locate it
+    std::string text;
+    for (const std::string& path : candidates) {
+        if (!readText(root + "/" + path, text)) {
+            continue;
+        }
+        std::string_view view(text);
+        std::uint32_t line = 1;
+        std::size_t counted = 0;
+        for (std::size_t at = view.find(term); at != std::string_view::npos; at = view.find(term, at + 1)) {
+            if (whole_word && ((at > 0 && identifierChar(view[at - 1]))
+                               || (at + term.size() < view.size() && identifierChar(view[at + term.size()])))) {
+                continue;
+            }
+            line += static_cast<std::uint32_t>(std::count(view.begin() + counted, view.begin() + at, '\n'));
+            counted = at;
+
+            std::size_t line_start = view.rfind('\n', at);
+            line_start = line_start == std::string_view::npos ? 0 : line_start + 1;
+            std::size_t line_end = view.find('\n', at);
+            if (line_end == std::string_view::npos) {
+                line_end = view.size();
+            }
+            std::size_t length = std::min(line_end - line_start, MaxLineText);
+            while (length < line_end - line_start && length > 0 && (view[line_start + length] & 0xC0) == 0x80) {
+                --length;
+            }
+
+            UsageHit hit;
+            hit.path = path;
+            hit.line = line;
+            hit.column = static_cast<std::uint32_t>(at - line_start);
+            hit.text = std::string(view.substr(line_start, length));
+            hits.push_back(std::move(hit));
+            if (hits.size() >= max_hits) {
+                return hits;
+            }
+            // One hit per line
+            at = line_end;
+            if (at >= view.size()) {
+                break;
+            }
+        }
+    }
+    return hits;
+}
+
+bool TrigramIndex::load()
+{
+    std::ifstream file(path_, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    std::string data = content.str();
+    std::string_view in(data);
+
+    std::uint32_t version = 0;
+    std::uint32_t count = 0;
+    if (in.size() < sizeof(Magic) || std::memcmp(in.data(), Magic, sizeof(Magic)) != 0) {
+        return false;
+    }
+    in.remove_prefix(sizeof(Magic));
+    if (!get(in, version) || version != FormatVersion || !get(in, count)) {
+        return false;
+    }
+
+    std::vector<Document> documents;
+    documents.reserve(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        Document document;
+        std::uint16_t length = 0;
+        std::uint32_t trigrams = 0;
+        if (!get(in, length) || in.size() < length) {
+            return false;
+        }
+        document.path.assign(in.data(), length);
+        in.remove_prefix(length);
+        if (!get(in, document.size) || !get(in, document.modified) || !get(in, trigrams)
+            || in.size() < static_cast<std::size_t>(trigrams) * sizeof(std::uint32_t)) {
+            return false;
+        }
+        document.trigrams.resize(trigrams);
+        std::memcpy(document.trigrams.data(), in.data(), trigrams * sizeof(std::uint32_t));
+        in.remove_prefix(trigrams * sizeof(std::uint32_t));
+        document.alive = true;
+        documents.push_back(std::move(document));
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    for (Document& document : documents) {
+        addDocument(std::move(document));
+    }
+    Wt::log("info") << "Workspace::TrigramIndex - loaded " << ids_.size() << " files from " << path_;
+    return true;
+}
+
+void TrigramIndex::save() const
+{
+    std::string out;
+    out.append(Magic, sizeof(Magic));
+    put(out, FormatVersion);
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        put(out, static_cast<std::uint32_t>(ids_.size()));
+        for (const Document& document : documents_) {
+            if (!document.alive) {
+                continue;
+            }
+            put(out, static_cast<std::uint16_t>(document.path.size()));
+            out += document.path;
+            put(out, document.size);
+            put(out, document.modified);
+            put(out, static_cast<std::uint32_t>(document.trigrams.size()));
+            out.append(reinterpret_cast<const char*>(document.trigrams.data()), document.trigrams.size() * sizeof(std::uint32_t));
+        }
+    }
+
+    // Written aside and renamed, so a crash never leaves a torn index
+    std::error_code ec;
+    std::filesystem::path target(path_);
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path(), ec);
+    }
+    std::string temporary = path_ + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+            Wt::log("error") << "Workspace::TrigramIndex - cannot write " << temporary;
+            return;
+        }
+    }
+    if (std::rename(temporary.c_str(), path_.c_str()) != 0) {
+        Wt::log("error") << "Workspace::TrigramIndex - cannot replace " << path_ << ": " << std::strerror(errno);
+    }
+}
+
+}
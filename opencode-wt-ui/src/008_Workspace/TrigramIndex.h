@@ -0,0 +1,111 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "008_Workspace/FileIndex.h"
+
+namespace Wt {
+    class WServer;
+}
+
+namespace Workspace {
+
+struct UsageHit {
+    std::string path;
+    std::uint32_t line = 0;    ///< 1-based
+    std::uint32_t column = 0;  ///< 0-based byte offset in the line
+    std::string text;          ///< The line, truncated
+};
+
+/**
+ * @brief Persistent trigram index of the text files under static/ and src/
+ *
+ * Every indexed file contributes the set of byte trigrams it contains.
+ * A query intersects the posting lists of its trigrams, smallest first,
+ * and only the surviving files are read to find the exact lines, so a
+ * message id or class name is located without scanning the tree.
+ *
+ * The index follows the FileIndex: files whose size or mtime changed are
+ * re-read, the others are left alone. Updates run on the server thread
+ * pool, UpdateDelay after a change so that a burst of file events costs a
+ * single pass. The per-file trigram sets are saved to disk after each pass
+ * and reloaded at startup, so a restart only re-reads the files that
+ * changed while the server was down. Until the first update has run,
+ * queries scan every indexable file instead.
+ */
+class TrigramIndex {
+public:
+    /**
+     * @param server Server whose thread pool runs the updates
+     * @param files Index to follow
+     * @param path File the index is persisted to
+     * @param roots Workspace relative directories to index
+     */
+    TrigramIndex(Wt::WServer& server, FileIndex& files, std::string path, std::vector<std::string> roots = {"static", "src"});
+    ~TrigramIndex();
+
+    TrigramIndex(const TrigramIndex&) = delete;
+    TrigramIndex& operator=(const TrigramIndex&) = delete;
+
+    /**
+     * @brief Lines containing term
+     * @param whole_word Only matches not preceded or followed by an
+     *                   identifier character ([A-Za-z0-9_-])
+     * @param max_hits Maximum number of hits returned
+     */
+    std::vector<UsageHit> find(std::string_view term, bool whole_word, std::size_t max_hits = 500) const;
+
+    std::size_t fileCount() const;
+
+    /// Files larger than this are not indexed
+    static constexpr std::uint64_t MaxFileSize = 1024 * 1024;
+
+    /// Delay between a FileIndex change and the update that follows it
+    static constexpr std::chrono::seconds UpdateDelay{2};
+
+private:
+    struct Document {
+        std::string path;
+        std::uint64_t size = 0;
+        std::int64_t modified = 0;
+        std::vector<std::uint32_t> trigrams;  ///< Sorted, distinct
+        bool alive = false;
+    };
+
+    void snapshotChanged(const SnapshotPtr& snapshot);
+    void runPendingUpdate();
+    void update(const SnapshotPtr& snapshot);
+    bool indexable(const FileEntry& entry) const;
+    bool readDocument(const std::string& root, Document& document) const;
+    void addDocument(Document document);
+    void removeDocument(std::uint32_t id);
+    bool load();
+    void save() const;
+
+    Wt::WServer& server_;
+    FileIndex& files_;
+    std::string path_;
+    std::vector<std::string> roots_;
+    int listener_ = 0;
+
+    std::mutex update_mutex_;  ///< Held by the running update
+    std::mutex pending_mutex_;
+    SnapshotPtr pending_;  ///< Latest snapshot not yet indexed
+    bool update_scheduled_ = false;
+
+    mutable std::shared_mutex mutex_;
+    std::string root_;  ///< Workspace root files are read from
+    std::vector<Document> documents_;  ///< Indexed by document id; ids are never reused
+    std::unordered_map<std::string, std::uint32_t> ids_;  ///< Path to live document id
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> postings_;  ///< Trigram to sorted document ids
+    std::size_t dead_ = 0;  ///< Removed documents still holding ids
+    bool built_ = false;  ///< Set by the first update; until then find() scans the files
+};
+
+}
@@ -0,0 +1,150 @@
+// Per-address token buckets and the construction slots new sessions wait
+// for: burst, refill, ticket ownership, the bounded bucket table, and admits
+// racing from many threads.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "000_Server/Admission.h"
+
+namespace {
+
+Admission::Options options(double per_second, double burst, std::size_t max_constructing)
+{
+    Admission::Options options;
+    options.sessions_per_second = per_second;
+    options.burst = burst;
+    options.max_constructing = max_constructing;
+    return options;
+}
+
+}
+
+TEST(Admission, BurstThenRateLimited)
+{
+    Admission admission(options(0.001, 3, 0));
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(admission.admit("10.0.0.1"));
+    }
+    EXPECT_FALSE(admission.admit("10.0.0.1"));
+    // Other addresses have their own bucket
+    EXPECT_TRUE(admission.admit("10.0.0.2"));
+}
+
+TEST(Admission, BucketRefills)
+{
+    Admission admission(options(100, 1, 0));
+    EXPECT_TRUE(admission.admit("10.0.0.1"));
+    EXPECT_FALSE(admission.admit("10.0.0.1"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_TRUE(admission.admit("10.0.0.1"));
+}
+
+TEST(Admission, ZeroRateDisablesTheLimit)
+{
+    Admission admission(options(0, 1, 0));
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(admission.admit("10.0.0.1"));
+    }
+}
+
+TEST(Admission, TicketHoldsAConstructionSlot)
+{
+    Admission admission(options(0, 1, 2));
+    {
+        Admission::Ticket first = admission.admit("10.0.0.1");
+        Admission::Ticket second = admission.admit("10.0.0.2");
+        EXPECT_TRUE(first);
+        EXPECT_TRUE(second);
+        EXPECT_FALSE(admission.admit("10.0.0.3"));
+
+        // Moving a ticket keeps one slot, not two
+        Admission::Ticket moved(std::move(first));
+        EXPECT_TRUE(moved);
+        EXPECT_FALSE(first);
+        EXPECT_FALSE(admission.admit("10.0.0.3"));
+    }
+    EXPECT_TRUE(admission.admit("10.0.0.3"));
+}
+
+TEST(Admission, OverCapacityKeepsTheToken)
+{
+    Admission admission(options(0.001, 1, 1));
+    {
+        Admission::Ticket busy = admission.admit("10.0.0.1");
+        ASSERT_TRUE(busy);
+        EXPECT_FALSE(admission.admit("10.0.0.2"));
+    }
+    // Turned away for capacity only, its bucket was not touched
+    EXPECT_TRUE(admission.admit("10.0.0.2"));
+}
+
+TEST(Admission, FullTableEvictsTheLeastRecentlySeen)
+{
+    // Every tracked address has spent its only token and refills for hours
+    Admission admission(options(0.0001, 1, 0));
+    const int tracked = 4096;
+    for (int i = 0; i < tracked; ++i) {
+        ASSERT_TRUE(admission.admit("addr-" + std::to_string(i)));
+    }
+    EXPECT_FALSE(admission.admit("addr-0"));
+
+    // A new address is still let in; addr-1, now the oldest, makes room for it
+    EXPECT_TRUE(admission.admit("new-address"));
+    EXPECT_TRUE(admission.admit("addr-1"));
+    // addr-0 was seen again above, so it was not the one evicted
+    EXPECT_FALSE(admission.admit("addr-0"));
+}
+
+TEST(Admission, ConcurrentAdmitsRespectTheSlots)
+{
+    Admission admission(options(0, 1, 3));
+    std::atomic<int> inside{0};
+    std::atomic<int> most{0};
+    std::atomic<int> admitted{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 2000; ++i) {
+                Admission::Ticket ticket = admission.admit("10.0.0." + std::to_string(t));
+                if (!ticket) {
+                    continue;
+                }
+                int now = ++inside;
+                int seen = most.load();
+                while (now > seen && !most.compare_exchange_weak(seen, now)) {
+                }
+                ++admitted;
+                --inside;
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    EXPECT_LE(most.load(), 3);
+    EXPECT_GT(admitted.load(), 0);
+}
+
+TEST(Admission, ConcurrentAdmitsSpendEachTokenOnce)
+{
+    Admission admission(options(0.0001, 50, 0));
+    std::atomic<int> admitted{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 100; ++i) {
+                if (admission.admit("10.0.0.1")) {
+                    ++admitted;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(admitted.load(), 50);
+}
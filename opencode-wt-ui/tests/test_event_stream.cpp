@@ -0,0 +1,497 @@
+// The shared opencode event stream against a local stand-in for the opencode
+// server: a socket that answers GET /event with a chunked text/event-stream
+// the test writes to. Batches are delivered to real Wt sessions, so the test
+// runs a WServer on a free local port and opens sessions with plain GETs
+// (progressive bootstrap constructs the application on the first request).
+
+#include <gtest/gtest.h>
+
+#include <Wt/WApplication.h>
+#include <Wt/WEnvironment.h>
+#include <Wt/WServer.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "007_Opencode/EventStream.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+int listenLocal(int& port)
+{
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 8) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    socklen_t length = sizeof(address);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+    port = ntohs(address.sin_port);
+    return fd;
+}
+
+bool writeAll(int fd, const std::string& data)
+{
+    std::size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        written += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+/// Reads until terminator (or end of stream when empty) or timeout
+std::string readUntil(int fd, const std::string& terminator, std::chrono::milliseconds timeout)
+{
+    std::string data;
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    char buffer[4096];
+    while (terminator.empty() || data.find(terminator) == std::string::npos) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        pollfd poll_fd{fd, POLLIN, 0};
+        if (left.count() <= 0 || ::poll(&poll_fd, 1, static_cast<int>(left.count())) <= 0) {
+            break;
+        }
+        ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            break;
+        }
+        data.append(buffer, static_cast<std::size_t>(n));
+    }
+    return data;
+}
+
+/**
+ * Stand-in for the opencode server: accepts GET /event and streams what the
+ * test sends, chunk by chunk, until hangUp()
+ */
+class OpencodeStandIn {
+public:
+    OpencodeStandIn() { listen_fd_ = listenLocal(port_); }
+
+    ~OpencodeStandIn()
+    {
+        if (client_fd_ >= 0) {
+            ::close(client_fd_);
+        }
+        ::close(listen_fd_);
+    }
+
+    std::string url() const { return "http://127.0.0.1:" + std::to_string(port_); }
+
+    /**
+     * Waits for the event stream request and answers with the stream headers
+     * @return The request head, empty on timeout
+     */
+    std::string accept(std::chrono::milliseconds timeout = 5s)
+    {
+        pollfd poll_fd{listen_fd_, POLLIN, 0};
+        if (::poll(&poll_fd, 1, static_cast<int>(timeout.count())) <= 0) {
+            return std::string();
+        }
+        client_fd_ = ::accept(listen_fd_, nullptr, nullptr);
+        std::string head = readUntil(client_fd_, "\r\n\r\n", timeout);
+        writeAll(client_fd_, "HTTP/1.1 200 OK\r\n"
+                             "Content-Type: text/event-stream\r\n"
+                             "Cache-Control: no-cache\r\n"
+                             "Transfer-Encoding: chunked\r\n\r\n");
+        return head;
+    }
+
+    void send(const std::string& data)
+    {
+        char size[32];
+        std::snprintf(size, sizeof(size), "%zx\r\n", data.size());
+        writeAll(client_fd_, size + data + "\r\n");
+    }
+
+    /// Sends one event; the SSE event name stays "message" as with opencode
+    void event(const std::string& json, const std::string& id = std::string())
+    {
+        send((id.empty() ? std::string() : "id: " + id + "\n") + "data: " + json + "\n\n");
+    }
+
+    /// Ends the response, as opencode does when it restarts
+    void hangUp()
+    {
+        send(std::string());
+        ::close(client_fd_);
+        client_fd_ = -1;
+    }
+
+private:
+    int listen_fd_ = -1;
+    int client_fd_ = -1;
+    int port_ = 0;
+};
+
+std::string sessionUpdated(const std::string& session)
+{
+    return R"({"type":"session.updated","properties":{"info":{"id":")" + session + R"(","title":"t"}}})";
+}
+
+std::string partUpdated(const std::string& session)
+{
+    return R"({"type":"message.part.updated","properties":{"part":{"id":"prt_1","sessionID":")" + session
+         + R"(","messageID":"msg_1","type":"text","text":"hi"},"delta":"hi"}})";
+}
+
+/// Batches a subscription received, in the order its session got them
+class Recorder {
+public:
+    /// The handler keeps the state alive, a push already under way may outlive the test
+    Opencode::EventStream::Handler handler()
+    {
+        return [state = state_](Opencode::EventBatch batch) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->batches.push_back(std::move(batch));
+            state->changed.notify_all();
+        };
+    }
+
+    /// Waits until at least count events arrived
+    bool waitForEvents(std::size_t count, std::chrono::milliseconds timeout = 5s)
+    {
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        return state_->changed.wait_for(lock, timeout, [&]() {
+            std::size_t events = 0;
+            for (const auto& batch : state_->batches) {
+                events += batch.events.size();
+            }
+            return events >= count;
+        });
+    }
+
+    /// Waits until a batch flagged resync arrived
+    bool waitForResync(std::chrono::milliseconds timeout = 5s)
+    {
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        return state_->changed.wait_for(lock, timeout, [&]() {
+            return std::any_of(state_->batches.begin(), state_->batches.end(),
+                               [](const Opencode::EventBatch& batch) { return batch.resync; });
+        });
+    }
+
+    std::vector<Opencode::EventBatch> batches()
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->batches;
+    }
+
+    std::vector<Opencode::Event> events()
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        std::vector<Opencode::Event> events;
+        for (const auto& batch : state_->batches) {
+            events.insert(events.end(), batch.events.begin(), batch.events.end());
+        }
+        return events;
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::vector<Opencode::EventBatch> batches;
+    };
+
+    std::shared_ptr<State> state_ = std::make_shared<State>();
+};
+
+std::mutex created_mutex;
+std::promise<std::string>* created = nullptr;
+
+/// Does nothing but report its session id
+class StandInApp : public Wt::WApplication {
+public:
+    explicit StandInApp(const Wt::WEnvironment& env)
+        : Wt::WApplication(env)
+    {
+        std::lock_guard<std::mutex> lock(created_mutex);
+        if (created != nullptr) {
+            created->set_value(sessionId());
+            created = nullptr;
+        }
+    }
+};
+
+/**
+ * One WServer for the whole test program, Wt allows no more. Event streams
+ * are kept until it has stopped, so no IO callback outlives its stream.
+ */
+class ServerEnvironment : public ::testing::Environment {
+public:
+    static ServerEnvironment* instance;
+
+    void SetUp() override
+    {
+        config_ = std::filesystem::temp_directory_path() / ("wt-event-stream-" + std::to_string(::getpid()) + ".xml");
+        std::ofstream(config_) << "<server><application-settings location=\"*\">"
+                                  "<progressive-bootstrap>true</progressive-bootstrap>"
+                                  "<log-config>* -debug -info</log-config>"
+                                  "</application-settings></server>";
+
+        std::vector<std::string> args = {"test_event_stream", "--docroot", ".", "--http-address", "127.0.0.1", "--http-port", "0"};
+        std::vector<char*> argv;
+        for (std::string& arg : args) {
+            argv.push_back(arg.data());
+        }
+        server_ = std::make_unique<Wt::WServer>(static_cast<int>(argv.size()), argv.data(), config_.string());
+        server_->addEntryPoint(Wt::EntryPointType::Application, [](const Wt::WEnvironment& env) {
+            return std::make_unique<StandInApp>(env);
+        });
+        ASSERT_TRUE(server_->start());
+    }
+
+    void TearDown() override
+    {
+        server_->stop();
+        streams_.clear();
+        server_.reset();
+        std::filesystem::remove(config_);
+    }
+
+    Opencode::EventStream& newStream(const std::string& url)
+    {
+        streams_.push_back(std::make_unique<Opencode::EventStream>(*server_, url));
+        return *streams_.back();
+    }
+
+    /// Opens a Wt session the way a browser's first request does
+    std::string newSession()
+    {
+        std::promise<std::string> promise;
+        std::future<std::string> id = promise.get_future();
+        {
+            std::lock_guard<std::mutex> lock(created_mutex);
+            created = &promise;
+        }
+
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<std::uint16_t>(server_->httpPort()));
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            writeAll(fd, "GET / HTTP/1.0\r\nHost: 127.0.0.1\r\n"
+                         "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n\r\n");
+            readUntil(fd, std::string(), 5s);
+        }
+        ::close(fd);
+
+        std::string session;
+        if (id.wait_for(5s) == std::future_status::ready) {
+            session = id.get();
+        }
+        std::lock_guard<std::mutex> lock(created_mutex);
+        created = nullptr;
+        return session;
+    }
+
+private:
+    std::filesystem::path config_;
+    std::unique_ptr<Wt::WServer> server_;
+    std::vector<std::unique_ptr<Opencode::EventStream>> streams_;
+};
+
+ServerEnvironment* ServerEnvironment::instance = nullptr;
+
+/// A stand-in, a started stream connected to it and a live Wt session
+class EventStreamTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        session_ = ServerEnvironment::instance->newSession();
+        ASSERT_FALSE(session_.empty()) << "no Wt session was created";
+        stream_ = &ServerEnvironment::instance->newStream(stand_in_.url());
+        stream_->start();
+        request_ = stand_in_.accept();
+        ASSERT_NE(request_.find("GET /event "), std::string::npos) << request_;
+    }
+
+    void TearDown() override
+    {
+        for (int id : subscriptions_) {
+            stream_->unsubscribe(id);
+        }
+        stream_->stop();
+    }
+
+    void subscribe(Recorder& recorder, const std::string& filter, std::chrono::milliseconds batch_window = 0ms,
+                   const std::string& type_prefix = std::string())
+    {
+        subscriptions_.push_back(stream_->subscribe(session_, filter, recorder.handler(), batch_window, type_prefix));
+    }
+
+    OpencodeStandIn stand_in_;
+    std::string session_;
+    Opencode::EventStream* stream_ = nullptr;
+    std::string request_;
+    std::vector<int> subscriptions_;
+};
+
+}
+
+TEST(SseParser, AssemblesEventsAcrossChunks)
+{
+    Opencode::SseParser parser;
+    std::vector<std::vector<std::string>> events;
+    auto callback = [&](std::string id, std::string event, std::string data) {
+        events.push_back({id, event, data});
+    };
+    parser.feed(": keep-alive\nid: 7\nda", callback);
+    parser.feed("ta: {\"a\":\r\n", callback);
+    EXPECT_TRUE(events.empty());
+    parser.feed("data: 1}\n\nevent: ping\ndata:x\n\n", callback);
+
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0], (std::vector<std::string>{"7", "message", "{\"a\":\n1}"}));
+    EXPECT_EQ(events[1], (std::vector<std::string>{"7", "ping", "x"}));
+    EXPECT_EQ(parser.lastEventId(), "7");
+}
+
+TEST(SseParser, ResetDropsThePartialEvent)
+{
+    Opencode::SseParser parser;
+    std::vector<std::string> data;
+    auto callback = [&](std::string, std::string, std::string value) { data.push_back(value); };
+    parser.feed("id: 3\ndata: half", callback);
+    parser.reset();
+    parser.feed("data: whole\n\n", callback);
+    EXPECT_EQ(data, std::vector<std::string>{"whole"});
+    // The resume point survives a reset, it is sent on reconnect
+    EXPECT_EQ(parser.lastEventId(), "3");
+}
+
+TEST_F(EventStreamTest, DeliversOnlyTheSubscribedTypes)
+{
+    Recorder sessions;
+    Recorder everything;
+    subscribe(sessions, Opencode::EventStream::AllSessions, 0ms, "session.");
+    subscribe(everything, Opencode::EventStream::AllSessions);
+
+    stand_in_.event(partUpdated("ses_a"));
+    stand_in_.event(sessionUpdated("ses_a"));
+    stand_in_.event(partUpdated("ses_b"));
+    stand_in_.event(R"({"type":"session.deleted","properties":{"info":{"id":"ses_b"}}})");
+
+    ASSERT_TRUE(everything.waitForEvents(4));
+    ASSERT_TRUE(sessions.waitForEvents(2));
+    std::this_thread::sleep_for(100ms);
+    std::vector<Opencode::Event> events = sessions.events();
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].type, "session.updated");
+    EXPECT_EQ(events[0].session_id, "ses_a");
+    EXPECT_EQ(events[1].type, "session.deleted");
+    EXPECT_EQ(events[1].session_id, "ses_b");
+}
+
+TEST_F(EventStreamTest, FiltersBySessionAndKeepsGlobalEvents)
+{
+    Recorder recorder;
+    subscribe(recorder, "ses_a");
+
+    stand_in_.event(partUpdated("ses_b"));
+    stand_in_.event(partUpdated("ses_a"));
+    stand_in_.event(R"({"type":"server.connected","properties":{}})");
+
+    ASSERT_TRUE(recorder.waitForEvents(2));
+    std::this_thread::sleep_for(100ms);
+    std::vector<Opencode::Event> events = recorder.events();
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].session_id, "ses_a");
+    ASSERT_TRUE(events[0].payload);
+    EXPECT_EQ(events[0].payload->delta, "hi");
+    EXPECT_EQ(events[1].type, "server.connected");
+    EXPECT_TRUE(events[1].session_id.empty());
+}
+
+TEST_F(EventStreamTest, BatchWindowDebouncesABurst)
+{
+    Recorder recorder;
+    subscribe(recorder, "ses_a", 300ms);
+
+    // Streamed tokens arrive in several network reads within the window
+    for (int i = 0; i < 3; ++i) {
+        stand_in_.event(partUpdated("ses_a"));
+    }
+    std::this_thread::sleep_for(50ms);
+    stand_in_.event(partUpdated("ses_a"));
+    stand_in_.event(sessionUpdated("ses_a"));
+
+    ASSERT_TRUE(recorder.waitForEvents(5));
+    std::this_thread::sleep_for(400ms);
+    std::vector<Opencode::EventBatch> batches = recorder.batches();
+    ASSERT_EQ(batches.size(), 1u);
+    EXPECT_EQ(batches[0].events.size(), 5u);
+    EXPECT_FALSE(batches[0].resync);
+
+    // The next burst opens a new window
+    stand_in_.event(sessionUpdated("ses_a"));
+    ASSERT_TRUE(recorder.waitForEvents(6));
+    EXPECT_EQ(recorder.batches().size(), 2u);
+}
+
+TEST_F(EventStreamTest, ZeroWindowPushesAtOnce)
+{
+    Recorder recorder;
+    subscribe(recorder, "ses_a");
+
+    auto sent = std::chrono::steady_clock::now();
+    stand_in_.event(sessionUpdated("ses_a"));
+    ASSERT_TRUE(recorder.waitForEvents(1));
+    EXPECT_LT(std::chrono::steady_clock::now() - sent, 250ms);
+}
+
+TEST_F(EventStreamTest, ResumesFromTheLastEventId)
+{
+    Recorder recorder;
+    subscribe(recorder, "ses_a");
+
+    stand_in_.event(sessionUpdated("ses_a"), "41");
+    ASSERT_TRUE(recorder.waitForEvents(1));
+    stand_in_.hangUp();
+
+    // Subscribers learn that events may have been missed in between
+    ASSERT_TRUE(recorder.waitForResync());
+    std::string request = stand_in_.accept();
+    EXPECT_NE(request.find("Last-Event-ID: 41"), std::string::npos) << request;
+
+    stand_in_.event(partUpdated("ses_a"), "42");
+    ASSERT_TRUE(recorder.waitForEvents(2));
+    EXPECT_EQ(recorder.events().back().id, "42");
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    ServerEnvironment::instance = new ServerEnvironment();
+    ::testing::AddGlobalTestEnvironment(ServerEnvironment::instance);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,171 @@
+// Fuzzy path completion: subsequence matching, ranking (including negative
+// scores), the narrowing cache, and finds racing snapshot updates.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "008_Workspace/FuzzyIndex.h"
+
+using Workspace::FuzzyIndex;
+
+namespace {
+
+Workspace::SnapshotPtr snapshotOf(std::vector<std::string> paths, std::uint64_t version = 1)
+{
+    std::sort(paths.begin(), paths.end(), Workspace::Snapshot::pathLess);
+    std::vector<Workspace::FileEntry> entries;
+    for (std::string& path : paths) {
+        Workspace::FileEntry entry;
+        entry.path = std::move(path);
+        entries.push_back(std::move(entry));
+    }
+    return std::make_shared<Workspace::Snapshot>("/workspace", std::move(entries), version);
+}
+
+std::vector<std::string> pathsOf(const std::vector<Workspace::FuzzyMatch>& matches)
+{
+    std::vector<std::string> paths;
+    for (const Workspace::FuzzyMatch& match : matches) {
+        paths.push_back(match.path);
+    }
+    return paths;
+}
+
+}
+
+TEST(FuzzyIndex, MatchesSubsequencesOnly)
+{
+    FuzzyIndex index;
+    index.update(snapshotOf({"src/008_Workspace/FileIndex.cpp", "src/main.cpp", "static/css/tailwind.css"}));
+    EXPECT_EQ(index.size(), 3u);
+
+    auto matches = index.find("fileidx", 10);
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_EQ(matches[0].path, "src/008_Workspace/FileIndex.cpp");
+    EXPECT_TRUE(index.find("xyz", 10).empty());
+    EXPECT_TRUE(index.find("", 10).empty());
+}
+
+TEST(FuzzyIndex, QueryIsCaseInsensitiveAndIgnoresSpaces)
+{
+    FuzzyIndex index;
+    index.update(snapshotOf({"src/001_App/App.cpp"}));
+    EXPECT_EQ(index.find("APP CPP", 10).size(), 1u);
+}
+
+TEST(FuzzyIndex, ReportsMatchedPositions)
+{
+    FuzzyIndex index;
+    index.update(snapshotOf({"src/main.cpp"}));
+    auto matches = index.find("main", 1);
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_EQ(matches[0].positions, (std::vector<std::uint16_t>{4, 5, 6, 7}));
+}
+
+TEST(FuzzyIndex, RanksFileNameMatchesFirst)
+{
+    FuzzyIndex index;
+    index.update(snapshotOf({"src/theme/a.cpp", "src/widgets/Theme.cpp"}));
+    auto matches = index.find("theme", 10);
+    ASSERT_EQ(matches.size(), 2u);
+    EXPECT_EQ(matches[0].path, "src/widgets/Theme.cpp");
+    EXPECT_GT(matches[0].score, matches[1].score);
+}
+
+TEST(FuzzyIndex, OrdersNegativeScores)
+{
+    // Long gaps push scores below zero; ranking must still be by score, then shorter path
+    FuzzyIndex index;
+    std::vector<std::string> paths = {
+        "a/zzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz/yyyyyyyyyyyyyyyyyyyyyyyyyyyyyy/b",
+        "a/zzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz/b",
+        "a/zzzzzzzzzzzzzzzzzzzzzzzz/b",
+        "ab",
+        "a/b",
+    };
+    index.update(snapshotOf(paths));
+    auto matches = index.find("ab", 10);
+    ASSERT_EQ(matches.size(), paths.size());
+    EXPECT_LT(matches.back().score, 0);
+    for (std::size_t i = 1; i < matches.size(); ++i) {
+        EXPECT_TRUE(matches[i - 1].score > matches[i].score
+                    || (matches[i - 1].score == matches[i].score && matches[i - 1].path.size() <= matches[i].path.size()))
+            << matches[i - 1].path << " (" << matches[i - 1].score << ") before "
+            << matches[i].path << " (" << matches[i].score << ")";
+    }
+}
+
+TEST(FuzzyIndex, KeepsTopResults)
+{
+    FuzzyIndex index;
+    std::vector<std::string> paths;
+    for (int i = 0; i < 100; ++i) {
+        paths.push_back("src/file" + std::to_string(i) + ".cpp");
+    }
+    index.update(snapshotOf(paths));
+    EXPECT_EQ(index.find("file", 7).size(), 7u);
+    EXPECT_EQ(index.find("file", 0).size(), 0u);
+}
+
+TEST(FuzzyIndex, FollowsSnapshots)
+{
+    FuzzyIndex index;
+    index.update(snapshotOf({"src/a.cpp", "src/b.cpp"}, 1));
+    index.update(snapshotOf({"src/b.cpp", "src/c.cpp"}, 2));
+    EXPECT_EQ(index.size(), 2u);
+    EXPECT_EQ(pathsOf(index.find("cpp", 10)), (std::vector<std::string>{"src/b.cpp", "src/c.cpp"}));
+    EXPECT_TRUE(index.find("a.cpp", 10).empty());
+}
+
+TEST(FuzzyIndex, CacheNarrowsAndIsInvalidatedByUpdates)
+{
+    FuzzyIndex index;
+    index.update(snapshotOf({"src/Search.cpp", "src/Search.h", "src/Server.cpp"}, 1));
+
+    Workspace::FuzzyCache cache;
+    EXPECT_EQ(index.find("se", 10, &cache).size(), 3u);
+    EXPECT_EQ(pathsOf(index.find("sea", 10, &cache)), pathsOf(index.find("sea", 10)));
+
+    // A file added after the cached query must still be found by a narrower one
+    index.update(snapshotOf({"src/Search.cpp", "src/Search.h", "src/Server.cpp", "src/SearchPanel.cpp"}, 2));
+    EXPECT_EQ(pathsOf(index.find("sear", 10, &cache)), pathsOf(index.find("sear", 10)));
+    EXPECT_EQ(index.find("sear", 10, &cache).size(), 3u);
+}
+
+TEST(FuzzyIndex, ConcurrentFindsDuringUpdates)
+{
+    FuzzyIndex index;
+    std::vector<std::string> base;
+    for (int i = 0; i < 500; ++i) {
+        base.push_back("src/dir" + std::to_string(i % 10) + "/file" + std::to_string(i) + ".cpp");
+    }
+    index.update(snapshotOf(base, 1));
+
+    std::atomic<std::size_t> found{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            Workspace::FuzzyCache cache;
+            for (int i = 0; i < 200; ++i) {
+                for (const auto& match : index.find(i % 2 ? "file" : "fil", 20, &cache)) {
+                    EXPECT_NE(match.path.find("fil"), std::string::npos);
+                    ++found;
+                }
+            }
+        });
+    }
+    for (std::uint64_t version = 2; version < 50; ++version) {
+        std::vector<std::string> paths = base;
+        auto first = paths.begin() + static_cast<std::ptrdiff_t>(version % 100);
+        paths.erase(first, first + 50);
+        index.update(snapshotOf(paths, version));
+    }
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    EXPECT_GT(found.load(), 0u);
+    EXPECT_EQ(index.size(), base.size() - 50);
+}
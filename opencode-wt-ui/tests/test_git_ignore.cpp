@@ -0,0 +1,100 @@
+// .gitignore pattern matching and the ignore rules the file index builds
+// from a workspace's ignore files.
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include "008_Workspace/GitIgnore.h"
+
+using Workspace::GitIgnore;
+
+TEST(GitIgnore, GlobStopsAtSlash)
+{
+    EXPECT_TRUE(GitIgnore::match("*.o", "main.o"));
+    EXPECT_FALSE(GitIgnore::match("*.o", "src/main.o"));
+    EXPECT_TRUE(GitIgnore::match("src/?.h", "src/a.h"));
+    EXPECT_FALSE(GitIgnore::match("src/?.h", "src/ab.h"));
+    EXPECT_TRUE(GitIgnore::match("**/*.o", "main.o"));
+    EXPECT_TRUE(GitIgnore::match("**/*.o", "a/b/main.o"));
+    EXPECT_TRUE(GitIgnore::match("a/**/b", "a/b"));
+    EXPECT_TRUE(GitIgnore::match("a/**/b", "a/x/y/b"));
+    EXPECT_FALSE(GitIgnore::match("a/**/b", "a/xb"));
+    EXPECT_TRUE(GitIgnore::match("log[0-9].txt", "log7.txt"));
+    EXPECT_FALSE(GitIgnore::match("log[!0-9].txt", "log7.txt"));
+    EXPECT_TRUE(GitIgnore::match("log[!0-9].txt", "logx.txt"));
+}
+
+TEST(GitIgnore, UnanchoredPatternsMatchAtAnyDepth)
+{
+    GitIgnore ignore;
+    ignore.add("", "# build output\n*.o\n\nnode_modules\n");
+    EXPECT_TRUE(ignore.ignored("main.o", false));
+    EXPECT_TRUE(ignore.ignored("src/deep/main.o", false));
+    EXPECT_TRUE(ignore.ignored("static/node_modules", true));
+    EXPECT_TRUE(ignore.ignored("static/node_modules/pkg/index.js", false));
+    EXPECT_FALSE(ignore.ignored("src/main.cpp", false));
+    EXPECT_FALSE(ignore.ignored("# build output", false));
+}
+
+TEST(GitIgnore, AnchoredPatternsMatchBelowTheirBase)
+{
+    GitIgnore ignore;
+    ignore.add("", "/build\n");
+    EXPECT_TRUE(ignore.ignored("build", true));
+    EXPECT_TRUE(ignore.ignored("build/app", false));
+    EXPECT_FALSE(ignore.ignored("src/build", true));
+}
+
+TEST(GitIgnore, DirectoryOnlyPatterns)
+{
+    GitIgnore ignore;
+    ignore.add("", "cache/\n");
+    EXPECT_TRUE(ignore.ignored("cache", true));
+    EXPECT_FALSE(ignore.ignored("cache", false));
+    EXPECT_TRUE(ignore.ignored("a/cache/file.txt", false));
+}
+
+TEST(GitIgnore, LaterNegationWins)
+{
+    GitIgnore ignore;
+    ignore.add("", "*.log\n!keep.log\n");
+    EXPECT_TRUE(ignore.ignored("server.log", false));
+    EXPECT_FALSE(ignore.ignored("keep.log", false));
+    EXPECT_FALSE(ignore.ignored("logs/keep.log", false));
+}
+
+TEST(GitIgnore, NestedFileTakesPrecedence)
+{
+    GitIgnore ignore;
+    ignore.add("", "*.json\n");
+    ignore.add("static", "!*.json\n");
+    EXPECT_TRUE(ignore.ignored("package.json", false));
+    EXPECT_FALSE(ignore.ignored("static/manifest.json", false));
+    // Rules of a nested file stay below its directory
+    EXPECT_TRUE(ignore.ignored("staticx/manifest.json", false));
+}
+
+TEST(GitIgnore, LoadsEveryGitIgnoreOfASnapshot)
+{
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "wt-gitignore-test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "src");
+    std::ofstream(root / ".gitignore") << "*.tmp\n";
+    std::ofstream(root / "src" / ".gitignore") << "generated/\n";
+
+    std::vector<Workspace::FileEntry> entries;
+    entries.push_back({".gitignore", false, 6, 0});
+    entries.push_back({"src", true, 0, 0});
+    entries.push_back({"src/.gitignore", false, 11, 0});
+    Workspace::Snapshot snapshot(root.string(), entries, 1);
+
+    GitIgnore ignore = GitIgnore::load(snapshot);
+    EXPECT_FALSE(ignore.empty());
+    EXPECT_TRUE(ignore.ignored("a.tmp", false));
+    EXPECT_TRUE(ignore.ignored("src/generated/x.cpp", false));
+    EXPECT_FALSE(ignore.ignored("generated/x.cpp", false));
+
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,207 @@
+// Content-defined chunking and the revision log of shared files: dedupe of
+// unchanged chunks, recovery from a torn log line, concurrent saves.
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <set>
+#include <thread>
+#include <unistd.h>
+
+#include "008_Workspace/RevisionStore.h"
+
+using Workspace::RevisionStore;
+
+namespace {
+
+class RevisionStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        directory_ = std::filesystem::temp_directory_path()
+                   / ("wt-revisions-" + std::to_string(::getpid()) + "-"
+                      + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        std::filesystem::remove_all(directory_);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(directory_); }
+
+    std::size_t objectCount() const
+    {
+        std::size_t count = 0;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(directory_ / "objects")) {
+            count += entry.is_regular_file();
+        }
+        return count;
+    }
+
+    std::filesystem::path directory_;
+};
+
+std::string randomText(std::size_t size, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::string text(size, ' ');
+    for (char& c : text) {
+        c = static_cast<char>(std::uniform_int_distribution<int>(32, 126)(rng));
+    }
+    return text;
+}
+
+}
+
+TEST(RevisionStoreChunks, BoundsAndCoverage)
+{
+    std::string content = randomText(200 * 1024, 1);
+    std::vector<std::size_t> ends = RevisionStore::chunkEnds(content);
+    ASSERT_FALSE(ends.empty());
+    EXPECT_EQ(ends.back(), content.size());
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < ends.size(); ++i) {
+        std::size_t size = ends[i] - start;
+        EXPECT_LE(size, RevisionStore::MaxChunk);
+        if (i + 1 < ends.size()) {
+            EXPECT_GE(size, RevisionStore::MinChunk);
+        }
+        start = ends[i];
+    }
+    EXPECT_TRUE(RevisionStore::chunkEnds("").empty());
+}
+
+TEST(RevisionStoreChunks, EditOnlyMovesNearbyBoundaries)
+{
+    std::string content = randomText(100 * 1024, 2);
+    std::vector<std::size_t> before = RevisionStore::chunkEnds(content);
+    content.insert(50 * 1024, "inserted");
+    std::vector<std::size_t> after = RevisionStore::chunkEnds(content);
+
+    // Boundaries after the edit are the old ones shifted by the insert
+    std::set<std::size_t> shifted;
+    for (std::size_t end : before) {
+        if (end > 50 * 1024) {
+            shifted.insert(end + 8);
+        }
+    }
+    std::size_t kept = 0;
+    for (std::size_t end : after) {
+        kept += shifted.count(end);
+    }
+    EXPECT_GE(kept + 2, shifted.size());
+}
+
+TEST_F(RevisionStoreTest, RecordsAndReadsRevisions)
+{
+    RevisionStore store(directory_.string());
+    EXPECT_EQ(store.record("static/app.xml", "<messages/>", "alice"), 1u);
+    EXPECT_EQ(store.record("static/app.xml", "<messages><message id=\"a\"/></messages>", "bob"), 2u);
+
+    std::vector<Workspace::FileRevision> revisions = store.revisions("static/app.xml");
+    ASSERT_EQ(revisions.size(), 2u);
+    EXPECT_EQ(revisions[0].number, 1u);
+    EXPECT_EQ(revisions[0].author, "alice");
+    EXPECT_EQ(revisions[1].size, 38u);
+
+    std::string content;
+    ASSERT_TRUE(store.read("static/app.xml", 1, content));
+    EXPECT_EQ(content, "<messages/>");
+    ASSERT_TRUE(store.read("static/app.xml", 2, content));
+    EXPECT_EQ(content, "<messages><message id=\"a\"/></messages>");
+    EXPECT_FALSE(store.read("static/app.xml", 3, content));
+    EXPECT_TRUE(store.revisions("static/other.xml").empty());
+}
+
+TEST_F(RevisionStoreTest, UnchangedContentKeepsTheRevision)
+{
+    RevisionStore store(directory_.string());
+    EXPECT_EQ(store.record("a.css", "body {}", "alice"), 1u);
+    EXPECT_EQ(store.record("a.css", "body {}", "bob"), 1u);
+    EXPECT_EQ(store.revisions("a.css").size(), 1u);
+}
+
+TEST_F(RevisionStoreTest, EmptyFile)
+{
+    RevisionStore store(directory_.string());
+    EXPECT_EQ(store.record("empty.txt", "", "alice"), 1u);
+    std::string content = "stale";
+    ASSERT_TRUE(store.read("empty.txt", 1, content));
+    EXPECT_EQ(content, "");
+}
+
+TEST_F(RevisionStoreTest, StoresSharedChunksOnce)
+{
+    RevisionStore store(directory_.string());
+    std::string content = randomText(256 * 1024, 3);
+    ASSERT_EQ(store.record("big.txt", content, "alice"), 1u);
+    std::size_t first = objectCount();
+    ASSERT_GT(first, 4u);
+
+    content.replace(128 * 1024, 5, "EDIT!");
+    ASSERT_EQ(store.record("big.txt", content, "alice"), 2u);
+    EXPECT_LE(objectCount(), first + 2);
+
+    // A copy under another name adds no object at all
+    std::size_t second = objectCount();
+    ASSERT_EQ(store.record("copy.txt", content, "alice"), 1u);
+    EXPECT_EQ(objectCount(), second);
+
+    std::string read;
+    ASSERT_TRUE(store.read("big.txt", 2, read));
+    EXPECT_EQ(read, content);
+}
+
+TEST_F(RevisionStoreTest, SurvivesATornLogLine)
+{
+    {
+        RevisionStore store(directory_.string());
+        ASSERT_EQ(store.record("a.xml", "one", "alice"), 1u);
+    }
+    // A crash in the middle of an append leaves half a line
+    for (const auto& entry : std::filesystem::directory_iterator(directory_ / "logs")) {
+        std::ofstream(entry.path(), std::ios::binary | std::ios::app) << "2\t17";
+    }
+
+    RevisionStore store(directory_.string());
+    EXPECT_EQ(store.revisions("a.xml").size(), 1u);
+    EXPECT_EQ(store.record("a.xml", "two", "alice"), 2u);
+    std::string content;
+    ASSERT_TRUE(store.read("a.xml", 2, content));
+    EXPECT_EQ(content, "two");
+    EXPECT_EQ(store.revisions("a.xml").size(), 2u);
+}
+
+TEST_F(RevisionStoreTest, ConcurrentRecords)
+{
+    RevisionStore store(directory_.string());
+    const int threads = 8;
+    const int per_thread = 10;
+    std::vector<std::vector<std::uint64_t>> numbers(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            for (int i = 0; i < per_thread; ++i) {
+                // Every thread saves the shared file, and one of its own
+                numbers[t].push_back(store.record("shared.xml", "t" + std::to_string(t) + " i" + std::to_string(i), "user"));
+                store.record("own" + std::to_string(t) + ".xml", randomText(20 * 1024, t * 100 + i), "user");
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    std::set<std::uint64_t> seen;
+    for (const auto& list : numbers) {
+        for (std::uint64_t number : list) {
+            EXPECT_NE(number, 0u);
+            EXPECT_TRUE(seen.insert(number).second) << "revision " << number << " handed out twice";
+        }
+    }
+    EXPECT_EQ(store.revisions("shared.xml").size(), static_cast<std::size_t>(threads * per_thread));
+    for (int t = 0; t < threads; ++t) {
+        std::string content;
+        ASSERT_TRUE(store.read("own" + std::to_string(t) + ".xml", per_thread, content));
+        EXPECT_EQ(content, randomText(20 * 1024, t * 100 + per_thread - 1));
+    }
+}
@@ -0,0 +1,177 @@
+// Operational transform on UTF-16 text: apply, component merging, JSON
+// round trips, and transform convergence on random concurrent edits.
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "008_Workspace/TextOperation.h"
+
+using Workspace::TextOperation;
+
+namespace {
+
+std::u16string u(const char* text)
+{
+    return TextOperation::fromUtf8(text);
+}
+
+/// A random edit of a text of the given length
+TextOperation randomOperation(std::mt19937& rng, std::size_t length)
+{
+    TextOperation op;
+    std::size_t left = length;
+    while (left > 0) {
+        std::size_t count = std::uniform_int_distribution<std::size_t>(1, left)(rng);
+        switch (std::uniform_int_distribution<int>(0, 2)(rng)) {
+        case 0:
+            op.retain(count);
+            left -= count;
+            break;
+        case 1:
+            op.remove(count);
+            left -= count;
+            break;
+        default:
+            op.insert(u("xy"));
+            break;
+        }
+    }
+    if (std::uniform_int_distribution<int>(0, 1)(rng)) {
+        op.insert(u("z"));
+    }
+    return op;
+}
+
+}
+
+TEST(TextOperation, AppliesRetainInsertDelete)
+{
+    TextOperation op;
+    op.retain(6).remove(5).insert(u("there"));
+    EXPECT_EQ(op.baseLength(), 11u);
+    EXPECT_EQ(op.targetLength(), 11u);
+
+    std::u16string text = u("hello world");
+    ASSERT_TRUE(op.apply(text));
+    EXPECT_EQ(TextOperation::toUtf8(text), "hello there");
+}
+
+TEST(TextOperation, RejectsTextOfAnotherLength)
+{
+    TextOperation op;
+    op.retain(3).insert(u("!"));
+    std::u16string text = u("four");
+    EXPECT_FALSE(op.apply(text));
+    EXPECT_EQ(TextOperation::toUtf8(text), "four");
+}
+
+TEST(TextOperation, MergesAdjacentComponents)
+{
+    TextOperation op;
+    op.retain(2).retain(3).insert(u("a")).insert(u("b")).remove(1).remove(1);
+    ASSERT_EQ(op.components().size(), 3u);
+    EXPECT_EQ(op.components()[0].count, 5u);
+    EXPECT_EQ(op.components()[1].text, u("ab"));
+    EXPECT_EQ(op.components()[2].count, 2u);
+}
+
+TEST(TextOperation, NoopOnlyRetains)
+{
+    TextOperation op;
+    op.retain(4);
+    EXPECT_TRUE(op.isNoop());
+    op.insert(u("x"));
+    EXPECT_FALSE(op.isNoop());
+}
+
+TEST(TextOperation, CountsUtf16Units)
+{
+    // U+1F600 is a surrogate pair, two units in the editor
+    std::u16string text = u("a\xF0\x9F\x98\x80" "b");
+    EXPECT_EQ(text.size(), 4u);
+    EXPECT_EQ(TextOperation::toUtf8(text), "a\xF0\x9F\x98\x80" "b");
+
+    TextOperation op;
+    op.retain(1).remove(2).retain(1);
+    ASSERT_TRUE(op.apply(text));
+    EXPECT_EQ(TextOperation::toUtf8(text), "ab");
+}
+
+TEST(TextOperation, JsonRoundTrip)
+{
+    TextOperation op;
+    op.retain(2).insert(u("hi")).remove(3).retain(1);
+    nlohmann::json json = op.toJson();
+    EXPECT_EQ(json, nlohmann::json::parse(R"([2, "hi", -3, 1])"));
+
+    TextOperation back;
+    ASSERT_TRUE(TextOperation::fromJson(json, back));
+    EXPECT_EQ(back.toJson(), json);
+    EXPECT_EQ(back.baseLength(), op.baseLength());
+    EXPECT_EQ(back.targetLength(), op.targetLength());
+}
+
+TEST(TextOperation, JsonRejectsMalformed)
+{
+    TextOperation op;
+    EXPECT_FALSE(TextOperation::fromJson(nlohmann::json::parse(R"({"retain": 1})"), op));
+    EXPECT_FALSE(TextOperation::fromJson(nlohmann::json::parse(R"([0])"), op));
+    EXPECT_FALSE(TextOperation::fromJson(nlohmann::json::parse(R"([1.5])"), op));
+    EXPECT_FALSE(TextOperation::fromJson(nlohmann::json::parse(R"([true])"), op));
+}
+
+TEST(TextOperation, TransformOrdersInsertsAtSameOffset)
+{
+    TextOperation a;
+    a.retain(3).insert(u("A"));
+    TextOperation b;
+    b.retain(3).insert(u("B"));
+
+    TextOperation a_prime;
+    TextOperation b_prime;
+    ASSERT_TRUE(TextOperation::transform(a, b, a_prime, b_prime));
+
+    std::u16string left = u("abc");
+    ASSERT_TRUE(a.apply(left));
+    ASSERT_TRUE(b_prime.apply(left));
+    std::u16string right = u("abc");
+    ASSERT_TRUE(b.apply(right));
+    ASSERT_TRUE(a_prime.apply(right));
+    EXPECT_EQ(TextOperation::toUtf8(left), "abcAB");
+    EXPECT_EQ(left, right);
+}
+
+TEST(TextOperation, TransformRejectsDifferentBases)
+{
+    TextOperation a;
+    a.retain(3);
+    TextOperation b;
+    b.retain(4);
+    TextOperation a_prime;
+    TextOperation b_prime;
+    EXPECT_FALSE(TextOperation::transform(a, b, a_prime, b_prime));
+}
+
+TEST(TextOperation, TransformConverges)
+{
+    // Whatever two sessions do to the same text, both orders end up equal
+    std::mt19937 rng(26);
+    for (int round = 0; round < 500; ++round) {
+        std::u16string base = u("the quick brown fox");
+        TextOperation a = randomOperation(rng, base.size());
+        TextOperation b = randomOperation(rng, base.size());
+
+        TextOperation a_prime;
+        TextOperation b_prime;
+        ASSERT_TRUE(TextOperation::transform(a, b, a_prime, b_prime));
+
+        std::u16string left = base;
+        ASSERT_TRUE(a.apply(left));
+        ASSERT_TRUE(b_prime.apply(left));
+        std::u16string right = base;
+        ASSERT_TRUE(b.apply(right));
+        ASSERT_TRUE(a_prime.apply(right));
+        ASSERT_EQ(left, right) << "a " << a.toJson().dump() << ", b " << b.toJson().dump();
+    }
+}
@@ -0,0 +1,195 @@
+// Compressed transcript logs: windowed reads across blocks, gap handling,
+// reopen from disk, the open-log bound, and concurrent sessions.
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+#include "007_Opencode/TranscriptStore.h"
+
+using Opencode::MessageData;
+using Opencode::PartData;
+using Opencode::TranscriptStore;
+
+namespace {
+
+class TranscriptStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        directory_ = std::filesystem::temp_directory_path()
+                   / ("wt-transcripts-" + std::to_string(::getpid()) + "-"
+                      + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        std::filesystem::remove_all(directory_);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(directory_); }
+
+    std::filesystem::path directory_;
+};
+
+MessageData message(std::size_t number)
+{
+    MessageData message;
+    message.id = "msg_" + std::to_string(number);
+    message.role = number % 2 ? "assistant" : "user";
+    PartData text;
+    text.id = "prt_" + std::to_string(number);
+    text.message_id = message.id;
+    text.type = "text";
+    text.text = "message " + std::to_string(number) + " " + std::string(number % 50, 'x');
+    message.parts.push_back(text);
+    if (number % 3 == 0) {
+        PartData tool;
+        tool.id = "prt_tool_" + std::to_string(number);
+        tool.type = "tool";
+        tool.tool = "edit";
+        tool.status = "completed";
+        tool.file_path = "src/main.cpp";
+        tool.old_text = "a";
+        tool.new_text = "b";
+        message.parts.push_back(tool);
+    }
+    return message;
+}
+
+std::vector<MessageData> messages(std::size_t first, std::size_t count)
+{
+    std::vector<MessageData> result;
+    for (std::size_t i = first; i < first + count; ++i) {
+        result.push_back(message(i));
+    }
+    return result;
+}
+
+void expectMessages(const std::vector<MessageData>& read, std::size_t first, std::size_t count)
+{
+    ASSERT_EQ(read.size(), count);
+    for (std::size_t i = 0; i < count; ++i) {
+        MessageData expected = message(first + i);
+        EXPECT_EQ(read[i].id, expected.id);
+        EXPECT_EQ(read[i].role, expected.role);
+        ASSERT_EQ(read[i].parts.size(), expected.parts.size()) << expected.id;
+        for (std::size_t p = 0; p < expected.parts.size(); ++p) {
+            EXPECT_EQ(read[i].parts[p].text, expected.parts[p].text);
+            EXPECT_EQ(read[i].parts[p].tool, expected.parts[p].tool);
+            EXPECT_EQ(read[i].parts[p].new_text, expected.parts[p].new_text);
+        }
+    }
+}
+
+std::size_t openDescriptors()
+{
+    return static_cast<std::size_t>(std::distance(std::filesystem::directory_iterator("/proc/self/fd"),
+                                                  std::filesystem::directory_iterator()));
+}
+
+}
+
+TEST_F(TranscriptStoreTest, AppendsAndReadsWindows)
+{
+    TranscriptStore store(directory_.string());
+    const std::size_t total = 3 * TranscriptStore::BlockRecords + 5;
+    EXPECT_EQ(store.append("ses_1", 0, messages(0, total)), total);
+    EXPECT_EQ(store.messageCount("ses_1"), total);
+    EXPECT_GT(store.logSize("ses_1"), 0u);
+
+    expectMessages(store.read("ses_1", 0, total), 0, total);
+    // Windows across block boundaries and into the unflushed tail
+    expectMessages(store.read("ses_1", TranscriptStore::BlockRecords - 3, 10), TranscriptStore::BlockRecords - 3, 10);
+    expectMessages(store.read("ses_1", total - 7, 50), total - 7, 7);
+    EXPECT_TRUE(store.read("ses_1", total, 10).empty());
+}
+
+TEST_F(TranscriptStoreTest, SkipsStoredMessagesAndRefusesGaps)
+{
+    TranscriptStore store(directory_.string());
+    EXPECT_EQ(store.append("ses_1", 0, messages(0, 10)), 10u);
+    // Overlapping: only 10..14 are new
+    EXPECT_EQ(store.append("ses_1", 5, messages(5, 10)), 15u);
+    // Would leave 15..19 missing
+    EXPECT_EQ(store.append("ses_1", 20, messages(20, 5)), 15u);
+    expectMessages(store.read("ses_1", 0, 100), 0, 15);
+}
+
+TEST_F(TranscriptStoreTest, PersistsAcrossReopen)
+{
+    const std::size_t total = 2 * TranscriptStore::BlockRecords + 3;
+    {
+        TranscriptStore store(directory_.string());
+        store.append("ses_1", 0, messages(0, total));
+    }
+    TranscriptStore store(directory_.string());
+    EXPECT_EQ(store.messageCount("ses_1"), total);
+    expectMessages(store.read("ses_1", 0, total), 0, total);
+    EXPECT_EQ(store.append("ses_1", total, messages(total, 2)), total + 2);
+}
+
+TEST_F(TranscriptStoreTest, RejectsUnsafeSessionIds)
+{
+    TranscriptStore store(directory_.string());
+    EXPECT_EQ(store.append("../escape", 0, messages(0, 1)), 0u);
+    EXPECT_EQ(store.append("", 0, messages(0, 1)), 0u);
+    EXPECT_TRUE(store.logPath("a/b").empty());
+    EXPECT_FALSE(std::filesystem::exists(directory_.parent_path() / "escape.log"));
+}
+
+TEST_F(TranscriptStoreTest, RemoveDeletesTheLog)
+{
+    TranscriptStore store(directory_.string());
+    store.append("ses_1", 0, messages(0, 40));
+    store.flush("ses_1");
+    ASSERT_TRUE(std::filesystem::exists(store.logPath("ses_1")));
+    store.remove("ses_1");
+    EXPECT_FALSE(std::filesystem::exists(store.logPath("ses_1")));
+    EXPECT_EQ(store.messageCount("ses_1"), 0u);
+}
+
+TEST_F(TranscriptStoreTest, OpenLogsStayBounded)
+{
+    TranscriptStore store(directory_.string());
+    const std::size_t before = openDescriptors();
+    const std::size_t sessions = 3 * TranscriptStore::MaxOpenLogs;
+    for (std::size_t s = 0; s < sessions; ++s) {
+        store.append("ses_" + std::to_string(s), 0, messages(0, TranscriptStore::BlockRecords + 1));
+    }
+    // Two files per open log
+    EXPECT_LE(openDescriptors(), before + 2 * TranscriptStore::MaxOpenLogs);
+
+    // Closed logs were flushed and reopen from disk
+    for (std::size_t s = 0; s < sessions; s += 17) {
+        expectMessages(store.read("ses_" + std::to_string(s), 0, 100), 0, TranscriptStore::BlockRecords + 1);
+    }
+}
+
+TEST_F(TranscriptStoreTest, ConcurrentSessions)
+{
+    TranscriptStore store(directory_.string());
+    const int threads = 8;
+    const std::size_t per_session = 2 * TranscriptStore::BlockRecords + 9;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            const std::string own = "ses_own_" + std::to_string(t);
+            for (std::size_t i = 0; i < per_session; ++i) {
+                store.append(own, i, messages(i, 1));
+                // Everyone also streams into one shared session, overlapping each other
+                std::size_t count = store.messageCount("ses_shared");
+                store.append("ses_shared", count, messages(count, 1));
+                store.read("ses_shared", count > 5 ? count - 5 : 0, 5);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    for (int t = 0; t < threads; ++t) {
+        expectMessages(store.read("ses_own_" + std::to_string(t), 0, per_session), 0, per_session);
+    }
+    std::size_t shared = store.messageCount("ses_shared");
+    EXPECT_GE(shared, per_session);
+    expectMessages(store.read("ses_shared", 0, shared), 0, shared);
+}